@@ -0,0 +1,6 @@
+#include "Adc.h"
+
+#if defined(__AVR__)
+// Only wakes the CPU from Adc::read(); the result is read from ADC there
+EMPTY_INTERRUPT(ADC_vect);
+#endif
@@ -0,0 +1,106 @@
+#pragma once
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "Config.h"
+
+// -----------------------------------------------------------------------------
+// Adc - ADC conversions with the CPU asleep, oversampling on a fast ADC clock
+// -----------------------------------------------------------------------------
+// analogRead() busy-waits ~104us per conversion with the CPU core and the
+// flash switching next to the ADC. read() starts the conversion and sleeps in
+// SLEEP_MODE_IDLE until the ADC interrupt: clkCPU and clkFLASH stop, clkIO and
+// clkADC keep running.
+//
+// Why IDLE and not ADC Noise Reduction: that mode (and every deeper one) also
+// stops clkIO, which halts Timer 0. The power PWM on D5/D6 would freeze at its
+// current level during every conversion (~40% of a PWM period, 40+ conversions
+// per control tick) and millis()/micros() would lose that time. IDLE keeps
+// the PWM and the time base exact and still silences the CPU core.
+//
+// Other interrupts (Timer 0 overflow every 255us, CAN INT, Serial) wake the
+// CPU early; read() sleeps again until ADSC clears. With interrupts disabled
+// there is no wake-up source, so read() busy-waits like analogRead().
+//
+// The 3.9 kHz ripple on the ACS758 outputs is load current, not conversion
+// noise: CURRENT_ADC_SAMPLES still has to average over the PWM phase. The
+// boot calibration prints the standard deviation per channel - compare it with
+// ENABLE_ADC_SLEEP on and off before cutting sample counts.
+// -----------------------------------------------------------------------------
+
+class Adc {
+public:
+    // pin: A0..A7 or channel 0..7, AVcc reference (analogReference(DEFAULT))
+    static uint16_t read(uint8_t pin) {
+        select(pin);
+        return convert(pin);
+    }
+
+    // 4^bits conversions at 16 MHz / prescaler (16..128), decimated to
+    // 10 + bits bits: 0 .. 1023 << bits. The ADC clock is set back afterwards
+    // (the core's /128), so read() and analogRead() keep full accuracy.
+    //
+    // Conversion time is 13 ADC clocks: 104us at /128, 26us at /32, 13us at
+    // /16. Each extra bit costs 4x the conversions, so 12 bits (16 + 1
+    // conversions) at /32 take ~440us - four default conversions, not one.
+    // Only 11 bits at /16 (5 x 13us) beat a single analogRead().
+    // Above 200 kHz a single conversion loses about a bit of accuracy; the
+    // decimation needs at least one LSB of noise on the input to gain bits.
+    static uint16_t readOversampled(uint8_t pin, uint8_t bits, uint8_t prescaler) {
+        uint8_t savedPrescaler = ADCSRA & ADPS_MASK;
+        ADCSRA = (ADCSRA & (uint8_t)~ADPS_MASK) | prescalerBits(prescaler);
+        select(pin);
+        convert(pin);  // Discarded: the S/H may still hold the previous channel
+        uint32_t sum = 0;
+        uint16_t count = (uint16_t)1 << (2 * bits);
+        for (uint16_t i = 0; i < count; i++) {
+            sum += convert(pin);
+        }
+        ADCSRA = (ADCSRA & (uint8_t)~ADPS_MASK) | savedPrescaler;
+        return (uint16_t)(sum >> bits);
+    }
+
+private:
+    static const uint8_t ADPS_MASK = _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+
+    static uint8_t prescalerBits(uint8_t prescaler) {
+        switch (prescaler) {
+            case 16: return _BV(ADPS2);
+            case 32: return _BV(ADPS2) | _BV(ADPS0);
+            case 64: return _BV(ADPS2) | _BV(ADPS1);
+            default: return ADPS_MASK;  // 128
+        }
+    }
+
+#if defined(__AVR__)
+    static void select(uint8_t pin) {
+        if (pin >= A0) pin -= A0;
+        ADMUX = _BV(REFS0) | (pin & 0x07);
+    }
+
+    static uint16_t convert(uint8_t) {
+        if (Config::ENABLE_ADC_SLEEP && (SREG & _BV(SREG_I))) {
+            ADCSRA |= _BV(ADIE) | _BV(ADSC);
+            set_sleep_mode(SLEEP_MODE_IDLE);
+            while (ADCSRA & _BV(ADSC)) {
+                cli();
+                if (ADCSRA & _BV(ADSC)) {
+                    sleep_enable();
+                    sei();        // SEI delays interrupts by one instruction:
+                    sleep_cpu();  // a completion right here still wakes the CPU
+                    sleep_disable();
+                }
+                sei();
+            }
+            ADCSRA &= (uint8_t)~_BV(ADIE);
+        } else {
+            ADCSRA |= _BV(ADSC);
+            while (ADCSRA & _BV(ADSC)) { }
+        }
+        return ADC;
+    }
+#else
+    // Host build: the simulator's analogRead() (same conversion time, ADPS included)
+    static void select(uint8_t) {}
+    static uint16_t convert(uint8_t pin) { return (uint16_t)analogRead(pin); }
+#endif
+};
@@ -0,0 +1,182 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "CanInterface.h"
+#include "CanTelemetry.h"
+#include "CanTelemetryLayout.h"
+
+// -----------------------------------------------------------------------------
+// CanCommand - Setpoint source from the ECU command frame
+// -----------------------------------------------------------------------------
+// Decodes PumpCommand (CAN_COMMAND_ID, layout PUMP_COMMAND_SIGNALS in
+// CanTelemetryLayout.h). A frame is accepted only if:
+//   - dlc is 8 and CommandChecksum matches (CRC-8 SAE J1850 over id + bytes 0..6)
+//   - the counter moved forward by 1..CAN_COMMAND_MAX_COUNTER_STEP. A repeated
+//     counter means a stuck sender and is rejected; a larger jump is rejected
+//     and resynchronises, so the next consecutive frame is accepted again
+//   - mode is known and the duty is within 0..100 %
+// The first frame after the command went stale is accepted with any counter.
+//
+// onFrame() runs from loop() as soon as the frame leaves the RX ring, so a new
+// setpoint is applied without waiting for the 20 Hz control tick. update()
+// runs at the tick and decides whether the command is in control (fresh and
+// not RELEASE).
+// -----------------------------------------------------------------------------
+
+class CanCommand {
+public:
+    // CommandMode values (see PUMP_TELEMETRY_VALUES)
+    enum Mode : uint8_t {
+        MODE_RELEASE = 0,
+        MODE_DUTY = 1,
+        MODE_PRESSURE = 2
+    };
+
+    CanCommand()
+        : _mode(MODE_RELEASE)
+        , _duty(0.0f)
+        , _pressureBar(0.0f)
+        , _counter(0)
+        , _hasCommand(false)
+        , _active(false)
+        , _newCommand(false)
+        , _lastAcceptMs(0)
+        , _accepted(0)
+        , _checksumErrors(0)
+        , _counterErrors(0)
+        , _rangeErrors(0)
+        , _timeouts(0)
+    {}
+
+    // Feed one received frame. Returns true if it was accepted as a new command.
+    bool onFrame(const CanFrame& frame, unsigned long nowMs) {
+        if (frame.extended || frame.id != Config::CAN_COMMAND_ID) return false;
+
+        if (frame.dlc != 8 || checksum(frame.id, frame.data) != rawCommandChecksum(frame.data)) {
+            _checksumErrors++;
+            return false;
+        }
+
+        uint8_t counter = (uint8_t)rawCommandCounter(frame.data);
+        if (isFresh(nowMs)) {
+            uint8_t step = (uint8_t)((counter - _counter) & 0x0F);
+            if (step == 0 || step > Config::CAN_COMMAND_MAX_COUNTER_STEP) {
+                _counterErrors++;
+                _counter = counter;
+                return false;
+            }
+        }
+        _counter = counter;
+
+        uint8_t mode = (uint8_t)rawCommandMode(frame.data);
+        if (mode > MODE_PRESSURE ||
+            (mode == MODE_DUTY && rawDutyCommand(frame.data) > 10000)) {
+            _rangeErrors++;
+            return false;
+        }
+
+        _mode = (Mode)mode;
+        _duty = decodeDutyCommand(frame.data) / 100.0f;
+        _pressureBar = decodePressureCommand(frame.data);
+        _hasCommand = true;
+        _newCommand = true;
+        _lastAcceptMs = nowMs;
+        _accepted++;
+        return true;
+    }
+
+    // Freshness check - call once per control tick. Returns true while the
+    // command is in control.
+    bool update(unsigned long nowMs) {
+        bool active = isFresh(nowMs) && _mode != MODE_RELEASE;
+        if (_active && !active && _mode != MODE_RELEASE) {
+            _timeouts++;
+        }
+        _active = active;
+        return _active;
+    }
+
+    // Result of the last update()
+    bool isActive() const { return _active; }
+
+    // True once per accepted frame (fast-path apply)
+    bool takeNewCommand() {
+        bool fresh = _newCommand;
+        _newCommand = false;
+        return fresh;
+    }
+
+    // Mode of the last accepted frame
+    Mode getMode() const { return _mode; }
+    // Commanded duty (0.0 - 1.0), MODE_DUTY
+    float getDuty() const { return _duty; }
+    // Commanded gauge pressure (bar), MODE_PRESSURE
+    float getPressureBar() const { return _pressureBar; }
+    // Age of the last accepted frame (real ms)
+    unsigned long getAgeMs(unsigned long nowMs) const {
+        return _hasCommand ? (nowMs - _lastAcceptMs) / Config::TIMER0_PRESCALER_FACTOR : 0;
+    }
+
+    // Frame counters since boot
+    uint16_t getAccepted() const { return _accepted; }
+    uint16_t getChecksumErrors() const { return _checksumErrors; }
+    uint16_t getCounterErrors() const { return _counterErrors; }
+    uint16_t getRangeErrors() const { return _rangeErrors; }
+    // Active command lost by timeout (not by RELEASE)
+    uint16_t getTimeouts() const { return _timeouts; }
+
+    // CRC-8 SAE J1850 (poly 0x1D, init 0xFF, final XOR 0xFF) over the id
+    // (low byte, high byte) and payload bytes 0..6
+    static uint8_t checksum(uint16_t id, const uint8_t* data) {
+        uint8_t crc = 0xFF;
+        crc = crc8Step(crc, (uint8_t)(id & 0xFF));
+        crc = crc8Step(crc, (uint8_t)(id >> 8));
+        for (uint8_t i = 0; i < 7; i++) {
+            crc = crc8Step(crc, data[i]);
+        }
+        return (uint8_t)(crc ^ 0xFF);
+    }
+
+    static uint8_t crc8Step(uint8_t crc, uint8_t b) {
+        crc ^= b;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x1D) : (uint8_t)(crc << 1);
+        }
+        return crc;
+    }
+
+    // Generated decoders: rawX() = field bits, decodeX() = physical value
+#define PUMP_COMMAND_DECODER(frame, name, start, len, sgn, factor, offset, unit, comment)     \
+    static_assert((start) + (len) <= 64 && (len) <= 16, "Command signal " #name " out of range"); \
+    static const uint8_t START_##name = start;                                                \
+    static uint16_t raw##name(const uint8_t* data) { return CanTelemetry::unpackSignal(data, start, len); } \
+    static float decode##name(const uint8_t* data) {                                          \
+        long raw = raw##name(data);                                                           \
+        if ((sgn) && (raw & (1L << ((len) - 1)))) raw -= (1L << (len));                       \
+        return (float)raw * (factor) + (offset);                                              \
+    }
+    PUMP_COMMAND_SIGNALS(PUMP_COMMAND_DECODER)
+#undef PUMP_COMMAND_DECODER
+
+private:
+    static_assert(START_CommandChecksum == 56, "checksum() assumes CommandChecksum in byte 7");
+
+    Mode _mode;
+    float _duty;
+    float _pressureBar;
+    uint8_t _counter;
+    bool _hasCommand;
+    bool _active;
+    bool _newCommand;
+    unsigned long _lastAcceptMs;
+    uint16_t _accepted;
+    uint16_t _checksumErrors;
+    uint16_t _counterErrors;
+    uint16_t _rangeErrors;
+    uint16_t _timeouts;
+
+    bool isFresh(unsigned long nowMs) const {
+        return _hasCommand &&
+               (unsigned long)(nowMs - _lastAcceptMs) < MILLIS_COMPENSATED(Config::CAN_COMMAND_TIMEOUT_MS);
+    }
+};
@@ -1,2 +1,2 @@
 #include "CanInterface.h"
-// Implementaes futuras via biblioteca MCP2515.
+// Driver MCP2515 implementado no header (ISR em PumpControl.ino).
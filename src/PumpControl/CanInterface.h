@@ -1,13 +1,463 @@
 #pragma once
 #include <Arduino.h>
-// Futuro: Implementar interface MCP2515 (SPI) para leitura CAN.
-// Placeholder class.
-class CanInterface {
+#include <SPI.h>
+#include "Config.h"
+#include "FastPin.h"
+#include "SpscRing.h"
+#include "Timer1Clock.h"
+
+// -----------------------------------------------------------------------------
+// CanInterface - Interrupt-driven MCP2515 CAN driver (SPI)
+// -----------------------------------------------------------------------------
+// Hardware: MCP2515 + TJA1050, SPI on D11/D12/D13, CS = PIN_CAN_CS.
+// Both power outputs are on Timer 0 (D6/D5), which shares no pins with SPI,
+// so bus traffic cannot disturb the PWM (see docs/session_spi_timer2_conflict.md).
+//
+// Design goals:
+//   - Never delay the control tick: all bus work happens in short SPI bursts
+//   - RX is INT-pin driven: MCP2515 INT (active low) on PIN_CAN_INT via
+//     pin-change interrupt; the ISR drains both RX buffers into a ring
+//   - TX goes through a ring; the TX0-complete interrupt loads the next frame
+//   - Hardware acceptance filters/masks set once in begin(), so the MCU only
+//     ever sees frames in the CAN_RX_ACCEPT_ID/MASK block
+//
+// SPI transactions use the MCP2515 short-cut instructions:
+//   READ RX BUFFER (0x90/0x94): 13-byte burst, clears RXnIF on CS release
+//   LOAD TX BUFFER (0x40):      13-byte burst straight into TXB0SIDH
+//   RTS (0x81), READ STATUS (0xA0), BIT MODIFY (0x05)
+// Each transaction is timed (Timer1Clock counts: micros() steps backwards
+// with the phase-correct Timer 0, and these run with interrupts off) so the
+// worst case can be checked against the control tick budget.
+//
+// Concurrency:
+//   - RX ring: producer = ISR, consumer = main loop (lock-free)
+//   - TX ring: producer = main loop; consumer = ISR, or main loop with
+//     interrupts off when the transmitter is idle (kick)
+//   - Main-context SPI runs with interrupts masked (SPI.usingInterrupt(255)),
+//     so it cannot be split by the CAN ISR. Timer 0 PWM is hardware and keeps
+//     running; only the millis() tick may be deferred by ~20us.
+//
+// CS and INT are template parameters (FastPin.h): the CS toggles of every
+// transaction and the INT checks in the ISR are single SBI/CBI/SBIS
+// instructions. Use the CanInterface typedef below.
+//
+// The host simulator (tools/sim) links this same header against a register
+// model of the MCP2515 behind its SPI shim.
+// -----------------------------------------------------------------------------
+
+struct CanFrame {
+    uint32_t id;        // 11-bit standard or 29-bit extended identifier
+    uint8_t dlc;        // 0..8
+    bool extended;
+    uint8_t data[8];
+};
+
+template <uint8_t CS_PIN, uint8_t INT_PIN>
+class CanInterfaceT {
 public:
-    void begin() {
-        // TODO: iniciar SPI e MCP2515 (usar biblioteca adequada, ex: mcp_can)
+    // MCP2515 SPI instructions
+    static constexpr uint8_t INSTR_RESET       = 0xC0;
+    static constexpr uint8_t INSTR_READ        = 0x03;
+    static constexpr uint8_t INSTR_WRITE       = 0x02;
+    static constexpr uint8_t INSTR_READ_RX0    = 0x90;  // RXB0SIDH..RXB0D7
+    static constexpr uint8_t INSTR_READ_RX1    = 0x94;  // RXB1SIDH..RXB1D7
+    static constexpr uint8_t INSTR_LOAD_TX0    = 0x40;  // TXB0SIDH..TXB0D7
+    static constexpr uint8_t INSTR_RTS_TX0     = 0x81;
+    static constexpr uint8_t INSTR_READ_STATUS = 0xA0;
+    static constexpr uint8_t INSTR_BIT_MODIFY  = 0x05;
+
+    // MCP2515 registers
+    static constexpr uint8_t REG_RXF0SIDH = 0x00;
+    static constexpr uint8_t REG_RXF3SIDH = 0x10;
+    static constexpr uint8_t REG_CANSTAT  = 0x0E;
+    static constexpr uint8_t REG_CANCTRL  = 0x0F;
+    static constexpr uint8_t REG_TEC      = 0x1C;
+    static constexpr uint8_t REG_REC      = 0x1D;
+    static constexpr uint8_t REG_RXM0SIDH = 0x20;
+    static constexpr uint8_t REG_RXM1SIDH = 0x24;
+    static constexpr uint8_t REG_CNF3     = 0x28;
+    static constexpr uint8_t REG_CANINTE  = 0x2B;
+    static constexpr uint8_t REG_CANINTF  = 0x2C;
+    static constexpr uint8_t REG_EFLG     = 0x2D;
+    static constexpr uint8_t REG_TXB0CTRL = 0x30;
+    static constexpr uint8_t REG_RXB0CTRL = 0x60;
+    static constexpr uint8_t REG_RXB1CTRL = 0x70;
+
+    // CANINTF / CANINTE bits
+    static constexpr uint8_t INT_RX0  = 0x01;
+    static constexpr uint8_t INT_RX1  = 0x02;
+    static constexpr uint8_t INT_TX0  = 0x04;
+    static constexpr uint8_t INT_ERR  = 0x20;
+
+    // READ STATUS bits
+    static constexpr uint8_t STATUS_RX0IF = 0x01;
+    static constexpr uint8_t STATUS_RX1IF = 0x02;
+    static constexpr uint8_t STATUS_TX0IF = 0x08;
+
+    // CANCTRL / CANSTAT operating modes
+    static constexpr uint8_t MODE_NORMAL = 0x00;
+    static constexpr uint8_t MODE_CONFIG = 0x80;
+    static constexpr uint8_t MODE_MASK   = 0xE0;
+
+    // EFLG overflow bits
+    static constexpr uint8_t EFLG_RX0OVR = 0x40;
+    static constexpr uint8_t EFLG_RX1OVR = 0x80;
+
+    CanInterfaceT()
+        : _ready(false)
+        , _txIdle(true)
+        , _rxFrames(0)
+        , _txFrames(0)
+        , _rxDropped(0)
+        , _hwOverruns(0)
+        , _lastTxnUs(0)
+        , _maxTxnUs(0)
+        , _maxIsrUs(0)
+    {}
+
+    // Reset the controller, program bit timing, filters and interrupts.
+    // Returns false (driver stays disabled) if the MCP2515 does not respond.
+    bool begin() {
+        _ready = false;
+        if (!Config::ENABLE_CAN) return false;
+
+        FastPin<CS_PIN>::high();
+        FastPin<CS_PIN>::output();
+        FastPin<INT_PIN>::inputPullup();
+
+        SPI.begin();
+        SPI.usingInterrupt(255);  // Main-context transactions mask all interrupts
+
+        // RESET, then wait for the oscillator start-up (128 OSC1 cycles + margin)
+        txnBegin();
+        SPI.transfer(INSTR_RESET);
+        txnEnd();
+        delayMicroseconds(100);
+
+        // Must come up in configuration mode
+        if ((readRegister(REG_CANSTAT) & MODE_MASK) != MODE_CONFIG) {
+            Serial.println(F("[CAN] MCP2515 not responding - CAN disabled"));
+            return false;
+        }
+
+        // Bit timing
+        uint8_t cnf[3];
+        if (!bitTimingFor(Config::CAN_CRYSTAL_MHZ, Config::CAN_BITRATE_KBPS, cnf)) {
+            Serial.println(F("[CAN] Unsupported crystal/bitrate - CAN disabled"));
+            return false;
+        }
+        writeRegisters(REG_CNF3, cnf, 3);  // CNF3, CNF2, CNF1 are contiguous (0x28..0x2A)
+
+        // Acceptance: both masks = CAN_RX_ACCEPT_MASK, all six filters = CAN_RX_ACCEPT_ID
+        // (standard frames only; EXIDE = 0 in every filter)
+        uint8_t mask[4], filter[4];
+        encodeId(Config::CAN_RX_ACCEPT_MASK, false, mask);
+        encodeId(Config::CAN_RX_ACCEPT_ID, false, filter);
+        writeRegisters(REG_RXM0SIDH, mask, 4);
+        writeRegisters(REG_RXM1SIDH, mask, 4);
+        for (uint8_t f = 0; f < 3; f++) {
+            writeRegisters(REG_RXF0SIDH + 4 * f, filter, 4);
+            writeRegisters(REG_RXF3SIDH + 4 * f, filter, 4);
+        }
+
+        // RXB0: filters on, rollover into RXB1 when full (BUKT). RXB1: filters on.
+        writeRegister(REG_RXB0CTRL, 0x04);
+        writeRegister(REG_RXB1CTRL, 0x00);
+
+        // Interrupts: both RX buffers + TX0 complete
+        writeRegister(REG_CANINTF, 0x00);
+        writeRegister(REG_CANINTE, INT_RX0 | INT_RX1 | INT_TX0);
+
+        // Normal mode
+        writeRegister(REG_CANCTRL, MODE_NORMAL);
+        if ((readRegister(REG_CANSTAT) & MODE_MASK) != MODE_NORMAL) {
+            Serial.println(F("[CAN] MCP2515 did not enter normal mode - CAN disabled"));
+            return false;
+        }
+
+        _txIdle = true;
+        _ready = true;
+
+        // Pin-change interrupt on the INT pin (ISR in PumpControl.ino calls onInterrupt())
+        *digitalPinToPCMSK(INT_PIN) |= _BV(digitalPinToPCMSKbit(INT_PIN));
+        *digitalPinToPCICR(INT_PIN) |= _BV(digitalPinToPCICRbit(INT_PIN));
+
+        Serial.print(F("[CAN] MCP2515 ready @ "));
+        Serial.print(Config::CAN_BITRATE_KBPS);
+        Serial.println(F(" kbps"));
+        return true;
+    }
+
+    // Called from the pin-change ISR. Only acts while INT is asserted (low).
+    void onInterrupt() {
+        if (!_ready) return;
+        if (FastPin<INT_PIN>::read()) return;  // Rising edge / other pin in group
+        service();
     }
+
+    // Main-loop safety net: if INT is held low (edge missed), service it here.
     void poll() {
-        // TODO: leitura de frames CAN
+        if (!_ready) return;
+        if (!FastPin<INT_PIN>::read()) {
+            uint8_t sreg = SREG;
+            noInterrupts();
+            service();
+            SREG = sreg;
+        }
+    }
+
+    // Queue a frame for transmission. Returns false if the TX ring is full.
+    bool send(const CanFrame& frame) {
+        if (!_ready) return false;
+        if (!_txRing.push(frame)) return false;
+
+        // Kick the transmitter if idle (interrupts off: TX ring consumer is
+        // otherwise only the ISR)
+        uint8_t sreg = SREG;
+        noInterrupts();
+        if (_txIdle) {
+            loadNextTx();
+        }
+        SREG = sreg;
+        return true;
+    }
+
+    // Take the oldest received frame. Returns false if none pending.
+    bool receive(CanFrame& frame) {
+        return _rxRing.pop(frame);
+    }
+
+    bool isReady() const { return _ready; }
+
+    // INT asserted: the ISR (or poll()) has SPI work to do. Time-critical
+    // bit-banging (status LED frames) waits while this is true.
+    bool isInterruptPending() const { return _ready && !FastPin<INT_PIN>::read(); }
+
+    // Statistics
+    uint32_t getRxFrames() const { return _rxFrames; }
+    uint32_t getTxFrames() const { return _txFrames; }
+    uint16_t getRxDropped() const { return _rxDropped; }     // RX ring full
+    uint16_t getHwOverruns() const { return _hwOverruns; }   // MCP2515 RXnOVR
+    uint16_t getLastTransactionUs() const { return _lastTxnUs; }
+    uint16_t getMaxTransactionUs() const { return _maxTxnUs; }
+    uint16_t getMaxIsrUs() const { return _maxIsrUs; }
+
+    void resetTiming() {
+        uint8_t sreg = SREG;
+        noInterrupts();
+        _maxTxnUs = 0;
+        _maxIsrUs = 0;
+        SREG = sreg;
+    }
+
+    // Error counters straight from the controller (main context only)
+    uint8_t readTec() { return _ready ? readRegister(REG_TEC) : 0; }
+    uint8_t readRec() { return _ready ? readRegister(REG_REC) : 0; }
+
+    // Standard/extended id <-> SIDH, SIDL, EID8, EID0 layout (public for tools)
+    static void encodeId(uint32_t id, bool extended, uint8_t out[4]) {
+        if (extended) {
+            out[0] = (uint8_t)(id >> 21);
+            out[1] = (uint8_t)(((id >> 13) & 0xE0) | 0x08 | ((id >> 16) & 0x03));
+            out[2] = (uint8_t)(id >> 8);
+            out[3] = (uint8_t)id;
+        } else {
+            out[0] = (uint8_t)(id >> 3);
+            out[1] = (uint8_t)((id & 0x07) << 5);
+            out[2] = 0;
+            out[3] = 0;
+        }
+    }
+
+    static uint32_t decodeId(const uint8_t in[4], bool& extended) {
+        extended = (in[1] & 0x08) != 0;
+        uint32_t sid = ((uint32_t)in[0] << 3) | (in[1] >> 5);
+        if (!extended) return sid;
+        return (sid << 18) | ((uint32_t)(in[1] & 0x03) << 16) | ((uint32_t)in[2] << 8) | in[3];
+    }
+
+    // CNF3, CNF2, CNF1 for the supported crystal/bitrate pairs.
+    // 16 TQ bits: PROP 5 + PS1 7 + PS2 3 -> sample point 81%
+    //  8 TQ bits: PROP 2 + PS1 3 + PS2 2 -> sample point 75%
+    // SJW = 1 TQ. 1 Mbps needs >= 5 TQ, so it is 16 MHz only.
+    static bool bitTimingFor(uint8_t crystalMhz, uint16_t kbps, uint8_t cnf[3]) {
+        // Bit length in units of the minimum TQ (2 / Fosc)
+        uint32_t bitTqMin = (uint32_t)crystalMhz * 500UL / kbps;
+        if (crystalMhz != 8 && crystalMhz != 16) return false;
+        if ((uint32_t)kbps * bitTqMin != (uint32_t)crystalMhz * 500UL) return false;
+
+        uint8_t tqPerBit = (bitTqMin % 16 == 0) ? 16 : 8;
+        if (bitTqMin % tqPerBit != 0) return false;
+        uint8_t brp = (uint8_t)(bitTqMin / tqPerBit - 1);
+        if (brp > 63) return false;
+
+        if (tqPerBit == 16) {
+            cnf[0] = 0x02;          // CNF3: PHSEG2 = 3 TQ
+            cnf[1] = 0xB4;          // CNF2: BTLMODE, PHSEG1 = 7 TQ, PRSEG = 5 TQ
+        } else {
+            cnf[0] = 0x01;          // CNF3: PHSEG2 = 2 TQ
+            cnf[1] = 0x91;          // CNF2: BTLMODE, PHSEG1 = 3 TQ, PRSEG = 2 TQ
+        }
+        cnf[2] = brp;               // CNF1: SJW = 1 TQ, BRP
+        return true;
+    }
+
+private:
+    volatile bool _ready;
+    volatile bool _txIdle;        // TXB0 free, nothing in flight
+    volatile uint32_t _rxFrames;
+    volatile uint32_t _txFrames;
+    volatile uint16_t _rxDropped;
+    volatile uint16_t _hwOverruns;
+    volatile uint16_t _lastTxnUs;
+    volatile uint16_t _maxTxnUs;
+    volatile uint16_t _maxIsrUs;
+    uint16_t _txnStart;  // Timer1Clock::ticks16()
+    SpscRing<CanFrame, Config::CAN_RX_RING_SIZE> _rxRing;
+    SpscRing<CanFrame, Config::CAN_TX_RING_SIZE> _txRing;
+
+    // Drain everything the INT line reports. Runs with interrupts disabled
+    // (ISR, or poll()/send() with interrupts masked).
+    void service() {
+        uint16_t isrStart = Timer1Clock::ticks16();
+
+        // Bounded: INT is level-triggered, new flags may appear while we work
+        for (uint8_t pass = 0; pass < 4; pass++) {
+            uint8_t status = readStatus();
+            bool worked = false;
+
+            if (status & STATUS_RX0IF) {
+                readRxBuffer(INSTR_READ_RX0);
+                worked = true;
+            }
+            if (status & STATUS_RX1IF) {
+                readRxBuffer(INSTR_READ_RX1);
+                worked = true;
+            }
+            if (status & STATUS_TX0IF) {
+                bitModify(REG_CANINTF, INT_TX0, 0);
+                _txFrames++;
+                _txIdle = true;
+                loadNextTx();
+                worked = true;
+            }
+            if (!worked) {
+                // Overrun/error flags: count, clear, carry on
+                uint8_t eflg = readRegister(REG_EFLG);
+                if (eflg & (EFLG_RX0OVR | EFLG_RX1OVR)) {
+                    _hwOverruns++;
+                    bitModify(REG_EFLG, EFLG_RX0OVR | EFLG_RX1OVR, 0);
+                }
+                bitModify(REG_CANINTF, (uint8_t)~(INT_RX0 | INT_RX1 | INT_TX0), 0);
+                break;
+            }
+            if (FastPin<INT_PIN>::read()) break;
+        }
+
+        uint16_t isrUs = (uint16_t)(Timer1Clock::ticks16() - isrStart) / Timer1Clock::COUNTS_PER_US;
+        if (isrUs > _maxIsrUs) _maxIsrUs = isrUs;
+    }
+
+    // READ RX BUFFER: one 13-byte burst, RXnIF cleared by the controller on CS high
+    void readRxBuffer(uint8_t instruction) {
+        uint8_t raw[13];
+        txnBegin();
+        SPI.transfer(instruction);
+        for (uint8_t i = 0; i < 13; i++) {
+            raw[i] = SPI.transfer(0x00);
+        }
+        txnEnd();
+
+        CanFrame frame;
+        frame.id = decodeId(raw, frame.extended);
+        frame.dlc = raw[4] & 0x0F;
+        if (frame.dlc > 8) frame.dlc = 8;
+        for (uint8_t i = 0; i < 8; i++) {
+            frame.data[i] = raw[5 + i];
+        }
+
+        if (_rxRing.push(frame)) {
+            _rxFrames++;
+        } else {
+            _rxDropped++;
+        }
+    }
+
+    // LOAD TX BUFFER + RTS for the next queued frame (caller has interrupts off)
+    void loadNextTx() {
+        CanFrame frame;
+        if (!_txRing.pop(frame)) return;
+
+        uint8_t header[4];
+        encodeId(frame.id, frame.extended, header);
+        uint8_t dlc = (frame.dlc > 8) ? 8 : frame.dlc;
+
+        txnBegin();
+        SPI.transfer(INSTR_LOAD_TX0);
+        for (uint8_t i = 0; i < 4; i++) SPI.transfer(header[i]);
+        SPI.transfer(dlc);
+        for (uint8_t i = 0; i < dlc; i++) SPI.transfer(frame.data[i]);
+        txnEnd();
+
+        txnBegin();
+        SPI.transfer(INSTR_RTS_TX0);
+        txnEnd();
+
+        _txIdle = false;
+    }
+
+    uint8_t readStatus() {
+        txnBegin();
+        SPI.transfer(INSTR_READ_STATUS);
+        uint8_t status = SPI.transfer(0x00);
+        txnEnd();
+        return status;
+    }
+
+    uint8_t readRegister(uint8_t reg) {
+        txnBegin();
+        SPI.transfer(INSTR_READ);
+        SPI.transfer(reg);
+        uint8_t value = SPI.transfer(0x00);
+        txnEnd();
+        return value;
+    }
+
+    void writeRegister(uint8_t reg, uint8_t value) {
+        writeRegisters(reg, &value, 1);
+    }
+
+    // Sequential write (address auto-increments)
+    void writeRegisters(uint8_t reg, const uint8_t* values, uint8_t count) {
+        txnBegin();
+        SPI.transfer(INSTR_WRITE);
+        SPI.transfer(reg);
+        for (uint8_t i = 0; i < count; i++) SPI.transfer(values[i]);
+        txnEnd();
+    }
+
+    void bitModify(uint8_t reg, uint8_t mask, uint8_t value) {
+        txnBegin();
+        SPI.transfer(INSTR_BIT_MODIFY);
+        SPI.transfer(reg);
+        SPI.transfer(mask);
+        SPI.transfer(value);
+        txnEnd();
+    }
+
+    void txnBegin() {
+        SPI.beginTransaction(SPISettings(Config::CAN_SPI_CLOCK_HZ, MSBFIRST, SPI_MODE0));
+        FastPin<CS_PIN>::low();
+        _txnStart = Timer1Clock::ticks16();
+    }
+
+    void txnEnd() {
+        FastPin<CS_PIN>::high();
+        SPI.endTransaction();
+        uint16_t us = (uint16_t)(Timer1Clock::ticks16() - _txnStart) / Timer1Clock::COUNTS_PER_US;
+        _lastTxnUs = us;
+        if (us > _maxTxnUs) _maxTxnUs = us;
     }
 };
+
+typedef CanInterfaceT<Config::PIN_CAN_CS, Config::PIN_CAN_INT> CanInterface;
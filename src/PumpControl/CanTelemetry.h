@@ -0,0 +1,148 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "CanInterface.h"
+#include "CanTelemetryLayout.h"
+
+// -----------------------------------------------------------------------------
+// CanTelemetry - Packed control-state broadcast over CAN
+// -----------------------------------------------------------------------------
+// Frames and signals come from CanTelemetryLayout.h (same table generates the
+// DBC). The loop fills signals with the generated setters (setMapPressure(),
+// setCurrent1(), ...), each value is scaled and packed immediately into its
+// frame buffer, and publish() stamps the rolling counter and queues every
+// frame on the CAN TX ring.
+//
+// publish() runs from a fast path in loop() at CAN_TELEMETRY_RATE_HZ (up to
+// 100 Hz), independent of the 20 Hz control tick: values captured at the tick
+// are repeated until the next tick; ActualDuty, OutputLimit and
+// ProtectionLevel are refreshed right before each publish.
+// -----------------------------------------------------------------------------
+
+class CanTelemetry {
+public:
+    // Frame indexes
+    enum Frame : uint8_t {
+#define PUMP_TELEMETRY_FRAME_ENUM(frame, name, idOffset, dlc, comment) FRAME_##name = frame,
+        PUMP_TELEMETRY_FRAMES(PUMP_TELEMETRY_FRAME_ENUM)
+#undef PUMP_TELEMETRY_FRAME_ENUM
+        FRAME_COUNT
+    };
+
+    // SourceMode values (see PUMP_TELEMETRY_VALUES)
+    enum SourceMode : uint8_t {
+        SOURCE_MAP = 0,
+        SOURCE_EXTERNAL_PWM = 1,
+        SOURCE_SAFETY_OFF = 2,
+        SOURCE_CAN = 3
+    };
+
+    explicit CanTelemetry(CanInterface& can)
+        : _can(can)
+        , _counter(0)
+        , _cycles(0)
+        , _droppedFrames(0)
+    {
+        memset(_data, 0, sizeof(_data));
+    }
+
+    // Generated setters: physical value in the signal's unit
+#define PUMP_TELEMETRY_SETTER(frame, name, start, len, sgn, factor, offset, unit, comment)      \
+    static_assert((start) + (len) <= 64 && (len) <= 16, "Telemetry signal " #name " out of range"); \
+    void set##name(float value) {                                                               \
+        packSignal(_data[frame], start, len, encode(value, factor, offset, len, sgn));          \
+    }
+    PUMP_TELEMETRY_SIGNALS(PUMP_TELEMETRY_SETTER)
+#undef PUMP_TELEMETRY_SETTER
+
+    // Stamp the counter and queue all frames. Returns false if any frame
+    // did not fit in the TX ring (bus down or saturated).
+    bool publish() {
+        if (!_can.isReady()) return false;
+
+        setCounter1(_counter);
+        setCounter2(_counter);
+        _counter = (uint8_t)((_counter + 1) & 0x0F);
+
+        bool allQueued = true;
+        for (uint8_t f = 0; f < FRAME_COUNT; f++) {
+            CanFrame frame;
+            frame.id = Config::CAN_TELEMETRY_BASE_ID + frameIdOffset(f);
+            frame.extended = false;
+            frame.dlc = frameDlc(f);
+            memcpy(frame.data, _data[f], sizeof(frame.data));
+            if (!_can.send(frame)) {
+                _droppedFrames++;
+                allQueued = false;
+            }
+        }
+        _cycles++;
+        return allQueued;
+    }
+
+    // Publish cycles since boot
+    uint32_t getCycles() const { return _cycles; }
+    // Frames that did not fit in the TX ring
+    uint16_t getDroppedFrames() const { return _droppedFrames; }
+
+    // Raw value for a physical value: round, then saturate to the field
+    static uint16_t encode(float value, float factor, float offset, uint8_t len, bool isSigned) {
+        float scaled = (value - offset) / factor;
+        if (scaled != scaled) scaled = 0.0f;  // NaN (sensor not read yet)
+        long lo = isSigned ? -(1L << (len - 1)) : 0L;
+        long hi = isSigned ? (1L << (len - 1)) - 1 : (1L << len) - 1;
+        if (scaled < (float)lo) scaled = (float)lo;
+        if (scaled > (float)hi) scaled = (float)hi;
+        long raw = (long)floorf(scaled + 0.5f);
+        if (raw > hi) raw = hi;
+        return (uint16_t)((unsigned long)raw & ((1UL << len) - 1));
+    }
+
+    // Intel (little-endian) bit packing: bit n of the payload is bit (n % 8) of byte n / 8
+    static void packSignal(uint8_t* data, uint8_t start, uint8_t len, uint16_t raw) {
+        for (uint8_t i = 0; i < len; i++) {
+            uint8_t bit = start + i;
+            uint8_t mask = (uint8_t)(1 << (bit & 7));
+            if (raw & (1U << i)) {
+                data[bit >> 3] |= mask;
+            } else {
+                data[bit >> 3] &= (uint8_t)~mask;
+            }
+        }
+    }
+
+    // Inverse of packSignal(): raw field bits
+    static uint16_t unpackSignal(const uint8_t* data, uint8_t start, uint8_t len) {
+        uint16_t raw = 0;
+        for (uint8_t i = 0; i < len; i++) {
+            uint8_t bit = start + i;
+            if (data[bit >> 3] & (1 << (bit & 7))) raw |= (uint16_t)(1U << i);
+        }
+        return raw;
+    }
+
+private:
+    CanInterface& _can;
+    uint8_t _data[FRAME_COUNT][8];
+    uint8_t _counter;
+    uint32_t _cycles;
+    uint16_t _droppedFrames;
+
+    static uint8_t frameIdOffset(uint8_t f) {
+        switch (f) {
+#define PUMP_TELEMETRY_FRAME_ID(frame, name, idOffset, dlc, comment) case frame: return idOffset;
+            PUMP_TELEMETRY_FRAMES(PUMP_TELEMETRY_FRAME_ID)
+#undef PUMP_TELEMETRY_FRAME_ID
+            default: return 0;
+        }
+    }
+
+    static uint8_t frameDlc(uint8_t f) {
+        switch (f) {
+#define PUMP_TELEMETRY_FRAME_DLC(frame, name, idOffset, dlc, comment) case frame: return dlc;
+            PUMP_TELEMETRY_FRAMES(PUMP_TELEMETRY_FRAME_DLC)
+#undef PUMP_TELEMETRY_FRAME_DLC
+            default: return 8;
+        }
+    }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+// -----------------------------------------------------------------------------
+// CanTelemetryLayout.h - Single definition of the CAN frames
+// -----------------------------------------------------------------------------
+// X-macro tables consumed by:
+//   - CanTelemetry.h             (firmware: setters + packing)
+//   - CanCommand.h               (firmware: command frame decoding)
+//   - LoadShare.h                (firmware: board-to-board load sharing)
+//   - tools/can/telemetry_dbc    (host: generates docs/PumpControl.dbc)
+// Edit ONLY here, then regenerate the DBC (cmake --build build-tools --target dbc).
+//
+// Encoding: Intel byte order (little-endian), start bit = LSB position in the
+// 64-bit payload, raw = (physical - offset) / factor, saturated to the field.
+// Both telemetry frames carry the same 4-bit rolling counter for the publish cycle.
+// -----------------------------------------------------------------------------
+
+// F(frame, name, id offset from CAN_TELEMETRY_BASE_ID, dlc, comment)
+#define PUMP_TELEMETRY_FRAMES(F) \
+    F(0, PumpStatus1, 0, 8, "Control state: pressure, duty, supply, protection") \
+    F(1, PumpStatus2, 1, 8, "Channel currents, temperatures, fault counters")
+
+// S(frame, name, start bit, length, signed, factor, offset, unit, comment)
+#define PUMP_TELEMETRY_SIGNALS(S) \
+    S(0, MapPressure,      0, 16, 1, 0.001f, 0.0f,   "bar", "MAP gauge pressure (last MAP-mode reading)") \
+    S(0, TargetDuty,      16, 10, 0, 0.1f,   0.0f,   "%",   "Target output from the active source") \
+    S(0, ActualDuty,      26, 10, 0, 0.1f,   0.0f,   "%",   "Duty applied to the MOSFETs") \
+    S(0, SupplyVoltage,   36, 12, 0, 0.01f,  0.0f,   "V",   "Supply voltage") \
+    S(0, ProtectionLevel, 48,  2, 0, 1.0f,   0.0f,   "",    "Current protection level") \
+    S(0, SourceMode,      50,  2, 0, 1.0f,   0.0f,   "",    "Active setpoint source") \
+    S(0, OutputLimit,     52,  8, 0, 0.5f,   0.0f,   "%",   "Output limit (protection + thermal)") \
+    S(0, Counter1,        60,  4, 0, 1.0f,   0.0f,   "",    "Rolling counter") \
+    S(1, Current1,         0, 12, 0, 0.02f,  0.0f,   "A",   "Channel 1 current") \
+    S(1, Current2,        12, 12, 0, 0.02f,  0.0f,   "A",   "Channel 2 current") \
+    S(1, HeatsinkTemp,    24, 10, 0, 0.25f, -40.0f,  "degC", "Heatsink NTC temperature") \
+    S(1, MosfetTemp,      34,  8, 0, 1.0f,  -40.0f,  "degC", "Estimated MOSFET junction (hottest channel)") \
+    S(1, CurrentFaults,   42,  8, 0, 1.0f,   0.0f,   "",    "Current FAULT events (saturates at 255)") \
+    S(1, VoltageFaults,   50,  8, 0, 1.0f,   0.0f,   "",    "Supply sensor FAULT events (saturates at 255)") \
+    S(1, VoltageLevel,    58,  2, 0, 1.0f,   0.0f,   "",    "Supply sensor protection level") \
+    S(1, Counter2,        60,  4, 0, 1.0f,   0.0f,   "",    "Rolling counter")
+
+// V(signal name, raw value, label) - DBC value tables
+#define PUMP_TELEMETRY_VALUES(V) \
+    V(ProtectionLevel, 0, "NORMAL") \
+    V(ProtectionLevel, 1, "FAULT") \
+    V(ProtectionLevel, 2, "EMERGENCY") \
+    V(SourceMode,      0, "MAP") \
+    V(SourceMode,      1, "EXTERNAL_PWM") \
+    V(SourceMode,      2, "SAFETY_OFF") \
+    V(SourceMode,      3, "CAN") \
+    V(VoltageLevel,    0, "NORMAL") \
+    V(VoltageLevel,    1, "FAULT") \
+    V(CommandMode,     0, "RELEASE") \
+    V(CommandMode,     1, "DUTY") \
+    V(CommandMode,     2, "PRESSURE")
+
+// PumpCommand (ECU -> PumpControl, id CAN_COMMAND_ID, dlc 8). Same S() columns;
+// frame is always 0. CommandChecksum = CRC-8 SAE J1850 (poly 0x1D, init 0xFF,
+// final XOR 0xFF) over the id (low byte, high byte) followed by bytes 0..6.
+#define PUMP_COMMAND_SIGNALS(S) \
+    S(0, CommandMode,      0,  4, 0, 1.0f,   0.0f,   "",    "0 = release to PWM/MAP, 1 = duty, 2 = pressure") \
+    S(0, CommandCounter,   4,  4, 0, 1.0f,   0.0f,   "",    "Sequence counter, +1 per frame (wraps at 15)") \
+    S(0, DutyCommand,      8, 16, 0, 0.01f,  0.0f,   "%",   "Target output (mode 1), 0..100 %") \
+    S(0, PressureCommand, 24, 16, 1, 0.001f, 0.0f,   "bar", "Gauge pressure fed to the MAP curve (mode 2)") \
+    S(0, CommandChecksum, 56,  8, 0, 1.0f,   0.0f,   "",    "CRC-8 SAE J1850 over id + bytes 0..6")
+
+// PumpShare (board n -> all boards, id CAN_LOAD_SHARE_BASE_ID + n, dlc 8), see
+// LoadShare.h. Same S() columns; frame is always 0.
+#define PUMP_SHARE_SIGNALS(S) \
+    S(0, ShareDemand,      0, 10, 0, 0.1f,   0.0f,   "%",    "Local demand (target of the active source)") \
+    S(0, ShareCapacity,   10, 10, 0, 0.1f,   0.0f,   "%",    "Output limit (protection + thermal), 0 when unavailable") \
+    S(0, ShareApplied,    20, 10, 0, 0.1f,   0.0f,   "%",    "Share of the total flow applied by this board") \
+    S(0, ShareCurrent,    30, 10, 0, 0.1f,   0.0f,   "A",    "Channel 1 + channel 2 current") \
+    S(0, ShareTemp,       40,  8, 0, 1.0f,  -40.0f,  "degC", "Heatsink temperature (load weighting)") \
+    S(0, ShareAvailable,  48,  1, 0, 1.0f,   0.0f,   "",     "Board can take load (no safety, no EMERGENCY)") \
+    S(0, ShareCounter,    60,  4, 0, 1.0f,   0.0f,   "",     "Rolling counter")
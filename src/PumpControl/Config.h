@@ -5,6 +5,10 @@
 // -----------------------------------------------------------------------------
 // Adjust setpoints, thresholds, and operational parameters here.
 // Nothing is user-configurable at runtime.
+//
+// The values swept on the host (MAP curve and boost lead) take their default
+// from a PUMPCONTROL_<NAME> macro when it is not defined already: the Arduino
+// build defines none, tools/CMakeLists.txt sets them from PUMPCONTROL_CONFIG.
 // -----------------------------------------------------------------------------
 
 namespace Config {
@@ -18,26 +22,85 @@ namespace Config {
     // Verified: 833mV @ atmospheric conditions = 1.013 bar absolute = 0 bar gauge
     
     // Atmospheric pressure at sea level (for absolute?gauge conversion)
+    // Default only: the barometric baseline is measured at every cold boot
+    // (SensorCalibration.h) and stored in EEPROM
     constexpr float ATMOSPHERIC_PRESSURE_BAR = 1.013f; // bar (101.3 kPa)
     
     // Pressure setpoints (bar gauge - relative to atmospheric)
     // Negative values = vacuum (intake manifold below atmospheric)
     // Positive values = boost (turbo pressure above atmospheric)
     // Pressure (bar gauge) where output should be at OUTPUT_PERCENT_MIN
-    constexpr float MAP_BAR_LOW_SETPOINT  = 0.4f; // bar gauge (low pressure)
+    #ifndef PUMPCONTROL_MAP_BAR_LOW_SETPOINT
+    #define PUMPCONTROL_MAP_BAR_LOW_SETPOINT 0.4f
+    #endif
+    constexpr float MAP_BAR_LOW_SETPOINT  = PUMPCONTROL_MAP_BAR_LOW_SETPOINT; // bar gauge (low pressure)
     // Pressure (bar gauge) where output should be at OUTPUT_PERCENT_MAX
-    constexpr float MAP_BAR_HIGH_SETPOINT = 0.6f;  // bar gauge (high pressure)
+    #ifndef PUMPCONTROL_MAP_BAR_HIGH_SETPOINT
+    #define PUMPCONTROL_MAP_BAR_HIGH_SETPOINT 0.6f
+    #endif
+    constexpr float MAP_BAR_HIGH_SETPOINT = PUMPCONTROL_MAP_BAR_HIGH_SETPOINT;  // bar gauge (high pressure)
 
     // Target output as percentage of measured supply voltage
     // This makes the system adaptive to voltage variations (8-14.5V automotive range)
     // Low pressure (?0.2bar): 50% of Vsupply (e.g., 7V @ 14V, 6V @ 12V)
     // High pressure (?0.4bar): 100% of Vsupply (e.g., 14V @ 14V, 12V @ 12V)
     // Intermediate pressures: linear interpolation between 50% and 100%
-    constexpr float OUTPUT_PERCENT_MIN = 0.50f; // 50% of supply voltage
-    constexpr float OUTPUT_PERCENT_MAX = 1.00f; // 100% of supply voltage (full power)
+    #ifndef PUMPCONTROL_OUTPUT_PERCENT_MIN
+    #define PUMPCONTROL_OUTPUT_PERCENT_MIN 0.50f
+    #endif
+    #ifndef PUMPCONTROL_OUTPUT_PERCENT_MAX
+    #define PUMPCONTROL_OUTPUT_PERCENT_MAX 1.00f
+    #endif
+    constexpr float OUTPUT_PERCENT_MIN = PUMPCONTROL_OUTPUT_PERCENT_MIN; // 50% of supply voltage
+    constexpr float OUTPUT_PERCENT_MAX = PUMPCONTROL_OUTPUT_PERCENT_MAX; // 100% of supply voltage (full power)
 
-    // MAP sensor filter coefficient (EMA)
-    constexpr float MAP_FILTER_ALPHA   = 0.15f; // 0<alpha<=1 (smaller = smoother)
+    // MAP acquisition: fast ADC clock + 4^n oversampling -> 10 + n bits (Adc.h)
+    // 10-bit LSB = 4.9 mV = 7.8 mbar on the MPX5700AP: the 0.4-0.6 bar control
+    // window is only ~26 steps. 2 extra bits -> ~2 mbar, ~100 steps.
+    // Cost per read: 4^n + 1 conversions of 13 ADC clocks. /32 and n = 2:
+    // 17 x 26 us = ~440 us (a default analogRead() is ~112 us) - at 20 Hz
+    // that is under 1% of the tick.
+    constexpr uint8_t MAP_ADC_PRESCALER   = 32;  // 16, 32, 64 or 128 (core default)
+    constexpr uint8_t MAP_OVERSAMPLE_BITS = 2;   // 0 = single conversion, max 3
+
+    static_assert(MAP_ADC_PRESCALER == 16 || MAP_ADC_PRESCALER == 32 ||
+                  MAP_ADC_PRESCALER == 64 || MAP_ADC_PRESCALER == 128,
+                  "MAP_ADC_PRESCALER must be 16, 32, 64 or 128");
+    static_assert(MAP_OVERSAMPLE_BITS <= 3, "MAP_OVERSAMPLE_BITS above 3 takes 64+ conversions per read");
+
+    // MAP sensor filter cutoff (Filters.h, fed once per control tick)
+    // One oversampled read already averages 16 conversions (white noise / 4),
+    // so the filter can follow faster: time constant 140 ms (1.14 Hz) instead
+    // of 310 ms (0.52 Hz) with single conversions.
+    constexpr float MAP_FILTER_CUTOFF_HZ = (MAP_OVERSAMPLE_BITS >= 2) ? 1.14f : 0.52f;
+
+    // Second-order Butterworth instead of the first-order EMA at the same
+    // cutoff: -40 dB/decade on sensor noise, similar delay
+    constexpr bool MAP_FILTER_BIQUAD = false;
+
+    // Boost-rate feedforward (MapSensor.h)
+    // The filtered MAP trails a boost rise by rate x time constant (140 ms at
+    // 1.14 Hz) plus the tick, so the pump reached full output late. A line
+    // fit over the last MAP_SLOPE_WINDOW fast reads (every MAP_SLOPE_INTERVAL_MS,
+    // between ticks) gives dP/dt; MAP mode reads the curve at
+    //   P + MAP_RATE_LOOKAHEAD_S x (dP/dt - MAP_RATE_DEADBAND_BAR_S)
+    // Rising pressure only: a lift-off still ramps down at the filter's pace.
+    // The lead is held and decays with MAP_RATE_DECAY_S once the rise stops,
+    // while the filter catches up. Fast reads: ~440 us each, ~4.5% of the CPU.
+    constexpr bool ENABLE_MAP_RATE_FEEDFORWARD = true;
+    constexpr unsigned long MAP_SLOPE_INTERVAL_MS = 10;  // Fast reads, 100 Hz
+    constexpr uint8_t MAP_SLOPE_WINDOW = 8;              // Reads in the fit (~80 ms)
+    #ifndef PUMPCONTROL_MAP_RATE_LOOKAHEAD_S
+    #define PUMPCONTROL_MAP_RATE_LOOKAHEAD_S 0.30f
+    #endif
+    #ifndef PUMPCONTROL_MAP_RATE_DEADBAND_BAR_S
+    #define PUMPCONTROL_MAP_RATE_DEADBAND_BAR_S 0.20f
+    #endif
+    constexpr float MAP_RATE_LOOKAHEAD_S = PUMPCONTROL_MAP_RATE_LOOKAHEAD_S;        // s: filter lag + tick + output ramp
+    constexpr float MAP_RATE_DEADBAND_BAR_S = PUMPCONTROL_MAP_RATE_DEADBAND_BAR_S;  // bar/s; slope noise ~0.03 bar/s
+    constexpr float MAP_RATE_DECAY_S = 1.0f / (2.0f * 3.14159265f * MAP_FILTER_CUTOFF_HZ);
+    // Lead cap: the curve span plus margin, so one glitch cannot do more
+    constexpr float MAP_RATE_LEAD_MAX_BAR = MAP_BAR_HIGH_SETPOINT - MAP_BAR_LOW_SETPOINT + 0.1f;
 
     // =========================================================================
     // CURRENT SENSING - ACS758LCB-050B (BIDIRECTIONAL)
@@ -54,7 +117,7 @@ namespace Config {
     // This offset is within the ±60mV Voe spec of the datasheet.
     // Negative currents (reverse flow) are clamped to 0 in CurrentSensor.
     constexpr float ACS758_SENSITIVITY = 0.04f;        // V/A (40mV/A for 050B bidirectional)
-    constexpr float ACS758_ZERO_CURRENT_V = 2.49f;    // Volts (derived @ 0A - calibrate per board)
+    constexpr float ACS758_ZERO_CURRENT_V = 2.49f;    // Volts (default until the first boot calibration)
     constexpr float ACS758_MAX_CURRENT = 50.0f;        // Amperes (sensor absolute max)
     
     // ADC configuration
@@ -66,12 +129,47 @@ namespace Config {
     constexpr uint8_t CURRENT_ADC_SAMPLES = 32;         // Number of ADC samples to average
     constexpr uint8_t CURRENT_ADC_DELAY_US = 50;        // Delay between samples (microseconds)
 
-    // Current reading filter coefficient (EMA)
-    // Higher alpha = faster response, more noise
-    // Lower alpha = slower response, smoother
-    // 0.05 @ 20Hz loop => time constant ~1s (slow but clean for protection use)
-    constexpr float CURRENT_FILTER_ALPHA = 0.05f;       // 0<alpha<=1 (heavy smoothing for PWM ripple)
+    // Current reading filter cutoff (EMA on the summed conversions, Filters.h)
+    // Higher cutoff = faster response, more noise
+    // Lower cutoff = slower response, smoother
+    // 0.33 Hz => time constant ~0.5s (slow but clean for protection use). The
+    // former alpha 0.05 ran on every read - twice per tick - which is ~0.5s.
+    constexpr float CURRENT_FILTER_CUTOFF_HZ = 0.33f;
+    static_assert(CURRENT_ADC_SAMPLES * 1023L <= 32767L,
+                  "CURRENT_ADC_SAMPLES: the sum of the conversions is filtered in 16 bits");
+
+    // Fast unfiltered reading (inrush monitoring during soft-start)
+    // 4 samples @ ~160us ≈ 0.65ms window = ~2.5 PWM cycles, no EMA
+    constexpr uint8_t CURRENT_FAST_ADC_SAMPLES = 4;
     
+    // =========================================================================
+    // PUMP SPEED ESTIMATION - COMMUTATION RIPPLE (see PumpSpeedEstimator.h)
+    // =========================================================================
+
+    // Burst capture on the current channels, synchronous to the 3.9kHz PWM,
+    // analysed with a fixed-point Goertzel scan: f_ripple = RPM/60 * segments
+    constexpr bool  ENABLE_PUMP_SPEED_ESTIMATION = true;
+    constexpr uint8_t PUMP_COMMUTATOR_SEGMENTS = 6;     // Ripple periods per revolution (calibrate per pump)
+    constexpr uint8_t PUMP_SPEED_SAMPLES = 64;          // Burst length (64 x 255us = 16ms, 61Hz bins)
+    constexpr unsigned long PUMP_SPEED_INTERVAL_MS = 500; // One channel per interval (alternating)
+    constexpr float PUMP_RIPPLE_FREQ_MIN = 250.0f;      // Hz (2500 RPM @ 6 segments)
+    constexpr float PUMP_RIPPLE_FREQ_MAX = 1900.0f;     // Hz (19000 RPM @ 6 segments, < Nyquist)
+    constexpr float PUMP_SPEED_MIN_SNR = 4.0f;          // Peak / mean bin power to accept
+
+    // Diagnostics
+    constexpr float PUMP_STALL_CURRENT_A = 5.0f;        // Current that implies the pump should spin
+    constexpr float PUMP_STALL_RPM_MIN = 500.0f;        // Below this with current flowing = STALL
+    constexpr float PUMP_SPEED_MIN_VOLTAGE = 4.0f;      // Don't judge wear below this output voltage
+    constexpr float PUMP_WORN_RPM_PER_V_MIN = 250.0f;   // Healthy pump: ~400+ RPM/V
+
+    // Optional closed-loop speed control: PI trim of the MAP-mode target so that
+    // RPM follows targetPercent x PUMP_SPEED_TARGET_RPM_MAX
+    constexpr bool  ENABLE_PUMP_SPEED_CONTROL = false;
+    constexpr float PUMP_SPEED_TARGET_RPM_MAX = 6000.0f; // RPM at 100% target
+    constexpr float PUMP_SPEED_KP = 0.30f;               // Trim per normalized RPM error
+    constexpr float PUMP_SPEED_KI = 0.20f;               // Trim per normalized error-second
+    constexpr float PUMP_SPEED_TRIM_MAX = 0.15f;         // Max +/- trim of target percent
+
     // =========================================================================
     // VOLTAGE MONITORING - Supply voltage measurement with percentage-based protection
     // =========================================================================
@@ -83,8 +181,10 @@ namespace Config {
     // At 8V input: ADC sees 8V � 0.0909 = 0.73V ? (safe)
     constexpr float VOLTAGE_DIVIDER_RATIO = 0.0909f;    // 1/(10+1) = 1/11
     
-    // Voltage reading filter coefficient (EMA)
-    constexpr float VOLTAGE_FILTER_ALPHA = 1.0f;        // 0<alpha<=1 (smoother than current)
+    // Voltage reading filter: median of the last N ticks (Filters.h). Drops
+    // single-tick spikes (load dump, cranking glitches) without the lag of an
+    // EMA; a real step passes after (N+1)/2 ticks. 1 = no filter.
+    constexpr uint8_t VOLTAGE_MEDIAN_SAMPLES = 3;       // Odd, 1..9
     
     // Percentage-based voltage protection (adaptive to actual supply voltage)
     // Instead of fixed thresholds (9V, 12V), use percentage drop from measured voltage
@@ -100,7 +200,40 @@ namespace Config {
     // Only detect sensor faults (reading outside valid automotive range)
     constexpr float VOLTAGE_MINIMUM_VALID = 7.0f;    // Volts (below this = sensor fault)
     constexpr float VOLTAGE_MAXIMUM_VALID = 16.0f;   // Volts (above this = sensor fault)
-    
+
+    // =========================================================================
+    // CONSTANT-VOLTAGE OUTPUT MODE (SUPPLY FEED-FORWARD)
+    // =========================================================================
+
+    // When enabled, MAP mode targets a pump VOLTAGE instead of a fraction of
+    // whatever the supply happens to be. Duty = Vtarget / Vsupply is recomputed
+    // on every supply reading, so flow stays constant while the battery sags
+    // (cranking, alternator load) across the 9-14.5V range.
+    //   Vtarget = pressureToTargetPercent(P) * CV_REFERENCE_VOLTAGE
+    //   e.g. 50% -> 6.0V, 100% -> 12.0V (saturates at 100% duty below 12V supply)
+    // External PWM (slave) mode is NOT regulated - the input duty is replicated.
+    constexpr bool  ENABLE_CONSTANT_VOLTAGE_MODE = false;  // false = legacy percent-of-supply
+    constexpr float CV_REFERENCE_VOLTAGE = 12.0f;          // Volts at OUTPUT_PERCENT = 100%
+
+    // Feed-forward rate: supply is re-read and duty corrected at this interval,
+    // independently of the 20Hz control tick (one analogRead per update)
+    constexpr unsigned long CV_FEEDFORWARD_INTERVAL_MS = 2;  // 500Hz
+    constexpr float CV_FEEDFORWARD_HZ = 1000.0f / CV_FEEDFORWARD_INTERVAL_MS;
+
+    // Regulated mode has a single supply estimate: a first-order filter over
+    // the feed-forward reads (VoltageSensor::updateFast()), which the control
+    // tick uses too. Ride-through therefore starts and clears on one signal,
+    // not on the tick median and single conversions in turn. 25 Hz = 6.4 ms
+    // time constant (~3 reads): conversion noise out, a sag still followed.
+    constexpr float CV_SUPPLY_FILTER_CUTOFF_HZ = 25.0f;
+
+    // Ride-through for dips below VOLTAGE_MINIMUM_VALID (cranking):
+    //   - First CV_RIDE_THROUGH_MS: duty saturates at CV_RIDE_THROUGH_DUTY
+    //   - After that the reading is not trusted: duty = Vtarget / CV_FALLBACK_SUPPLY_VOLTAGE
+    constexpr unsigned long CV_RIDE_THROUGH_MS = 1500;      // Typical crank duration
+    constexpr float CV_RIDE_THROUGH_DUTY = 1.00f;           // Full available voltage
+    constexpr float CV_FALLBACK_SUPPLY_VOLTAGE = 12.0f;     // Assumed supply (Volts)
+
     // =========================================================================
     // CURRENT PROTECTION SYSTEM
     // =========================================================================
@@ -125,7 +258,24 @@ namespace Config {
     // Prevents chattering/oscillation between protection levels
     // Level changes require crossing threshold � hysteresis
     constexpr float CURRENT_HYSTERESIS = 2.5f;           // Amperes
-    
+
+    // I2t (inverse-time) overcurrent protection
+    // Replaces the fixed FAULT threshold with a thermal integral per channel:
+    //   X += (I^2 - I2T_NOMINAL_CURRENT_A^2) * dt,  clamped to [0, I2T_CAPACITY_A2S]
+    //   FAULT when X reaches capacity, back to NORMAL when headroom >= I2T_RESET_HEADROOM
+    // Trip time for a constant overload I: t = CAPACITY / (I^2 - Inom^2)
+    //   38A -> 9.2s, 40A -> 7.1s, 44A -> 4.8s (EMERGENCY at 45A stays instantaneous)
+    // When false, the fixed CURRENT_THRESHOLD_FAULT + CURRENT_HYSTERESIS logic is used.
+    constexpr bool  ENABLE_I2T_PROTECTION = true;
+    constexpr float I2T_NOMINAL_CURRENT_A = 30.0f;   // Continuous rating (Amperes)
+    constexpr float I2T_CAPACITY_A2S      = 5000.0f; // Thermal capacity (A^2*s)
+    constexpr float I2T_RESET_HEADROOM    = 0.50f;   // Headroom needed to leave FAULT
+    constexpr float I2T_MAX_STEP_S        = 0.5f;    // Max integration step (stalled loop guard)
+
+    // Proportional derating: below this headroom the voltage limit ramps linearly
+    // from PROTECTION_PERCENT_NORMAL down to PROTECTION_PERCENT_FAULT at the trip point
+    constexpr float I2T_DERATE_START_HEADROOM = 0.50f;
+
     // Percentage-based voltage limiting for protection levels
     // These percentages apply to the measured supply voltage (adaptive)
     // NORMAL:    100% (1.00) - no limiting (full power)
@@ -158,6 +308,24 @@ namespace Config {
     // EMERGENCY rate limiting (bypass normal rate limiting in critical situations)
     // When entering EMERGENCY level, apply immediate reduction without rate limiting
     constexpr float VOLTAGE_LIMIT_RATE_EMERGENCY = 1.0f; // Instant shutdown (no rate limiting)
+
+    // =========================================================================
+    // SOFT-START (INRUSH-MANAGED PUMP SPIN-UP, see SoftStart.h)
+    // =========================================================================
+
+    // After boot hold-off, EMERGENCY or external safety the output ramps up
+    // through a duty ceiling instead of stepping to >= OUTPUT_PERCENT_MIN.
+    constexpr bool  ENABLE_SOFT_START = true;
+    constexpr float SOFTSTART_INITIAL_DUTY = 0.20f;    // Ceiling at ramp start
+    constexpr float SOFTSTART_SLOPE_INITIAL = 2.0f;    // Duty per second (0.2->0.5 in 150ms)
+    constexpr float SOFTSTART_SLOPE_MIN = 0.25f;       // Duty per second (floor when over budget)
+    constexpr float SOFTSTART_SLOPE_MAX = 5.0f;        // Duty per second
+    // Inrush budget as fraction of CURRENT_THRESHOLD_FAULT (0.7 x 40A = 28A)
+    constexpr float SOFTSTART_INRUSH_FRACTION = 0.70f;
+    // Slope only grows while current is below this fraction of the budget
+    constexpr float SOFTSTART_SLOPE_UP_MARGIN = 0.80f;
+    constexpr unsigned long SOFTSTART_STEP_INTERVAL_MS = 10;   // 100Hz ramp service
+    constexpr unsigned long SOFTSTART_TIMEOUT_MS = 3000;       // Ramp always ends by then
     
     // =========================================================================
     // TEMPERATURE SENSOR - NTC 10K (HEATSINK MONITORING)
@@ -182,9 +350,41 @@ namespace Config {
     constexpr float NTC_BETA       = 3950.0f;   // Beta coefficient (typical 10K NTC)
     constexpr float NTC_T25_KELVIN = 298.15f;   // 25°C reference in Kelvin
 
-    // Temperature reading filter coefficient (EMA)
+    // Temperature reading filter: moving average of the ADC counts (Filters.h)
     // Heatsink thermal mass is large -> slow filter is fine and reduces noise
-    constexpr float TEMP_FILTER_ALPHA = 0.10f;  // 0<alpha<=1 (smaller = smoother)
+    constexpr float TEMP_FILTER_WINDOW_S = 0.8f;  // Averaging window (seconds)
+
+    // =========================================================================
+    // THERMAL MODEL - JUNCTION ESTIMATE & DERATING (see ThermalModel.h)
+    // =========================================================================
+
+    // Heatsink NTC + per-channel current and duty -> MOSFET/diode junction temps.
+    // Output is derated progressively before the limits are reached.
+    constexpr bool ENABLE_THERMAL_DERATING = true;
+
+    // IRFB3077 (low-side switch) - conduction loss I^2 * Rds(Tj) * D
+    constexpr float MOSFET_RDS_ON_25C  = 0.0033f;  // Ohms (datasheet max @ 25°C)
+    constexpr float MOSFET_RDS_TEMPCO  = 0.0070f;  // 1/°C (~2x Rds at 175°C)
+    constexpr float MOSFET_RTH_JH      = 0.80f;    // °C/W junction->heatsink (Rth_jc 0.29 + pad)
+    constexpr float MOSFET_TAU_S       = 2.0f;     // Seconds, junction->heatsink time constant
+    constexpr float MOSFET_DERATE_START_C = 125.0f;
+    constexpr float MOSFET_TJ_LIMIT_C     = 160.0f; // Below datasheet 175°C max
+
+    // MBR30100 (freewheel) - conduction loss Vf * I * (1 - D)
+    constexpr float DIODE_VF           = 0.70f;    // Volts @ ~15A, hot
+    constexpr float DIODE_RTH_JH       = 2.00f;    // °C/W junction->heatsink (Rth_jc 1.5 + pad)
+    constexpr float DIODE_TAU_S        = 2.0f;     // Seconds
+    constexpr float DIODE_DERATE_START_C = 110.0f; // Known hot spot - start early
+    constexpr float DIODE_TJ_LIMIT_C     = 140.0f; // Below datasheet 150°C max
+
+    // Derating floor: never below the FAULT minimum (pump cannot be shut down)
+    constexpr float THERMAL_DERATE_MIN = PROTECTION_PERCENT_FAULT;
+
+    // Heatsink temperature assumed when the NTC reads open/short
+    constexpr float THERMAL_FALLBACK_HEATSINK_C = 85.0f;
+
+    // Max integration step (stalled loop / external safety hold guard)
+    constexpr float THERMAL_MAX_STEP_S = 0.5f;
 
     // =========================================================================
     // PWM CONFIGURATION
@@ -230,6 +430,32 @@ namespace Config {
     // Use this macro for all time intervals to ensure accurate timing
     // Example: if (millis() < MILLIS_COMPENSATED(2000)) // 2 seconds actual time
     #define MILLIS_COMPENSATED(ms) ((ms) * Config::TIMER0_PRESCALER_FACTOR)
+
+    // Exact Timer 0 time base. The core's overflow ISR adds 1024us per Timer 0
+    // overflow whatever the timer setup (wiring.c assumes /64 fast PWM, 256
+    // counts). Phase-correct at /8 overflows every 510 counts = 255us, so
+    // millis()/micros() run 1024/255 = 4.02x fast, not 8x: the intervals set
+    // with MILLIS_COMPENSATED (the control timing was tuned with them) are
+    // about twice their nominal value on the board. Anything stored or
+    // reported as a physical quantity (usage hours, Ah/Wh) or integrated
+    // over real time (I2t, thermal model, ramps, rates) converts with this
+    // ratio instead.
+    constexpr uint16_t TIMER0_CORE_US_PER_OVERFLOW = 1024;  // wiring.c MICROSECONDS_PER_TIMER0_OVERFLOW
+    constexpr uint16_t TIMER0_OVERFLOW_COUNTS = ENABLE_HIGH_FREQ_PWM ? 510 : 256;  // Phase-correct: up and down
+    constexpr uint16_t TIMER0_PRESCALER = ENABLE_HIGH_FREQ_PWM ? 8 : 64;
+    constexpr uint16_t TIMER0_REAL_US_PER_OVERFLOW = TIMER0_OVERFLOW_COUNTS * TIMER0_PRESCALER / 16;  // 16 MHz
+
+    // millis() (micros()) difference -> real ms (us); up to 16.7e6 units
+    constexpr uint32_t coreTimeToReal(uint32_t coreUnits) {
+        return coreUnits * TIMER0_REAL_US_PER_OVERFLOW / TIMER0_CORE_US_PER_OVERFLOW;
+    }
+
+    // millis() difference -> real seconds (float time steps)
+    constexpr float REAL_S_PER_MILLIS = TIMER0_REAL_US_PER_OVERFLOW / (1000.0f * TIMER0_CORE_US_PER_OVERFLOW);
+
+    // Real ms -> millis() units (exact counterpart of MILLIS_COMPENSATED)
+    #define MILLIS_REAL(ms) ((unsigned long)(ms) * Config::TIMER0_CORE_US_PER_OVERFLOW / \
+                             Config::TIMER0_REAL_US_PER_OVERFLOW)
     
     // =========================================================================
     // PIN ASSIGNMENTS
@@ -240,10 +466,18 @@ namespace Config {
     constexpr uint8_t PIN_PWM_OUT_1    = 6;  // D6 (SSR channel 1) // Modificado para D6 para evitar conflito com Timer 0
     constexpr uint8_t PIN_PWM_OUT_2    = 5;  // D5 (SSR channel 2)
     
-    // Status LED NeoPixel
-    constexpr uint8_t PIN_STATUS_LED   = 2;  // D2 - NeoPixel RGB LED
-    constexpr uint16_t STATUS_LED_COUNT = 1; // Número de LEDs NeoPixel
+    // Status LED WS2812 (Ws2812.h, StatusLed.h)
+    constexpr uint8_t PIN_STATUS_LED   = 2;  // D2 - WS2812 RGB LED
+    // Cada quadro desliga as interrupções por STATUS_LED_COUNT x 30 µs (não há
+    // hardware para o D2): no máximo 4 LEDs = 120 µs, longe dos ~260 µs do
+    // overrun da RX serial a 115200; atrasa uma borda da INT1 no máximo isso
+    constexpr uint8_t STATUS_LED_COUNT = 1;  // Número de LEDs WS2812 (mesma cor, 1-4)
     constexpr uint8_t LED_BRIGHTNESS   = 200; // Brilho do LED (0-255, 50 = ~20%)
+    // Quadros só saem da StatusLed::service() com a linha INT do CAN inativa,
+    // no máximo um a cada STATUS_LED_FRAME_INTERVAL_MS; um quadro esperando há
+    // STATUS_LED_MAX_DEFER_MS sai mesmo com a linha ativa
+    constexpr unsigned long STATUS_LED_FRAME_INTERVAL_MS = 20;  // 50 quadros/s
+    constexpr unsigned long STATUS_LED_MAX_DEFER_MS      = 100;
     
     // Current sensors (ACS758LCB-050B)
     constexpr uint8_t PIN_CURRENT_1    = A2; // Current sensor channel 1
@@ -286,14 +520,317 @@ namespace Config {
 
     // External PWM mode enable flag
     constexpr bool  ENABLE_EXTERNAL_PWM_MODE = true;  // Allow external PWM at D8 to override MAP control
+
+    // =========================================================================
+    // ENGINE INPUT (D3 / INT1) & FUEL-DEMAND FEEDFORWARD (see EngineInput.h)
+    // =========================================================================
+
+    // Tach or injector signal on D3 (INT1 - free since PWM_OUT_1 moved to D6).
+    // Edges are timestamped in the INT1 ISR; the control tick turns them into
+    // RPM and, for an injector signal, injector duty.
+    constexpr bool    ENABLE_ENGINE_INPUT     = false;  // Needs the D3 input wired
+    constexpr uint8_t PIN_ENGINE_INPUT        = 3;      // D3 - INT1
+    constexpr bool    ENGINE_INPUT_INJECTOR   = false;  // false = tach, true = injector (duty measured)
+    constexpr bool    ENGINE_INPUT_ACTIVE_LOW = true;   // Pulse = LOW (open-collector tach, low-side injector driver)
+    constexpr bool    ENGINE_INPUT_PULLUP     = true;   // Internal pull-up on D3
+
+    // Pulses per crankshaft revolution:
+    //   tach: cylinders / 2 (4-cyl = 2.0); injector: 0.5 sequential, 1.0 batch fire
+    constexpr float ENGINE_PULSES_PER_REV = 2.0f;
+
+    // Edges closer than this are noise (1 ms = 30000 RPM at 2 pulses/rev)
+    constexpr unsigned long ENGINE_INPUT_MIN_PERIOD_US = 1000;
+    // No pulse for this long: engine stopped, RPM 0 and no feedforward
+    constexpr unsigned long ENGINE_INPUT_TIMEOUT_MS = 1000;
+
+    // Fuel-demand estimate 0..1:
+    //   tach:     (MAP absolute / ENGINE_MAP_FULL_LOAD_BAR) x (RPM / ENGINE_RPM_MAX)
+    //   injector: injector duty / ENGINE_INJECTOR_DUTY_MAX
+    constexpr float ENGINE_RPM_MAX = 7000.0f;
+    constexpr float ENGINE_MAP_FULL_LOAD_BAR = ATMOSPHERIC_PRESSURE_BAR + MAP_BAR_HIGH_SETPOINT;  // Absolute
+    constexpr float ENGINE_INJECTOR_DUTY_MAX = 0.85f;
+
+    // MAP mode: target = pressure curve + DEMAND_FEEDFORWARD_GAIN x demand x
+    // (OUTPUT_PERCENT_MAX - OUTPUT_PERCENT_MIN), capped at OUTPUT_PERCENT_MAX.
+    // Flow follows fuel consumption (RPM at constant MAP) instead of pressure alone.
+    constexpr bool  ENABLE_DEMAND_FEEDFORWARD = ENABLE_ENGINE_INPUT;
+    constexpr float DEMAND_FEEDFORWARD_GAIN = 0.5f;
+
+    // =========================================================================
+    // CAN BUS (MCP2515 via SPI, see CanInterface.h)
+    // =========================================================================
+
+    // MCP2515 + TJA1050 module. SPI: MOSI=D11, MISO=D12, SCK=D13.
+    // INT (active low) is serviced through a pin-change interrupt (PCINT2 group
+    // for D0-D7); the ISR lives in PumpControl.ino.
+    constexpr bool     ENABLE_CAN        = true;       // false = driver stays idle, no SPI traffic
+    constexpr uint8_t  PIN_CAN_CS        = 9;          // D9 - MCP2515 chip select (older boards: D10)
+    constexpr uint8_t  PIN_CAN_INT       = 4;          // D4 - MCP2515 INT (PCINT20)
+    constexpr uint8_t  CAN_CRYSTAL_MHZ   = 8;          // MCP2515 oscillator (8 or 16 MHz)
+    constexpr uint16_t CAN_BITRATE_KBPS  = 500;        // 125, 250, 500 or 1000
+    constexpr uint32_t CAN_SPI_CLOCK_HZ  = 8000000UL;  // MCP2515 max 10 MHz; F_CPU/2 on the Nano
+
+    // Board number on a shared bus (0..3). Selects the PumpShare id and moves
+    // the telemetry block by 0x10 per board so several boards never send the
+    // same id. The DBC describes board 0.
+    constexpr uint8_t  CAN_NODE_ID       = 0;
+    static_assert(CAN_NODE_ID < 4, "CAN_NODE_ID must be 0..3");
+
+    // Hardware acceptance: a frame is accepted when (id & MASK) == (ACCEPT_ID & MASK).
+    // 0x6A0/0x7F0 = standard ids 0x6A0..0x6AF reserved for this controller.
+    constexpr uint16_t CAN_RX_ACCEPT_ID   = 0x6A0;
+    constexpr uint16_t CAN_RX_ACCEPT_MASK = 0x7F0;
+
+    // Software rings between ISR and main loop (power of two; one slot unused)
+    constexpr uint8_t  CAN_RX_RING_SIZE  = 8;          // 7 frames (~15 bytes each)
+    constexpr uint8_t  CAN_TX_RING_SIZE  = 4;          // 3 frames
+
+    // Telemetry broadcast (layout: CanTelemetryLayout.h, DBC: docs/PumpControl.dbc)
+    // Two 8-byte frames per cycle (~0.5 ms of bus time at 500 kbps)
+    constexpr bool     ENABLE_CAN_TELEMETRY   = true;
+    constexpr uint16_t CAN_TELEMETRY_BASE_ID  = 0x6B0 + 0x10 * CAN_NODE_ID; // Board 0: 0x6B0/0x6B1
+    constexpr uint8_t  CAN_TELEMETRY_RATE_HZ  = 50;      // 1..100 Hz
+    constexpr unsigned long CAN_TELEMETRY_INTERVAL_MS = 1000UL / CAN_TELEMETRY_RATE_HZ;
+    static_assert(CAN_TELEMETRY_RATE_HZ >= 1 && CAN_TELEMETRY_RATE_HZ <= 100,
+                  "CAN_TELEMETRY_RATE_HZ must be 1..100");
+
+    // Command source (layout: PUMP_COMMAND_SIGNALS, DBC: docs/PumpControl.dbc)
+    // The ECU sends a target duty or a pressure for the MAP curve. A command is
+    // used only while fresh; a stale or released command falls back to
+    // external PWM / MAP at the next control tick.
+    constexpr bool     ENABLE_CAN_COMMAND      = true;
+    constexpr uint16_t CAN_COMMAND_ID          = 0x6A0;  // Inside the acceptance block
+    constexpr unsigned long CAN_COMMAND_TIMEOUT_MS = 100; // Freshness (ECU sends at 50-100 Hz)
+    constexpr uint8_t  CAN_COMMAND_MAX_COUNTER_STEP = 2; // Counter jump accepted (1 lost frame)
+    constexpr bool     CAN_COMMAND_OVER_EXTERNAL_PWM = true; // Priority: CAN > PWM > MAP (false: PWM > CAN > MAP)
+    static_assert((CAN_COMMAND_ID & CAN_RX_ACCEPT_MASK) == (CAN_RX_ACCEPT_ID & CAN_RX_ACCEPT_MASK),
+                  "CAN_COMMAND_ID must pass the acceptance filter");
+    static_assert(CAN_COMMAND_MAX_COUNTER_STEP >= 1 && CAN_COMMAND_MAX_COUNTER_STEP <= 14,
+                  "CAN_COMMAND_MAX_COUNTER_STEP must be 1..14");
+
+    // Load sharing between boards driving pumps in parallel (see LoadShare.h).
+    // Each board broadcasts its state every control tick and applies its part
+    // of the total flow instead of its own target.
+    constexpr bool     ENABLE_LOAD_SHARING     = false;  // Single board by default
+    constexpr uint8_t  LOAD_SHARE_NODE_COUNT   = 2;      // Pumps in the system (flow of a missing board is redistributed)
+    constexpr uint16_t CAN_LOAD_SHARE_BASE_ID  = 0x6A8;  // PumpShare of board n = 0x6A8 + n
+    constexpr unsigned long LOAD_SHARE_PEER_TIMEOUT_MS = 150; // 3 control ticks without a frame = board gone
+    constexpr float    LOAD_SHARE_MIN_PERCENT  = 0.30f;  // Floor per available pump (never stopped)
+    constexpr float    LOAD_SHARE_TEMP_BIAS_START_C = 60.0f; // Heatsink temperature where load starts moving away
+    constexpr float    LOAD_SHARE_TEMP_BIAS_END_C   = 90.0f; // ... reaching LOAD_SHARE_MIN_WEIGHT here
+    constexpr float    LOAD_SHARE_MIN_WEIGHT   = 0.50f;  // Hot board takes half the share of a cool one
+    constexpr float    LOAD_SHARE_AGREEMENT    = 0.005f; // Peer share vs local result for "converged"
+    static_assert(LOAD_SHARE_NODE_COUNT >= 1 && LOAD_SHARE_NODE_COUNT <= 4,
+                  "LOAD_SHARE_NODE_COUNT must be 1..4");
+    static_assert((CAN_LOAD_SHARE_BASE_ID & CAN_RX_ACCEPT_MASK) == (CAN_RX_ACCEPT_ID & CAN_RX_ACCEPT_MASK) &&
+                  ((CAN_LOAD_SHARE_BASE_ID + 3) & CAN_RX_ACCEPT_MASK) == (CAN_RX_ACCEPT_ID & CAN_RX_ACCEPT_MASK),
+                  "PumpShare ids must pass the acceptance filter");
+    static_assert(CAN_COMMAND_ID < CAN_LOAD_SHARE_BASE_ID || CAN_COMMAND_ID > CAN_LOAD_SHARE_BASE_ID + 3,
+                  "CAN_COMMAND_ID overlaps the PumpShare ids");
     
+    // =========================================================================
+    // BOOT CALIBRATION (see SensorCalibration.h)
+    // =========================================================================
+
+    // Motor-OFF boot window: measure both ACS758 zeros and the barometric MAP
+    // baseline, end the hold-off when the readings converge.
+    // false: fixed CAL_MAX_MS hold-off with the EEPROM/default values.
+    constexpr bool ENABLE_BOOT_CALIBRATION = true;
+
+    // Sampling (real time)
+    constexpr unsigned long CAL_SETTLE_MS = 50;            // Ignore readings before this (RC filters, MPX power-up)
+    constexpr unsigned long CAL_MAX_MS = 2000;             // Hold-off upper bound (the old fixed delay)
+    constexpr unsigned int CAL_SAMPLE_INTERVAL_US = 2000;  // Between sample sets (a set takes ~10 ms: 2 x CURRENT_ADC_SAMPLES)
+    constexpr uint8_t CAL_MIN_SAMPLES = 32;
+
+    // Convergence per channel: sample std deviation below MAX_STDDEV (input
+    // not moving) and standard error of the mean below TOLERANCE
+    constexpr float CAL_ACS_MAX_STDDEV_V = 0.010f;   // 0.25 A
+    constexpr float CAL_ACS_TOLERANCE_V = 0.001f;    // 25 mA
+    constexpr float CAL_BARO_MAX_STDDEV_BAR = 0.010f;
+    constexpr float CAL_BARO_TOLERANCE_BAR = 0.002f;
+
+    // Plausible windows - outside means a loaded sensor or a running engine
+    constexpr float CAL_ACS_ZERO_MIN_V = 2.40f;      // Vcc/2 +- Voe (60 mV) + divider tolerance
+    constexpr float CAL_ACS_ZERO_MAX_V = 2.60f;
+    constexpr float CAL_BARO_MIN_BAR = 0.80f;        // ~2000 m altitude, low weather
+    constexpr float CAL_BARO_MAX_BAR = 1.08f;        // Below sea level, high weather
+
+    // The 0 A output on this board sits above the intercept of the loaded-point
+    // slope calibration above (~22 mV, see ACS758_ZERO_CURRENT_V notes). The
+    // measured zero is corrected by this amount so loaded readings stay on the
+    // calibrated line. Set to 0 if the slope is recalibrated against the
+    // measured zero.
+    constexpr float CAL_ACS_ZERO_CORRECTION_V = -0.022f;
+
+    // EEPROM record (fallback when a channel does not converge, warm restart)
+    constexpr uint16_t EEPROM_CALIBRATION_ADDR = 0;
+    // Rewrite the record only when a value moved by more than this
+    constexpr float CAL_SAVE_DELTA_V = 0.002f;
+    constexpr float CAL_SAVE_DELTA_BAR = 0.005f;
+
+    static_assert(CAL_SETTLE_MS < CAL_MAX_MS, "CAL_SETTLE_MS must be below CAL_MAX_MS");
+    static_assert(ACS758_ZERO_CURRENT_V > CAL_ACS_ZERO_MIN_V && ACS758_ZERO_CURRENT_V < CAL_ACS_ZERO_MAX_V &&
+                  ATMOSPHERIC_PRESSURE_BAR > CAL_BARO_MIN_BAR && ATMOSPHERIC_PRESSURE_BAR < CAL_BARO_MAX_BAR,
+                  "Calibration defaults must lie inside the plausible windows");
+
+    // =========================================================================
+    // USAGE STATISTICS (see UsageLog.h)
+    // =========================================================================
+
+    // Season-long operating histograms and energy counters, accumulated every
+    // control tick, checkpointed to EEPROM and dumped in binary over Serial
+    constexpr bool ENABLE_USAGE_LOG = true;
+
+    // Histogram bins (time in 0.1 s per bin, uint32: 13 years per bin)
+    // Duty x MAP: duty in USAGE_DUTY_BINS equal bins of 0-100%; MAP in four
+    // bins along the curve: vacuum, 0..LOW, LOW..HIGH, above HIGH setpoint
+    constexpr uint8_t USAGE_DUTY_BINS = 5;             // 20% wide
+    constexpr uint8_t USAGE_CURRENT_BINS = 8;          // Per channel, both channels added
+    constexpr float USAGE_CURRENT_BIN_A = 5.0f;        // 0-5 A ... 35 A and above
+    constexpr uint8_t USAGE_TEMP_BINS = 8;             // Heatsink NTC
+    constexpr float USAGE_TEMP_FIRST_C = 30.0f;        // Below 30 C, 30-40 ... 90 C and above
+    constexpr float USAGE_TEMP_BIN_C = 10.0f;
+
+    // Checkpoint: one slot of the ring every interval, written one byte per
+    // loop pass (the EEPROM takes 3.4 ms per byte; the loop never waits).
+    // Intervals and counters in real time (MILLIS_REAL / coreTimeToReal).
+    // 5 slots at 5 min: each EEPROM cell written at most every 25 min of
+    // operation, 100k cycles = 4.7 years powered. The boot and supply drop
+    // checkpoints add two per drive; a supply flapping around the threshold
+    // costs at most one per USAGE_CHECKPOINT_MIN_GAP_S.
+    constexpr unsigned long USAGE_CHECKPOINT_INTERVAL_S = 300;
+    constexpr unsigned long USAGE_FIRST_CHECKPOINT_S = 30;    // After begin()
+    constexpr unsigned long USAGE_CHECKPOINT_MIN_GAP_S = 30;  // Early (supply drop) checkpoints
+    // Supply drop checkpoint (ignition off, undervoltage): only the bytes that
+    // changed since the previous checkpoint are written (a few dozen, ~0.1 s)
+    constexpr float USAGE_SUPPLY_DROP_V = 9.0f;
+    constexpr float USAGE_SUPPLY_REARM_V = 11.0f;
+    constexpr uint16_t EEPROM_USAGE_ADDR = 32;         // After the calibration record
+    constexpr uint8_t USAGE_EEPROM_SLOTS = 5;
+
+    // Serial byte that requests the binary dump (tools/log/usagedump decodes it)
+    constexpr char USAGE_DUMP_COMMAND = 'U';
+
+    static_assert(EEPROM_USAGE_ADDR >= EEPROM_CALIBRATION_ADDR + 32,
+                  "Usage ring overlaps the calibration record");
+    static_assert(USAGE_DUTY_BINS >= 1 && USAGE_CURRENT_BINS >= 2 && USAGE_TEMP_BINS >= 2,
+                  "Usage histograms need bins");
+    static_assert(USAGE_FIRST_CHECKPOINT_S <= USAGE_CHECKPOINT_INTERVAL_S &&
+                  USAGE_CHECKPOINT_MIN_GAP_S <= USAGE_CHECKPOINT_INTERVAL_S &&
+                  USAGE_CHECKPOINT_INTERVAL_S <= 65535,
+                  "Usage checkpoint intervals out of order");
+    static_assert(USAGE_SUPPLY_DROP_V < USAGE_SUPPLY_REARM_V, "Usage supply drop needs hysteresis");
+
+    // =========================================================================
+    // LATENCY PROBE (see LatencyProbe.h)
+    // =========================================================================
+
+    // Measurement mode: input event -> OCR0A/OCR0B write, per path (D7 safety
+    // edge, D8 PWM duty change, MAP step), min/max/percentiles in the status
+    // report. Adds pin-change interrupts on D7/D8 and ~200 B of SRAM for the
+    // histograms; build with it for bench work and performance comparisons.
+    constexpr bool ENABLE_LATENCY_PROBE = false;
+
+    // Input events
+    constexpr float LATENCY_PWM_STEP_PERCENT = 2.0f;   // D8 high time moved by this (of the period)
+    constexpr float LATENCY_MAP_STEP_BAR = 0.10f;      // MAP sample moved this far from the reference
+    // Output response: duty moved this many counts (of 255) in the direction
+    // of the input change (safety: duty written as 0)
+    constexpr uint8_t LATENCY_OUTPUT_STEP_COUNTS = 3;
+    // No matching output write within this time (real ms): counted as "no
+    // response" (output saturated, other source in control, EMERGENCY)
+    constexpr unsigned long LATENCY_TIMEOUT_MS = 1000;
+
+    // Scope pin: HIGH from the input event to the OCR write, so the pulse
+    // width is the latency (trigger on D7/D8 and this pin). D10 is the SPI SS
+    // pin, an output anyway; not on boards with the MCP2515 CS on D10.
+    constexpr bool ENABLE_LATENCY_SCOPE_PIN = false;
+    constexpr uint8_t PIN_LATENCY_SCOPE = 10;
+
+    // Serial byte that restarts the statistics (start of a measurement)
+    constexpr char LATENCY_RESET_COMMAND = 'L';
+
+    static_assert(!ENABLE_LATENCY_SCOPE_PIN ||
+                  (PIN_LATENCY_SCOPE != PIN_CAN_CS && PIN_LATENCY_SCOPE != PIN_CAN_INT &&
+                   PIN_LATENCY_SCOPE != PIN_STATUS_LED && PIN_LATENCY_SCOPE != PIN_ENGINE_INPUT &&
+                   PIN_LATENCY_SCOPE != PIN_PWM_OUT_1 && PIN_LATENCY_SCOPE != PIN_PWM_OUT_2 &&
+                   PIN_LATENCY_SCOPE != PIN_DIG_IN_1 && PIN_LATENCY_SCOPE != PIN_DIG_IN_2),
+                  "PIN_LATENCY_SCOPE is in use");
+    static_assert(LATENCY_RESET_COMMAND != USAGE_DUMP_COMMAND, "Serial commands must differ");
+
     // =========================================================================
     // TIMING
     // =========================================================================
     
     // Main control loop update interval
     constexpr unsigned long MAIN_LOOP_INTERVAL_MS = 50; // 20Hz
+
+    // Sensor filters are fed once per control tick (update() in loop()); their
+    // coefficients are computed from this rate (Filters.h)
+    constexpr float SENSOR_SAMPLE_HZ = 1000.0f / MAIN_LOOP_INTERVAL_MS;
     
     // Status report interval (verbose logging)
     constexpr unsigned long STATUS_REPORT_INTERVAL_MS = 1000; // 1Hz
+
+    // Compact status line on every control tick (20Hz). ~100 chars per tick
+    // fills the 64-byte Serial TX buffer and blocks the tick for several ms;
+    // CAN telemetry carries the same data. Enable for bench work without CAN.
+    constexpr bool ENABLE_SERIAL_TICK_LOG = !ENABLE_CAN_TELEMETRY;
+
+    // =========================================================================
+    // WATCHDOG & WARM RESTART (see WarmStart.h)
+    // =========================================================================
+
+    // Watchdog (500 ms), fed at the end of loop() while the loop is healthy.
+    // REQUIRES the Optiboot bootloader (processor "ATmega328P", not "Old
+    // Bootloader"): the old bootloader does not stop the watchdog and the
+    // board resets in a loop.
+    constexpr bool ENABLE_WATCHDOG = true;
+
+    // Loop health: the control tick must have run within this time (real ms).
+    // Covers one tick plus the longest pulseIn() wait of the PWM input.
+    constexpr unsigned long WATCHDOG_TICK_STALL_MS = 250;
+
+    // After a watchdog/brown-out reset, restore the saved output within
+    // microseconds instead of the cold boot (Serial wait, 100 ms grace, 2 s hold-off)
+    constexpr bool ENABLE_WARM_RESTART = true;
+
+    // Warm restarts in a row before a cold boot is forced (reset loop)
+    constexpr uint8_t WARM_RESTART_MAX_CONSECUTIVE = 3;
+
+    // Running this long after a reset ends a series of warm restarts (real ms)
+    constexpr unsigned long WARM_RESTART_STABLE_MS = 10000;
+
+    static_assert(WATCHDOG_TICK_STALL_MS > MAIN_LOOP_INTERVAL_MS && WATCHDOG_TICK_STALL_MS < 500,
+                  "WATCHDOG_TICK_STALL_MS must be above the tick interval and below the watchdog timeout");
+
+    // =========================================================================
+    // MEMORY MONITOR (see MemoryMonitor.h)
+    // =========================================================================
+
+    // Stack high-water mark by stack painting + free SRAM in the status report
+    constexpr bool ENABLE_MEMORY_MONITOR = true;
+
+    // Bytes checked per loop() pass (a full pass is at most ~1 KB)
+    constexpr uint8_t MEMORY_SCAN_BYTES = 16;
+
+    // Status report flags LOW MEMORY below this margin (heap end to the
+    // deepest stack write). Deep Serial.print chains and nested ISRs need
+    // roughly this much on top of the measured peak.
+    constexpr uint16_t MEMORY_LOW_MARGIN_BYTES = 128;
+
+    // =========================================================================
+    // SLEEP MODES (see Adc.h, CpuIdle.h)
+    // =========================================================================
+    // SLEEP_MODE_IDLE only: ADC Noise Reduction and the deeper modes stop
+    // clkIO, which halts Timer 0 - the power PWM would freeze mid-period and
+    // millis() would lose time.
+
+    // Sensor conversions sleep until the ADC interrupt instead of busy-waiting
+    constexpr bool ENABLE_ADC_SLEEP = true;
+
+    // loop() sleeps between passes until the next interrupt (<= 255 us)
+    // and reports the idle time in the status report
+    constexpr bool ENABLE_IDLE_SLEEP = true;
 }
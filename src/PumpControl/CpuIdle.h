@@ -0,0 +1,77 @@
+#pragma once
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "Config.h"
+#include "Timer1Clock.h"
+
+// -----------------------------------------------------------------------------
+// CpuIdle - Sleep between loop() passes, idle-time accounting
+// -----------------------------------------------------------------------------
+// loop() polls its schedules (control tick, feed-forward, telemetry, status)
+// and would otherwise spin. sleep() at the end of a pass puts the CPU in
+// SLEEP_MODE_IDLE until the next interrupt - at the latest the Timer 0
+// overflow every 255us (3.9 kHz PWM), so no schedule slips by more than one
+// PWM period. The CAN INT and Serial RX interrupts wake it at once. IDLE, not
+// a deeper mode: Timer 0 (PWM and millis()) must keep running (see Adc.h).
+//
+// Accounting: time asleep against wall time per report window, both in
+// Timer1Clock counts - not micros(), which steps backwards inside a Timer 0
+// period (a sleep is shorter than one). getIdlePercent() is the CPU
+// headroom: time the loop had nothing to do. Sleeping inside Adc::read() is
+// not counted, the CPU is waiting on the ADC there.
+// -----------------------------------------------------------------------------
+
+class CpuIdle {
+public:
+    CpuIdle()
+        : _windowStart(0)
+        , _sleepCounts(0)
+        , _sleeps(0)
+        , _idlePercent(0.0f)
+        , _wakeupsPerSec(0)
+    {}
+
+    // After Timer1Clock::begin()
+    void begin() {
+        _windowStart = Timer1Clock::now();
+        _sleepCounts = 0;
+        _sleeps = 0;
+    }
+
+    // Sleep until the next interrupt - end of every loop() pass. The Timer 1
+    // overflow wakes it within 32.8 ms, so the 16-bit difference is exact.
+    void sleep() {
+        if (!Config::ENABLE_IDLE_SLEEP) return;
+        uint16_t start = Timer1Clock::ticks16();
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        sleep_mode();
+        _sleepCounts += (uint16_t)(Timer1Clock::ticks16() - start);
+        _sleeps++;
+    }
+
+    // Close the report window and start the next one (status report)
+    void closeWindow() {
+        uint32_t now = Timer1Clock::now();
+        uint32_t span = now - _windowStart;
+        if (span > 0) {
+            _idlePercent = 100.0f * (float)_sleepCounts / (float)span;
+            float spanSec = (float)span / (Timer1Clock::COUNTS_PER_US * 1000000.0f);
+            _wakeupsPerSec = (unsigned long)(_sleeps / spanSec + 0.5f);
+        }
+        _windowStart = now;
+        _sleepCounts = 0;
+        _sleeps = 0;
+    }
+
+    // Time asleep in the last window (%)
+    float getIdlePercent() const { return _idlePercent; }
+    // Loop passes that slept, per second, in the last window
+    unsigned long getWakeupsPerSec() const { return _wakeupsPerSec; }
+
+private:
+    uint32_t _windowStart;   // Timer1Clock::now()
+    uint32_t _sleepCounts;   // Timer1Clock counts asleep in this window
+    unsigned long _sleeps;
+    float _idlePercent;
+    unsigned long _wakeupsPerSec;
+};
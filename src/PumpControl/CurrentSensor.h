@@ -1,6 +1,8 @@
 #pragma once
 #include <Arduino.h>
 #include "Config.h"
+#include "Adc.h"
+#include "Filters.h"
 
 // -----------------------------------------------------------------------------
 // CurrentSensor - Measures current using ACS758LCB-050B Hall-effect sensor
@@ -8,7 +10,7 @@
 // ACS758LCB-050B Specifications:
 //   - Bidirectional: -50A to +50A measurement range
 //   - Sensitivity: 40mV/A (0.040 V/A)
-//   - Zero current output: Vcc/2 (~2.5V nominal; calibrated per-board in Config)
+//   - Zero current output: Vcc/2 (~2.5V nominal; measured at boot, see SensorCalibration.h)
 //   - Supply voltage: 5V
 //   - Output voltage range: 0.5V (-50A) to 4.5V (+50A) around Vzero
 //
@@ -19,43 +21,42 @@
 //
 // PWM interference mitigation:
 //   - Multi-sample averaging (configurable via Config::CURRENT_ADC_SAMPLES)
-//   - EMA filtering for additional smoothing
+//   - EMA filtering for additional smoothing (Filters.h, fixed point on the
+//     sum of the conversions, CURRENT_FILTER_CUTOFF_HZ)
 //   - Samples taken with microsecond delays to average PWM cycles
+//
+// update() takes one burst and feeds the EMA, once per control tick; every
+// reader of the tick (protection, thermal model, status) gets the same
+// getCurrentA() value without another burst.
 // -----------------------------------------------------------------------------
 class CurrentSensor {
 public:
     explicit CurrentSensor(uint8_t pin) 
         : _pin(pin)
-        , _filteredVoltage(Config::ACS758_ZERO_CURRENT_V)
-        , _initialized(false)
-    {}
+        , _zeroVoltage(Config::ACS758_ZERO_CURRENT_V)
+    {
+        _filter.reset(voltageToSum(Config::ACS758_ZERO_CURRENT_V));
+    }
 
     void begin() {
         pinMode(_pin, INPUT);
         
         // Initialize filter with first reading to avoid startup transient
-        int adc = analogRead(_pin);
-        _filteredVoltage = adcToVoltage(adc);
-        _initialized = true;
+        int adc = Adc::read(_pin);
+        _filter.reset((uint16_t)(adc * Config::CURRENT_ADC_SAMPLES));
     }
 
-    // Returns instantaneous current in Amperes (with multi-sample averaging and EMA filtering)
-    float readCurrentA() {
+    // New multi-sample reading into the EMA - once per control tick
+    void update() {
         // Multi-sample averaging to filter PWM noise
         // Takes multiple ADC readings with small delays to average out PWM cycles
-        float voltage = readVoltageAveraged();
-        
-        // Apply Exponential Moving Average filter for additional noise reduction
-        if (_initialized) {
-            _filteredVoltage = (Config::CURRENT_FILTER_ALPHA * voltage) + 
-                              ((1.0f - Config::CURRENT_FILTER_ALPHA) * _filteredVoltage);
-        } else {
-            _filteredVoltage = voltage;
-            _initialized = true;
-        }
-        
+        _filter.update(readAdcSum(Config::CURRENT_ADC_SAMPLES));
+    }
+
+    // Filtered current in Amperes (last update(), no ADC access)
+    float getCurrentA() const {
         // Calculate current: I = (Vout - Vzero) / Sensitivity
-        float current = (_filteredVoltage - Config::ACS758_ZERO_CURRENT_V) /
+        float current = (getFilteredVoltage() - _zeroVoltage) /
                         Config::ACS758_SENSITIVITY;
 
         // Clamp negative (reverse-flow) readings; pump load is unidirectional
@@ -65,11 +66,23 @@ public:
         return current;
     }
 
+    // Returns fast unfiltered current (short multi-sample average, no EMA)
+    // For inrush monitoring where the 0.5s EMA would hide the spike.
+    // Does not disturb the EMA state used by getCurrentA().
+    float readCurrentFastA() {
+        float voltage = readVoltageAveraged(Config::CURRENT_FAST_ADC_SAMPLES);
+        float current = (voltage - _zeroVoltage) /
+                        Config::ACS758_SENSITIVITY;
+        if (current < 0.0f) current = 0.0f;
+        if (current > Config::ACS758_MAX_CURRENT) current = Config::ACS758_MAX_CURRENT;
+        return current;
+    }
+
     // Returns raw unfiltered current (single sample, for diagnostics)
     float readCurrentRawA() {
-        int adc = analogRead(_pin);
+        int adc = Adc::read(_pin);
         float voltage = adcToVoltage(adc);
-        float current = (voltage - Config::ACS758_ZERO_CURRENT_V) /
+        float current = (voltage - _zeroVoltage) /
                         Config::ACS758_SENSITIVITY;
         if (current < 0.0f) current = 0.0f;
         if (current > Config::ACS758_MAX_CURRENT) current = Config::ACS758_MAX_CURRENT;
@@ -83,36 +96,59 @@ public:
 
     // Returns filtered output voltage (for diagnostics)
     float getFilteredVoltage() const {
-        return _filteredVoltage;
+        return _filter.get() * SUM_TO_VOLTS;
+    }
+
+    // Zero-current output voltage (boot calibration, EEPROM or Config default)
+    void setZeroVoltage(float volts) {
+        _zeroVoltage = volts;
+    }
+
+    float getZeroVoltage() const {
+        return _zeroVoltage;
     }
 
     // Reset filter (useful after power cycling or fault recovery)
     void resetFilter() {
-        _filteredVoltage = readVoltageAveraged();
+        _filter.reset(readAdcSum(Config::CURRENT_ADC_SAMPLES));
     }
 
 private:
+    // Sum of CURRENT_ADC_SAMPLES conversions (<= 32 x 1023, Config.h)
+    typedef Filters::Ema<uint16_t, Filters::mHz(Config::CURRENT_FILTER_CUTOFF_HZ),
+                         Filters::mHz(Config::SENSOR_SAMPLE_HZ)> Filter;
+
+    static constexpr float SUM_TO_VOLTS =
+        Config::ADC_REFERENCE_VOLTAGE / (1023.0f * Config::CURRENT_ADC_SAMPLES);
+
     uint8_t _pin;
-    float _filteredVoltage;  // EMA filtered voltage reading
-    bool _initialized;
+    Filter _filter;          // EMA of the burst sums
+    float _zeroVoltage;      // Output at 0 A
+
+    static uint16_t voltageToSum(float volts) {
+        return (uint16_t)(volts / SUM_TO_VOLTS + 0.5f);
+    }
 
     // Read voltage with multi-sample averaging to filter PWM interference
     // Takes multiple ADC samples with small delays to average PWM cycles
     // PWM at 977Hz = ~1.02ms period, so 10 samples @ 50�s = 500�s covers ~half cycle
-    // SAFETY: uint32_t can hold up to 4,194,303 samples (each ADC read max 1023)
-    // Current CURRENT_ADC_SAMPLES=10 is safe. Max safe value = 4194 samples.
-    float readVoltageAveraged() {
-        uint32_t adcSum = 0;
+    // SAFETY: uint16_t holds 64 samples of 1023; the filtered sum is limited to
+    // 32 (static_assert next to CURRENT_ADC_SAMPLES in Config.h).
+    float readVoltageAveraged(uint8_t samples = Config::CURRENT_ADC_SAMPLES) {
+        float avgAdc = readAdcSum(samples) / (float)samples;
+        return adcToVoltage(avgAdc);
+    }
+
+    uint16_t readAdcSum(uint8_t samples) {
+        uint16_t adcSum = 0;
         
-        for (uint8_t i = 0; i < Config::CURRENT_ADC_SAMPLES; i++) {
-            adcSum += analogRead(_pin);
-            if (i < Config::CURRENT_ADC_SAMPLES - 1) {
+        for (uint8_t i = 0; i < samples; i++) {
+            adcSum += Adc::read(_pin);
+            if (i < samples - 1) {
                 delayMicroseconds(Config::CURRENT_ADC_DELAY_US);
             }
         }
-        
-        float avgAdc = adcSum / (float)Config::CURRENT_ADC_SAMPLES;
-        return adcToVoltage(avgAdc);
+        return adcSum;
     }
 
     // Convert ADC reading to voltage
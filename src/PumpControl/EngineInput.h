@@ -0,0 +1,186 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "FastPin.h"
+#include "Timer1Clock.h"
+
+// -----------------------------------------------------------------------------
+// EngineInput - Tach or injector pulses on an external-interrupt pin (D3/INT1)
+// -----------------------------------------------------------------------------
+// The ISR (INT1_vect in PumpControl.ino, any edge) only timestamps, in
+// Timer1Clock counts (0.5us, monotonic - not micros(), see Timer1Clock.h),
+// the start of each pulse, and its end on an injector signal. Periods
+// and pulse widths are summed; update() (once per control tick) takes the
+// sums with interrupts off and turns them into
+//   RPM            = 60e6 / (mean period us * ENGINE_PULSES_PER_REV)
+//   injector duty  = mean pulse width / mean period (ENGINE_INPUT_INJECTOR)
+// Averaging every pulse of the tick removes the per-edge interrupt latency.
+//
+// Slower than one pulse per tick: the last period is held, but the RPM is
+// capped by the time since the last pulse, so a falling engine speed shows
+// up at once. No pulse for ENGINE_INPUT_TIMEOUT_MS: engine stopped (invalid).
+// Edges closer than ENGINE_INPUT_MIN_PERIOD_US are ignored (ignition noise).
+//
+// getDemand() is the fuel-demand estimate (0..1) for the MAP-mode
+// feedforward: injector duty when measured, else MAP x RPM (speed-density).
+// Pin is a template parameter (FastPin.h); use the EngineInput typedef below.
+// -----------------------------------------------------------------------------
+
+template <uint8_t PIN>
+class EngineInputT {
+    static_assert(PIN == 2 || PIN == 3, "EngineInput: external interrupts are D2 (INT0) and D3 (INT1)");
+    static constexpr uint8_t INT_NUM = PIN - 2;
+
+public:
+    EngineInputT()
+        : _pulseStart(0)
+        , _periodSum(0)
+        , _widthSum(0)
+        , _periods(0)
+        , _widths(0)
+        , _inPulse(false)
+        , _running(false)
+        , _pulses(0)
+        , _lastPulses(0)
+        , _lastPulseMs(0)
+        , _periodUs(0.0f)
+        , _rpm(0.0f)
+        , _injectorDuty(0.0f)
+        , _valid(false) {}
+
+    void begin() {
+        if (Config::ENGINE_INPUT_PULLUP) {
+            FastPin<PIN>::inputPullup();
+        } else {
+            FastPin<PIN>::input();
+        }
+        // Any edge (ISCn0 = 1): pulse start and end both needed for the duty
+        EICRA = (uint8_t)((EICRA & ~(0x03 << (2 * INT_NUM))) | (0x01 << (2 * INT_NUM)));
+        EIFR = (uint8_t)_BV(INT_NUM);
+        EIMSK |= (uint8_t)_BV(INT_NUM);
+        _lastPulseMs = millis();
+    }
+
+    // Called from the external-interrupt ISR
+    void onEdge() {
+        uint32_t now = Timer1Clock::now();
+        bool active = FastPin<PIN>::read() != Config::ENGINE_INPUT_ACTIVE_LOW;
+        if (active) {
+            uint32_t period = now - _pulseStart;
+            if (_running && period < MIN_PERIOD_COUNTS) {
+                return;  // Glitch: keep the pulse that is running
+            }
+            if (_running) {
+                _periodSum += period;
+                _periods++;
+            }
+            _pulseStart = now;
+            _inPulse = true;
+            _running = true;
+            _pulses++;
+        } else if (_inPulse) {
+            _inPulse = false;
+            if (Config::ENGINE_INPUT_INJECTOR) {
+                _widthSum += now - _pulseStart;
+                _widths++;
+            }
+        }
+    }
+
+    // Once per control tick
+    void update() {
+        unsigned long nowMs = millis();
+
+        uint8_t sreg = SREG;
+        noInterrupts();
+        uint32_t periodSum = _periodSum;
+        uint32_t widthSum = _widthSum;
+        uint16_t periods = _periods;
+        uint16_t widths = _widths;
+        uint16_t pulses = _pulses;
+        uint32_t sinceStart = Timer1Clock::now() - _pulseStart;
+        _periodSum = 0;
+        _widthSum = 0;
+        _periods = 0;
+        _widths = 0;
+        SREG = sreg;
+
+        if (pulses != _lastPulses) {
+            _lastPulses = pulses;
+            _lastPulseMs = nowMs;
+        } else if ((unsigned long)(nowMs - _lastPulseMs) >= MILLIS_COMPENSATED(Config::ENGINE_INPUT_TIMEOUT_MS)) {
+            // Engine stopped: next edge starts a fresh measurement
+            sreg = SREG;
+            noInterrupts();
+            _running = false;
+            _inPulse = false;
+            SREG = sreg;
+            _valid = false;
+            _periodUs = 0.0f;
+            _rpm = 0.0f;
+            _injectorDuty = 0.0f;
+            return;
+        }
+
+        const float usPerCount = 1.0f / Timer1Clock::COUNTS_PER_US;
+        if (periods > 0) {
+            _periodUs = (float)periodSum * usPerCount / periods;
+            if (Config::ENGINE_INPUT_INJECTOR && widths > 0) {
+                _injectorDuty = ((float)widthSum / widths) / ((float)periodSum / periods);
+                if (_injectorDuty > 1.0f) _injectorDuty = 1.0f;
+            }
+            _valid = true;
+        }
+        if (!_valid) return;
+
+        // No complete period this tick: the running one is at least this long
+        float periodUs = _periodUs;
+        float runningUs = (float)sinceStart * usPerCount;
+        if (runningUs > periodUs) periodUs = runningUs;
+        _rpm = 60.0e6f / (periodUs * Config::ENGINE_PULSES_PER_REV);
+    }
+
+    bool isValid() const { return _valid; }
+    float getRpm() const { return _rpm; }
+    float getInjectorDuty() const { return _injectorDuty; }  // 0..1, injector signal only
+    float getPeriodUs() const { return _periodUs; }
+    uint16_t getPulseCount() const { return _pulses; }      // Wraps; edges accepted
+
+    // Fuel-demand estimate 0..1 (0 without a valid signal)
+    float getDemand(float mapAbsoluteBar) const {
+        if (!_valid) return 0.0f;
+        float demand;
+        if (Config::ENGINE_INPUT_INJECTOR) {
+            demand = _injectorDuty / Config::ENGINE_INJECTOR_DUTY_MAX;
+        } else {
+            demand = (mapAbsoluteBar / Config::ENGINE_MAP_FULL_LOAD_BAR) * (_rpm / Config::ENGINE_RPM_MAX);
+        }
+        if (demand < 0.0f) demand = 0.0f;
+        if (demand > 1.0f) demand = 1.0f;
+        return demand;
+    }
+
+private:
+    static constexpr uint32_t MIN_PERIOD_COUNTS =
+        Config::ENGINE_INPUT_MIN_PERIOD_US * Timer1Clock::COUNTS_PER_US;
+
+    // Shared with the ISR
+    volatile uint32_t _pulseStart;         // Timer1Clock::now()
+    volatile uint32_t _periodSum;          // Timer1Clock counts
+    volatile uint32_t _widthSum;
+    volatile uint16_t _periods;
+    volatile uint16_t _widths;
+    volatile bool _inPulse;
+    volatile bool _running;               // A previous pulse start exists
+    volatile uint16_t _pulses;
+
+    // Main loop only
+    uint16_t _lastPulses;
+    unsigned long _lastPulseMs;
+    float _periodUs;
+    float _rpm;
+    float _injectorDuty;
+    bool _valid;
+};
+
+typedef EngineInputT<Config::PIN_ENGINE_INPUT> EngineInput;
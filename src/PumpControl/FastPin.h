@@ -0,0 +1,86 @@
+#pragma once
+#include <Arduino.h>
+
+// -----------------------------------------------------------------------------
+// FastPin - Digital I/O on a pin known at compile time
+// -----------------------------------------------------------------------------
+// digitalRead()/digitalWrite()/pinMode() look the pin up in the core's
+// PROGMEM tables and check for a timer on every call (~50 cycles or more).
+// With the pin as a template parameter the port, register and bit mask are
+// constants, and each call compiles to one SBI/CBI/SBIS on the I/O register.
+//
+// ATmega328P Nano numbering: D0-D7 = PORTD, D8-D13 = PORTB, A0-A5 = PORTC.
+// Unlike digitalWrite(), high()/low() do not disconnect a timer's compare
+// output - a pin driven by hardware PWM keeps following the timer.
+//
+// writePwm() writes the Timer 0 compare register of D6 (OC0A) or D5 (OC0B)
+// and connects the compare output. Phase-correct mode only (ENABLE_HIGH_FREQ_PWM):
+// there 0 and 255 are a steady LOW/HIGH, so the core's analogWrite() special
+// cases are not needed.
+//
+// Host build (tools/sim): the plain Arduino calls, so the simulator's pin
+// model sees every access.
+// -----------------------------------------------------------------------------
+
+template <uint8_t PIN>
+class FastPin {
+    static_assert(PIN < 20, "FastPin: Nano pins are D0-D13 and A0-A5 (14-19)");
+
+public:
+    static const uint8_t MASK = (uint8_t)(1 << ((PIN < 8) ? PIN : (PIN < 14) ? PIN - 8 : PIN - 14));
+
+    static void write(bool level) {
+        if (level) {
+            high();
+        } else {
+            low();
+        }
+    }
+
+#if defined(__AVR__)
+    static void high() { port() |= MASK; }
+    static void low() { port() &= (uint8_t)~MASK; }
+    static bool read() { return (pinReg() & MASK) != 0; }
+
+    static void output() { ddr() |= MASK; }
+    static void input() {
+        ddr() &= (uint8_t)~MASK;
+        port() &= (uint8_t)~MASK;
+    }
+    static void inputPullup() {
+        ddr() &= (uint8_t)~MASK;
+        port() |= MASK;
+    }
+
+    // Compare value first, then connect the output: the pin never shows the
+    // PORT level in between
+    static void writePwm(uint8_t value) {
+        static_assert(PIN == 5 || PIN == 6, "FastPin::writePwm: Timer 0 outputs are D5 and D6");
+        if (PIN == 6) {
+            OCR0A = value;
+            TCCR0A |= _BV(COM0A1);
+        } else {
+            OCR0B = value;
+            TCCR0A |= _BV(COM0B1);
+        }
+    }
+
+private:
+    static volatile uint8_t& port() { return (PIN < 8) ? PORTD : (PIN < 14) ? PORTB : PORTC; }
+    static volatile uint8_t& pinReg() { return (PIN < 8) ? PIND : (PIN < 14) ? PINB : PINC; }
+    static volatile uint8_t& ddr() { return (PIN < 8) ? DDRD : (PIN < 14) ? DDRB : DDRC; }
+#else
+    static void high() { digitalWrite(PIN, HIGH); }
+    static void low() { digitalWrite(PIN, LOW); }
+    static bool read() { return digitalRead(PIN) == HIGH; }
+
+    static void output() { pinMode(PIN, OUTPUT); }
+    static void input() { pinMode(PIN, INPUT); }
+    static void inputPullup() { pinMode(PIN, INPUT_PULLUP); }
+
+    static void writePwm(uint8_t value) {
+        static_assert(PIN == 5 || PIN == 6, "FastPin::writePwm: Timer 0 outputs are D5 and D6");
+        analogWrite(PIN, value);
+    }
+#endif
+};
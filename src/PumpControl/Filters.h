@@ -0,0 +1,302 @@
+#pragma once
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Filters - Sensor filters with coefficients computed at compile time
+// -----------------------------------------------------------------------------
+// Cutoff and sample rate are template arguments in millihertz (mHz() converts
+// the Hz values of Config.h). The coefficients follow the rate the filter is
+// fed at, so changing MAIN_LOOP_INTERVAL_MS keeps every bandwidth.
+//
+//   Ema<T, CUTOFF, RATE>       first-order low-pass, alpha = 1 - exp(-2*pi*fc/fs)
+//   MovingAverage<T, N>        mean of the last N samples, running sum (O(1))
+//   Median<T, N>               median of the last N samples (N odd): rejects
+//                              spikes up to (N-1)/2 samples long
+//   Biquad<T, CUTOFF, RATE>    second-order Butterworth low-pass (bilinear,
+//                              prewarped)
+//   Slope<T, N>                least-squares slope of the last N samples
+//                              against their timestamps (derivative)
+//
+// T is the sample type. Integer samples (ADC counts, sums of conversions) are
+// filtered in fixed point with 16 fraction bits: no float math per sample.
+// They must stay within +/-32767 (12-bit oversampled ADC, sums of up to 32
+// conversions). float samples run the same equations in float.
+//
+// get() returns the filtered value as float (fraction bits included), value()
+// rounded to T. reset(x) starts the filter at x (first reading in begin()).
+// -----------------------------------------------------------------------------
+
+namespace Filters {
+
+constexpr uint32_t mHz(float hz) {
+    return (uint32_t)(hz * 1000.0f + 0.5f);
+}
+
+namespace detail {
+
+constexpr float PI_F = 3.14159265f;
+
+// Taylor series (terms until n = 24): enough for |x| <= pi
+constexpr float expSeries(float x, int n, float term, float sum) {
+    return n > 24 ? sum : expSeries(x, n + 1, term * x / n, sum + term * x / n);
+}
+constexpr float exp(float x) { return expSeries(x, 1, 1.0f, 1.0f); }
+
+constexpr float sinSeries(float x2, int n, float term, float sum) {
+    return n > 21 ? sum : sinSeries(x2, n + 2, -term * x2 / ((n - 1) * n), sum - term * x2 / ((n - 1) * n));
+}
+constexpr float cosSeries(float x2, int n, float term, float sum) {
+    return n > 20 ? sum : cosSeries(x2, n + 2, -term * x2 / ((n - 1) * n), sum - term * x2 / ((n - 1) * n));
+}
+constexpr float tan(float x) { return sinSeries(x * x, 3, x, x) / cosSeries(x * x, 2, 1.0f, 1.0f); }
+
+constexpr float omega(uint32_t cutoffMHz, uint32_t rateMHz) {
+    return 2.0f * PI_F * (float)cutoffMHz / (float)rateMHz;
+}
+
+// Fixed-point coefficient, rounded
+constexpr int32_t q(float c, uint8_t bits) {
+    return (int32_t)(c * (float)(1UL << bits) + (c < 0.0f ? -0.5f : 0.5f));
+}
+
+// Arithmetic per sample type: fixed point for integers, float for float
+template <typename T>
+struct Num {
+    static_assert(sizeof(T) <= 2, "Filters: integer samples must fit 16 bits");
+    typedef int32_t State;  // Value << 16
+    typedef int32_t Sum;
+
+    static State toState(T x) { return (State)x * 65536L; }
+    static float toFloat(State s) { return (float)s * (1.0f / 65536.0f); }
+    static T round(State s) { return (T)((s + 32768L) >> 16); }
+
+    // |x - y| < 2^15 and alpha < 2^16: the product fits 31 bits
+    static void ema(State& s, T x, int32_t alphaQ16, float) {
+        s += ((int32_t)x - ((s + 32768L) >> 16)) * alphaQ16;
+    }
+
+    static T mean(Sum s, uint8_t n) { return (T)((s + (s < 0 ? -(n / 2) : n / 2)) / n); }
+
+    // Direct form I, Q28 coefficients (C::B0..A2), 64-bit products
+    template <class C>
+    static State biquad(T x0, T x1, T x2, State y1, State y2) {
+        int64_t acc = (int64_t)q(C::B0, 28) * toState(x0) + (int64_t)q(C::B1, 28) * toState(x1) +
+                      (int64_t)q(C::B2, 28) * toState(x2) - (int64_t)q(C::A1, 28) * y1 -
+                      (int64_t)q(C::A2, 28) * y2;
+        return (State)((acc + (1LL << 27)) >> 28);
+    }
+};
+
+template <>
+struct Num<float> {
+    typedef float State;
+    typedef float Sum;
+
+    static State toState(float x) { return x; }
+    static float toFloat(State s) { return s; }
+    static float round(State s) { return s; }
+
+    static void ema(State& s, float x, int32_t, float alpha) { s += alpha * (x - s); }
+
+    static float mean(Sum s, uint8_t n) { return s / n; }
+
+    template <class C>
+    static State biquad(float x0, float x1, float x2, State y1, State y2) {
+        return C::B0 * x0 + C::B1 * x1 + C::B2 * x2 - C::A1 * y1 - C::A2 * y2;
+    }
+};
+
+template <bool C, typename A, typename B> struct Select { typedef A type; };
+template <typename A, typename B> struct Select<false, A, B> { typedef B type; };
+
+}  // namespace detail
+
+// Picks A or B at compile time (Config switches between filter types)
+template <bool C, typename A, typename B>
+using Select = typename detail::Select<C, A, B>::type;
+
+// -----------------------------------------------------------------------------
+// First-order low-pass (exponential moving average). Step response reaches
+// 63% after 1 / (2*pi*fc) seconds.
+// -----------------------------------------------------------------------------
+template <typename T, uint32_t CUTOFF_MHZ, uint32_t RATE_MHZ>
+class Ema {
+    static_assert(CUTOFF_MHZ > 0 && CUTOFF_MHZ <= RATE_MHZ / 2, "Ema: cutoff must be 0 < fc <= fs/2");
+    typedef detail::Num<T> N;
+
+public:
+    static constexpr float ALPHA = 1.0f - detail::exp(-detail::omega(CUTOFF_MHZ, RATE_MHZ));
+
+    void reset(T x) { _state = N::toState(x); }
+    void update(T x) { N::ema(_state, x, detail::q(ALPHA, 16), ALPHA); }
+
+    float get() const { return N::toFloat(_state); }
+    T value() const { return N::round(_state); }
+
+private:
+    typename N::State _state = typename N::State();
+};
+
+// -----------------------------------------------------------------------------
+// Moving average over the last N samples: ring buffer plus running sum, one
+// add and one subtract per sample. First zero at fs / N, delay (N - 1) / 2.
+// -----------------------------------------------------------------------------
+template <typename T, uint8_t N>
+class MovingAverage {
+    static_assert(N >= 2, "MovingAverage: N must be at least 2");
+
+public:
+    void reset(T x) {
+        for (uint8_t i = 0; i < N; i++) _ring[i] = x;
+        _sum = (typename detail::Num<T>::Sum)x * N;
+        _head = 0;
+    }
+
+    void update(T x) {
+        _sum += (typename detail::Num<T>::Sum)x - _ring[_head];
+        _ring[_head] = x;
+        if (++_head == N) _head = 0;
+    }
+
+    float get() const { return (float)_sum * (1.0f / N); }
+    T value() const { return detail::Num<T>::mean(_sum, N); }
+
+private:
+    T _ring[N] = {};
+    typename detail::Num<T>::Sum _sum = 0;
+    uint8_t _head = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Median of the last N samples (odd N, insertion sort of a copy: keep N small).
+// A step passes after (N + 1) / 2 samples, shorter spikes are dropped.
+// -----------------------------------------------------------------------------
+template <typename T, uint8_t N>
+class Median {
+    static_assert(N % 2 == 1 && N <= 9, "Median: N must be odd and at most 9");
+
+public:
+    void reset(T x) {
+        for (uint8_t i = 0; i < N; i++) _ring[i] = x;
+        _head = 0;
+    }
+
+    void update(T x) {
+        _ring[_head] = x;
+        if (++_head == N) _head = 0;
+    }
+
+    T value() const {
+        T sorted[N];
+        for (uint8_t i = 0; i < N; i++) {
+            T v = _ring[i];
+            uint8_t j = i;
+            for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+            sorted[j] = v;
+        }
+        return sorted[N / 2];
+    }
+
+    float get() const { return (float)value(); }
+
+private:
+    T _ring[N] = {};
+    uint8_t _head = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Second-order Butterworth low-pass: -40 dB/decade above fc instead of -20,
+// for about the same delay as an Ema at the same cutoff. Integer samples use
+// Q28 coefficients and 64-bit products (a few hundred cycles on the AVR -
+// fine at the control rate, not in an ISR).
+// -----------------------------------------------------------------------------
+template <typename T, uint32_t CUTOFF_MHZ, uint32_t RATE_MHZ>
+class Biquad {
+    static_assert(CUTOFF_MHZ > 0 && CUTOFF_MHZ < RATE_MHZ / 2, "Biquad: cutoff must be 0 < fc < fs/2");
+    typedef detail::Num<T> N;
+
+    static constexpr float K = detail::tan(detail::omega(CUTOFF_MHZ, RATE_MHZ) / 2.0f);
+    static constexpr float SQRT2 = 1.41421356f;
+    static constexpr float NORM = 1.0f / (1.0f + SQRT2 * K + K * K);
+
+public:
+    static constexpr float B0 = K * K * NORM;
+    static constexpr float B1 = 2.0f * B0;
+    static constexpr float B2 = B0;
+    static constexpr float A1 = 2.0f * (K * K - 1.0f) * NORM;
+    static constexpr float A2 = (1.0f - SQRT2 * K + K * K) * NORM;
+
+    void reset(T x) {
+        _x1 = _x2 = x;
+        _y1 = _y2 = N::toState(x);
+    }
+
+    void update(T x) {
+        typename N::State y = N::template biquad<Biquad>(x, _x1, _x2, _y1, _y2);
+        _x2 = _x1;
+        _x1 = x;
+        _y2 = _y1;
+        _y1 = y;
+    }
+
+    float get() const { return N::toFloat(_y1); }
+    T value() const { return N::round(_y1); }
+
+private:
+    T _x1 = T(), _x2 = T();
+    typename N::State _y1 = typename N::State(), _y2 = typename N::State();
+};
+
+// -----------------------------------------------------------------------------
+// Least-squares slope of the last N samples: the derivative of a noisy signal
+// from a line fit instead of the difference of two samples (noise / ~N^1.5).
+// Each sample carries its timestamp (any unsigned long clock, wrap-safe), so
+// the spacing need not be even - loop passes are not. get() is in units of T
+// per clock count and is 0 until 3 samples are in. update() is a ring write;
+// the sums are taken in get() (float, N terms): feed fast, read at the tick.
+// -----------------------------------------------------------------------------
+template <typename T, uint8_t N>
+class Slope {
+    static_assert(N >= 3 && N <= 32, "Slope: N must be 3 to 32");
+
+public:
+    void reset() {
+        _count = 0;
+        _head = 0;
+    }
+
+    void update(T x, unsigned long t) {
+        _x[_head] = x;
+        _t[_head] = t;
+        if (++_head == N) _head = 0;
+        if (_count < N) _count++;
+    }
+
+    float get() const {
+        if (_count < 3) return 0.0f;
+        // Relative to the newest sample: small numbers, no float cancellation
+        uint8_t newest = (_head == 0) ? N - 1 : _head - 1;
+        unsigned long t0 = _t[newest];
+        float x0 = (float)_x[newest];
+        float st = 0.0f, sx = 0.0f, stt = 0.0f, stx = 0.0f;
+        for (uint8_t i = 0; i < _count; i++) {
+            float t = -(float)(unsigned long)(t0 - _t[i]);
+            float x = (float)_x[i] - x0;
+            st += t;
+            sx += x;
+            stt += t * t;
+            stx += t * x;
+        }
+        float n = (float)_count;
+        float den = n * stt - st * st;
+        return (den > 0.0f) ? (n * stx - st * sx) / den : 0.0f;
+    }
+
+private:
+    T _x[N] = {};
+    unsigned long _t[N] = {};
+    uint8_t _head = 0;
+    uint8_t _count = 0;
+};
+
+}  // namespace Filters
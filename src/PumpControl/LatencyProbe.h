@@ -0,0 +1,286 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "FastPin.h"
+#include "Timer1Clock.h"
+
+// -----------------------------------------------------------------------------
+// LatencyProbe - Input event to OCR0A/OCR0B write, per input path
+// -----------------------------------------------------------------------------
+// Measurement mode (ENABLE_LATENCY_PROBE). An event is timestamped where it
+// can first be seen, and closed by the first output write that answers it
+// (the sketch hooks onOutput() to PowerOutputs, called right after each
+// OCR0A/OCR0B write):
+//   SAFETY  D7 to its active level - pin-change ISR (PCINT2, shared with the
+//           MCP2515 INT). Answer: duty written as 0.
+//   PWM     D8 high time moved by LATENCY_PWM_STEP_PERCENT - pin-change ISR
+//           (PCINT0), at the falling edge of the first changed pulse.
+//   MAP     MAP sample moved LATENCY_MAP_STEP_BAR from the reference, over
+//           the rising part of the curve - main loop, at the sample (MAP
+//           fast reads: up to MAP_SLOPE_INTERVAL_MS after the physical step).
+// PWM and MAP answer: duty moved LATENCY_OUTPUT_STEP_COUNTS in the direction
+// of the input change. One event per path in flight; changes while it is
+// pending are part of it. No answer within LATENCY_TIMEOUT_MS: "no response"
+// (output already at the limit, another source in control, EMERGENCY).
+//
+// Per path: count, min, max and a half-octave histogram (bin k below
+// 2^((k + 16) / 2) us: 256 us, 362 us, 512 us ... last bin from 262 ms) for
+// the percentiles, reported as the bin upper edge (at most the max).
+// Optional scope pin: HIGH while an event is pending.
+//
+// Timestamps are Timer1Clock counts (0.5us, monotonic): micros() steps
+// backwards inside a Timer 0 period, and the D7 and MAP answers come within
+// tens to hundreds of us.
+//
+// Pending state is shared with the ISRs: an ISR only starts an event on a
+// path that is not pending (start time written before the flag), the main
+// loop only reads and clears a pending one - no interrupt lock needed.
+// -----------------------------------------------------------------------------
+class LatencyProbe {
+public:
+    enum Path : uint8_t {
+        PATH_SAFETY,   // D7 edge
+        PATH_PWM,      // D8 duty change
+        PATH_MAP,      // MAP step
+        PATH_COUNT
+    };
+
+    static const uint8_t BINS = 22;
+
+    LatencyProbe()
+        : _outputCounts(0)
+        , _safetyActive(false)
+        , _pwmRise(0)
+        , _pwmWidth(0)
+        , _pwmEdges(0)
+        , _mapRefBar(0.0f)
+        , _mapHaveRef(false) {
+        for (uint8_t p = 0; p < PATH_COUNT; p++) _pending[p] = false;
+        reset();
+    }
+
+    // Pin-change interrupts on D7 (safety enabled) and D8 (PWM mode enabled);
+    // the PCINT2 group is shared with the MCP2515 INT (CanInterface.h)
+    void begin() {
+        if (Config::ENABLE_LATENCY_SCOPE_PIN) {
+            FastPin<Config::PIN_LATENCY_SCOPE>::low();
+            FastPin<Config::PIN_LATENCY_SCOPE>::output();
+        }
+        if (Config::ENABLE_EXTERNAL_SAFETY) {
+            _safetyActive = safetyActive();
+            enablePinChange(Config::PIN_DIG_IN_1);
+        }
+        if (Config::ENABLE_EXTERNAL_PWM_MODE) {
+            enablePinChange(Config::PIN_PWM_INPUT);
+        }
+    }
+
+    // Statistics back to empty (LATENCY_RESET_COMMAND); events in flight stay
+    void reset() {
+        for (uint8_t p = 0; p < PATH_COUNT; p++) {
+            Stats& st = _stats[p];
+            memset(st.bins, 0, sizeof(st.bins));
+            st.count = 0;
+            st.noResponse = 0;
+            st.minUs = 0xFFFFFFFFUL;
+            st.maxUs = 0;
+        }
+    }
+
+    // PCINT2 ISR (D0-D7): only a D7 change to the active level counts
+    void onSafetyEdge() {
+        if (!Config::ENABLE_EXTERNAL_SAFETY) return;
+        bool active = safetyActive();
+        if (active == _safetyActive) return;  // Other pin of the group
+        _safetyActive = active;
+        if (active) start(PATH_SAFETY, -1);
+    }
+
+    // PCINT0 ISR (D8-D13): width of each D8 high pulse against the last
+    // accepted width
+    void onPwmEdge() {
+        if (!Config::ENABLE_EXTERNAL_PWM_MODE) return;
+        uint32_t now = Timer1Clock::now();
+        if (FastPin<Config::PIN_PWM_INPUT>::read()) {
+            _pwmRise = now;
+            if (_pwmEdges == 0) _pwmEdges = 1;
+            return;
+        }
+        if (_pwmEdges == 0) return;  // No rising edge seen yet
+        uint32_t width = now - _pwmRise;
+        if (_pwmEdges == 1) {
+            _pwmWidth = width;
+            _pwmEdges = 2;
+            return;
+        }
+        long change = (long)(width - _pwmWidth);
+        if (change < PWM_STEP_COUNTS && change > -PWM_STEP_COUNTS) return;
+        _pwmWidth = width;
+        start(PATH_PWM, change > 0 ? 1 : -1);
+    }
+
+    // MAP sample (bar gauge, unfiltered), main loop. armed = MAP is the
+    // setpoint source; otherwise the reference only follows the pressure.
+    // A step entirely below MAP_BAR_LOW_SETPOINT or above MAP_BAR_HIGH_SETPOINT
+    // (flat part of the curve) asks for no output change and is not an event.
+    void onMapSample(float bar, bool armed) {
+        if (!_mapHaveRef || !armed) {
+            _mapRefBar = bar;
+            _mapHaveRef = true;
+            return;
+        }
+        float change = bar - _mapRefBar;
+        if (change < Config::LATENCY_MAP_STEP_BAR && change > -Config::LATENCY_MAP_STEP_BAR) return;
+        float low = (change > 0.0f) ? _mapRefBar : bar;
+        float high = (change > 0.0f) ? bar : _mapRefBar;
+        _mapRefBar = bar;
+        if (high < Config::MAP_BAR_LOW_SETPOINT || low > Config::MAP_BAR_HIGH_SETPOINT) return;
+        start(PATH_MAP, change > 0.0f ? 1 : -1);
+    }
+
+    // After every OCR0A/OCR0B write (PowerOutputs). counts: duty 0..255,
+    // before the hardware inversion.
+    void onOutput(uint8_t counts) {
+        _outputCounts = counts;
+        uint32_t now = Timer1Clock::now();
+        for (uint8_t p = 0; p < PATH_COUNT; p++) {
+            if (!_pending[p]) continue;
+            bool answered;
+            if (p == PATH_SAFETY) {
+                answered = (counts == 0);
+            } else {
+                int16_t moved = (int16_t)counts - _refCounts[p];
+                answered = (_direction[p] > 0) ? moved >= Config::LATENCY_OUTPUT_STEP_COUNTS
+                                               : moved <= -(int16_t)Config::LATENCY_OUTPUT_STEP_COUNTS;
+            }
+            if (!answered) continue;
+            record(_stats[p], now - _start[p]);
+            _pending[p] = false;
+        }
+        updateScopePin();
+    }
+
+    // Main loop: events without an answer expire
+    void service() {
+        uint32_t now = Timer1Clock::now();
+        for (uint8_t p = 0; p < PATH_COUNT; p++) {
+            if (!_pending[p]) continue;
+            if ((uint32_t)(now - _start[p]) < TIMEOUT_COUNTS) continue;
+            _stats[p].noResponse++;
+            _pending[p] = false;
+        }
+        updateScopePin();
+    }
+
+    uint16_t getCount(uint8_t path) const { return _stats[path].count; }
+    uint16_t getNoResponse(uint8_t path) const { return _stats[path].noResponse; }
+    unsigned long getMinUs(uint8_t path) const { return _stats[path].count ? _stats[path].minUs : 0; }
+    unsigned long getMaxUs(uint8_t path) const { return _stats[path].maxUs; }
+
+    // Latency below which a fraction q (0..1) of the events lie: upper edge
+    // of the histogram bin, at most the max (0 without events)
+    float getPercentileUs(uint8_t path, float q) const {
+        const Stats& st = _stats[path];
+        if (st.count == 0) return 0.0f;
+        uint16_t need = (uint16_t)(q * st.count + 0.999f);
+        if (need < 1) need = 1;
+        uint16_t sum = 0;
+        for (uint8_t k = 0; k < BINS; k++) {
+            sum += st.bins[k];
+            if (sum >= need) {
+                float edge = binUpperUs(k);
+                return (k == BINS - 1 || edge > st.maxUs) ? (float)st.maxUs : edge;
+            }
+        }
+        return (float)st.maxUs;
+    }
+
+private:
+    struct Stats {
+        uint16_t bins[BINS];
+        uint16_t count;
+        uint16_t noResponse;
+        unsigned long minUs;
+        unsigned long maxUs;
+    };
+
+    // Timer1Clock counts
+    static constexpr long PWM_STEP_COUNTS = (long)(Config::LATENCY_PWM_STEP_PERCENT / 100.0f * 1.0e6f /
+                                                   Config::PWM_INPUT_FREQ_MAX * Timer1Clock::COUNTS_PER_US);
+    static constexpr uint32_t TIMEOUT_COUNTS =
+        Config::LATENCY_TIMEOUT_MS * 1000UL * Timer1Clock::COUNTS_PER_US;
+
+    static bool safetyActive() {
+        bool high = FastPin<Config::PIN_DIG_IN_1>::read();
+        return Config::EXTERNAL_SAFETY_ACTIVE_HIGH ? high : !high;
+    }
+
+    static void enablePinChange(uint8_t pin) {
+        *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+        *digitalPinToPCICR(pin) |= _BV(digitalPinToPCICRbit(pin));
+    }
+
+    // ISR or main loop; a path already in flight keeps its start
+    void start(uint8_t path, int8_t direction) {
+        if (_pending[path]) return;
+        _start[path] = Timer1Clock::now();
+        _refCounts[path] = _outputCounts;
+        _direction[path] = direction;
+        _pending[path] = true;
+        if (Config::ENABLE_LATENCY_SCOPE_PIN) FastPin<Config::PIN_LATENCY_SCOPE>::high();
+    }
+
+    void updateScopePin() {
+        if (!Config::ENABLE_LATENCY_SCOPE_PIN) return;
+        for (uint8_t p = 0; p < PATH_COUNT; p++) {
+            if (_pending[p]) return;
+        }
+        FastPin<Config::PIN_LATENCY_SCOPE>::low();
+    }
+
+    static void record(Stats& st, uint32_t counts) {
+        unsigned long us = Timer1Clock::toUs(counts);
+        if (st.count == 0xFFFF) return;  // Full: reset to measure again
+        st.count++;
+        st.bins[binOf(us)]++;
+        if (us < st.minUs) st.minUs = us;
+        if (us > st.maxUs) st.maxUs = us;
+    }
+
+    // Half-octave bin: floor(log2(u^2)) with u in 16 us steps (u^2 fits 32 bits)
+    static uint8_t binOf(unsigned long us) {
+        unsigned long u = us >> 4;
+        if (u < 16) return 0;
+        if (u > 0xFFFFUL) u = 0xFFFFUL;
+        unsigned long sq = u * u;
+        uint8_t log2 = 0;
+        while (sq >>= 1) log2++;
+        uint8_t bin = (uint8_t)(log2 - 7);
+        return bin < BINS ? bin : (uint8_t)(BINS - 1);
+    }
+
+    // 2^((k + 16) / 2) us
+    static float binUpperUs(uint8_t k) {
+        float edge = (float)(1UL << ((k + 16) / 2));
+        return (k & 1) ? edge * 1.41421356f : edge;
+    }
+
+    Stats _stats[PATH_COUNT];
+
+    // Shared with the ISRs
+    volatile bool _pending[PATH_COUNT];
+    volatile uint32_t _start[PATH_COUNT];         // Timer1Clock::now()
+    volatile uint8_t _refCounts[PATH_COUNT];      // Output at the event
+    volatile int8_t _direction[PATH_COUNT];       // Expected output change (+1 / -1)
+    volatile uint8_t _outputCounts;               // Last duty written (0..255)
+
+    // ISR only
+    bool _safetyActive;
+    uint32_t _pwmRise;                            // Timer1Clock::now()
+    uint32_t _pwmWidth;                           // Last accepted D8 high time (counts)
+    uint8_t _pwmEdges;                            // 0: none, 1: rise seen, 2: width known
+
+    // Main loop only
+    float _mapRefBar;
+    bool _mapHaveRef;
+};
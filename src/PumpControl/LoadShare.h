@@ -0,0 +1,258 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "CanInterface.h"
+#include "CanTelemetry.h"
+#include "CanTelemetryLayout.h"
+
+// -----------------------------------------------------------------------------
+// LoadShare - Cooperative flow split between boards on the same CAN bus
+// -----------------------------------------------------------------------------
+// Every board broadcasts PumpShare (CAN_LOAD_SHARE_BASE_ID + CAN_NODE_ID,
+// layout PUMP_SHARE_SIGNALS) once per control tick: its local demand (target
+// from the active source), capacity (protection + thermal limit), heatsink
+// temperature, current and availability. There is no leader: every board runs
+// the same allocation over the same table and applies its own entry.
+//
+// Allocation (weighted water-filling):
+//   demand = highest demand among available boards
+//   total  = demand * LOAD_SHARE_NODE_COUNT   (flow of all pumps at demand)
+//   share_i = clamp(lambda * w_i, min_i, capacity_i), with lambda such that
+//             sum(share_i) = total
+//   w_i     = 1.0 below LOAD_SHARE_TEMP_BIAS_START_C, falling linearly to
+//             LOAD_SHARE_MIN_WEIGHT at LOAD_SHARE_TEMP_BIAS_END_C
+//   min_i   = min(LOAD_SHARE_MIN_PERCENT, capacity_i) - no pump is stopped
+// An unavailable or silent board (no frame for LOAD_SHARE_PEER_TIMEOUT_MS)
+// gets nothing and the others absorb its flow up to their capacity.
+// Shares are output after the limit; toTarget() turns the board's own share
+// back into the pre-limit target PowerOutputs expects.
+//
+// Determinism: the board's own entry is encoded and decoded through the same
+// frame layout the peers see, and lambda is found by a fixed-iteration
+// bisection in node order - identical tables give bit-identical shares on
+// every board. Tables agree one tick after the inputs settle (each board's
+// frame is at most one tick old), so the split converges within two ticks.
+// Heatsink temperature is used for the weights because it moves slowly; the
+// fast junction estimate already lowers the capacity through derating.
+// -----------------------------------------------------------------------------
+
+class LoadShare {
+public:
+    static const uint8_t MAX_NODES = 4;
+
+    // Inputs for this board at the current tick
+    struct NodeState {
+        float demand;      // Target from the active source (0.0 - 1.0)
+        float capacity;    // Output limit (0.0 - 1.0)
+        float currentA;    // I1 + I2
+        float tempC;       // Heatsink
+        bool available;    // false: safety, EMERGENCY (share 0)
+    };
+
+    // nodeCount: pumps in the system (LOAD_SHARE_NODE_COUNT; the host
+    // simulator runs other sizes)
+    explicit LoadShare(uint8_t nodeId, uint8_t nodeCount = Config::LOAD_SHARE_NODE_COUNT)
+        : _nodeId(nodeId)
+        , _nodeCount(nodeCount)
+        , _counter(0)
+        , _totalDemand(0.0f)
+        , _availableNodes(0)
+        , _converged(false)
+    {
+        memset(_rx, 0, sizeof(_rx));
+        memset(_lastRxMs, 0, sizeof(_lastRxMs));
+        memset(_seen, 0, sizeof(_seen));
+        memset(_alloc, 0, sizeof(_alloc));
+        _frame.id = Config::CAN_LOAD_SHARE_BASE_ID + _nodeId;
+        _frame.extended = false;
+        _frame.dlc = 8;
+        memset(_frame.data, 0, sizeof(_frame.data));
+    }
+
+    // Feed one received frame. Returns true if it was a peer PumpShare frame.
+    bool onFrame(const CanFrame& frame, unsigned long nowMs) {
+        if (frame.extended || frame.dlc != 8) return false;
+        if (frame.id < Config::CAN_LOAD_SHARE_BASE_ID ||
+            frame.id >= (uint32_t)Config::CAN_LOAD_SHARE_BASE_ID + MAX_NODES) return false;
+        uint8_t node = (uint8_t)(frame.id - Config::CAN_LOAD_SHARE_BASE_ID);
+        if (node == _nodeId) return false;  // Another board with our id: ignore
+        memcpy(_rx[node], frame.data, 8);
+        _lastRxMs[node] = nowMs;
+        _seen[node] = true;
+        return true;
+    }
+
+    // Run the allocation for this tick. Returns this board's share
+    // (0.0 - 1.0); the frame to broadcast is then available from getFrame().
+    float update(unsigned long nowMs, const NodeState& self) {
+        // Own entry through the wire format (same quantisation as the peers)
+        setSignal(START_ShareDemand, 10, CanTelemetry::encode(self.demand * 100.0f, 0.1f, 0.0f, 10, false));
+        setSignal(START_ShareCapacity, 10,
+                  CanTelemetry::encode(self.available ? self.capacity * 100.0f : 0.0f, 0.1f, 0.0f, 10, false));
+        setSignal(START_ShareCurrent, 10, CanTelemetry::encode(self.currentA, 0.1f, 0.0f, 10, false));
+        setSignal(START_ShareTemp, 8, CanTelemetry::encode(self.tempC, 1.0f, -40.0f, 8, false));
+        setSignal(START_ShareAvailable, 1, self.available ? 1 : 0);
+        setSignal(START_ShareCounter, 4, _counter);
+        _counter = (uint8_t)((_counter + 1) & 0x0F);
+        memcpy(_rx[_nodeId], _frame.data, 8);
+        _lastRxMs[_nodeId] = nowMs;
+        _seen[_nodeId] = true;
+
+        allocate(nowMs);
+
+        float share = self.available ? _alloc[_nodeId] : 0.0f;
+        setSignal(START_ShareApplied, 10, CanTelemetry::encode(share * 100.0f, 0.1f, 0.0f, 10, false));
+        updateConvergence(nowMs);
+        return share;
+    }
+
+    // Share (output after this board's limit) back to a target before the
+    // limit: PowerOutputs scales the target by the same limit (capacity), so
+    // the derating is applied once, not twice
+    static float toTarget(float share, float capacity) {
+        if (capacity <= 0.0f) return 0.0f;
+        float target = share / capacity;
+        return (target > 1.0f) ? 1.0f : target;  // Capacity quantised on the wire
+    }
+
+    // PumpShare frame for this board (valid after update())
+    const CanFrame& getFrame() const { return _frame; }
+
+    // Node id of this board
+    uint8_t getNodeId() const { return _nodeId; }
+    // Total flow to split (demand * node count, 1.0 = one pump at 100%)
+    float getTotalDemand() const { return _totalDemand; }
+    // Boards available at the last update (this one included)
+    uint8_t getAvailableNodes() const { return _availableNodes; }
+    // Share computed for a node at the last update
+    float getAllocation(uint8_t node) const { return (node < MAX_NODES) ? _alloc[node] : 0.0f; }
+    // All fresh peers report the share this board computed for them
+    bool isConverged() const { return _converged; }
+
+    // Last received (or own) values per node
+    bool isFresh(uint8_t node, unsigned long nowMs) const {
+        return node < MAX_NODES && _seen[node] &&
+               (unsigned long)(nowMs - _lastRxMs[node]) < MILLIS_COMPENSATED(Config::LOAD_SHARE_PEER_TIMEOUT_MS);
+    }
+    bool isAvailable(uint8_t node, unsigned long nowMs) const {
+        return isFresh(node, nowMs) && decodeShareAvailable(_rx[node]) > 0.5f;
+    }
+    float getDemand(uint8_t node) const { return decodeShareDemand(_rx[node]) / 100.0f; }
+    float getCapacity(uint8_t node) const { return decodeShareCapacity(_rx[node]) / 100.0f; }
+    float getApplied(uint8_t node) const { return decodeShareApplied(_rx[node]) / 100.0f; }
+    float getCurrentA(uint8_t node) const { return decodeShareCurrent(_rx[node]); }
+    float getTempC(uint8_t node) const { return decodeShareTemp(_rx[node]); }
+
+    // Weight for the water-filling (1.0 cool .. LOAD_SHARE_MIN_WEIGHT hot)
+    static float weightFor(float tempC) {
+        const float start = Config::LOAD_SHARE_TEMP_BIAS_START_C;
+        const float end = Config::LOAD_SHARE_TEMP_BIAS_END_C;
+        if (tempC <= start) return 1.0f;
+        if (tempC >= end) return Config::LOAD_SHARE_MIN_WEIGHT;
+        return 1.0f - (tempC - start) / (end - start) * (1.0f - Config::LOAD_SHARE_MIN_WEIGHT);
+    }
+
+    // Generated decoders / bit positions (same tables as the DBC)
+#define PUMP_SHARE_DECODER(frame, name, start, len, sgn, factor, offset, unit, comment)       \
+    static_assert((start) + (len) <= 64 && (len) <= 16, "Share signal " #name " out of range"); \
+    static const uint8_t START_##name = start;                                              \
+    static float decode##name(const uint8_t* data) {                                        \
+        long raw = CanTelemetry::unpackSignal(data, start, len);                            \
+        if ((sgn) && (raw & (1L << ((len) - 1)))) raw -= (1L << (len));                     \
+        return (float)raw * (factor) + (offset);                                            \
+    }
+    PUMP_SHARE_SIGNALS(PUMP_SHARE_DECODER)
+#undef PUMP_SHARE_DECODER
+
+private:
+    // Bisection steps: lambda resolution = range / 2^20, far below one LSB
+    static const uint8_t BISECT_STEPS = 20;
+
+    uint8_t _nodeId;
+    uint8_t _nodeCount;
+    uint8_t _counter;
+    uint8_t _rx[MAX_NODES][8];
+    unsigned long _lastRxMs[MAX_NODES];
+    bool _seen[MAX_NODES];
+    float _alloc[MAX_NODES];
+    float _totalDemand;
+    uint8_t _availableNodes;
+    bool _converged;
+    CanFrame _frame;
+
+    void setSignal(uint8_t start, uint8_t len, uint16_t raw) {
+        CanTelemetry::packSignal(_frame.data, start, len, raw);
+    }
+
+    void allocate(unsigned long nowMs) {
+        float weight[MAX_NODES];
+        float lo[MAX_NODES];
+        float hi[MAX_NODES];
+        float demand = 0.0f;
+        float sumLo = 0.0f;
+        float sumHi = 0.0f;
+        float lambdaMax = 0.0f;
+        _availableNodes = 0;
+
+        for (uint8_t n = 0; n < MAX_NODES; n++) {
+            _alloc[n] = 0.0f;
+            hi[n] = 0.0f;
+            lo[n] = 0.0f;
+            weight[n] = 1.0f;
+            if (!isAvailable(n, nowMs)) continue;
+            _availableNodes++;
+            demand = max(demand, getDemand(n));
+            hi[n] = getCapacity(n);
+            lo[n] = min(Config::LOAD_SHARE_MIN_PERCENT, hi[n]);
+            weight[n] = weightFor(getTempC(n));
+            sumLo += lo[n];
+            sumHi += hi[n];
+            lambdaMax = max(lambdaMax, hi[n] / weight[n]);
+        }
+
+        _totalDemand = demand * _nodeCount;
+        if (_availableNodes == 0) return;
+
+        if (_totalDemand >= sumHi || _totalDemand <= sumLo) {
+            // Saturated: everyone at capacity, or everyone at the floor
+            bool full = (_totalDemand >= sumHi);
+            for (uint8_t n = 0; n < MAX_NODES; n++) {
+                _alloc[n] = full ? hi[n] : lo[n];
+            }
+            return;
+        }
+
+        float lambdaLo = 0.0f;
+        float lambdaHi = lambdaMax;
+        for (uint8_t i = 0; i < BISECT_STEPS; i++) {
+            float lambda = 0.5f * (lambdaLo + lambdaHi);
+            if (filled(lambda, weight, lo, hi) < _totalDemand) {
+                lambdaLo = lambda;
+            } else {
+                lambdaHi = lambda;
+            }
+        }
+        float lambda = 0.5f * (lambdaLo + lambdaHi);
+        for (uint8_t n = 0; n < MAX_NODES; n++) {
+            _alloc[n] = (hi[n] > 0.0f) ? constrain(lambda * weight[n], lo[n], hi[n]) : 0.0f;
+        }
+    }
+
+    static float filled(float lambda, const float* weight, const float* lo, const float* hi) {
+        float sum = 0.0f;
+        for (uint8_t n = 0; n < MAX_NODES; n++) {
+            if (hi[n] > 0.0f) sum += constrain(lambda * weight[n], lo[n], hi[n]);
+        }
+        return sum;
+    }
+
+    void updateConvergence(unsigned long nowMs) {
+        _converged = true;
+        for (uint8_t n = 0; n < MAX_NODES; n++) {
+            if (n == _nodeId || !isFresh(n, nowMs)) continue;
+            if (fabs(getApplied(n) - _alloc[n]) > Config::LOAD_SHARE_AGREEMENT) {
+                _converged = false;
+            }
+        }
+    }
+};
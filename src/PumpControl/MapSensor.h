@@ -1,6 +1,8 @@
 #pragma once
 #include <Arduino.h>
 #include "Config.h"
+#include "Adc.h"
+#include "Filters.h"
 
 // -----------------------------------------------------------------------------
 // MapSensor - Leitura e converso do sensor MPX5700AP para presso MAP (bar gauge)
@@ -9,52 +11,129 @@
 // Frmula datasheet: Vout = Vs * (0.00125 * P(kPa) + 0.04)
 // => P(kPa) = (Vout/Vs - 0.04) / 0.00125
 // => P(bar absolute) = P(kPa) / 100
-// => P(bar gauge) = P(bar absolute) - ATMOSPHERIC_PRESSURE_BAR
+// => P(bar gauge) = P(bar absolute) - presso baromtrica (medida no boot,
+//    ver SensorCalibration.h; default ATMOSPHERIC_PRESSURE_BAR)
 // 
 // Verificado: 833mV @ atmosfera = 1.013 bar abs = 0 bar gauge
 // Vs = 5V (alimentao Arduino)
+//
+// update() l o sensor e alimenta o filtro (uma vez por tick de controle);
+// getPressureBar() s devolve a sada do filtro.
+//
+// Derivada (ENABLE_MAP_RATE_FEEDFORWARD): sampleFast() entre ticks
+// (MAP_SLOPE_INTERVAL_MS) e a leitura do tick entram num ajuste de reta
+// (Filters::Slope) -> getPressureRateBarS(). update() converte a subida em
+// avano de presso (getLeadBar(), >= 0): retido no pico e decaindo com
+// MAP_RATE_DECAY_S enquanto o filtro alcana a presso real.
 // -----------------------------------------------------------------------------
 class MapSensor {
 public:
-    explicit MapSensor(uint8_t pin, float filterAlpha = Config::MAP_FILTER_ALPHA)
-        : _pin(pin), _alpha(filterAlpha) {}
+    explicit MapSensor(uint8_t pin)
+        : _pin(pin), _atmosphericBar(Config::ATMOSPHERIC_PRESSURE_BAR), _leadBar(0.0f), _lastCounts(0) {}
 
     void begin() {
         pinMode(_pin, INPUT);
-        _filteredVoltage = sampleVoltage();
+        _lastCounts = sampleCounts();
+        _filter.reset(_lastCounts);
+        _slope.reset();
+        _leadBar = 0.0f;
     }
 
-    // Atualiza leitura filtrada e retorna presso em bar
-    float readPressureBar() {
-        float v = sampleVoltage();
-        _filteredVoltage = _alpha * v + (1.0f - _alpha) * _filteredVoltage;
-        return voltageToBar(_filteredVoltage);
+    // Nova amostra no filtro - uma vez por tick (SENSOR_SAMPLE_HZ)
+    void update() {
+        uint16_t counts = sampleCounts();
+        _lastCounts = counts;
+        _filter.update(counts);
+        if (Config::ENABLE_MAP_RATE_FEEDFORWARD) {
+            _slope.update(counts, millis());
+            updateLead();
+        }
     }
 
-    float rawVoltage() const { return _filteredVoltage; }
+    // Leitura extra s para a derivada (loop, MAP_SLOPE_INTERVAL_MS)
+    void sampleFast() {
+        unsigned long now = millis();
+        _lastCounts = sampleCounts();
+        _slope.update(_lastCounts, now);
+    }
+
+    // Presso filtrada em bar (gauge), sem nova leitura
+    float getPressureBar() const { return voltageToBar(rawVoltage()); }
+
+    // Presso da ltima amostra (update() ou sampleFast()), sem filtro
+    float getSampleBar() const { return voltageToBar(_lastCounts * COUNTS_TO_V); }
+
+    // dP/dt em bar/s (reta sobre as ltimas MAP_SLOPE_WINDOW leituras)
+    float getPressureRateBarS() const {
+        // Por segundo real: razo exata do Timer 0, no os 8x do MILLIS_COMPENSATED
+        return _slope.get() * COUNTS_TO_V * BAR_PER_V / Config::REAL_S_PER_MILLIS;
+    }
+
+    // Avano de presso para a curva (bar, 0 sem subida)
+    float getLeadBar() const { return _leadBar; }
+
+    // Tenso filtrada na sada do sensor
+    float rawVoltage() const { return _filter.get() * COUNTS_TO_V; }
+
+    // Presso absoluta de uma amostra, sem filtro (calibrao baromtrica)
+    float readAbsoluteBarRaw() const { return voltageToAbsoluteBar(sampleCounts() * COUNTS_TO_V); }
+
+    // Presso baromtrica usada na converso absoluta -> gauge
+    void setAtmosphericBar(float bar) { _atmosphericBar = bar; }
+    float getAtmosphericBar() const { return _atmosphericBar; }
 
 private:
+    // Filtro em ponto fixo sobre as contagens (MAP_FILTER_CUTOFF_HZ)
+    typedef Filters::Ema<uint16_t, Filters::mHz(Config::MAP_FILTER_CUTOFF_HZ),
+                         Filters::mHz(Config::SENSOR_SAMPLE_HZ)> EmaFilter;
+    typedef Filters::Biquad<uint16_t, Filters::mHz(Config::MAP_FILTER_CUTOFF_HZ),
+                            Filters::mHz(Config::SENSOR_SAMPLE_HZ)> BiquadFilter;
+
     uint8_t _pin;
-    float _alpha;
-    float _filteredVoltage = 0.0f;
+    Filters::Select<Config::MAP_FILTER_BIQUAD, BiquadFilter, EmaFilter> _filter;
+    Filters::Slope<uint16_t, Config::MAP_SLOPE_WINDOW> _slope;
+    float _atmosphericBar;
+    float _leadBar;       // Avano atual (bar)
+    uint16_t _lastCounts; // ltima amostra (contagens)
 
     static constexpr float VS = 5.0f; // tenso de referncia sensor
+    static constexpr float COUNTS_TO_V = VS / (1023.0f * (1 << Config::MAP_OVERSAMPLE_BITS));
+    static constexpr float BAR_PER_V = 1.0f / (VS * 0.00125f * 100.0f); // derivada da frmula
+    // Decaimento do avano por tick: exp(-1 / (fs * MAP_RATE_DECAY_S))
+    static constexpr float LEAD_DECAY =
+        Filters::detail::exp(-1.0f / (Config::SENSOR_SAMPLE_HZ * Config::MAP_RATE_DECAY_S));
 
-    float sampleVoltage() const {
-        int adc = analogRead(_pin); // 0..1023
-        return (adc / 1023.0f) * VS;
+    // Subida acima da zona morta -> avano; fica com o maior entre o novo e
+    // o anterior decado
+    void updateLead() {
+        float rise = getPressureRateBarS() - Config::MAP_RATE_DEADBAND_BAR_S;
+        float lead = (rise > 0.0f) ? rise * Config::MAP_RATE_LOOKAHEAD_S : 0.0f;
+        _leadBar *= LEAD_DECAY;
+        if (lead > _leadBar) _leadBar = lead;
+        if (_leadBar > Config::MAP_RATE_LEAD_MAX_BAR) _leadBar = Config::MAP_RATE_LEAD_MAX_BAR;
     }
 
-    float voltageToBar(float v) const {
+    // Uma leitura = 4^n converses com clock rpido do ADC, 10 + n bits
+    // (MAP_ADC_PRESCALER, MAP_OVERSAMPLE_BITS)
+    uint16_t sampleCounts() const {
+        return Adc::readOversampled(_pin, Config::MAP_OVERSAMPLE_BITS,
+                                    Config::MAP_ADC_PRESCALER); // 0..1023 << n
+    }
+
+    static float voltageToAbsoluteBar(float v) {
         float ratio = v / VS; // Vout/Vs
         float p_kPa = (ratio - 0.04f) / 0.00125f; // inverso da frmula do datasheet
-        float p_bar_absolute = p_kPa / 100.0f;    // kPa -> bar (presso absoluta)
+        return p_kPa / 100.0f;                    // kPa -> bar (presso absoluta)
+    }
+
+    float voltageToBar(float v) const {
+        float p_bar_absolute = voltageToAbsoluteBar(v);
         
         // Converter de presso absoluta para gauge (relativa  atmosfera)
         // Gauge = Absoluto - Atmosfrico
         // Valores negativos = vcuo (abaixo da presso atmosfrica)
         // Valores positivos = boost (acima da presso atmosfrica)
-        float p_bar_gauge = p_bar_absolute - Config::ATMOSPHERIC_PRESSURE_BAR;
+        float p_bar_gauge = p_bar_absolute - _atmosphericBar;
         
         return p_bar_gauge; // Retorna presso gauge (pode ser negativa)
     }
@@ -0,0 +1,41 @@
+#include "MemoryMonitor.h"
+
+#if defined(__AVR__)
+extern uint8_t _end;          // End of .data/.bss/.noinit (linker)
+extern uint8_t __heap_start;  // Same address, heap base
+extern char* __brkval;        // malloc() break, 0 before the first allocation
+
+// Paint from _end to RAMEND before the C runtime. Runs in .init1: r1 is not
+// cleared yet and there is no stack frame, so this is plain assembly.
+void paintStack() __attribute__((naked, used, section(".init1")));
+void paintStack() {
+    __asm__ __volatile__(
+        "    ldi r30, lo8(_end)\n"
+        "    ldi r31, hi8(_end)\n"
+        "    ldi r24, %0\n"
+        "    ldi r25, hi8(%1)\n"
+        "    rjmp 2f\n"
+        "1:  st Z+, r24\n"
+        "2:  cpi r30, lo8(%1)\n"
+        "    cpc r31, r25\n"
+        "    brlo 1b\n"
+        "    breq 1b\n"
+        :: "M"(MemoryMonitor::CANARY), "i"(RAMEND));
+}
+
+uint16_t MemoryMonitor::staticEnd() {
+    return (uint16_t)&_end;
+}
+
+uint16_t MemoryMonitor::heapEnd() {
+    return (__brkval != 0) ? (uint16_t)__brkval : (uint16_t)&__heap_start;
+}
+
+uint16_t MemoryMonitor::stackPointer() {
+    return SP;
+}
+#else
+uint16_t MemoryMonitor::staticEnd() { return RAMSTART; }
+uint16_t MemoryMonitor::heapEnd() { return RAMSTART; }
+uint16_t MemoryMonitor::stackPointer() { return RAMSTART; }
+#endif
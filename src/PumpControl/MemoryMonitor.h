@@ -0,0 +1,86 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// -----------------------------------------------------------------------------
+// MemoryMonitor - Free SRAM and stack high-water mark (stack painting)
+// -----------------------------------------------------------------------------
+// ATmega328P SRAM (2048 B):  .data | .bss | .noinit | heap ->   ...   <- stack
+//
+// MemoryMonitor.cpp fills everything from the end of the static data to
+// RAMEND with CANARY in .init1, before the C runtime runs. Any byte the heap
+// or the stack writes afterwards is no longer canary. service() checks
+// MEMORY_SCAN_BYTES per call, upward from the heap end: the first byte that
+// is not canary is the deepest point the stack (ISR frames included) has
+// reached since reset. Stack locals that are never written leave canary
+// gaps above that point, which does not matter - only the lowest write does.
+// A write that happens to store CANARY at the very bottom is missed; the
+// error is a few bytes.
+//
+// The scan never goes above the mark found so far, so a full pass costs
+// (margin) bytes and the loop pays MEMORY_SCAN_BYTES compares per pass.
+//
+// Static usage per object (.data/.bss/.noinit): tools/mem/memreport on the ELF.
+// -----------------------------------------------------------------------------
+
+class MemoryMonitor {
+public:
+    static const uint8_t CANARY = 0xC5;
+
+    MemoryMonitor()
+        : _scan(0)
+        , _mark(0)
+    {}
+
+    void begin() {
+        if (!Config::ENABLE_MEMORY_MONITOR || stackPointer() <= heapEnd()) return;  // Host build: no SRAM map
+        _mark = ramEnd() + 1;  // Nothing known yet: first pass finds the mark
+        _scan = heapEnd();
+    }
+
+    // Scan the next MEMORY_SCAN_BYTES - every loop() pass
+    void service() {
+        if (_mark == 0) return;
+        uint16_t heapTop = heapEnd();
+        if (_scan < heapTop) _scan = heapTop;  // Heap grew over the scan position
+        for (uint8_t i = 0; i < Config::MEMORY_SCAN_BYTES && _scan < _mark; i++, _scan++) {
+            if (*(volatile uint8_t*)(uintptr_t)_scan != CANARY) {
+                _mark = _scan;
+                break;
+            }
+        }
+        if (_scan >= _mark) _scan = heapTop;  // Pass complete, start over
+    }
+
+    // Between the heap end and the stack pointer right now
+    uint16_t getFreeBytes() const {
+        uint16_t sp = stackPointer();
+        uint16_t heapTop = heapEnd();
+        return (sp > heapTop) ? (uint16_t)(sp - heapTop) : 0;
+    }
+    // Never touched since reset: heap end to the deepest stack write
+    uint16_t getStackMarginBytes() const {
+        uint16_t heapTop = heapEnd();
+        return (_mark > heapTop) ? (uint16_t)(_mark - heapTop) : 0;
+    }
+    // Deepest stack use since reset
+    uint16_t getStackPeakBytes() const {
+        return (_mark != 0) ? (uint16_t)(ramEnd() + 1 - _mark) : 0;
+    }
+    // .data + .bss + .noinit
+    uint16_t getStaticBytes() const { return (uint16_t)(staticEnd() - RAMSTART); }
+    // malloc() use (none in the firmware: a non-zero value is a leak)
+    uint16_t getHeapBytes() const { return (uint16_t)(heapEnd() - staticEnd()); }
+    // Margin below MEMORY_LOW_MARGIN_BYTES: a new feature may collide
+    bool isLow() const { return _mark != 0 && getStackMarginBytes() < Config::MEMORY_LOW_MARGIN_BYTES; }
+
+    // Linker and CPU addresses (MemoryMonitor.cpp; all RAMSTART on the host build)
+    static uint16_t staticEnd();
+    static uint16_t heapEnd();
+    static uint16_t stackPointer();
+    static uint16_t ramEnd() { return RAMEND; }
+
+private:
+    uint16_t _scan;  // Next address to check
+    uint16_t _mark;  // Lowest non-canary address found (0 = not started)
+};
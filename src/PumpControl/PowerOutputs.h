@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include "Config.h"
+#include "FastPin.h"
 
 // -----------------------------------------------------------------------------
 // PowerOutputs - Manages two main PWM outputs for MOSFET driver
@@ -10,15 +11,38 @@
 // Timer 0 has NO pin overlap with SPI, so CAN bus (MCP2515) doesn't interfere.
 // Previously D3 (Timer 2 OC2B) was used, but SPI shares D11 (OC2A) with Timer 2,
 // causing periodic PWM glitches on D3 when CAN was active.
+//
+// The pins are template parameters (FastPin.h): pin setup is SBI/CBI and the
+// duty goes straight into OCR0A/OCR0B. Use the PowerOutputs typedef below.
+//
+// setOutputHook() registers a function called right after every pin write
+// with the duty in counts (the sketch connects the latency probe to it).
 // -----------------------------------------------------------------------------
-class PowerOutputs {
+template <uint8_t PIN1, uint8_t PIN2>
+class PowerOutputsT {
 public:
-    PowerOutputs(uint8_t pin1, uint8_t pin2)
-        : _pin1(pin1)
-        , _pin2(pin2)
+    // How the last requested output is tracked against supply variations
+    enum class OutputMode : uint8_t {
+        DIRECT = 0,          // Raw duty via setDuty() (forced OFF, EMERGENCY, safety)
+        PERCENT_OF_SUPPLY,   // Duty = percent (output voltage follows supply)
+        REGULATED_VOLTAGE    // Duty = Vtarget / Vsupply, recomputed on every supply update
+    };
+
+    // Called after each OCR0A/OCR0B write with the duty in counts (0-255,
+    // before the hardware inversion)
+    typedef void (*OutputHook)(uint8_t dutyCounts);
+
+    PowerOutputsT()
+        : _mode(OutputMode::DIRECT)
         , _currentDuty(0.0f)
+        , _requestedDuty(0.0f)
+        , _dutyCeiling(1.0f)
         , _voltageLimit(1.0f)
         , _supplyVoltage(12.0f)  // Initialize to nominal 12V, will be updated dynamically
+        , _targetVoltage(0.0f)
+        , _rideThrough(false)
+        , _dipStartMs(0)
+        , _outputHook(nullptr)
     {}
 
     void begin() {
@@ -27,35 +51,24 @@ public:
         // We want motor OFF during initialization, so set pins HIGH first
         
         // Step 1: Set pins to safe state while still INPUT (high impedance)
-        // With inverted circuit: digitalWrite HIGH = BC817 ON = BC807 OFF = MOSFET OFF
+        // With inverted circuit: HIGH = BC817 ON = BC807 OFF = MOSFET OFF
         if (Config::PWM_INVERTED_BY_HARDWARE) {
-            digitalWrite(_pin1, HIGH);  // Motor OFF (inverted circuit)
-            digitalWrite(_pin2, HIGH);  // Motor OFF (inverted circuit)
+            FastPin<PIN1>::high();  // Motor OFF (inverted circuit)
+            FastPin<PIN2>::high();  // Motor OFF (inverted circuit)
         } else {
-            digitalWrite(_pin1, LOW);   // Motor OFF (normal circuit)
-            digitalWrite(_pin2, LOW);   // Motor OFF (normal circuit)
+            FastPin<PIN1>::low();   // Motor OFF (normal circuit)
+            FastPin<PIN2>::low();   // Motor OFF (normal circuit)
         }
         
         // Step 2: Small delay to ensure pins stabilize before OUTPUT mode
         delayMicroseconds(100);
         
         // Step 3: Configure as OUTPUT (pins already in safe state)
-        pinMode(_pin1, OUTPUT);
-        pinMode(_pin2, OUTPUT);
+        FastPin<PIN1>::output();
+        FastPin<PIN2>::output();
 
         // Step 4: Configure high-frequency PWM (3.9 kHz)
-        // Both D5 (OC0B) and D6 (OC0A) are on Timer 0 — no SPI conflict.
-        // Timer 0 modification affects millis() and delay() - they run 8x faster!
-        // All timing code compensated using MILLIS_COMPENSATED() macro.
-        if (Config::ENABLE_HIGH_FREQ_PWM) {
-            // Configure Timer 0 (pins D5, D6) for 3.9 kHz Phase-Correct PWM
-            // Phase-Correct PWM: 16MHz / (2 * 256 * 8) = 3906.25 Hz ≈ 3.9 kHz
-            // Set WGM02=0, WGM01=0, WGM00=1 for Phase-Correct PWM, TOP=0xFF
-            TCCR0A = (TCCR0A & 0xFC) | 0x01;  // WGM01=0, WGM00=1
-            TCCR0B = (TCCR0B & 0xF7);         // WGM02=0
-            // Set prescaler to 8 (CS02=0, CS01=1, CS00=0)
-            TCCR0B = (TCCR0B & 0xF8) | 0x02;  // Prescaler 8 (8x faster timing!)
-        }
+        configureTimer();
 
         // Step 5: Set initial duty cycle to 0% (motor OFF)
         // This will write PWM=255 (HIGH) which keeps motor OFF with inverted circuit
@@ -66,6 +79,22 @@ public:
         delayMicroseconds(100000);  // 100ms grace period
     }
 
+    // Warm restart (see WarmStart.h): the pump is still spinning, so the pins
+    // go straight from reset (INPUT, MOSFET off) to the saved duty - no OFF
+    // state and no grace period. Normal control takes over at the next tick.
+    void beginWarm(float duty, float voltageLimit) {
+        configureTimer();
+        setVoltageLimit(voltageLimit);
+        setDuty(duty);  // Level/compare value first, then OUTPUT (as in begin())
+        FastPin<PIN1>::output();
+        FastPin<PIN2>::output();
+    }
+
+    // Output write hook (nullptr = none); takes effect at the next write
+    void setOutputHook(OutputHook hook) {
+        _outputHook = hook;
+    }
+
     // Set output as percentage of supply voltage (0.0 to 1.0)
     // Example: 0.70 = 70% of measured supply voltage
     // Respects current voltage limit from protection system
@@ -76,7 +105,21 @@ public:
         // Apply voltage limit from protection system
         float duty = percent * _voltageLimit;
         
-        setDuty(duty);
+        _mode = OutputMode::PERCENT_OF_SUPPLY;
+        applyDuty(duty);
+    }
+
+    // Regulated-voltage mode: hold the pump at a fixed voltage regardless of supply
+    // Duty is recomputed as Vtarget/Vsupply every time setSupplyVoltage() is called,
+    // so the caller should feed supply readings as fast as it can (see loop()).
+    // Respects current voltage limit from protection system
+    void setTargetVoltage(float voltage) {
+        if (voltage < 0) voltage = 0;
+        if (voltage > Config::VOLTAGE_MAXIMUM_VALID) voltage = Config::VOLTAGE_MAXIMUM_VALID;
+
+        _targetVoltage = voltage;
+        _mode = OutputMode::REGULATED_VOLTAGE;
+        updateRegulatedDuty();
     }
 
     // Legacy method: Set output voltage in Volts (for backward compatibility)
@@ -90,10 +133,26 @@ public:
     }
 
     // Update measured supply voltage (call this every cycle with fresh reading)
+    // In REGULATED_VOLTAGE mode this is also the feed-forward step: the duty is
+    // corrected immediately for the new supply reading.
     void setSupplyVoltage(float voltage) {
-        if (voltage < 7.0f) voltage = 7.0f;    // Clamp to reasonable minimum
-        if (voltage > 16.0f) voltage = 16.0f;  // Clamp to reasonable maximum
+        // Cranking dip: supply below the valid range -> ride-through policy
+        if (voltage < Config::VOLTAGE_MINIMUM_VALID) {
+            if (!_rideThrough) {
+                _rideThrough = true;
+                _dipStartMs = millis();
+            }
+        } else {
+            _rideThrough = false;
+        }
+
+        if (voltage < Config::VOLTAGE_MINIMUM_VALID) voltage = Config::VOLTAGE_MINIMUM_VALID;  // Clamp to reasonable minimum
+        if (voltage > Config::VOLTAGE_MAXIMUM_VALID) voltage = Config::VOLTAGE_MAXIMUM_VALID;  // Clamp to reasonable maximum
         _supplyVoltage = voltage;
+
+        if (_mode == OutputMode::REGULATED_VOLTAGE) {
+            updateRegulatedDuty();
+        }
     }
 
     // Get current supply voltage
@@ -104,12 +163,10 @@ public:
     // Set duty cycle directly (0.0 to 1.0)
     // Note: Hardware circuit (BC817+BC807 driver) inverts PWM signal
     // Software compensates for this inversion when PWM_INVERTED_BY_HARDWARE=true
+    // Leaves REGULATED_VOLTAGE mode, so a forced OFF is never undone by feed-forward
     void setDuty(float duty) {
-        if (duty < 0) duty = 0;
-        if (duty > 1) duty = 1;
-
-        _currentDuty = duty;
-        writeDutyToPins(duty);
+        _mode = OutputMode::DIRECT;
+        applyDuty(duty);
     }
 
     // Set voltage limit factor (0.0 to 1.0)
@@ -125,6 +182,24 @@ public:
         return _voltageLimit;
     }
 
+    // Set duty ceiling (0.0 to 1.0) - used by the soft-start ramp
+    // Applied on top of every mode and re-applied immediately.
+    void setDutyCeiling(float ceiling) {
+        if (ceiling < 0) ceiling = 0;
+        if (ceiling > 1) ceiling = 1;
+        _dutyCeiling = ceiling;
+        applyDuty(_requestedDuty);
+    }
+
+    float getDutyCeiling() const {
+        return _dutyCeiling;
+    }
+
+    // Get duty requested by the active mode, before the ceiling (0.0 to 1.0)
+    float getRequestedDuty() const {
+        return _requestedDuty;
+    }
+
     // Get current duty cycle (0.0 to 1.0)
     float getCurrentDuty() const {
         return _currentDuty;
@@ -135,10 +210,80 @@ public:
         return _currentDuty * _voltageLimit * _supplyVoltage;
     }
 
+    // Get output tracking mode (DIRECT, PERCENT_OF_SUPPLY, REGULATED_VOLTAGE)
+    OutputMode getMode() const {
+        return _mode;
+    }
+
+    bool isRegulatedMode() const {
+        return _mode == OutputMode::REGULATED_VOLTAGE;
+    }
+
+    // Get regulated-mode target voltage (Volts)
+    float getTargetVoltage() const {
+        return _targetVoltage;
+    }
+
+    // True while supply is below VOLTAGE_MINIMUM_VALID (cranking dip)
+    bool isInRideThrough() const {
+        return _rideThrough;
+    }
+
 private:
+    // High-frequency PWM (3.9 kHz) on Timer 0
+    void configureTimer() {
+        // Both D5 (OC0B) and D6 (OC0A) are on Timer 0 — no SPI conflict.
+        // Timer 0 modification affects millis() and delay() - they run 8x faster!
+        // All timing code compensated using MILLIS_COMPENSATED() macro.
+        if (Config::ENABLE_HIGH_FREQ_PWM) {
+            // Configure Timer 0 (pins D5, D6) for 3.9 kHz Phase-Correct PWM
+            // Phase-Correct PWM: 16MHz / (2 * 256 * 8) = 3906.25 Hz ≈ 3.9 kHz
+            // Set WGM02=0, WGM01=0, WGM00=1 for Phase-Correct PWM, TOP=0xFF
+            TCCR0A = (TCCR0A & 0xFC) | 0x01;  // WGM01=0, WGM00=1
+            TCCR0B = (TCCR0B & 0xF7);         // WGM02=0
+            // Set prescaler to 8 (CS02=0, CS01=1, CS00=0)
+            TCCR0B = (TCCR0B & 0xF8) | 0x02;  // Prescaler 8 (8x faster timing!)
+        }
+    }
+
+    void applyDuty(float duty) {
+        if (duty < 0) duty = 0;
+        if (duty > 1) duty = 1;
+
+        _requestedDuty = duty;
+        if (duty > _dutyCeiling) duty = _dutyCeiling;
+
+        _currentDuty = duty;
+        writeDutyToPins(duty);
+    }
+
+    // Duty = Vtarget / Vsupply, with ride-through during cranking dips:
+    //   - Dip shorter than CV_RIDE_THROUGH_MS: saturate at CV_RIDE_THROUGH_DUTY
+    //     (the supply is real but low - give the pump everything available)
+    //   - Dip longer than that: reading is no longer trusted, assume
+    //     CV_FALLBACK_SUPPLY_VOLTAGE so output cannot run away on a bad sensor
+    void updateRegulatedDuty() {
+        float duty;
+        if (_rideThrough) {
+            // COMPENSATED: millis() runs 8x faster due to Timer 0 prescaler
+            unsigned long dipMs = (unsigned long)(millis() - _dipStartMs);
+            if (dipMs < MILLIS_COMPENSATED(Config::CV_RIDE_THROUGH_MS)) {
+                duty = Config::CV_RIDE_THROUGH_DUTY;
+            } else {
+                duty = _targetVoltage / Config::CV_FALLBACK_SUPPLY_VOLTAGE;
+            }
+        } else {
+            duty = _targetVoltage / _supplyVoltage;
+        }
+        if (duty > 1.0f) duty = 1.0f;  // Supply below target: saturate
+
+        applyDuty(duty * _voltageLimit);
+    }
+
     void writeDutyToPins(float duty) {
         // Convert duty cycle to PWM value (0-255)
         int pwmValue = static_cast<int>(duty * 255.0f + 0.5f);
+        uint8_t dutyCounts = (uint8_t)pwmValue;
 
         // Hardware inversion compensation:
         // If driver circuit inverts signal (NPN+PNP topology), invert PWM in software
@@ -148,13 +293,30 @@ private:
         }
 
         // Both outputs on Timer 0 - hardware PWM, no SPI conflict
-        analogWrite(_pin1, pwmValue);  // D6 (OC0A)
-        analogWrite(_pin2, pwmValue);  // D5 (OC0B)
+        if (Config::ENABLE_HIGH_FREQ_PWM) {
+            // Phase-correct: 0 and 255 are steady levels, write OCR0A/OCR0B directly
+            FastPin<PIN1>::writePwm((uint8_t)pwmValue);  // D6 (OC0A)
+            FastPin<PIN2>::writePwm((uint8_t)pwmValue);  // D5 (OC0B)
+        } else {
+            // Core fast PWM: analogWrite() turns 0/255 into a plain pin level
+            // (OCR0x = 0 would still give a one-count pulse)
+            analogWrite(PIN1, pwmValue);
+            analogWrite(PIN2, pwmValue);
+        }
+
+        if (_outputHook) _outputHook(dutyCounts);
     }
 
-    uint8_t _pin1;
-    uint8_t _pin2;
+    OutputMode _mode;        // How _currentDuty was derived
     float _currentDuty;      // Current requested duty cycle (before limiting)
+    float _requestedDuty;    // Duty asked for by the active mode (before ceiling)
+    float _dutyCeiling;      // Soft-start ceiling (1.0 = no ceiling)
     float _voltageLimit;     // Voltage limit factor from protection system
     float _supplyVoltage;    // Measured supply voltage (updated dynamically)
+    float _targetVoltage;    // Regulated-mode target (Volts)
+    bool _rideThrough;       // Supply currently below VOLTAGE_MINIMUM_VALID
+    unsigned long _dipStartMs;  // millis() when the current dip started
+    OutputHook _outputHook;  // nullptr = none
 };
+
+typedef PowerOutputsT<Config::PIN_PWM_OUT_1, Config::PIN_PWM_OUT_2> PowerOutputs;
@@ -16,6 +16,14 @@
 //   FAULT:     >40A   - Reduce to minimum safe voltage (50%), log fault
 //   EMERGENCY: >45A   - Immediate shutdown if enabled (short circuit)
 //
+// I2t (inverse-time) mode - ENABLE_I2T_PROTECTION:
+//   FAULT is no longer a fixed threshold. Each channel integrates
+//   (I^2 - I_nominal^2) * dt against I2T_CAPACITY_A2S; short inrush above
+//   40A is tolerated while a sustained overload below 40A still trips.
+//   Below I2T_DERATE_START_HEADROOM the voltage limit is reduced in proportion
+//   to the remaining headroom, so the output eases off before FAULT is reached.
+//   EMERGENCY remains an instantaneous trip.
+//
 // Features:
 //   - Hysteresis: 2.5A band to prevent oscillation/chattering
 //   - Dual channel monitoring (triggers on EITHER channel exceeding limit)
@@ -41,26 +49,47 @@ public:
         , _voltageLimit(1.0f)
         , _lastLevelChangeMs(0)
         , _faultCount(0)
-    {}
+        , _lastUpdateMs(0)
+    {
+        _i2t[0] = 0.0f;
+        _i2t[1] = 0.0f;
+    }
 
     void begin() {
         _currentLevel = ProtectionLevel::NORMAL;
         _voltageLimit = 1.0f;  // Start at 100% (no limiting)
         _lastLevelChangeMs = millis();
+        _lastUpdateMs = _lastLevelChangeMs;
         _faultCount = 0;
+        _i2t[0] = 0.0f;
+        _i2t[1] = 0.0f;
         
         Serial.println(F("[PROTECTION] System initialized"));
     }
 
+    // Warm restart (see WarmStart.h): continue from the state saved before the
+    // reset instead of NORMAL with cold I2t accumulators
+    void restore(ProtectionLevel level, float voltageLimit, float headroom1, float headroom2) {
+        _currentLevel = level;
+        _voltageLimit = constrain(voltageLimit, 0.0f, 1.0f);
+        _i2t[0] = constrain(1.0f - headroom1, 0.0f, 1.0f) * Config::I2T_CAPACITY_A2S;
+        _i2t[1] = constrain(1.0f - headroom2, 0.0f, 1.0f) * Config::I2T_CAPACITY_A2S;
+    }
+
     // Update protection state based on current readings
     // Returns the voltage limit factor (0.0 to 1.0)
     float update() {
         // Read both current sensors
-        float current1 = _sensor1.readCurrentA();
-        float current2 = _sensor2.readCurrentA();
+        float current1 = _sensor1.getCurrentA();
+        float current2 = _sensor2.getCurrentA();
         
         // Use the maximum of the two channels for protection decision
         float maxCurrent = max(current1, current2);
+
+        // Integrate thermal stress per channel (I2t model)
+        if (Config::ENABLE_I2T_PROTECTION) {
+            integrateI2t(current1, current2);
+        }
         
         // Determine new protection level based on thresholds and hysteresis
         ProtectionLevel newLevel = calculateProtectionLevel(maxCurrent);
@@ -74,6 +103,11 @@ public:
         
         // Calculate target voltage limit based on current protection level
         float targetLimit = getVoltageLimitForLevel(_currentLevel);
+
+        // Proportional derating while still NORMAL but running out of headroom
+        if (Config::ENABLE_I2T_PROTECTION && _currentLevel == ProtectionLevel::NORMAL) {
+            targetLimit = getDerateLimit(getThermalHeadroom());
+        }
         
         // Apply rate limiting to voltage changes (gradual transition)
         applyRateLimiting(targetLimit);
@@ -91,6 +125,17 @@ public:
         return _voltageLimit;
     }
 
+    // Remaining I2t headroom for one channel (1.0 = cold, 0.0 = trip point)
+    float getThermalHeadroom(uint8_t channel) const {
+        if (channel > 1) return 1.0f;
+        return 1.0f - (_i2t[channel] / Config::I2T_CAPACITY_A2S);
+    }
+
+    // Remaining I2t headroom of the most stressed channel
+    float getThermalHeadroom() const {
+        return min(getThermalHeadroom(0), getThermalHeadroom(1));
+    }
+
     // Get total fault count (persistent counter)
     // Using uint32_t to prevent overflow (max ~4.3 billion events)
     uint32_t getFaultCount() const {
@@ -124,6 +169,36 @@ private:
     float _voltageLimit;          // Current voltage limit factor (0.0-1.0)
     unsigned long _lastLevelChangeMs;
     uint32_t _faultCount;         // Cumulative fault events (uint32_t prevents overflow)
+    unsigned long _lastUpdateMs;  // For I2t integration step
+    float _i2t[2];                // Accumulated (I^2 - Inom^2)*dt per channel (A^2*s)
+
+    // Integrate (I^2 - I_nominal^2) * dt per channel, clamped to [0, capacity]
+    // Below nominal current the term is negative, which models cooling.
+    void integrateI2t(float current1, float current2) {
+        unsigned long now = millis();
+        // Real seconds: the exact Timer 0 ratio, not MILLIS_COMPENSATED's 8x
+        float dt = (float)(unsigned long)(now - _lastUpdateMs) * Config::REAL_S_PER_MILLIS;
+        _lastUpdateMs = now;
+        if (dt > Config::I2T_MAX_STEP_S) dt = Config::I2T_MAX_STEP_S;  // Stalled loop guard
+
+        const float nominalSq = Config::I2T_NOMINAL_CURRENT_A * Config::I2T_NOMINAL_CURRENT_A;
+        const float currents[2] = { current1, current2 };
+        for (uint8_t ch = 0; ch < 2; ch++) {
+            _i2t[ch] += (currents[ch] * currents[ch] - nominalSq) * dt;
+            if (_i2t[ch] < 0.0f) _i2t[ch] = 0.0f;
+            if (_i2t[ch] > Config::I2T_CAPACITY_A2S) _i2t[ch] = Config::I2T_CAPACITY_A2S;
+        }
+    }
+
+    // Voltage limit for a given I2t headroom (NORMAL level only)
+    // Linear from 100% at I2T_DERATE_START_HEADROOM down to PROTECTION_PERCENT_FAULT at 0
+    float getDerateLimit(float headroom) const {
+        if (headroom >= Config::I2T_DERATE_START_HEADROOM) return Config::PROTECTION_PERCENT_NORMAL;
+        if (headroom < 0.0f) headroom = 0.0f;
+        float ratio = headroom / Config::I2T_DERATE_START_HEADROOM;  // 0..1
+        return Config::PROTECTION_PERCENT_FAULT +
+               ratio * (Config::PROTECTION_PERCENT_NORMAL - Config::PROTECTION_PERCENT_FAULT);
+    }
 
     // Calculate protection level with hysteresis
     ProtectionLevel calculateProtectionLevel(float current) {
@@ -134,6 +209,10 @@ private:
             return ProtectionLevel::EMERGENCY;
         }
 
+        if (Config::ENABLE_I2T_PROTECTION) {
+            return calculateI2tLevel(current);
+        }
+
         // Hysteresis logic: different thresholds for rising vs falling
         // This prevents rapid oscillation between levels
         switch (_currentLevel) {
@@ -161,6 +240,36 @@ private:
         }
     }
 
+    // I2t level logic: trip at capacity, recover once the integral has decayed
+    // below I2T_RESET_HEADROOM (hysteresis in the thermal domain)
+    ProtectionLevel calculateI2tLevel(float current) {
+        float headroom = getThermalHeadroom();
+
+        switch (_currentLevel) {
+            case ProtectionLevel::NORMAL:
+                if (headroom <= 0.0f) {
+                    return ProtectionLevel::FAULT;
+                }
+                return ProtectionLevel::NORMAL;
+
+            case ProtectionLevel::FAULT:
+                if (headroom >= Config::I2T_RESET_HEADROOM) {
+                    return ProtectionLevel::NORMAL;
+                }
+                return ProtectionLevel::FAULT;
+
+            case ProtectionLevel::EMERGENCY:
+                // Same recovery rule as fixed-threshold mode, then I2t takes over
+                if (current < Config::CURRENT_THRESHOLD_FAULT - Config::CURRENT_HYSTERESIS) {
+                    return (headroom > 0.0f) ? ProtectionLevel::NORMAL : ProtectionLevel::FAULT;
+                }
+                return ProtectionLevel::EMERGENCY;
+
+            default:
+                return ProtectionLevel::NORMAL;
+        }
+    }
+
     // Get voltage limit factor for a given protection level
     float getVoltageLimitForLevel(ProtectionLevel level) const {
         switch (level) {
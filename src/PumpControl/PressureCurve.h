@@ -0,0 +1,38 @@
+#pragma once
+#include "Config.h"
+
+// -----------------------------------------------------------------------------
+// PressureCurve - Manifold pressure to target output percentage
+// -----------------------------------------------------------------------------
+// Linear interpolation between the low and high setpoints:
+//   bar <= MAP_BAR_LOW_SETPOINT  -> OUTPUT_PERCENT_MIN (70% of supply voltage)
+//   bar >= MAP_BAR_HIGH_SETPOINT -> OUTPUT_PERCENT_MAX (100%)
+//
+// demandFeedforward() is the fuel-demand term added to it in MAP mode
+// (ENABLE_DEMAND_FEEDFORWARD, demand from EngineInput.h).
+//
+// Used by the sketch for the MAP and CAN pressure sources; kept out of the
+// .ino so host tools and tools/bench call the same code.
+// -----------------------------------------------------------------------------
+
+// Converts pressure (bar) to target output percentage (0.0 to 1.0)
+inline float pressureToTargetPercent(float bar) {
+    const float pLow  = Config::MAP_BAR_LOW_SETPOINT;
+    const float pHigh = Config::MAP_BAR_HIGH_SETPOINT;
+    const float percentLow  = Config::OUTPUT_PERCENT_MIN;  // 0.70 (70%)
+    const float percentHigh = Config::OUTPUT_PERCENT_MAX;  // 1.00 (100%)
+
+    if (bar <= pLow)  return percentLow;
+    if (bar >= pHigh) return percentHigh;
+
+    float spanP = pHigh - pLow;
+    float ratio = (bar - pLow) / spanP; // 0..1
+    return percentLow + ratio * (percentHigh - percentLow);
+}
+
+// Output fraction added for a fuel demand of 0..1 (engine input)
+inline float demandFeedforward(float demand) {
+    if (demand <= 0.0f) return 0.0f;
+    if (demand > 1.0f) demand = 1.0f;
+    return Config::DEMAND_FEEDFORWARD_GAIN * demand * (Config::OUTPUT_PERCENT_MAX - Config::OUTPUT_PERCENT_MIN);
+}
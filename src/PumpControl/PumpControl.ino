@@ -3,11 +3,20 @@
    
    Features:
    - MAP sensor-based pressure control (MPX5700ASX on A4)
+   - Boost-rate (dP/dt) feedforward: output leads a rising MAP
    - Dual ACS758LCB-050B current sensors (A2, A3)
+   - Boot calibration of current zeros and barometric MAP baseline (EEPROM)
    - Current fault protection (never fully shuts down under normal fault)
-   - Two PWM outputs (D3, D5) for SSR control
-   - NeoPixel RGB LED indicating current level and protection state
+   - Two PWM outputs (D6, D5, Timer 0) for SSR control; D3 is the engine INT1 input
+   - WS2812 RGB LED indicating current level and protection state
    - Serial logging of all parameters
+   - CAN telemetry (MCP2515) and ECU command source (duty or pressure)
+   - Optional load sharing between boards on the same CAN bus
+   - Optional engine RPM / injector input (D3, INT1) as fuel-demand feedforward
+   - Season-long usage histograms and Ah/Wh counters (EEPROM, binary dump)
+   - Optional latency probe: D7/D8/MAP input event to OCR0A/OCR0B write
+   - Watchdog with warm restart (output restored at once after a WDT/BOR reset)
+   - SRAM monitor: free memory and stack high-water mark (stack painting)
 
    LED Status Indication:
    - NORMAL (0-40A):   Green solid (gradient green->red as current rises)
@@ -26,6 +35,7 @@
 ---------------------------------------------------------------------------- */
 #include <Arduino.h>
 #include "Config.h"
+#include "FastPin.h"
 #include "MapSensor.h"
 #include "PowerOutputs.h"
 #include "CurrentSensor.h"
@@ -33,49 +43,228 @@
 #include "VoltageSensor.h"
 #include "VoltageProtection.h"
 #include "TempSensor.h"
+#include "ThermalModel.h"
 #include "CanInterface.h"
+#include "CanTelemetry.h"
+#include "CanCommand.h"
+#include "LoadShare.h"
 #include "StatusLed.h"
 #include "PwmInput.h"
+#include "EngineInput.h"
+#include "SoftStart.h"
+#include "PumpSpeedEstimator.h"
+#include "WarmStart.h"
+#include "SensorCalibration.h"
+#include "UsageLog.h"
+#include "LatencyProbe.h"
+#include "MemoryMonitor.h"
+#include "CpuIdle.h"
+#include "Timer1Clock.h"
+#include "PressureCurve.h"
 
 // ============================================================================
 // Global instances
 // ============================================================================
 
 MapSensor      g_map(Config::PIN_MAP_SENSOR);
-PowerOutputs   g_power(Config::PIN_PWM_OUT_1, Config::PIN_PWM_OUT_2);
+PowerOutputs   g_power;  // D6/D5 (Config::PIN_PWM_OUT_1/2)
 CurrentSensor  g_curr1(Config::PIN_CURRENT_1);
 CurrentSensor  g_curr2(Config::PIN_CURRENT_2);
 PowerProtection g_protection(g_curr1, g_curr2);
 VoltageSensor  g_voltage(Config::PIN_VCC_SENSE);
 VoltageProtection g_voltageProtection(g_voltage);
-TempSensor     g_temp(Config::PIN_NTC_TEMP);  // Heatsink NTC 10K (monitoring only)
-CanInterface   g_can;  // stub for future CAN bus integration
-StatusLed      g_statusLed(Config::PIN_STATUS_LED, Config::STATUS_LED_COUNT);
-PwmInput       g_pwmInput(Config::PIN_PWM_INPUT);  // External PWM input source
+TempSensor     g_temp(Config::PIN_NTC_TEMP);  // Heatsink NTC 10K
+ThermalModel   g_thermal(g_temp);  // Junction estimate + derating (uses heatsink NTC)
+CanInterface   g_can;  // MCP2515 on PIN_CAN_CS/PIN_CAN_INT, interrupt-driven
+CanTelemetry   g_telemetry(g_can);  // Packed state broadcast (CanTelemetryLayout.h)
+CanCommand     g_canCommand;  // ECU setpoint frames (PUMP_COMMAND_SIGNALS)
+LoadShare      g_loadShare(Config::CAN_NODE_ID);  // Flow split between boards (PUMP_SHARE_SIGNALS)
+StatusLed      g_statusLed;  // WS2812 on PIN_STATUS_LED, frames from service()
+PwmInput       g_pwmInput;  // External PWM input source (PIN_PWM_INPUT)
+EngineInput    g_engine;  // Tach/injector pulses on PIN_ENGINE_INPUT (INT1)
+SoftStart      g_softStart(g_curr1, g_curr2);  // Inrush-managed ramp after forced OFF
+PumpSpeedEstimator g_pumpSpeed(Config::PIN_CURRENT_1, Config::PIN_CURRENT_2);  // RPM from ripple
+SpeedController g_speedControl;  // Optional closed-loop RPM trim (MAP mode)
+WarmStart      g_warmStart;  // Watchdog + .noinit output snapshot
+SensorCalibration g_calibration(g_curr1, g_curr2, g_map);  // ACS758 zeros + baro (EEPROM fallback)
+UsageLog       g_usage;  // Operating histograms + Ah/Wh, EEPROM ring after the calibration
+MemoryMonitor  g_memory;  // Free SRAM + stack high-water mark
+CpuIdle        g_cpuIdle;  // Sleep between loop passes + idle accounting
+LatencyProbe   g_latency;  // Input-to-output latency (ENABLE_LATENCY_PROBE)
 
 unsigned long g_lastUpdateMs = 0;
 unsigned long g_lastStatusMs = 0;
+unsigned long g_lastFeedForwardMs = 0;
+unsigned long g_lastMapSlopeMs = 0;
+unsigned long g_lastSoftStartMs = 0;
+unsigned long g_lastTelemetryMs = 0;
+
+// Setpoint source chosen at the last control tick (read by the CAN command fast path)
+enum class ControlSource : uint8_t { MAP, EXTERNAL_PWM, CAN };
+ControlSource g_source = ControlSource::MAP;
+bool g_outputForcedOff = false;  // External safety or EMERGENCY at the last tick
 
 // ============================================================================
-// Pressure to output percentage conversion
+// Interrupts
 // ============================================================================
 
-// Converts pressure (bar) to target output percentage (0.0 to 1.0)
-// Linear interpolation between low and high setpoints
-// Low pressure (?0.2bar): 70% of supply voltage
-// High pressure (?0.4bar): 100% of supply voltage
-static float pressureToTargetPercent(float bar) {
-    const float pLow  = Config::MAP_BAR_LOW_SETPOINT;
-    const float pHigh = Config::MAP_BAR_HIGH_SETPOINT;
-    const float percentLow  = Config::OUTPUT_PERCENT_MIN;  // 0.70 (70%)
-    const float percentHigh = Config::OUTPUT_PERCENT_MAX;  // 1.00 (100%)
-
-    if (bar <= pLow)  return percentLow;
-    if (bar >= pHigh) return percentHigh;
-
-    float spanP = pHigh - pLow;
-    float ratio = (bar - pLow) / spanP; // 0..1
-    return percentLow + ratio * (percentHigh - percentLow);
+// MCP2515 INT (PIN_CAN_INT, PCINT2 group D0-D7): drain RX buffers / feed TX.
+// Latency probe: D7 safety edge timestamp first (same group)
+ISR(PCINT2_vect) {
+    if (Config::ENABLE_LATENCY_PROBE) g_latency.onSafetyEdge();
+    g_can.onInterrupt();
+}
+
+// External PWM input (PIN_PWM_INPUT = D8, PCINT0): latency probe only
+ISR(PCINT0_vect) {
+    if (Config::ENABLE_LATENCY_PROBE) g_latency.onPwmEdge();
+}
+
+// Engine tach/injector (PIN_ENGINE_INPUT = D3, INT1, any edge): timestamp only
+ISR(INT1_vect) {
+    g_engine.onEdge();
+}
+
+// Timer 1 overflow (every 32.8 ms): high word of Timer1Clock::now()
+ISR(TIMER1_OVF_vect) {
+    Timer1Clock::onOverflow();
+}
+
+// ============================================================================
+// Setpoint helpers
+// ============================================================================
+
+// Target from the CAN command: duty as-is, pressure through the MAP curve
+static float canCommandTargetPercent() {
+    if (g_canCommand.getMode() == CanCommand::MODE_PRESSURE) {
+        return pressureToTargetPercent(g_canCommand.getPressureBar());
+    }
+    return g_canCommand.getDuty();
+}
+
+// Output write for a non-EMERGENCY tick and for the CAN command fast path.
+// Pressure-curve targets are regulated in constant-voltage mode; direct duty
+// commands (external PWM, CAN duty) are not.
+static void applyOutput(float targetPercent, bool fromPressureCurve) {
+    if (Config::ENABLE_CONSTANT_VOLTAGE_MODE && fromPressureCurve) {
+        g_power.setTargetVoltage(targetPercent * Config::CV_REFERENCE_VOLTAGE);
+    } else {
+        g_power.setOutputPercent(targetPercent);
+    }
+}
+
+// External safety input (D7): true = output must be OFF
+static bool readExternalSafety() {
+    if (!Config::ENABLE_EXTERNAL_SAFETY) return false;
+    bool high = FastPin<Config::PIN_DIG_IN_1>::read();
+    return Config::EXTERNAL_SAFETY_ACTIVE_HIGH ? high : !high;  // Active level = shutdown
+}
+
+// External safety: output off at once (no rate limiting), ramp on release
+static void safetyShutdown() {
+    g_outputForcedOff = true;
+    g_power.setDuty(0.0f);
+    g_softStart.restart();
+    g_power.setDutyCeiling(g_softStart.getCeiling());
+}
+
+// Loop health for the watchdog: control tick not stalled and Timer 0 still
+// at prescaler 8 (a corrupted TCCR0B would change the PWM frequency and
+// every MILLIS_COMPENSATED interval)
+static bool loopHealthy(unsigned long now) {
+    if ((unsigned long)(now - g_lastUpdateMs) >= MILLIS_COMPENSATED(Config::WATCHDOG_TICK_STALL_MS)) {
+        return false;
+    }
+    if (Config::ENABLE_HIGH_FREQ_PWM && (TCCR0B & 0x07) != 0x02) {
+        return false;
+    }
+    return true;
+}
+
+// PowerOutputs output hook: each OCR0A/OCR0B write ends a latency measurement
+static void latencyOnOutput(uint8_t dutyCounts) {
+    g_latency.onOutput(dutyCounts);
+}
+
+// Sensor, bus and input drivers (cold boot and warm restart)
+static void beginSubsystems() {
+    Timer1Clock::begin();  // Short-interval time base (CpuIdle, LatencyProbe)
+    g_map.begin();
+    g_curr1.begin();
+    g_curr2.begin();
+    g_calibration.begin();  // Stored zeros/baro (or defaults) until measured
+    g_protection.begin();
+    g_voltage.begin();
+    g_voltageProtection.begin();
+    g_temp.begin();
+    g_thermal.begin();
+    g_can.begin(); // MCP2515: bit timing, acceptance filters, INT
+    g_pwmInput.begin(); // External PWM input - configures PIN_DIG_IN_1 as INPUT (no pullup)
+    if (Config::ENABLE_LATENCY_PROBE) {
+        g_latency.begin();  // D7/D8 pin-change interrupts
+        g_power.setOutputHook(latencyOnOutput);
+    }
+    if (Config::ENABLE_ENGINE_INPUT) g_engine.begin();  // D3 / INT1
+    g_pumpSpeed.begin();
+    g_statusLed.begin();
+    if (Config::ENABLE_USAGE_LOG) g_usage.begin();  // Newest EEPROM slot
+    g_memory.begin();
+    g_cpuIdle.begin();
+}
+
+// Warm restart: saved output back on the pins first, then the subsystems.
+// No Serial wait, no grace period, no hold-off; the soft-start ramp is only
+// armed if the pump was stopped.
+static void warmRestart() {
+    const WarmSnapshot& saved = g_warmStart.getSnapshot();
+    g_power.beginWarm(saved.duty, saved.outputLimit);
+    Serial.begin(115200);  // Before beginSubsystems(): drivers print from begin()
+
+    beginSubsystems();
+    // Output limit (protection + thermal) is at most the protection limit:
+    // resuming from it is conservative and recovers at the normal rate
+    g_protection.restore((PowerProtection::ProtectionLevel)saved.protectionLevel,
+                         saved.outputLimit, saved.headroom[0], saved.headroom[1]);
+    g_source = (ControlSource)saved.source;
+    if (saved.duty <= 0.0f) {
+        g_softStart.begin();
+        g_power.setDutyCeiling(g_softStart.getCeiling());
+    }
+
+    Serial.print(F("*** WARM RESTART *** reset: "));
+    g_warmStart.printResetCause();
+    Serial.print(F("| duty restored: "));
+    Serial.print(saved.duty * 100.0f, 1);
+    Serial.print(F("% | in a row: "));
+    Serial.println(g_warmStart.getConsecutive());
+
+    g_warmStart.enableWatchdog();
+}
+
+// Output state for a warm restart (once per control tick)
+static void saveWarmSnapshot(unsigned long now) {
+    g_warmStart.save(g_power.getCurrentDuty(), g_power.getVoltageLimit(),
+                     g_protection.getThermalHeadroom(0), g_protection.getThermalHeadroom(1),
+                     (uint8_t)g_source, (uint8_t)g_protection.getLevel(), now);
+}
+
+// Usage histograms and counters (once per control tick, safety branch included)
+static void recordUsage(unsigned long now, float pressureBar, bool forcedOff) {
+    if (!Config::ENABLE_USAGE_LOG) return;
+    PowerProtection::ProtectionLevel level = g_protection.getLevel();
+    UsageLog::Tick tick = {
+        g_power.getCurrentDuty(),
+        pressureBar,
+        { g_curr1.getCurrentA(), g_curr2.getCurrentA() },
+        g_voltage.getFilteredVoltage(),
+        g_voltage.isValid(),  // A sensor fault is not a supply drop
+        g_temp.getFilteredTemperatureC(),
+        level == PowerProtection::ProtectionLevel::FAULT,
+        level == PowerProtection::ProtectionLevel::EMERGENCY,
+        Config::ENABLE_THERMAL_DERATING && g_thermal.isDerating(),
+        forcedOff
+    };
+    g_usage.update(now, tick);
 }
 
 // ============================================================================
@@ -83,6 +272,15 @@ static float pressureToTargetPercent(float bar) {
 // ============================================================================
 
 void setup() {
+    // Warm restart check before anything slow (D7 pull-up first for the
+    // external safety reading)
+    FastPin<Config::PIN_DIG_IN_1>::inputPullup();    // D7 for external safety (active low - HIGH = OK)
+    g_warmStart.begin(readExternalSafety(), (uint8_t)PowerProtection::ProtectionLevel::EMERGENCY);
+    if (g_warmStart.isWarm()) {
+        warmRestart();
+        return;
+    }
+
     Serial.begin(115200);
     // COMPENSATED: millis() runs 64x faster due to Timer 0 prescaler change for PWM
     // 2000ms actual time = 2000 * 64 ticks with modified Timer 0
@@ -100,27 +298,18 @@ void setup() {
     Serial.println(F("Initializing power outputs (motor OFF)..."));
     g_power.begin();  // This sets motor to OFF state with safety delays
     
-    Serial.println(F("Initializing sensors..."));
-    g_map.begin();
-    g_curr1.begin();
-    g_curr2.begin();
-    g_protection.begin();
-    g_voltage.begin();
-    g_voltageProtection.begin();
-    g_temp.begin();
-    g_can.begin(); // stub
-    g_pwmInput.begin(); // External PWM input - configures PIN_DIG_IN_1 as INPUT (no pullup)
+    Serial.println(F("Initializing sensors and status LED..."));
+    beginSubsystems();
+    g_softStart.begin(); // First rise after the hold-off is ramped
     
     // Enable PWM debug for first 10 seconds (for troubleshooting)
     // Comment out after confirming PWM detection works
     g_pwmInput.setDebug(true);
-    
-    Serial.println(F("Initializing status LED..."));
-    g_statusLed.begin();
 
-    // Configure digital inputs
     // NOTE: PIN_DIG_IN_2 (D8) is used for external PWM input and configured by g_pwmInput.begin()
-    pinMode(Config::PIN_DIG_IN_1, INPUT_PULLUP);     // D7 for external safety (active low - HIGH = OK)
+    Serial.print(F("Reset cause: "));
+    g_warmStart.printResetCause();
+    Serial.println();
 
     // Print configuration summary
     Serial.println(F("Configuration:"));
@@ -138,7 +327,13 @@ void setup() {
     
     Serial.println();
     Serial.println(F("Protection thresholds (A):"));
-    Serial.print(F("  FAULT:     ")); Serial.println(Config::CURRENT_THRESHOLD_FAULT, 1);
+    if (Config::ENABLE_I2T_PROTECTION) {
+        Serial.print(F("  FAULT:     I2t ")); Serial.print(Config::I2T_NOMINAL_CURRENT_A, 1);
+        Serial.print(F("A nominal, ")); Serial.print(Config::I2T_CAPACITY_A2S, 0);
+        Serial.println(F(" A2s"));
+    } else {
+        Serial.print(F("  FAULT:     ")); Serial.println(Config::CURRENT_THRESHOLD_FAULT, 1);
+    }
     Serial.print(F("  EMERGENCY: ")); Serial.println(Config::CURRENT_THRESHOLD_EMERGENCY, 1);
     Serial.println();
     
@@ -146,118 +341,272 @@ void setup() {
     Serial.println(F("========================================"));
     Serial.println();
     
-    // Additional safety: Keep motor OFF for 2 seconds after full initialization
-    // Allows all sensors to stabilize before motor operation begins
-    Serial.println(F("Safety delay: Motor OFF for 2 seconds..."));
+    // Additional safety: Keep motor OFF until the sensors have settled. The
+    // window is used to measure the current zeros and the barometric MAP
+    // baseline; it ends when the readings converge (CAL_MAX_MS at most).
+    Serial.println(F("Safety delay: Motor OFF, calibrating sensors..."));
     g_power.setDuty(0.0f);  // Ensure motor is OFF
-    // Using delayMicroseconds because it's NOT affected by Timer 0 prescaler change
-    // delay() would require dividing by 64, not multiplying
-    delayMicroseconds(2000000UL);  // 2 seconds = 2,000,000 microseconds
+    g_calibration.run();
+    g_calibration.printSummary();
 
     Serial.println(F("Starting normal operation"));
     Serial.println();
+    g_warmStart.enableWatchdog();
 }
 
 // ============================================================================
 // Main loop
 // ============================================================================
 
-void loop() {
-    unsigned long now = millis();
-    
-    // Main control loop - runs at MAIN_LOOP_INTERVAL_MS (20Hz default)
-    // Safe millis() rollover handling: subtraction is always safe for unsigned types
-    // COMPENSATED: millis() runs 64x faster, so interval must be 64x larger
-    if ((unsigned long)(now - g_lastUpdateMs) >= MILLIS_COMPENSATED(Config::MAIN_LOOP_INTERVAL_MS)) {
-        g_lastUpdateMs = now;
+// Control tick (MAIN_LOOP_INTERVAL_MS). Returning early (external safety)
+// only ends the tick: the rest of loop() - CAN, LED, usage, watchdog - runs
+// on every pass regardless
+static void controlTick(unsigned long now) {
+    // ====================================================================
+    // 1. Update PWM input reading (uses pulseIn, may block ~40-100ms)
+    // ====================================================================
+    // Skipped while a CAN command with priority is in control: the
+    // blocking read would delay the CAN fast path for nothing.
+    bool canActive = (Config::ENABLE_CAN_COMMAND && g_canCommand.update(now));
+    if (Config::ENABLE_EXTERNAL_PWM_MODE &&
+        !(canActive && Config::CAN_COMMAND_OVER_EXTERNAL_PWM)) {
+        g_pwmInput.update();
+    }
+
+    // ====================================================================
+    // 1b. Check external safety input (D7) - HIGHEST PRIORITY
+    // ====================================================================
+    // Read right after the blocking PWM read and before the sensor pass
+    // (~10ms of ADC bursts): output off first, the rest of the safety
+    // handling is in step 2.
+    bool safetyOff = readExternalSafety();
+    if (safetyOff) safetyShutdown();
 
-        // ====================================================================
-        // 1. Update PWM input reading (uses pulseIn, may block ~40-100ms)
-        // ====================================================================
-        if (Config::ENABLE_EXTERNAL_PWM_MODE) {
-            g_pwmInput.update();
+    // ====================================================================
+    // 1c. Sample the sensors - once per tick: the filter coefficients
+    //     assume SENSOR_SAMPLE_HZ; everything below reads the results
+    // ====================================================================
+    g_curr1.update();
+    g_curr2.update();
+    g_voltage.update();
+    g_temp.update();
+    g_map.update();
+    if (Config::ENABLE_ENGINE_INPUT) g_engine.update();
+    if (Config::ENABLE_LATENCY_PROBE) {
+        g_latency.onMapSample(g_map.getSampleBar(), g_source == ControlSource::MAP && !g_outputForcedOff);
+    }
+
+    // ====================================================================
+    // 2. External safety active: output already off (step 1b), skip normal
+    //    control
+    // ====================================================================
+    if (safetyOff) {
+        g_statusLed.updateExternalSafetyBlink();  // Blue blinking LED
+        g_telemetry.setSourceMode(CanTelemetry::SOURCE_SAFETY_OFF);
+        g_telemetry.setTargetDuty(0.0f);
+        if (Config::ENABLE_LOAD_SHARING && g_can.isReady()) {
+            // Tell the other boards to take over this pump's flow
+            LoadShare::NodeState self = { 0.0f, 0.0f, 0.0f, g_temp.getFilteredTemperatureC(), false };
+            g_loadShare.update(now, self);
+            g_can.send(g_loadShare.getFrame());
         }
+        saveWarmSnapshot(now);
+        recordUsage(now, g_map.getPressureBar(), true);
+        Serial.println(F("*** EXTERNAL SAFETY ACTIVE - OUTPUT FORCED OFF ***"));
+        // Skip the rest of the tick - safety has priority (loop() services,
+        // watchdog included, still run)
+        return;
+    }
 
-        // ====================================================================
-        // 2. Check external safety input (D8) - HIGHEST PRIORITY
-        // ====================================================================
-        bool externalSafetyActive = false;
-        if (Config::ENABLE_EXTERNAL_SAFETY) {
-            int safetyInput = digitalRead(Config::PIN_DIG_IN_1);  // D7
-            if (Config::EXTERNAL_SAFETY_ACTIVE_HIGH) {
-                externalSafetyActive = (safetyInput == HIGH);  // HIGH = shutdown
-            } else {
-                externalSafetyActive = (safetyInput == LOW);   // LOW = shutdown
-            }
+    // ====================================================================
+    // 3. Update current protection (filtered currents, applies hysteresis)
+    // ====================================================================
+    float voltageLimit = g_protection.update();
+    PowerProtection::ProtectionLevel protLevel = g_protection.getLevel();
+    bool inFault = (protLevel == PowerProtection::ProtectionLevel::FAULT);
+    bool inEmergency = (protLevel == PowerProtection::ProtectionLevel::EMERGENCY);
 
-            // If external safety triggered, immediately shutdown and skip normal control
-            if (externalSafetyActive) {
-                g_power.setDuty(0.0f);  // IMMEDIATE shutdown (no rate limiting)
-                g_statusLed.updateExternalSafetyBlink();  // Blue blinking LED
-                Serial.println(F("*** EXTERNAL SAFETY ACTIVE - OUTPUT FORCED OFF ***"));
-                // Skip rest of control loop - safety has priority
-                return;
-            }
+    // ====================================================================
+    // 4. Common readings + status LED
+    // ====================================================================
+    // Regulated mode: the feed-forward's fast estimate (below) is the one
+    // supply value, here too. Otherwise the median, and the fast filter
+    // follows it so regulation starts from a current value.
+    float supplyVoltage;
+    if (g_power.isRegulatedMode()) {
+        supplyVoltage = g_voltage.getFastVoltage();
+    } else {
+        supplyVoltage = g_voltage.getFilteredVoltage();
+        g_voltage.syncFast();
+    }
+    g_power.setSupplyVoltage(supplyVoltage);
+
+    float current1 = g_curr1.getCurrentA();
+    float current2 = g_curr2.getCurrentA();
+
+    // Thermal derating combines with the current-protection limit (lowest wins)
+    float outputLimit = voltageLimit;
+    if (Config::ENABLE_THERMAL_DERATING) {
+        float thermalLimit = g_thermal.update(current1, current2, g_power.getCurrentDuty());
+        outputLimit = min(outputLimit, thermalLimit);
+    }
+    g_power.setVoltageLimit(outputLimit);
+
+    // Pump speed from commutation ripple (one channel burst per interval)
+    bool speedUpdated = false;
+    if (Config::ENABLE_PUMP_SPEED_ESTIMATION) {
+        const float currents[2] = { current1, current2 };
+        speedUpdated = g_pumpSpeed.update(currents, g_power.getCurrentDuty() * supplyVoltage);
+    }
+
+    float maxCurrent = max(current1, current2);
+    g_statusLed.updateFromCurrent(maxCurrent, inFault, inEmergency);
+
+    // ====================================================================
+    // 5. Source select: CAN command / External PWM (priority per
+    //    CAN_COMMAND_OVER_EXTERNAL_PWM), MAP fallback
+    // ====================================================================
+    bool pwmValid = (Config::ENABLE_EXTERNAL_PWM_MODE && g_pwmInput.isSignalValid());
+    if (canActive && (Config::CAN_COMMAND_OVER_EXTERNAL_PWM || !pwmValid)) {
+        g_source = ControlSource::CAN;
+    } else if (pwmValid) {
+        g_source = ControlSource::EXTERNAL_PWM;
+    } else {
+        g_source = ControlSource::MAP;
+    }
+    bool externalMode = (g_source == ControlSource::EXTERNAL_PWM);
+    bool canMode = (g_source == ControlSource::CAN);
+    bool fromPressureCurve = !externalMode &&
+        !(canMode && g_canCommand.getMode() == CanCommand::MODE_DUTY);
+    float targetPercent;
+    float pressureBar = 0.0f;
+    if (externalMode) {
+        targetPercent = g_pwmInput.getDutyCycle();
+    } else if (canMode) {
+        targetPercent = canCommandTargetPercent();
+        g_canCommand.takeNewCommand();  // Applied below
+    } else {
+        g_voltageProtection.update();
+        pressureBar = g_map.getPressureBar();
+        // Boost-rate feedforward: the curve read ahead of a rising MAP
+        // (lead is 0 when disabled or with steady / falling pressure)
+        targetPercent = pressureToTargetPercent(pressureBar + g_map.getLeadBar());
+
+        // Fuel-demand feedforward: flow rises with RPM / injector duty,
+        // not only with manifold pressure
+        if (Config::ENABLE_DEMAND_FEEDFORWARD) {
+            float demand = g_engine.getDemand(pressureBar + g_map.getAtmosphericBar());
+            targetPercent = min(targetPercent + demandFeedforward(demand), Config::OUTPUT_PERCENT_MAX);
         }
 
-        // ====================================================================
-        // 3. Update current protection (reads currents, applies hysteresis)
-        // ====================================================================
-        float voltageLimit = g_protection.update();
-        PowerProtection::ProtectionLevel protLevel = g_protection.getLevel();
-        bool inFault = (protLevel == PowerProtection::ProtectionLevel::FAULT);
-        bool inEmergency = (protLevel == PowerProtection::ProtectionLevel::EMERGENCY);
-
-        // ====================================================================
-        // 4. Common readings + status LED
-        // ====================================================================
-        float supplyVoltage = g_voltage.readVoltage();
-        g_power.setSupplyVoltage(supplyVoltage);
-        g_power.setVoltageLimit(voltageLimit);
-
-        float current1 = g_curr1.readCurrentA();
-        float current2 = g_curr2.readCurrentA();
-        float maxCurrent = max(current1, current2);
-        g_statusLed.updateFromCurrent(maxCurrent, inFault, inEmergency);
-
-        // ====================================================================
-        // 5. Source select: External PWM (if valid) vs MAP fallback
-        // ====================================================================
-        bool externalMode = (Config::ENABLE_EXTERNAL_PWM_MODE && g_pwmInput.isSignalValid());
-        float targetPercent;
-        float pressureBar = 0.0f;
-        if (externalMode) {
-            targetPercent = g_pwmInput.getDutyCycle();
-        } else {
-            g_voltageProtection.update();
-            pressureBar = g_map.readPressureBar();
-            targetPercent = pressureToTargetPercent(pressureBar);
+        // Optional closed-loop speed trim (mean RPM of the channels with a valid estimate)
+        if (Config::ENABLE_PUMP_SPEED_ESTIMATION && Config::ENABLE_PUMP_SPEED_CONTROL) {
+            if (speedUpdated) {
+                uint8_t validCount = 0;
+                float rpmSum = 0.0f;
+                for (uint8_t ch = 0; ch < 2; ch++) {
+                    if (g_pumpSpeed.isValid(ch)) {
+                        rpmSum += g_pumpSpeed.getRpm(ch);
+                        validCount++;
+                    }
+                }
+                float rpm = (validCount > 0) ? rpmSum / validCount : 0.0f;
+                g_speedControl.updateEstimate(targetPercent, rpm, validCount > 0,
+                                              Config::PUMP_SPEED_INTERVAL_MS / 1000.0f);
+            }
+            targetPercent = g_speedControl.apply(targetPercent);
         }
+    }
+
+    // ====================================================================
+    // 5b. Load sharing: the target above is this board's demand; apply
+    //     its part of the total flow instead (no CAN: local control).
+    //     The share already respects outputLimit - toTarget() undoes it
+    //     so setOutputPercent() derates once
+    // ====================================================================
+    if (Config::ENABLE_LOAD_SHARING && g_can.isReady()) {
+        LoadShare::NodeState self = {
+            targetPercent,
+            outputLimit,
+            current1 + current2,
+            Config::ENABLE_THERMAL_DERATING ? g_thermal.getHeatsinkC() : g_temp.getFilteredTemperatureC(),
+            !inEmergency
+        };
+        targetPercent = LoadShare::toTarget(g_loadShare.update(now, self), outputLimit);
+        g_can.send(g_loadShare.getFrame());
+    }
+
+    // ====================================================================
+    // 6. Apply: EMERGENCY overrides source with explicit zero duty
+    // ====================================================================
+    g_outputForcedOff = inEmergency;
+    if (inEmergency) {
+        g_power.setDuty(0.0f);
+        g_softStart.restart();  // Ramp again on recovery
+        g_power.setDutyCeiling(g_softStart.getCeiling());
+    } else {
+        applyOutput(targetPercent, fromPressureCurve);
+    }
+    saveWarmSnapshot(now);
+    recordUsage(now, g_map.getPressureBar(), false);
 
-        // ====================================================================
-        // 6. Apply: EMERGENCY overrides source with explicit zero duty
-        // ====================================================================
-        if (inEmergency) {
-            g_power.setDuty(0.0f);
+    // ====================================================================
+    // 7. CAN telemetry snapshot (sent by the fast path below)
+    // ====================================================================
+    if (Config::ENABLE_CAN_TELEMETRY) {
+        g_telemetry.setSourceMode(externalMode ? CanTelemetry::SOURCE_EXTERNAL_PWM
+                                  : canMode    ? CanTelemetry::SOURCE_CAN
+                                               : CanTelemetry::SOURCE_MAP);
+        if (g_source == ControlSource::MAP) {
+            g_telemetry.setMapPressure(pressureBar);
+        }
+        g_telemetry.setTargetDuty(targetPercent * 100.0f);
+        g_telemetry.setSupplyVoltage(supplyVoltage);
+        g_telemetry.setCurrent1(current1);
+        g_telemetry.setCurrent2(current2);
+        if (Config::ENABLE_THERMAL_DERATING) {
+            g_telemetry.setHeatsinkTemp(g_thermal.getHeatsinkC());
+            g_telemetry.setMosfetTemp(max(g_thermal.getMosfetTempC(0), g_thermal.getMosfetTempC(1)));
         } else {
-            g_power.setOutputPercent(targetPercent);
+            g_telemetry.setHeatsinkTemp(g_temp.getFilteredTemperatureC());
         }
+        g_telemetry.setCurrentFaults((float)g_protection.getFaultCount());
+        g_telemetry.setVoltageFaults((float)g_voltageProtection.getFaultCount());
+        g_telemetry.setVoltageLevel((float)(uint8_t)g_voltageProtection.getLevel());
+    }
 
-        // ====================================================================
-        // 7. Status line
-        // ====================================================================
+    // ====================================================================
+    // 8. Status line (ENABLE_SERIAL_TICK_LOG - CAN telemetry replaces it)
+    // ====================================================================
+    if (Config::ENABLE_SERIAL_TICK_LOG) {
         if (externalMode) {
             Serial.print(F("*** EXTERNAL PWM MODE *** | PWM In:"));
             Serial.print(g_pwmInput.getDutyCycle() * 100.0f, 1);
             Serial.print(F("% @ "));
             Serial.print(g_pwmInput.getFrequency(), 1);
             Serial.print(F("Hz | "));
+        } else if (canMode) {
+            Serial.print(F("*** CAN MODE *** | "));
+            if (g_canCommand.getMode() == CanCommand::MODE_PRESSURE) {
+                Serial.print(F("P cmd:"));
+                Serial.print(g_canCommand.getPressureBar(), 2);
+                Serial.print(F("bar | "));
+            }
+            Serial.print(F("T%:"));
+            Serial.print(targetPercent * 100.0f, 1);
+            Serial.print(F("% | "));
         } else {
             Serial.print(F("*** MAP MODE *** | P:"));
             Serial.print(pressureBar, 2);
             Serial.print(F("bar | T%:"));
             Serial.print(targetPercent * 100.0f, 0);
-            Serial.print(F("% | Vo:"));
+            Serial.print(F("% | "));
+            if (g_power.isRegulatedMode()) {
+                Serial.print(F("Vt:"));
+                Serial.print(g_power.getTargetVoltage(), 1);
+                Serial.print(F("V | "));
+            }
+            Serial.print(F("Vo:"));
             Serial.print(g_power.getActualOutputVoltage(), 1);
             Serial.print(F("V | "));
         }
@@ -268,11 +617,99 @@ void loop() {
         Serial.print(F("A | I2:"));
         Serial.print(current2, 1);
         Serial.print(F("A | Lim:"));
-        Serial.print(voltageLimit * 100.0f, 0);
+        Serial.print(outputLimit * 100.0f, 0);
         Serial.print(F("% | "));
         Serial.println(g_protection.getLevelString());
     }
+}
+
+void loop() {
+    unsigned long now = millis();
+
+    // External safety between ticks: one pin read per pass, so the output
+    // goes off at the next pass instead of the next tick (the tick does the
+    // rest of the safety handling)
+    if (!g_outputForcedOff && readExternalSafety()) safetyShutdown();
+    
+    // Main control loop - runs at MAIN_LOOP_INTERVAL_MS (20Hz default)
+    // Safe millis() rollover handling: subtraction is always safe for unsigned types
+    // COMPENSATED: millis() runs 64x faster, so interval must be 64x larger
+    if ((unsigned long)(now - g_lastUpdateMs) >= MILLIS_COMPENSATED(Config::MAIN_LOOP_INTERVAL_MS)) {
+        g_lastUpdateMs = now;
+        controlTick(now);
+    }
     
+    // ========================================================================
+    // Soft-start ramp - runs at SOFTSTART_STEP_INTERVAL_MS (100Hz) while active
+    // ========================================================================
+    if (g_softStart.isActive() &&
+        (unsigned long)(now - g_lastSoftStartMs) >= MILLIS_COMPENSATED(Config::SOFTSTART_STEP_INTERVAL_MS)) {
+        g_lastSoftStartMs = now;
+        g_power.setDutyCeiling(g_softStart.service(g_power.getRequestedDuty()));
+    }
+
+    // ========================================================================
+    // Supply feed-forward - runs at CV_FEEDFORWARD_INTERVAL_MS (500Hz default)
+    // ========================================================================
+    // Only in regulated-voltage mode: re-read Vsupply into the fast estimate and
+    // correct the duty so the pump voltage holds through sags between 20Hz
+    // control ticks.
+    if (g_power.isRegulatedMode() &&
+        (unsigned long)(now - g_lastFeedForwardMs) >= MILLIS_COMPENSATED(Config::CV_FEEDFORWARD_INTERVAL_MS)) {
+        g_lastFeedForwardMs = now;
+        g_power.setSupplyVoltage(g_voltage.updateFast());
+    }
+
+    // ========================================================================
+    // MAP fast reads - runs at MAP_SLOPE_INTERVAL_MS (100Hz default)
+    // ========================================================================
+    // Extra samples for the dP/dt line fit (and the latency probe MAP steps);
+    // the filter stays at the tick.
+    if ((Config::ENABLE_MAP_RATE_FEEDFORWARD || Config::ENABLE_LATENCY_PROBE) &&
+        (unsigned long)(now - g_lastMapSlopeMs) >= MILLIS_COMPENSATED(Config::MAP_SLOPE_INTERVAL_MS)) {
+        g_lastMapSlopeMs = now;
+        g_map.sampleFast();
+        if (Config::ENABLE_LATENCY_PROBE) {
+            g_latency.onMapSample(g_map.getSampleBar(), g_source == ControlSource::MAP && !g_outputForcedOff);
+        }
+    }
+
+    // ========================================================================
+    // CAN RX - every loop pass: drain the RX ring (ECU command, peer boards)
+    // and, when the CAN source is in control, apply a new setpoint immediately
+    // ========================================================================
+    // Source choice, protection limits and EMERGENCY/safety stay with the
+    // control tick; a command that goes stale is dropped at the next tick.
+    // With load sharing the command is a demand and is split at the tick.
+    if (Config::ENABLE_CAN_COMMAND || Config::ENABLE_LOAD_SHARING) {
+        CanFrame frame;
+        while (g_can.receive(frame)) {
+            if (Config::ENABLE_CAN_COMMAND) g_canCommand.onFrame(frame, now);
+            if (Config::ENABLE_LOAD_SHARING) g_loadShare.onFrame(frame, now);
+        }
+        if (Config::ENABLE_CAN_COMMAND && !Config::ENABLE_LOAD_SHARING &&
+            g_canCommand.takeNewCommand() && g_source == ControlSource::CAN && !g_outputForcedOff &&
+            g_canCommand.getMode() != CanCommand::MODE_RELEASE) {
+            float targetPercent = canCommandTargetPercent();
+            applyOutput(targetPercent, g_canCommand.getMode() == CanCommand::MODE_PRESSURE);
+            g_telemetry.setTargetDuty(targetPercent * 100.0f);
+        }
+    }
+
+    // ========================================================================
+    // CAN telemetry - runs at CAN_TELEMETRY_INTERVAL_MS (50Hz default, up to 100Hz)
+    // ========================================================================
+    // Tick values are repeated between ticks; duty, limit and protection level
+    // are refreshed here so soft-start/feed-forward changes show up at full rate.
+    if (Config::ENABLE_CAN_TELEMETRY &&
+        (unsigned long)(now - g_lastTelemetryMs) >= MILLIS_COMPENSATED(Config::CAN_TELEMETRY_INTERVAL_MS)) {
+        g_lastTelemetryMs = now;
+        g_telemetry.setActualDuty(g_power.getCurrentDuty() * 100.0f);
+        g_telemetry.setOutputLimit(g_power.getVoltageLimit() * 100.0f);
+        g_telemetry.setProtectionLevel((float)(uint8_t)g_protection.getLevel());
+        g_telemetry.publish();
+    }
+
     // ========================================================================
     // Detailed status report - runs at STATUS_REPORT_INTERVAL_MS (1Hz default)
     // ========================================================================
@@ -281,13 +718,59 @@ void loop() {
     if ((unsigned long)(now - g_lastStatusMs) >= MILLIS_COMPENSATED(Config::STATUS_REPORT_INTERVAL_MS)) {
         g_lastStatusMs = now;
         
+        g_cpuIdle.closeWindow();
         printDetailedStatus();
     }
     
     // ========================================================================
-    // CAN bus polling (stub for future implementation)
+    // CAN bus: RX/TX are serviced from the INT pin ISR; poll() only catches
+    // an INT line left asserted (missed edge)
     // ========================================================================
     g_can.poll();
+
+    // ========================================================================
+    // Status LED: a frame goes out only if the colour changed, at most every
+    // STATUS_LED_FRAME_INTERVAL_MS and while the CAN INT line is idle
+    // ========================================================================
+    g_statusLed.service(now, !g_can.isInterruptPending());
+
+    // ========================================================================
+    // Usage statistics: EEPROM checkpoint one byte per pass
+    // ========================================================================
+    if (Config::ENABLE_USAGE_LOG) g_usage.service(now);
+
+    // ========================================================================
+    // Latency probe: events without an output answer expire
+    // ========================================================================
+    if (Config::ENABLE_LATENCY_PROBE) g_latency.service();
+
+    // ========================================================================
+    // Serial commands: USAGE_DUMP_COMMAND (binary usage dump),
+    // LATENCY_RESET_COMMAND (latency statistics from zero)
+    // ========================================================================
+    if (Serial.available() > 0) {
+        char command = (char)Serial.read();
+        if (Config::ENABLE_USAGE_LOG && command == Config::USAGE_DUMP_COMMAND) {
+            g_usage.dump(Serial);
+        } else if (Config::ENABLE_LATENCY_PROBE && command == Config::LATENCY_RESET_COMMAND) {
+            g_latency.reset();
+        }
+    }
+
+    // ========================================================================
+    // Stack high-water mark: MEMORY_SCAN_BYTES per pass
+    // ========================================================================
+    g_memory.service();
+
+    // ========================================================================
+    // Watchdog: fed only while the loop is healthy
+    // ========================================================================
+    g_warmStart.feed(loopHealthy(now));
+
+    // ========================================================================
+    // Idle until the next interrupt (Timer 0 overflow at the latest)
+    // ========================================================================
+    g_cpuIdle.sleep();
 }
 
 // ============================================================================
@@ -334,14 +817,52 @@ void printDetailedStatus() {
     }
     
     // Pressure
-    float pressure = g_map.readPressureBar();
+    float pressure = g_map.getPressureBar();
     Serial.print(F("Pressure:        ")); 
     Serial.print(pressure, 3);
+    if (Config::ENABLE_MAP_RATE_FEEDFORWARD) {
+        Serial.print(F(" bar | dP/dt "));
+        Serial.print(g_map.getPressureRateBarS(), 2);
+        Serial.print(F(" bar/s | Lead "));
+        Serial.print(g_map.getLeadBar(), 3);
+    }
     Serial.println(F(" bar"));
     
+    // Calibration in use
+    Serial.print(F("Calibration:     I1 0A="));
+    Serial.print(g_calibration.getValue(SensorCalibration::CH_CURRENT_1), 4);
+    Serial.print(F("V I2 0A="));
+    Serial.print(g_calibration.getValue(SensorCalibration::CH_CURRENT_2), 4);
+    Serial.print(F("V Baro="));
+    Serial.print(g_calibration.getValue(SensorCalibration::CH_BARO), 3);
+    Serial.print(F("bar ("));
+    Serial.print(SensorCalibration::getSourceString(g_calibration.getSource(SensorCalibration::CH_BARO)));
+    Serial.print(F(", "));
+    Serial.print(g_calibration.getDurationMs());
+    Serial.println(F(" ms)"));
+
+    // Engine input (D3): RPM, injector duty, feedforward demand
+    if (Config::ENABLE_ENGINE_INPUT) {
+        Serial.print(F("Engine:          "));
+        if (g_engine.isValid()) {
+            Serial.print(g_engine.getRpm(), 0);
+            Serial.print(F(" RPM"));
+            if (Config::ENGINE_INPUT_INJECTOR) {
+                Serial.print(F(" | Inj duty "));
+                Serial.print(g_engine.getInjectorDuty() * 100.0f, 1);
+                Serial.print(F(" %"));
+            }
+            Serial.print(F(" | Demand "));
+            Serial.print(g_engine.getDemand(pressure + g_map.getAtmosphericBar()) * 100.0f, 0);
+            Serial.println(F(" %"));
+        } else {
+            Serial.println(F("no signal (stopped)"));
+        }
+    }
+
     // Current readings (filtered)
-    float i1 = g_curr1.readCurrentA();
-    float i2 = g_curr2.readCurrentA();
+    float i1 = g_curr1.getCurrentA();
+    float i2 = g_curr2.getCurrentA();
     Serial.print(F("Current Ch1:     ")); 
     Serial.print(i1, 2);
     Serial.println(F(" A"));
@@ -351,6 +872,26 @@ void printDetailedStatus() {
     Serial.print(F("Max Current:     ")); 
     Serial.print(max(i1, i2), 2);
     Serial.println(F(" A"));
+
+    // Pump speed (commutation ripple)
+    if (Config::ENABLE_PUMP_SPEED_ESTIMATION) {
+        for (uint8_t ch = 0; ch < 2; ch++) {
+            Serial.print(ch == 0 ? F("Pump RPM Ch1:    ") : F("Pump RPM Ch2:    "));
+            if (g_pumpSpeed.isValid(ch)) {
+                Serial.print(g_pumpSpeed.getRpm(ch), 0);
+            } else {
+                Serial.print(F("--"));
+            }
+            Serial.print(F(" ("));
+            Serial.print(PumpSpeedEstimator::getHealthString(g_pumpSpeed.getHealth(ch)));
+            Serial.println(F(")"));
+        }
+        if (Config::ENABLE_PUMP_SPEED_CONTROL) {
+            Serial.print(F("Speed Trim:      "));
+            Serial.print(g_speedControl.getTrim() * 100.0f, 1);
+            Serial.println(F(" %"));
+        }
+    }
     
     // Diagnostic: raw voltage readings
     Serial.print(F("Ch1 Voltage:     ")); 
@@ -365,7 +906,7 @@ void printDetailedStatus() {
     Serial.println(F(" V (raw avg)"));
     
     // Supply voltage status
-    float supplyV = g_voltage.readVoltage();
+    float supplyV = g_voltage.getFilteredVoltage();
     Serial.print(F("Supply Voltage:  ")); 
     Serial.print(supplyV, 2);
     Serial.println(F(" V"));
@@ -376,8 +917,8 @@ void printDetailedStatus() {
     Serial.print(F("V Fault Count:   "));
     Serial.println(g_voltageProtection.getFaultCount());
 
-    // Heatsink temperature (monitoring only, no protection logic)
-    float heatsinkC = g_temp.readTemperatureC();
+    // Heatsink temperature (sampled every control tick)
+    float heatsinkC = g_temp.getFilteredTemperatureC();
     Serial.print(F("Heatsink Temp:   "));
     Serial.print(heatsinkC, 1);
     Serial.print(F(" °C"));
@@ -385,6 +926,21 @@ void printDetailedStatus() {
         Serial.print(F("  (sensor fault?)"));
     }
     Serial.println();
+    if (Config::ENABLE_THERMAL_DERATING) {
+        Serial.print(F("Tj MOSFET:       "));
+        Serial.print(g_thermal.getMosfetTempC(0), 1);
+        Serial.print(F(" / "));
+        Serial.print(g_thermal.getMosfetTempC(1), 1);
+        Serial.println(F(" °C (Ch1/Ch2)"));
+        Serial.print(F("Tj Diode:        "));
+        Serial.print(g_thermal.getDiodeTempC(0), 1);
+        Serial.print(F(" / "));
+        Serial.print(g_thermal.getDiodeTempC(1), 1);
+        Serial.println(F(" °C (Ch1/Ch2)"));
+        Serial.print(F("Thermal Limit:   "));
+        Serial.print(g_thermal.getDerateLimit() * 100.0f, 1);
+        Serial.println(F(" %"));
+    }
     Serial.println();
     
     // Current protection status
@@ -393,12 +949,21 @@ void printDetailedStatus() {
     Serial.print(F("Voltage Limit:   ")); 
     Serial.print(g_protection.getVoltageLimit() * 100.0f, 1);
     Serial.println(F(" %"));
+    if (Config::ENABLE_I2T_PROTECTION) {
+        Serial.print(F("I2t Headroom:    "));
+        Serial.print(g_protection.getThermalHeadroom(0) * 100.0f, 0);
+        Serial.print(F(" % (Ch1), "));
+        Serial.print(g_protection.getThermalHeadroom(1) * 100.0f, 0);
+        Serial.println(F(" % (Ch2)"));
+    }
     Serial.print(F("Fault Count:     ")); 
     Serial.println(g_protection.getFaultCount());
     
     // Output status
     float targetPercent = pressureToTargetPercent(pressure);
-    float targetV = targetPercent * supplyV;
+    float targetV = Config::ENABLE_CONSTANT_VOLTAGE_MODE ?
+                    targetPercent * Config::CV_REFERENCE_VOLTAGE :
+                    targetPercent * supplyV;
     Serial.print(F("Target Percent:  ")); 
     Serial.print(targetPercent * 100.0f, 1);
     Serial.println(F(" %"));
@@ -411,22 +976,36 @@ void printDetailedStatus() {
     Serial.print(F("PWM Duty:        "));
     Serial.print(g_power.getCurrentDuty() * 100.0f, 1);
     Serial.println(F(" %"));
+    if (Config::ENABLE_SOFT_START) {
+        Serial.print(F("Soft-start:      "));
+        Serial.print(g_softStart.isActive() ? F("RAMPING, ceiling ") : F("done, last peak "));
+        if (g_softStart.isActive()) {
+            Serial.print(g_softStart.getCeiling() * 100.0f, 0);
+            Serial.println(F(" %"));
+        } else {
+            Serial.print(g_softStart.getPeakCurrent(), 1);
+            Serial.println(F(" A"));
+        }
+    }
+    Serial.print(F("Output Mode:     "));
+    if (g_power.isRegulatedMode()) {
+        Serial.println(g_power.isInRideThrough() ? F("REGULATED (RIDE-THROUGH)") : F("REGULATED VOLTAGE"));
+    } else {
+        Serial.println(F("PERCENT OF SUPPLY"));
+    }
     Serial.print(F("Output Source:   "));
-    Serial.println((Config::ENABLE_EXTERNAL_PWM_MODE && g_pwmInput.isSignalValid())
-                       ? F("EXTERNAL PWM") : F("MAP"));
+    Serial.println((g_source == ControlSource::CAN)          ? F("CAN COMMAND")
+                   : (g_source == ControlSource::EXTERNAL_PWM) ? F("EXTERNAL PWM") : F("MAP"));
     
     // External safety status
     if (Config::ENABLE_EXTERNAL_SAFETY) {
-        int safetyInput = digitalRead(Config::PIN_DIG_IN_1);
-        bool safetyActive = Config::EXTERNAL_SAFETY_ACTIVE_HIGH ?
-                           (safetyInput == HIGH) : (safetyInput == LOW);
         Serial.print(F("External Safety: "));
-        Serial.println(safetyActive ? "*** ACTIVE (SHUTDOWN) ***" : "OK");
+        Serial.println(readExternalSafety() ? "*** ACTIVE (SHUTDOWN) ***" : "OK");
     }
 
     // Digital inputs
     // Note: D8 (PIN_DIG_IN_2) is used for external PWM input when ENABLE_EXTERNAL_PWM_MODE is true
-    bool d1 = (digitalRead(Config::PIN_DIG_IN_1) == LOW);
+    bool d1 = !FastPin<Config::PIN_DIG_IN_1>::read();
     Serial.print(F("Digital In 1:    "));
     Serial.println(d1 ? "ACTIVE (LOW)" : "inactive (HIGH)");
 
@@ -434,16 +1013,170 @@ void printDetailedStatus() {
         Serial.print(F("Digital In 2:    "));
         Serial.println(F("(used for external PWM input)"));
     } else {
-        bool d2 = (digitalRead(Config::PIN_DIG_IN_2) == LOW);
+        bool d2 = !FastPin<Config::PIN_DIG_IN_2>::read();
         Serial.print(F("Digital In 2:    "));
         Serial.println(d2 ? "ACTIVE" : "inactive");
     }
     
+    // CAN bus
+    Serial.print(F("CAN:             "));
+    if (g_can.isReady()) {
+        Serial.print(F("RX "));
+        Serial.print(g_can.getRxFrames());
+        Serial.print(F(" TX "));
+        Serial.print(g_can.getTxFrames());
+        Serial.print(F(" | drop "));
+        Serial.print(g_can.getRxDropped());
+        Serial.print(F(" ovr "));
+        Serial.print(g_can.getHwOverruns());
+        Serial.print(F(" | TEC "));
+        Serial.print(g_can.readTec());
+        Serial.print(F(" REC "));
+        Serial.println(g_can.readRec());
+        if (Config::ENABLE_CAN_TELEMETRY) {
+            Serial.print(F("CAN Telemetry:   "));
+            Serial.print(g_telemetry.getCycles());
+            Serial.print(F(" cycles @ "));
+            Serial.print(Config::CAN_TELEMETRY_RATE_HZ);
+            Serial.print(F("Hz | dropped "));
+            Serial.println(g_telemetry.getDroppedFrames());
+        }
+        if (Config::ENABLE_LOAD_SHARING) {
+            unsigned long nowMs = millis();
+            Serial.print(F("Load Share:      node "));
+            Serial.print(g_loadShare.getNodeId());
+            Serial.print(F(" | total "));
+            Serial.print(g_loadShare.getTotalDemand() * 100.0f, 0);
+            Serial.print(F("% | "));
+            Serial.print(g_loadShare.getAvailableNodes());
+            Serial.print(F("/"));
+            Serial.print(Config::LOAD_SHARE_NODE_COUNT);
+            Serial.println(g_loadShare.isConverged() ? F(" boards | converged") : F(" boards | settling"));
+            for (uint8_t n = 0; n < LoadShare::MAX_NODES; n++) {
+                if (!g_loadShare.isFresh(n, nowMs)) continue;
+                Serial.print(F("  Board "));
+                Serial.print(n);
+                Serial.print(g_loadShare.isAvailable(n, nowMs) ? F(": share ") : F(": OFF   share "));
+                Serial.print(g_loadShare.getAllocation(n) * 100.0f, 1);
+                Serial.print(F("% cap "));
+                Serial.print(g_loadShare.getCapacity(n) * 100.0f, 0);
+                Serial.print(F("% | "));
+                Serial.print(g_loadShare.getCurrentA(n), 1);
+                Serial.print(F("A "));
+                Serial.print(g_loadShare.getTempC(n), 0);
+                Serial.println(F("C"));
+            }
+        }
+        if (Config::ENABLE_CAN_COMMAND) {
+            Serial.print(F("CAN Command:     "));
+            if (g_canCommand.isActive()) {
+                if (g_canCommand.getMode() == CanCommand::MODE_PRESSURE) {
+                    Serial.print(g_canCommand.getPressureBar(), 2);
+                    Serial.print(F(" bar"));
+                } else {
+                    Serial.print(g_canCommand.getDuty() * 100.0f, 1);
+                    Serial.print(F(" %"));
+                }
+                Serial.print(F(", age "));
+                Serial.print(g_canCommand.getAgeMs(millis()));
+                Serial.print(F("ms"));
+            } else {
+                Serial.print(F("idle"));
+            }
+            Serial.print(F(" | ok "));
+            Serial.print(g_canCommand.getAccepted());
+            Serial.print(F(" crc "));
+            Serial.print(g_canCommand.getChecksumErrors());
+            Serial.print(F(" seq "));
+            Serial.print(g_canCommand.getCounterErrors());
+            Serial.print(F(" range "));
+            Serial.print(g_canCommand.getRangeErrors());
+            Serial.print(F(" timeout "));
+            Serial.println(g_canCommand.getTimeouts());
+        }
+        Serial.print(F("CAN SPI:         last "));
+        Serial.print(g_can.getLastTransactionUs());
+        Serial.print(F("us max "));
+        Serial.print(g_can.getMaxTransactionUs());
+        Serial.print(F("us | ISR max "));
+        Serial.print(g_can.getMaxIsrUs());
+        Serial.println(F("us"));
+    } else {
+        Serial.println(Config::ENABLE_CAN ? F("NOT RESPONDING") : F("disabled"));
+    }
+
     // Runtime
     // COMPENSATED: millis() runs 64x faster, divide by prescaler factor for real time
     Serial.print(F("Uptime:          ")); 
     Serial.print(millis() / (1000UL * Config::TIMER0_PRESCALER_FACTOR));
     Serial.println(F(" s"));
+    if (Config::ENABLE_MEMORY_MONITOR) {
+        Serial.print(F("Memory:          free "));
+        Serial.print(g_memory.getFreeBytes());
+        Serial.print(F(" B | stack peak "));
+        Serial.print(g_memory.getStackPeakBytes());
+        Serial.print(F(" B, margin "));
+        Serial.print(g_memory.getStackMarginBytes());
+        Serial.print(F(" B | static "));
+        Serial.print(g_memory.getStaticBytes());
+        Serial.print(F(" B, heap "));
+        Serial.print(g_memory.getHeapBytes());
+        Serial.println(g_memory.isLow() ? F(" B *** LOW MEMORY ***") : F(" B"));
+    }
+    if (Config::ENABLE_IDLE_SLEEP) {
+        Serial.print(F("CPU Idle:        "));
+        Serial.print(g_cpuIdle.getIdlePercent(), 1);
+        Serial.print(F(" % | "));
+        Serial.print(g_cpuIdle.getWakeupsPerSec());
+        Serial.print(Config::ENABLE_ADC_SLEEP ? F(" wakeups/s | ADC sleep on") : F(" wakeups/s | ADC sleep off"));
+        Serial.println();
+    }
+    if (Config::ENABLE_USAGE_LOG) {
+        Serial.print(F("Usage:           "));
+        Serial.print(g_usage.getPoweredHours(), 2);
+        Serial.print(F(" h | "));
+        Serial.print(g_usage.getChargeAh(), 2);
+        Serial.print(F(" Ah | "));
+        Serial.print(g_usage.getEnergyWh(), 1);
+        Serial.print(F(" Wh | boots "));
+        Serial.print(g_usage.getRecord().boots);
+        Serial.print(F(" | checkpoint "));
+        Serial.print(g_usage.getRecord().sequence);
+        Serial.print(F(" slot "));
+        Serial.print(g_usage.getSlot());
+        Serial.println(g_usage.wasLoaded() ? F(" (EEPROM)") : F(" (new)"));
+    }
+    if (Config::ENABLE_LATENCY_PROBE) {
+        // Input event -> OCR0A/OCR0B write (ms); percentiles at half-octave resolution
+        for (uint8_t p = 0; p < LatencyProbe::PATH_COUNT; p++) {
+            Serial.print(p == LatencyProbe::PATH_SAFETY ? F("Latency D7:      ")
+                         : p == LatencyProbe::PATH_PWM  ? F("Latency D8 PWM:  ") : F("Latency MAP:     "));
+            Serial.print(F("n "));
+            Serial.print(g_latency.getCount(p));
+            if (g_latency.getCount(p) > 0) {
+                Serial.print(F(" | min "));
+                Serial.print(g_latency.getMinUs(p) / 1000.0f, 1);
+                Serial.print(F(" p50 "));
+                Serial.print(g_latency.getPercentileUs(p, 0.50f) / 1000.0f, 1);
+                Serial.print(F(" p90 "));
+                Serial.print(g_latency.getPercentileUs(p, 0.90f) / 1000.0f, 1);
+                Serial.print(F(" p99 "));
+                Serial.print(g_latency.getPercentileUs(p, 0.99f) / 1000.0f, 1);
+                Serial.print(F(" max "));
+                Serial.print(g_latency.getMaxUs(p) / 1000.0f, 1);
+                Serial.print(F(" ms"));
+            }
+            Serial.print(F(" | no response "));
+            Serial.println(g_latency.getNoResponse(p));
+        }
+    }
+    Serial.print(F("Last Reset:      "));
+    g_warmStart.printResetCause();
+    Serial.print(g_warmStart.isWarm() ? F("(warm) | warm restarts ") : F("(cold) | warm restarts "));
+    Serial.print(g_warmStart.getWarmRestarts());
+    Serial.print(F(" | WDT "));
+    Serial.print(Config::ENABLE_WATCHDOG ? F("on, unhealthy passes ") : F("off, unhealthy passes "));
+    Serial.println(g_warmStart.getUnhealthyPasses());
     
     Serial.println(F("----------------------------------------"));
     Serial.println();
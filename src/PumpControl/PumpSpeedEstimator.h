@@ -0,0 +1,334 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// -----------------------------------------------------------------------------
+// PumpSpeedEstimator - Pump RPM from current commutation ripple
+// -----------------------------------------------------------------------------
+// A brushed DC pump draws a current ripple at
+//     f_ripple = RPM / 60 * PUMP_COMMUTATOR_SEGMENTS
+// The normal current path averages this away, so speed is measured with a
+// separate burst capture on A2/A3:
+//
+// Capture (blocking, ~PUMP_SPEED_SAMPLES x 256us ≈ 16ms per channel):
+//   - ADC auto-triggered by Timer 0 overflow (ADTS = 100). In Phase-Correct
+//     mode TOV0 fires once per PWM period at BOTTOM, so every sample is taken
+//     at the same PWM phase: the 3.9kHz PWM ripple aliases to DC and drops out.
+//     Fs = 16MHz / 8 / 510 = 3921.6 Hz, Nyquist 1960 Hz.
+//   - ADC clock /32 during the burst (26us conversion, well inside 256us)
+//   - Previous ADCSRA/ADCSRB/ADMUX restored afterwards -> analogRead() unaffected
+//
+// Analysis (fixed-point Goertzel, no FFT buffer):
+//   - Mean removed, Hann window applied in Q15
+//   - Goertzel power at each bin between PUMP_RIPPLE_FREQ_MIN..MAX
+//   - Peak refined with parabolic interpolation on neighbour bins
+//   - Peak must exceed PUMP_SPEED_MIN_SNR x mean bin power, else no estimate
+//
+// Channels are captured alternately, one per PUMP_SPEED_INTERVAL_MS, to keep
+// the blocking time per loop pass bounded.
+//
+// Diagnostics:
+//   - STALL: current above PUMP_STALL_CURRENT_A with no ripple / RPM below
+//     PUMP_STALL_RPM_MIN (locked rotor, seized pump)
+//   - WORN:  RPM per volt below PUMP_WORN_RPM_PER_V_MIN while running
+//     (worn brushes/bearings: pump draws current but spins slow)
+// -----------------------------------------------------------------------------
+
+class PumpSpeedEstimator {
+public:
+    enum class Health : uint8_t {
+        UNKNOWN = 0,   // No valid estimate yet / pump not running
+        OK,
+        WORN,          // Low RPM per applied volt
+        STALL          // Current flowing but rotor not turning
+    };
+
+    PumpSpeedEstimator(uint8_t pin1, uint8_t pin2)
+        : _nextChannel(0)
+        , _lastCaptureMs(0)
+    {
+        _pins[0] = pin1;
+        _pins[1] = pin2;
+        for (uint8_t ch = 0; ch < 2; ch++) {
+            _rpm[ch] = 0.0f;
+            _valid[ch] = false;
+            _health[ch] = Health::UNKNOWN;
+        }
+    }
+
+    void begin() {
+        _lastCaptureMs = millis();
+    }
+
+    // Run one capture + analysis if the interval elapsed.
+    // currents: filtered current per channel (A), for stall classification
+    // outputVoltage: voltage applied to the pump (duty x Vsupply)
+    // Returns true if a new estimate was produced.
+    bool update(const float currents[2], float outputVoltage) {
+        unsigned long now = millis();
+        // COMPENSATED: millis() runs 8x faster due to Timer 0 prescaler
+        if ((unsigned long)(now - _lastCaptureMs) < MILLIS_COMPENSATED(Config::PUMP_SPEED_INTERVAL_MS)) {
+            return false;
+        }
+        _lastCaptureMs = now;
+
+        uint8_t ch = _nextChannel;
+        _nextChannel ^= 1;
+
+        captureBurst(_pins[ch]);
+        float freq = findRippleFrequency();
+
+        _valid[ch] = (freq > 0.0f);
+        _rpm[ch] = _valid[ch] ? (freq * 60.0f / Config::PUMP_COMMUTATOR_SEGMENTS) : 0.0f;
+
+        Health health = classify(_rpm[ch], currents[ch], outputVoltage);
+        if (health != _health[ch] && (health == Health::STALL || health == Health::WORN)) {
+            Serial.print(F("[PUMP_SPEED] Ch"));
+            Serial.print(ch + 1);
+            Serial.print(F(": "));
+            Serial.print(getHealthString(health));
+            Serial.print(F(" | RPM: "));
+            Serial.print(_rpm[ch], 0);
+            Serial.print(F(" | Current: "));
+            Serial.print(currents[ch], 1);
+            Serial.println(F("A"));
+        }
+        _health[ch] = health;
+        return true;
+    }
+
+    // Estimated RPM for channel 0/1 (0 if no valid ripple peak)
+    float getRpm(uint8_t channel) const {
+        return (channel < 2) ? _rpm[channel] : 0.0f;
+    }
+
+    bool isValid(uint8_t channel) const {
+        return (channel < 2) ? _valid[channel] : false;
+    }
+
+    Health getHealth(uint8_t channel) const {
+        return (channel < 2) ? _health[channel] : Health::UNKNOWN;
+    }
+
+    static const char* getHealthString(Health health) {
+        switch (health) {
+            case Health::OK:    return "OK";
+            case Health::WORN:  return "WORN?";
+            case Health::STALL: return "*** STALL ***";
+            default:            return "--";
+        }
+    }
+
+private:
+    uint8_t _pins[2];
+    float _rpm[2];
+    bool _valid[2];
+    Health _health[2];
+    uint8_t _nextChannel;
+    unsigned long _lastCaptureMs;
+    int16_t _samples[Config::PUMP_SPEED_SAMPLES];  // Raw ADC burst (mean removed in place)
+
+    // Sample rate = Timer 0 overflow rate in Phase-Correct mode (16MHz / prescaler / 510)
+    static constexpr float SAMPLE_RATE_HZ =
+        16000000.0f / (Config::ENABLE_HIGH_FREQ_PWM ? 8.0f : 64.0f) / 510.0f;
+    static constexpr uint8_t RIPPLE_K_MIN_RAW =
+        (uint8_t)(Config::PUMP_RIPPLE_FREQ_MIN / (SAMPLE_RATE_HZ / Config::PUMP_SPEED_SAMPLES));
+    static constexpr uint8_t RIPPLE_K_MIN = RIPPLE_K_MIN_RAW < 1 ? 1 : RIPPLE_K_MIN_RAW;
+
+    // Goertzel state bound for bin k: |s| <= max|x| * sum_m |sin(m w) / sin w|,
+    // each term <= min(m, N / 4k) (sin w >= 2w / pi). Input peak that keeps
+    // coeff (Q14, < 2^15) * s inside int32 down to the lowest scanned bin:
+    static constexpr uint8_t GOERTZEL_K_LOW = RIPPLE_K_MIN - 1;
+    static constexpr int32_t GOERTZEL_GAIN = GOERTZEL_K_LOW == 0
+        ? (int32_t)Config::PUMP_SPEED_SAMPLES * (Config::PUMP_SPEED_SAMPLES + 1) / 2
+        : ((int32_t)Config::PUMP_SPEED_SAMPLES * Config::PUMP_SPEED_SAMPLES + 4 * GOERTZEL_K_LOW - 1)
+              / (4 * GOERTZEL_K_LOW);
+    static constexpr int16_t GOERTZEL_INPUT_MAX = (int16_t)(0x7FFFFFFFL / 32768L / GOERTZEL_GAIN);
+    static_assert(GOERTZEL_INPUT_MAX >= 32,
+                  "PumpSpeedEstimator: ripple band too close to DC for the Q14 Goertzel");
+
+    // Blocking burst: ADC auto-triggered by Timer 0 overflow, one sample per PWM period
+    void captureBurst(uint8_t pin) {
+        uint8_t savedAdcsra = ADCSRA;
+        uint8_t savedAdcsrb = ADCSRB;
+        uint8_t savedAdmux = ADMUX;
+
+        // Select channel with AVcc reference (same as analogRead DEFAULT)
+        ADMUX = _BV(REFS0) | ((pin - A0) & 0x07);
+        ADCSRB = (ADCSRB & ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) | _BV(ADTS2);  // Timer0 OVF
+        // Enable, auto-trigger, clear flag, prescaler /32 (500kHz ADC clock)
+        ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIF) | _BV(ADPS2) | _BV(ADPS0);
+
+        // First conversion after a mux change is discarded
+        for (uint8_t i = 0; i <= Config::PUMP_SPEED_SAMPLES; i++) {
+            while (!(ADCSRA & _BV(ADIF))) { }
+            int16_t value = ADC;
+            ADCSRA |= _BV(ADIF);  // Clear flag (write one)
+            if (i > 0) {
+                _samples[i - 1] = value;
+            }
+        }
+
+        ADCSRA = savedAdcsra & ~_BV(ADATE);
+        ADCSRB = savedAdcsrb;
+        ADMUX = savedAdmux;
+    }
+
+    // Goertzel scan over the ripple band; returns peak frequency (Hz) or 0
+    float findRippleFrequency() {
+        const uint8_t n = Config::PUMP_SPEED_SAMPLES;
+
+        // Remove mean (DC = average current) and apply Hann window in Q15
+        // Window generated by rotation (two trig calls instead of one per sample)
+        int32_t sum = 0;
+        for (uint8_t i = 0; i < n; i++) sum += _samples[i];
+        int16_t mean = (int16_t)(sum / n);
+        const float step = 2.0f * (float)M_PI / (n - 1);
+        const float cd = cos(step), sd = sin(step);
+        float c = 1.0f, sn = 0.0f;  // cos/sin of 2*pi*i/(n-1)
+        int16_t peak = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            // Hann: w = 0.5 - 0.5*cos(2*pi*i/(n-1))
+            int32_t wQ15 = (int32_t)((0.5f - 0.5f * c) * 32767.0f);
+            // x4 scale keeps fractional bits; ripple is a few counts
+            int32_t x = (int32_t)(_samples[i] - mean) * 4;
+            _samples[i] = (int16_t)((x * wQ15) >> 15);
+            int16_t mag = _samples[i] < 0 ? -_samples[i] : _samples[i];
+            if (mag > peak) peak = mag;
+            float cNext = c * cd - sn * sd;
+            sn = sn * cd + c * sd;
+            c = cNext;
+        }
+
+        // Large ripple: scale down until the Goertzel state fits int32 (the
+        // bins are only compared with each other, a common scale drops out).
+        // >= leaves room for the extra count of >> on negative samples
+        uint8_t shift = 0;
+        while ((peak >> shift) >= GOERTZEL_INPUT_MAX) shift++;
+        if (shift) {
+            for (uint8_t i = 0; i < n; i++) _samples[i] >>= shift;
+        }
+
+        const float binHz = SAMPLE_RATE_HZ / n;
+        const uint8_t kMin = RIPPLE_K_MIN;
+        uint8_t kMax = (uint8_t)(Config::PUMP_RIPPLE_FREQ_MAX / binHz) + 1;
+        if (kMax > n / 2 - 1) kMax = n / 2 - 1;
+
+        float prev = 0.0f, best = 0.0f, bestPrev = 0.0f, bestNext = 0.0f, total = 0.0f;
+        uint8_t bestK = 0;
+        uint8_t bins = 0;
+        bool captureNext = false;
+        for (uint8_t k = kMin - 1; k <= kMax + 1; k++) {
+            float p = goertzelPower(k);
+            if (captureNext) {
+                bestNext = p;
+                captureNext = false;
+            }
+            if (k >= kMin && k <= kMax) {
+                total += p;
+                bins++;
+                if (p > best) {
+                    best = p;
+                    bestK = k;
+                    bestPrev = prev;
+                    captureNext = true;
+                }
+            }
+            prev = p;
+        }
+
+        if (bins == 0 || bestK == 0) return 0.0f;
+        float meanPower = total / bins;
+        if (best < meanPower * Config::PUMP_SPEED_MIN_SNR) return 0.0f;
+
+        // Parabolic interpolation on log-free power values
+        float denom = bestPrev - 2.0f * best + bestNext;
+        float delta = (denom != 0.0f) ? 0.5f * (bestPrev - bestNext) / denom : 0.0f;
+        if (delta > 0.5f) delta = 0.5f;
+        if (delta < -0.5f) delta = -0.5f;
+        return ((float)bestK + delta) * binHz;
+    }
+
+    // Fixed-point Goertzel for bin k: coefficient 2cos(2*pi*k/N) in Q14.
+    // Input bounded by GOERTZEL_INPUT_MAX (findRippleFrequency)
+    int32_t goertzelCoeffQ14(uint8_t k) const {
+        return (int32_t)(2.0f * cos(2.0f * (float)M_PI * k / Config::PUMP_SPEED_SAMPLES) * 16384.0f);
+    }
+
+    float goertzelPower(uint8_t k) const {
+        int32_t coeff = goertzelCoeffQ14(k);
+        int32_t s1 = 0, s2 = 0;
+        for (uint8_t i = 0; i < Config::PUMP_SPEED_SAMPLES; i++) {
+            int32_t s0 = (int32_t)_samples[i] + ((coeff * s1) >> 14) - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        // |X|^2 = s1^2 + s2^2 - coeff*s1*s2 (float to avoid 64-bit math on AVR)
+        float f1 = (float)s1, f2 = (float)s2, c = coeff / 16384.0f;
+        return f1 * f1 + f2 * f2 - c * f1 * f2;
+    }
+
+    Health classify(float rpm, float current, float outputVoltage) const {
+        if (current >= Config::PUMP_STALL_CURRENT_A && rpm < Config::PUMP_STALL_RPM_MIN) {
+            return Health::STALL;
+        }
+        if (rpm <= 0.0f || outputVoltage < Config::PUMP_SPEED_MIN_VOLTAGE) {
+            return Health::UNKNOWN;
+        }
+        if (rpm / outputVoltage < Config::PUMP_WORN_RPM_PER_V_MIN) {
+            return Health::WORN;
+        }
+        return Health::OK;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// SpeedController - Optional closed-loop RPM trim on top of the duty target
+// -----------------------------------------------------------------------------
+// Target RPM = targetPercent x PUMP_SPEED_TARGET_RPM_MAX. A PI term trims the
+// feed-forward percent by at most +/-PUMP_SPEED_TRIM_MAX. Runs only while the
+// estimate is valid; otherwise the integrator bleeds off and the open-loop
+// target passes through unchanged.
+// -----------------------------------------------------------------------------
+
+class SpeedController {
+public:
+    SpeedController() : _integral(0.0f), _trim(0.0f) {}
+
+    // Called each time a new RPM estimate is available
+    void updateEstimate(float targetPercent, float rpm, bool valid, float dtS) {
+        if (!valid) {
+            _integral *= 0.5f;
+            _trim = _integral;
+            return;
+        }
+        float targetRpm = targetPercent * Config::PUMP_SPEED_TARGET_RPM_MAX;
+        float error = (targetRpm - rpm) / Config::PUMP_SPEED_TARGET_RPM_MAX;  // Normalized
+
+        _integral += Config::PUMP_SPEED_KI * error * dtS;
+        _integral = clampTrim(_integral);
+        _trim = clampTrim(Config::PUMP_SPEED_KP * error + _integral);
+    }
+
+    // Apply trim to an open-loop target percent (0.0 to 1.0)
+    float apply(float targetPercent) const {
+        float out = targetPercent + _trim;
+        if (out < 0.0f) out = 0.0f;
+        if (out > 1.0f) out = 1.0f;
+        return out;
+    }
+
+    float getTrim() const {
+        return _trim;
+    }
+
+private:
+    float _integral;
+    float _trim;
+
+    static float clampTrim(float v) {
+        if (v > Config::PUMP_SPEED_TRIM_MAX) return Config::PUMP_SPEED_TRIM_MAX;
+        if (v < -Config::PUMP_SPEED_TRIM_MAX) return -Config::PUMP_SPEED_TRIM_MAX;
+        return v;
+    }
+};
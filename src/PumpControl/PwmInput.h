@@ -1,19 +1,21 @@
 #pragma once
 #include <Arduino.h>
 #include "Config.h"
+#include "FastPin.h"
 
 // -----------------------------------------------------------------------------
 // PwmInput - Reads external PWM signal for slave mode operation
 // -----------------------------------------------------------------------------
 // Simplified approach using pulseIn() for reliable low-frequency PWM reading
 // Optimized for 25Hz PWM with variable duty cycle (0-100%)
+// Pin is a template parameter (FastPin.h); use the PwmInput typedef below.
 // -----------------------------------------------------------------------------
 
-class PwmInput {
+template <uint8_t PIN>
+class PwmInputT {
 public:
-    PwmInput(uint8_t pin) 
-        : _pin(pin)
-        , _dutyCycle(0.0f)
+    PwmInputT()
+        : _dutyCycle(0.0f)
         , _frequency(0.0f)
         , _signalValid(false)
         , _lastValidSignalMs(0)
@@ -22,7 +24,7 @@ public:
     {}
 
     void begin() {
-        pinMode(_pin, INPUT);  // No pullup - external signal
+        FastPin<PIN>::input();  // No pullup - external signal
         _lastValidSignalMs = millis();
     }
 
@@ -38,11 +40,11 @@ public:
         unsigned long nowMs = millis();
         
         // Measure HIGH pulse duration (timeout 100ms = minimum 10Hz)
-        unsigned long highUs = pulseIn(_pin, HIGH, 100000UL);
+        unsigned long highUs = pulseIn(PIN, HIGH, 100000UL);
         
         if (highUs > 0) {
             // We got a valid HIGH pulse, now measure LOW pulse
-            unsigned long lowUs = pulseIn(_pin, LOW, 100000UL);
+            unsigned long lowUs = pulseIn(PIN, LOW, 100000UL);
             
             if (lowUs > 0) {
                 // Both HIGH and LOW measured - we have a complete cycle!
@@ -144,7 +146,7 @@ public:
 
     // Get current pin state (for debugging)
     int getCurrentState() const {
-        return digitalRead(_pin);
+        return FastPin<PIN>::read() ? HIGH : LOW;
     }
 
     // Get time since last valid signal (ms) - for debugging
@@ -153,7 +155,6 @@ public:
     }
 
 private:
-    uint8_t _pin;
     float _dutyCycle;
     float _frequency;
     bool _signalValid;
@@ -161,3 +162,5 @@ private:
     unsigned long _pulsesDetected;
     bool _debugEnabled;
 };
+
+typedef PwmInputT<Config::PIN_PWM_INPUT> PwmInput;
@@ -0,0 +1,283 @@
+#pragma once
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include "Config.h"
+#include "CurrentSensor.h"
+#include "MapSensor.h"
+
+// -----------------------------------------------------------------------------
+// SensorCalibration - Zero/baseline calibration in the motor-OFF boot window
+// -----------------------------------------------------------------------------
+// With the motor OFF at a cold boot both ACS758 outputs sit at their 0 A
+// voltage and the MAP sensor reads barometric pressure (engine not running).
+// run() samples the three channels every CAL_SAMPLE_INTERVAL_US and keeps a
+// running mean and variance per channel (Welford: no sample buffer, no loss
+// of precision on a 2.5 V mean with millivolt spread). The hold-off ends as
+// soon as every channel has converged:
+//   - at least CAL_MIN_SAMPLES, all taken after CAL_SETTLE_MS
+//   - sample standard deviation below CAL_*_MAX_STDDEV (input not moving)
+//   - standard error of the mean below CAL_*_TOLERANCE
+//   - mean inside the plausible window (CAL_ACS_ZERO_*_V, CAL_BARO_*_BAR):
+//     rejects a loaded current sensor or an engine already running
+// or at CAL_MAX_MS. A channel that did not converge keeps its fallback: the
+// EEPROM record from an earlier boot, else the Config default.
+//
+// Converged values are stored in EEPROM (CRC-16) when they moved by more than
+// CAL_SAVE_DELTA_* from the record, so the record is rewritten only when the
+// board actually drifts. The warm-restart path (motor running, nothing to
+// measure) uses the record through begin().
+// -----------------------------------------------------------------------------
+
+class SensorCalibration {
+public:
+    enum Channel : uint8_t {
+        CH_CURRENT_1 = 0,
+        CH_CURRENT_2,
+        CH_BARO,
+        CH_COUNT
+    };
+
+    // Where a channel's value came from
+    enum Source : uint8_t {
+        SOURCE_DEFAULT = 0,  // Config (no valid EEPROM record)
+        SOURCE_EEPROM,       // Stored by an earlier boot
+        SOURCE_MEASURED      // Converged at this boot
+    };
+
+    SensorCalibration(CurrentSensor& curr1, CurrentSensor& curr2, MapSensor& map)
+        : _curr1(curr1)
+        , _curr2(curr2)
+        , _map(map)
+        , _samples(0)
+        , _durationMs(0)
+        , _recordValid(false)
+        , _saved(false)
+    {
+        memset(_stats, 0, sizeof(_stats));
+        memset(&_record, 0, sizeof(_record));
+        for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+            _value[ch] = defaultFor(ch);
+            _source[ch] = SOURCE_DEFAULT;
+        }
+    }
+
+    // Load the EEPROM record (or Config defaults) into the sensors - both boot
+    // paths, after the sensors' begin()
+    void begin() {
+        _recordValid = loadRecord(_record);
+        for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+            _value[ch] = _recordValid ? _record.value[ch] : defaultFor(ch);
+            _source[ch] = _recordValid ? SOURCE_EEPROM : SOURCE_DEFAULT;
+        }
+        apply();
+    }
+
+    // Motor-OFF hold-off: sample until every channel converged or CAL_MAX_MS.
+    // Blocking (cold boot only). Returns true if every channel converged.
+    bool run() {
+        memset(_stats, 0, sizeof(_stats));
+        _samples = 0;
+        _saved = false;
+
+        // COMPENSATED: millis() runs 8x faster, divide by prescaler factor for real time
+        unsigned long startMs = millis();
+        unsigned long elapsedMs = 0;
+        for (;;) {
+            elapsedMs = (unsigned long)(millis() - startMs) / Config::TIMER0_PRESCALER_FACTOR;
+            if (Config::ENABLE_BOOT_CALIBRATION && elapsedMs >= Config::CAL_SETTLE_MS) {
+                addSample(_stats[CH_CURRENT_1], _curr1.readVoltageRaw());
+                addSample(_stats[CH_CURRENT_2], _curr2.readVoltageRaw());
+                addSample(_stats[CH_BARO], _map.readAbsoluteBarRaw());
+                _samples++;
+                if (allConverged()) break;
+            }
+            if (elapsedMs >= Config::CAL_MAX_MS) break;
+            delayMicroseconds(Config::CAL_SAMPLE_INTERVAL_US);
+        }
+        _durationMs = elapsedMs;
+
+        // Rewrite the record if a measured value is new or moved past CAL_SAVE_DELTA_*
+        bool changed = false;
+        for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+            if (!isConverged(ch)) continue;
+            float measured = _stats[ch].mean;
+            if (ch != CH_BARO) measured += Config::CAL_ACS_ZERO_CORRECTION_V;
+            _value[ch] = measured;
+            _source[ch] = SOURCE_MEASURED;
+            if (!_recordValid || fabs(measured - _record.value[ch]) > saveDeltaFor(ch)) {
+                changed = true;
+            }
+        }
+        apply();
+        if (changed) {
+            saveRecord();
+        }
+        return allConverged();
+    }
+
+    // Value in use (ACS zero in V, barometric pressure in bar absolute)
+    float getValue(uint8_t ch) const { return (ch < CH_COUNT) ? _value[ch] : 0.0f; }
+    Source getSource(uint8_t ch) const { return (ch < CH_COUNT) ? _source[ch] : SOURCE_DEFAULT; }
+    // Sample standard deviation at the end of run() (V or bar)
+    float getStdDev(uint8_t ch) const { return (ch < CH_COUNT) ? sqrtf(variance(_stats[ch])) : 0.0f; }
+    // Channel met every convergence condition in run()
+    bool isConverged(uint8_t ch) const {
+        if (ch >= CH_COUNT || _stats[ch].n < Config::CAL_MIN_SAMPLES) return false;
+        const Stats& s = _stats[ch];
+        float var = variance(s);
+        bool baro = (ch == CH_BARO);
+        float maxStd = baro ? Config::CAL_BARO_MAX_STDDEV_BAR : Config::CAL_ACS_MAX_STDDEV_V;
+        float tol = baro ? Config::CAL_BARO_TOLERANCE_BAR : Config::CAL_ACS_TOLERANCE_V;
+        float lo = baro ? Config::CAL_BARO_MIN_BAR : Config::CAL_ACS_ZERO_MIN_V;
+        float hi = baro ? Config::CAL_BARO_MAX_BAR : Config::CAL_ACS_ZERO_MAX_V;
+        return var <= maxStd * maxStd && var / s.n <= tol * tol && s.mean >= lo && s.mean <= hi;
+    }
+    // Sample sets taken / length of the hold-off (real ms)
+    uint16_t getSamples() const { return _samples; }
+    unsigned long getDurationMs() const { return _durationMs; }
+    // EEPROM record rewritten by run() / record writes over the board's life
+    bool wasSaved() const { return _saved; }
+    uint16_t getSaveCount() const { return _recordValid ? _record.saves : 0; }
+
+    static const char* getSourceString(Source source) {
+        switch (source) {
+            case SOURCE_MEASURED: return "measured";
+            case SOURCE_EEPROM:   return "EEPROM";
+            default:              return "default";
+        }
+    }
+
+    // One line per channel (setup)
+    void printSummary() const {
+        Serial.print(F("[CAL] "));
+        if (!Config::ENABLE_BOOT_CALIBRATION) {
+            Serial.print(F("disabled, fixed hold-off "));
+        } else if (allConverged()) {
+            Serial.print(F("converged in "));
+        } else {
+            Serial.print(F("TIMEOUT after "));
+        }
+        Serial.print(_durationMs);
+        Serial.print(F(" ms, "));
+        Serial.print(_samples);
+        Serial.print(_saved ? F(" samples, EEPROM updated") : F(" samples"));
+        Serial.println();
+        for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+            Serial.print(ch == CH_CURRENT_1 ? F("[CAL]   I1 zero: ")
+                         : ch == CH_CURRENT_2 ? F("[CAL]   I2 zero: ")
+                                              : F("[CAL]   Baro:    "));
+            Serial.print(_value[ch], 4);
+            Serial.print(ch == CH_BARO ? F(" bar (") : F(" V ("));
+            Serial.print(getSourceString(_source[ch]));
+            if (_stats[ch].n > 1) {
+                Serial.print(F(", sd "));
+                Serial.print(getStdDev(ch) * 1000.0f, 2);
+                Serial.print(ch == CH_BARO ? F(" mbar") : F(" mV"));
+            }
+            Serial.println(F(")"));
+        }
+    }
+
+private:
+    static const uint16_t MAGIC = 0x4341;  // "CA"
+    static const uint8_t VERSION = 1;
+
+    struct Stats {
+        uint16_t n;
+        float mean;
+        float m2;  // Sum of squared deviations from the running mean
+    };
+
+    struct Record {
+        uint16_t magic;
+        uint8_t version;
+        float value[CH_COUNT];
+        uint16_t saves;
+        uint16_t crc;  // CRC-16 of everything above
+    };
+
+    CurrentSensor& _curr1;
+    CurrentSensor& _curr2;
+    MapSensor& _map;
+    Stats _stats[CH_COUNT];
+    float _value[CH_COUNT];
+    Source _source[CH_COUNT];
+    uint16_t _samples;
+    unsigned long _durationMs;
+    Record _record;
+    bool _recordValid;
+    bool _saved;
+
+    // Welford update
+    static void addSample(Stats& s, float x) {
+        s.n++;
+        float delta = x - s.mean;
+        s.mean += delta / s.n;
+        s.m2 += delta * (x - s.mean);
+    }
+
+    static float variance(const Stats& s) {
+        return (s.n > 1) ? s.m2 / (s.n - 1) : 0.0f;
+    }
+
+    bool allConverged() const {
+        for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+            if (!isConverged(ch)) return false;
+        }
+        return true;
+    }
+
+    static float defaultFor(uint8_t ch) {
+        return (ch == CH_BARO) ? Config::ATMOSPHERIC_PRESSURE_BAR : Config::ACS758_ZERO_CURRENT_V;
+    }
+
+    static float saveDeltaFor(uint8_t ch) {
+        return (ch == CH_BARO) ? Config::CAL_SAVE_DELTA_BAR : Config::CAL_SAVE_DELTA_V;
+    }
+
+    void apply() {
+        _curr1.setZeroVoltage(_value[CH_CURRENT_1]);
+        _curr2.setZeroVoltage(_value[CH_CURRENT_2]);
+        _map.setAtmosphericBar(_value[CH_BARO]);
+    }
+
+    static uint16_t crcOf(const Record& r) {
+        const uint8_t* p = (const uint8_t*)&r;
+        uint16_t crc = 0xFFFF;
+        for (uint8_t i = 0; i < offsetof(Record, crc); i++) {
+            crc = _crc16_update(crc, p[i]);
+        }
+        return crc;
+    }
+
+    static bool loadRecord(Record& r) {
+        eeprom_read_block(&r, (const void*)(uintptr_t)Config::EEPROM_CALIBRATION_ADDR, sizeof(r));
+        if (r.magic != MAGIC || r.version != VERSION || r.crc != crcOf(r)) return false;
+        // A record outside the windows (older firmware, corrupted but CRC-valid) is not used
+        for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+            bool baro = (ch == CH_BARO);
+            float lo = baro ? Config::CAL_BARO_MIN_BAR : Config::CAL_ACS_ZERO_MIN_V + Config::CAL_ACS_ZERO_CORRECTION_V;
+            float hi = baro ? Config::CAL_BARO_MAX_BAR : Config::CAL_ACS_ZERO_MAX_V + Config::CAL_ACS_ZERO_CORRECTION_V;
+            if (!(r.value[ch] >= lo && r.value[ch] <= hi)) return false;
+        }
+        return true;
+    }
+
+    // Channels that did not converge keep the value in use (EEPROM or default)
+    void saveRecord() {
+        Record r;
+        r.magic = MAGIC;
+        r.version = VERSION;
+        for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+            r.value[ch] = _value[ch];
+        }
+        r.saves = (uint16_t)((_recordValid ? _record.saves : 0) + 1);
+        r.crc = crcOf(r);
+        // eeprom_update_block() skips bytes that already hold the value
+        eeprom_update_block(&r, (void*)(uintptr_t)Config::EEPROM_CALIBRATION_ADDR, sizeof(r));
+        _record = r;
+        _recordValid = true;
+        _saved = true;
+    }
+};
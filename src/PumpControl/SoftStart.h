@@ -0,0 +1,129 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "CurrentSensor.h"
+
+// -----------------------------------------------------------------------------
+// SoftStart - Inrush-managed pump spin-up
+// -----------------------------------------------------------------------------
+// Whenever the output has been forced to 0 (boot hold-off, EMERGENCY, external
+// safety) the next rise is ramped instead of stepping straight to the target
+// (>= OUTPUT_PERCENT_MIN = 50%). The ramp is a duty CEILING applied on top of
+// PowerOutputs, so it works the same for every source and output mode.
+//
+// Adaptive slope:
+//   - Inrush is sampled every SOFTSTART_STEP_INTERVAL_MS with a short unfiltered
+//     average (the 0.5s protection EMA would hide the spike)
+//   - Above budget (SOFTSTART_INRUSH_FRACTION x CURRENT_THRESHOLD_FAULT):
+//     ceiling holds and slope is halved
+//   - Comfortably below budget: slope grows back towards SOFTSTART_SLOPE_MAX
+// So the pump reaches target flow as fast as the current budget allows.
+//
+// The ramp ends when the ceiling reaches the requested duty, or after
+// SOFTSTART_TIMEOUT_MS at the latest (pump cannot be starved indefinitely).
+// -----------------------------------------------------------------------------
+
+class SoftStart {
+public:
+    SoftStart(CurrentSensor& sensor1, CurrentSensor& sensor2)
+        : _sensor1(sensor1)
+        , _sensor2(sensor2)
+        , _active(false)
+        , _ceiling(1.0f)
+        , _slope(Config::SOFTSTART_SLOPE_INITIAL)
+        , _peakCurrent(0.0f)
+        , _running(false)
+        , _startMs(0)
+        , _lastStepMs(0)
+    {}
+
+    void begin() {
+        restart();
+    }
+
+    // Output was forced to 0 - arm the ramp for the next rise
+    void restart() {
+        if (!Config::ENABLE_SOFT_START) return;
+        _active = true;
+        _ceiling = Config::SOFTSTART_INITIAL_DUTY;
+        _slope = Config::SOFTSTART_SLOPE_INITIAL;
+        _peakCurrent = 0.0f;
+        _running = false;      // Armed; timer starts on first non-zero request
+        _lastStepMs = millis();
+    }
+
+    // Advance the ramp one step and return the new duty ceiling (0.0 to 1.0)
+    // requestedDuty: duty the active mode wants, before the ceiling
+    float service(float requestedDuty) {
+        if (!_active) return 1.0f;
+
+        unsigned long now = millis();
+        // Real seconds: the exact Timer 0 ratio, not MILLIS_COMPENSATED's 8x
+        float dt = (float)(unsigned long)(now - _lastStepMs) * Config::REAL_S_PER_MILLIS;
+        _lastStepMs = now;
+
+        // Output still held at 0 (safety/EMERGENCY/boot): stay armed, don't ramp
+        if (requestedDuty <= 0.0f) {
+            return _ceiling;
+        }
+        if (!_running) {
+            // Ramp starts now: the time spent held at 0 is not a ramp step
+            _running = true;
+            _startMs = now;
+            dt = 0.0f;
+        }
+
+        float current = max(_sensor1.readCurrentFastA(), _sensor2.readCurrentFastA());
+        if (current > _peakCurrent) _peakCurrent = current;
+
+        const float budget = Config::SOFTSTART_INRUSH_FRACTION * Config::CURRENT_THRESHOLD_FAULT;
+        if (current > budget) {
+            // Over budget: hold the ceiling and back off the slope
+            _slope *= 0.5f;
+            if (_slope < Config::SOFTSTART_SLOPE_MIN) _slope = Config::SOFTSTART_SLOPE_MIN;
+        } else {
+            if (current < budget * Config::SOFTSTART_SLOPE_UP_MARGIN) {
+                _slope *= 1.25f;
+                if (_slope > Config::SOFTSTART_SLOPE_MAX) _slope = Config::SOFTSTART_SLOPE_MAX;
+            }
+            _ceiling += _slope * dt;
+        }
+
+        bool reached = (_ceiling >= requestedDuty);
+        bool timedOut = (unsigned long)(now - _startMs) >= MILLIS_COMPENSATED(Config::SOFTSTART_TIMEOUT_MS);
+        if (reached || timedOut) {
+            _active = false;
+            _ceiling = 1.0f;
+        }
+        return _ceiling;
+    }
+
+    bool isActive() const {
+        return _active;
+    }
+
+    float getCeiling() const {
+        return _ceiling;
+    }
+
+    // Current slope (duty per second)
+    float getSlope() const {
+        return _slope;
+    }
+
+    // Highest inrush current seen during the last ramp (A)
+    float getPeakCurrent() const {
+        return _peakCurrent;
+    }
+
+private:
+    CurrentSensor& _sensor1;
+    CurrentSensor& _sensor2;
+    bool _active;
+    float _ceiling;              // Duty ceiling handed to PowerOutputs
+    float _slope;                // Duty per second
+    float _peakCurrent;          // Peak inrush during last ramp (A)
+    bool _running;               // false = armed, waiting for a non-zero request
+    unsigned long _startMs;      // First non-zero request of this ramp
+    unsigned long _lastStepMs;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <Arduino.h>
+
+// -----------------------------------------------------------------------------
+// SpscRing - Lock-free single-producer / single-consumer ring buffer
+// -----------------------------------------------------------------------------
+// For ISR <-> main loop hand-off without disabling interrupts:
+//   - Producer only writes _head, consumer only writes _tail
+//   - Indexes are uint8_t: loads/stores are atomic on AVR
+//   - Compiler barrier orders the slot copy before the index publish
+// N must be a power of two; one slot is kept empty (capacity = N - 1).
+// -----------------------------------------------------------------------------
+
+template <typename T, uint8_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    SpscRing() : _head(0), _tail(0) {}
+
+    // Producer side. Returns false if full (item dropped).
+    bool push(const T& item) {
+        uint8_t head = _head;
+        uint8_t next = (uint8_t)((head + 1) & (N - 1));
+        if (next == _tail) return false;
+        _buf[head] = item;
+        __asm__ __volatile__("" ::: "memory");
+        _head = next;
+        return true;
+    }
+
+    // Consumer side. Returns false if empty.
+    bool pop(T& item) {
+        uint8_t tail = _tail;
+        if (tail == _head) return false;
+        item = _buf[tail];
+        __asm__ __volatile__("" ::: "memory");
+        _tail = (uint8_t)((tail + 1) & (N - 1));
+        return true;
+    }
+
+    bool isEmpty() const {
+        return _head == _tail;
+    }
+
+    uint8_t count() const {
+        return (uint8_t)((_head - _tail) & (N - 1));
+    }
+
+    static uint8_t capacity() {
+        return N - 1;
+    }
+
+private:
+    volatile uint8_t _head;  // Next slot to write (producer)
+    volatile uint8_t _tail;  // Next slot to read (consumer)
+    T _buf[N];
+};
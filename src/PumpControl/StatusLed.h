@@ -1,129 +1,192 @@
 #pragma once
 #include <Arduino.h>
-#include <Adafruit_NeoPixel.h>
+#include <avr/pgmspace.h>
 #include "Config.h"
+#include "Ws2812.h"
 
 // -----------------------------------------------------------------------------
-// StatusLed - Controle de LED NeoPixel para indica��o visual de corrente
-// 
-// NORMAL (0-40A):   Verde sólido com gradiente verde->vermelho conforme corrente sobe
-// FAULT (>40A):     Pisca vermelho (1Hz)
-// EMERGENCY (>45A): Pisca vermelho rápido (5Hz)
-// 
-// A cor do LED permite identificar visualmente o n�vel de corrente e 
-// comportamento da prote��o sem precisar do monitor serial
+// StatusLed - LED WS2812 para indicação visual de corrente e proteção
+//
+// NORMAL (0-40A):   gradiente verde -> amarelo -> vermelho conforme a corrente
+// FAULT (>40A):     pisca vermelho (1Hz)
+// EMERGENCY (>45A): pisca vermelho rápido (5Hz)
+// External safety:  pisca azul (2Hz)
+//
+// Padrões declarativos (tabela PATTERNS): cor, meio período do pisca (0 = fixo)
+// ou gradiente. O tick de controle só escolhe o padrão e o nível de corrente;
+// service() (a cada passada do loop) calcula a cor, grava no buffer do Ws2812
+// (que só fica "sujo" se algum byte mudar) e envia o quadro numa janela:
+//   - no máximo um quadro a cada STATUS_LED_FRAME_INTERVAL_MS
+//   - só com a linha INT do MCP2515 inativa (quiet), ou depois de
+//     STATUS_LED_MAX_DEFER_MS esperando
+// Cor inalterada = nenhum envio, nenhuma interrupção desligada.
+// Com STATUS_LED_COUNT > 1 todos os LEDs mostram a mesma cor; as interrupções
+// ficam desligadas pelo quadro inteiro (30 µs por LED, no máximo 4 = 120 µs,
+// abaixo do overrun da RX serial; compromisso aceito, ver Ws2812.h).
 // -----------------------------------------------------------------------------
 class StatusLed {
 public:
-    explicit StatusLed(uint8_t pin, uint16_t numPixels = 1)
-        : _strip(numPixels, pin, NEO_GRB + NEO_KHZ800)
-        , _blinkState(false)
-        , _lastBlinkMs(0) {}
+    enum Pattern : uint8_t {
+        PATTERN_OFF,
+        PATTERN_CURRENT,    // Gradiente pelo nível de corrente
+        PATTERN_FAULT,
+        PATTERN_EMERGENCY,
+        PATTERN_SAFETY,     // External safety ativo
+        PATTERN_COUNT
+    };
+
+    StatusLed()
+        : _pattern(PATTERN_OFF)
+        , _level(0)
+        , _blinkOn(true)
+        , _newPattern(false)
+        , _phaseStartMs(0)
+        , _lastShowMs(0)
+        , _dirtySinceMs(0)
+        , _color(0) {}
 
     void begin() {
         _strip.begin();
-        _strip.setBrightness(Config::LED_BRIGHTNESS);
-        _strip.show(); // Initialize all pixels to 'off'
-        _lastBlinkMs = millis();
+        _strip.show(); // Todos os pixels apagados
+        _lastShowMs = millis();
+    }
+
+    // Troca de padrão reinicia o pisca (começa aceso no próximo service())
+    void setPattern(Pattern pattern) {
+        if (pattern == _pattern) return;
+        _pattern = pattern;
+        _blinkOn = true;
+        _newPattern = true;
+    }
+
+    // Posição no gradiente de PATTERN_CURRENT: 0 = verde, 255 = vermelho
+    void setLevel(uint8_t level) {
+        _level = level;
     }
 
-    // Atualiza LED para indicar desligamento por external safety
-    // Pisca azul em 2Hz (250ms ON/OFF)
+    // Desligamento por external safety: pisca azul
     void updateExternalSafetyBlink() {
-        unsigned long now = millis();
-        unsigned long blinkInterval = MILLIS_COMPENSATED(250); // 250ms com compensa��o (2Hz)
-        
-        if ((unsigned long)(now - _lastBlinkMs) >= blinkInterval) {
-            _lastBlinkMs = now;
-            _blinkState = !_blinkState;
-            
-            if (_blinkState) {
-                setColor(0, 0, 255); // Azul brilhante
-            } else {
-                setColor(0, 0, 0);   // Apagado
-            }
-        }
+        setPattern(PATTERN_SAFETY);
     }
-    
-    // Atualiza a cor do LED baseado na corrente
+
+    // Padrão a partir da proteção de corrente (chamado no tick de controle)
     // current: corrente atual em Amperes
-    // inFault: true se estiver em n�vel FAULT
-    // inEmergency: true se estiver em n�vel EMERGENCY
+    // inFault / inEmergency: nível atual da PowerProtection
     void updateFromCurrent(float current, bool inFault, bool inEmergency) {
-        unsigned long now = millis();
-        
-        // EMERGENCY: Pisca vermelho r�pido (5Hz = 200ms per�odo = 100ms ON/OFF)
         if (inEmergency) {
-            unsigned long blinkInterval = MILLIS_COMPENSATED(100); // 100ms com compensa��o
-            if ((unsigned long)(now - _lastBlinkMs) >= blinkInterval) {
-                _lastBlinkMs = now;
-                _blinkState = !_blinkState;
-                
-                if (_blinkState) {
-                    setColor(255, 0, 0); // Vermelho brilhante
-                } else {
-                    setColor(0, 0, 0);   // Apagado
-                }
-            }
+            setPattern(PATTERN_EMERGENCY);
             return;
         }
-        
-        // FAULT: Pisca vermelho lento (1Hz = 1000ms per�odo = 500ms ON/OFF)
         if (inFault) {
-            unsigned long blinkInterval = MILLIS_COMPENSATED(500); // 500ms com compensa��o
-            if ((unsigned long)(now - _lastBlinkMs) >= blinkInterval) {
-                _lastBlinkMs = now;
-                _blinkState = !_blinkState;
-                
-                if (_blinkState) {
-                    setColor(255, 0, 0); // Vermelho
-                } else {
-                    setColor(0, 0, 0);   // Apagado
-                }
-            }
+            setPattern(PATTERN_FAULT);
             return;
         }
-        
-        // NORMAL: gradiente verde->vermelho de 0A até FAULT
-        uint8_t red, green, blue;
 
         float ratio = current / Config::CURRENT_THRESHOLD_FAULT; // 0..1
         if (ratio < 0.0f) ratio = 0.0f;
         if (ratio > 1.0f) ratio = 1.0f;
+        setLevel((uint8_t)(ratio * 255.0f));
+        setPattern(PATTERN_CURRENT);
+    }
 
-        // Interpolação: 0A = Verde (0,255,0) -> FAULT = Vermelho (255,0,0)
-        // Passa por amarelo no meio
-        if (ratio <= 0.5f) {
-            float subRatio = ratio * 2.0f;
-            red = (uint8_t)(subRatio * 255.0f);
-            green = 255;
-            blue = 0;
+    // Desliga o LED
+    void off() {
+        setPattern(PATTERN_OFF);
+    }
+
+    // A cada passada do loop. quiet: nenhuma interrupção crítica pendente
+    // (linha INT do CAN inativa) - o quadro só sai nessas janelas
+    void service(unsigned long now, bool quiet) {
+        PatternDef def;
+        memcpy_P(&def, &PATTERNS()[_pattern], sizeof(def));
+
+        if (_newPattern) {
+            _newPattern = false;
+            _phaseStartMs = now;
+        } else if (def.halfPeriodMs != 0) {
+            unsigned long half = MILLIS_COMPENSATED((unsigned long)def.halfPeriodMs);
+            unsigned long elapsed = now - _phaseStartMs;
+            if (elapsed >= half) {
+                // Sem deriva; atrasado mais de um meio período: recomeça a fase
+                _phaseStartMs = (elapsed < 2 * half) ? _phaseStartMs + half : now;
+                _blinkOn = !_blinkOn;
+            }
+        }
+
+        uint32_t color;
+        if (def.gradient) {
+            color = gradient(_level);
         } else {
-            float subRatio = (ratio - 0.5f) * 2.0f;
-            red = 255;
-            green = (uint8_t)((1.0f - subRatio) * 255.0f);
-            blue = 0;
+            color = (_blinkOn || def.halfPeriodMs == 0) ? def.color : 0;
         }
-        
-        setColor(red, green, blue);
-    }
 
-    // Define cor espec�fica RGB (0-255)
-    void setColor(uint8_t red, uint8_t green, uint8_t blue) {
-        uint32_t color = _strip.Color(red, green, blue);
-        for(uint16_t i = 0; i < _strip.numPixels(); i++) {
-            _strip.setPixelColor(i, color);
+        if (color != _color) {
+            _color = color;
+            bool wasDirty = _strip.isDirty();
+            if (_strip.setAll((uint8_t)(color >> 16), (uint8_t)(color >> 8), (uint8_t)color) && !wasDirty) {
+                _dirtySinceMs = now;
+            }
         }
-        _strip.show();
+        if (!_strip.isDirty()) return;
+
+        // Janela de envio: intervalo mínimo entre quadros, linha CAN quieta
+        // (ou espera máxima esgotada)
+        if ((unsigned long)(now - _lastShowMs) < MILLIS_COMPENSATED(Config::STATUS_LED_FRAME_INTERVAL_MS)) return;
+        if (!quiet && (unsigned long)(now - _dirtySinceMs) < MILLIS_COMPENSATED(Config::STATUS_LED_MAX_DEFER_MS)) return;
+        _lastShowMs = now;
+        _strip.show();  // Cortado por um pedido CAN: continua sujo, sai no próximo quadro
     }
 
-    // Desliga o LED
-    void off() {
-        setColor(0, 0, 0);
+    Pattern getPattern() const { return _pattern; }
+
+    // Cor atual (0xRRGGBB, antes do brilho)
+    uint32_t getColor() const {
+        return _color;
     }
 
+    // Estatísticas do driver
+    uint16_t getFrameCount() const { return _strip.getFrameCount(); }
+    uint16_t getAbortCount() const { return _strip.getAbortCount(); }
+
 private:
-    Adafruit_NeoPixel _strip;
-    bool _blinkState;              // Estado atual do pisca (ON/OFF)
-    unsigned long _lastBlinkMs;    // �ltimo momento de mudan�a de estado do pisca
+    struct PatternDef {
+        uint32_t color;         // 0xRRGGBB (aceso)
+        uint16_t halfPeriodMs;  // Meio período do pisca, 0 = fixo
+        bool gradient;          // Cor pelo nível de corrente (ignora color)
+    };
+
+    // Uma linha por Pattern, na ordem do enum (flash)
+    static const PatternDef* PATTERNS() {
+        static const PatternDef table[PATTERN_COUNT] PROGMEM = {
+            { 0x000000UL,   0, false },  // OFF
+            { 0x000000UL,   0, true  },  // CURRENT: verde -> amarelo -> vermelho
+            { 0xFF0000UL, 500, false },  // FAULT: vermelho 1Hz
+            { 0xFF0000UL, 100, false },  // EMERGENCY: vermelho 5Hz
+            { 0x0000FFUL, 250, false },  // SAFETY: azul 2Hz
+        };
+        return table;
+    }
+
+    // 0 = verde (0,255,0), 128 = amarelo, 255 = vermelho (255,0,0)
+    static uint32_t gradient(uint8_t level) {
+        uint8_t red, green;
+        if (level < 128) {
+            red = (uint8_t)(level * 2);
+            green = 255;
+        } else {
+            red = 255;
+            green = (uint8_t)((255 - level) * 2);
+        }
+        return ((uint32_t)red << 16) | ((uint32_t)green << 8);
+    }
+
+    Ws2812<Config::PIN_STATUS_LED, Config::STATUS_LED_COUNT, Config::LED_BRIGHTNESS> _strip;
+    Pattern _pattern;
+    uint8_t _level;
+    bool _blinkOn;                 // Estado atual do pisca (ON/OFF)
+    bool _newPattern;              // Fase do pisca começa no próximo service()
+    unsigned long _phaseStartMs;   // Última mudança de estado do pisca
+    unsigned long _lastShowMs;     // Último quadro enviado (ou tentado)
+    unsigned long _dirtySinceMs;   // Quadro pendente desde
+    uint32_t _color;
 };
@@ -2,6 +2,8 @@
 #include <Arduino.h>
 #include <math.h>
 #include "Config.h"
+#include "Adc.h"
+#include "Filters.h"
 
 // -----------------------------------------------------------------------------
 // TempSensor - Heatsink temperature via NTC 10K thermistor
@@ -14,7 +16,11 @@
 //   1/T = 1/T25 + (1/B) * ln(R_NTC / R25)
 //   T_celsius = T_kelvin - 273.15
 //
-// Monitoring only - no protection logic.
+// No protection logic here: ThermalModel reads this every control tick to
+// estimate junction temperatures and derate the output.
+//
+// update() adds one conversion to a moving average over TEMP_FILTER_WINDOW_S
+// (once per control tick) and converts the mean; readers get that value.
 // -----------------------------------------------------------------------------
 
 class TempSensor {
@@ -22,29 +28,19 @@ public:
     explicit TempSensor(uint8_t pin)
         : _pin(pin)
         , _filteredTempC(25.0f)
-        , _initialized(false)
     {}
 
     void begin() {
         pinMode(_pin, INPUT);
-        int adc = analogRead(_pin);
+        uint16_t adc = Adc::read(_pin);
+        _filter.reset(adc);
         _filteredTempC = adcToCelsius(adc);
-        _initialized = true;
     }
 
-    // Returns heatsink temperature in Celsius (with EMA filtering)
-    float readTemperatureC() {
-        int adc = analogRead(_pin);
-        float tempC = adcToCelsius(adc);
-
-        if (_initialized) {
-            _filteredTempC = (Config::TEMP_FILTER_ALPHA * tempC) +
-                             ((1.0f - Config::TEMP_FILTER_ALPHA) * _filteredTempC);
-        } else {
-            _filteredTempC = tempC;
-            _initialized = true;
-        }
-        return _filteredTempC;
+    // New conversion into the moving average - once per control tick
+    void update() {
+        _filter.update(Adc::read(_pin));
+        _filteredTempC = adcToCelsius(_filter.get());
     }
 
     float getFilteredTemperatureC() const {
@@ -56,22 +52,27 @@ public:
         return _filteredTempC > -40.0f && _filteredTempC < 150.0f;
     }
 
-private:
-    uint8_t _pin;
-    float _filteredTempC;
-    bool _initialized;
-
-    float adcToCelsius(int adc) const {
+    // Beta equation on an ADC reading (0..1023, fractional counts from the
+    // average allowed); public for tools/bench
+    static float adcToCelsius(float adc) {
         // Guard against open/shorted sensor (avoid div-by-zero / log(0))
         if (adc <= 0)    return 150.0f;   // NTC shorted -> very high temp reading
         if (adc >= 1023) return -40.0f;   // NTC open    -> very low  temp reading
 
         // Divider supply and ADC reference are the same +5V rail -> cancels out
-        float rNtc = Config::NTC_R_PULLUP * (float)adc / (float)(1023 - adc);
+        float rNtc = Config::NTC_R_PULLUP * adc / (1023.0f - adc);
 
         float invT = (1.0f / Config::NTC_T25_KELVIN) +
                      (1.0f / Config::NTC_BETA) * log(rNtc / Config::NTC_R25);
         float tKelvin = 1.0f / invT;
         return tKelvin - 273.15f;
     }
+
+private:
+    static constexpr uint8_t AVERAGE_SAMPLES =
+        (uint8_t)(Config::TEMP_FILTER_WINDOW_S * Config::SENSOR_SAMPLE_HZ + 0.5f);
+
+    uint8_t _pin;
+    Filters::MovingAverage<uint16_t, AVERAGE_SAMPLES> _filter;
+    float _filteredTempC;  // Mean converted once per update()
 };
@@ -0,0 +1,144 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "TempSensor.h"
+
+// -----------------------------------------------------------------------------
+// ThermalModel - Junction temperature estimate and progressive derating
+// -----------------------------------------------------------------------------
+// The heatsink NTC only sees the slow, averaged temperature of the whole
+// heatsink. The dies sit above it by (power loss x thermal resistance) and get
+// there with a short time constant. Per channel this model estimates:
+//
+//   MOSFET (IRFB3077, low-side switch) - conduction loss while ON:
+//     Rds(Tj) = RDS_ON_25C * (1 + RDS_TEMPCO * (Tj - 25))
+//     P_mos   = I^2 * Rds(Tj) * D
+//
+//   Freewheel diode (MBR30100) - conducts the load current while OFF:
+//     P_diode = Vf * I * (1 - D)
+//
+//   First-order thermal RC to the measured heatsink:
+//     Tj += dt/tau * (T_heatsink + P * Rth - Tj)
+//
+// Derating: the voltage limit falls linearly from 100% at THERMAL_DERATE_START
+// to THERMAL_DERATE_MIN at the device limit, for whichever device is hottest.
+// This lets the output run up to the real envelope instead of relying only on
+// fixed current thresholds.
+//
+// Switching losses are ignored (3.9 kHz, slow gate edges are already covered
+// by the conservative Rth values in Config).
+// -----------------------------------------------------------------------------
+
+class ThermalModel {
+public:
+    explicit ThermalModel(TempSensor& sensor)
+        : _sensor(sensor)
+        , _heatsinkC(25.0f)
+        , _derateLimit(1.0f)
+        , _lastUpdateMs(0)
+    {
+        for (uint8_t ch = 0; ch < 2; ch++) {
+            _mosfetC[ch] = 25.0f;
+            _diodeC[ch] = 25.0f;
+        }
+    }
+
+    void begin() {
+        // Dies start at heatsink temperature (no load during boot)
+        _heatsinkC = readHeatsinkC();
+        for (uint8_t ch = 0; ch < 2; ch++) {
+            _mosfetC[ch] = _heatsinkC;
+            _diodeC[ch] = _heatsinkC;
+        }
+        _derateLimit = 1.0f;
+        _lastUpdateMs = millis();
+    }
+
+    // Advance the model one step and return the derating factor (0.0 to 1.0)
+    // current1/current2: per-channel load current (A)
+    // duty: applied MOSFET duty cycle (0.0 to 1.0), after all limits
+    float update(float current1, float current2, float duty) {
+        unsigned long now = millis();
+        // Real seconds: the exact Timer 0 ratio, not MILLIS_COMPENSATED's 8x
+        float dt = (float)(unsigned long)(now - _lastUpdateMs) * Config::REAL_S_PER_MILLIS;
+        _lastUpdateMs = now;
+        if (dt > Config::THERMAL_MAX_STEP_S) dt = Config::THERMAL_MAX_STEP_S;
+
+        if (duty < 0.0f) duty = 0.0f;
+        if (duty > 1.0f) duty = 1.0f;
+
+        _heatsinkC = readHeatsinkC();
+
+        const float currents[2] = { current1, current2 };
+        float limit = 1.0f;
+        for (uint8_t ch = 0; ch < 2; ch++) {
+            float i = currents[ch];
+
+            float rds = Config::MOSFET_RDS_ON_25C *
+                        (1.0f + Config::MOSFET_RDS_TEMPCO * (_mosfetC[ch] - 25.0f));
+            float pMos = i * i * rds * duty;
+            float pDiode = Config::DIODE_VF * i * (1.0f - duty);
+
+            _mosfetC[ch] = stepRc(_mosfetC[ch], pMos, Config::MOSFET_RTH_JH, Config::MOSFET_TAU_S, dt);
+            _diodeC[ch] = stepRc(_diodeC[ch], pDiode, Config::DIODE_RTH_JH, Config::DIODE_TAU_S, dt);
+
+            limit = min(limit, derateFor(_mosfetC[ch], Config::MOSFET_DERATE_START_C, Config::MOSFET_TJ_LIMIT_C));
+            limit = min(limit, derateFor(_diodeC[ch], Config::DIODE_DERATE_START_C, Config::DIODE_TJ_LIMIT_C));
+        }
+
+        _derateLimit = limit;
+        return _derateLimit;
+    }
+
+    // Get last derating factor (0.0 to 1.0)
+    float getDerateLimit() const {
+        return _derateLimit;
+    }
+
+    // Estimated MOSFET junction temperature for channel 0/1 (Celsius)
+    float getMosfetTempC(uint8_t channel) const {
+        return (channel < 2) ? _mosfetC[channel] : 0.0f;
+    }
+
+    // Estimated freewheel diode junction temperature for channel 0/1 (Celsius)
+    float getDiodeTempC(uint8_t channel) const {
+        return (channel < 2) ? _diodeC[channel] : 0.0f;
+    }
+
+    // Heatsink temperature used by the model (Celsius, fallback applied)
+    float getHeatsinkC() const {
+        return _heatsinkC;
+    }
+
+    bool isDerating() const {
+        return _derateLimit < 1.0f;
+    }
+
+private:
+    TempSensor& _sensor;
+    float _heatsinkC;
+    float _mosfetC[2];
+    float _diodeC[2];
+    float _derateLimit;
+    unsigned long _lastUpdateMs;
+
+    // Open/shorted NTC must not hide a hot heatsink: assume a hot one instead
+    float readHeatsinkC() {
+        float t = _sensor.getFilteredTemperatureC();
+        return _sensor.isSensorOk() ? t : Config::THERMAL_FALLBACK_HEATSINK_C;
+    }
+
+    float stepRc(float tj, float power, float rth, float tau, float dt) const {
+        float steady = _heatsinkC + power * rth;
+        float k = dt / tau;
+        if (k > 1.0f) k = 1.0f;
+        return tj + k * (steady - tj);
+    }
+
+    static float derateFor(float tj, float startC, float limitC) {
+        if (tj <= startC) return 1.0f;
+        if (tj >= limitC) return Config::THERMAL_DERATE_MIN;
+        float ratio = (tj - startC) / (limitC - startC);  // 0..1
+        return 1.0f - ratio * (1.0f - Config::THERMAL_DERATE_MIN);
+    }
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <Arduino.h>
+
+// -----------------------------------------------------------------------------
+// Timer1Clock - Monotonic 0.5us time base from Timer 1
+// -----------------------------------------------------------------------------
+// Timer 0 runs phase-correct for the power PWM: TCNT0 counts up and back down
+// every 255us, while the core's micros() returns (overflows * 256 + TCNT0) * 4.
+// micros() therefore steps backwards in the down-count half of each period,
+// and a micros() difference over less than one overflow can be negative.
+// Short intervals (sleep, SPI transactions, ISR time, input-to-output
+// latency, engine edges) are timed here instead.
+//
+// Timer 1 is otherwise unused (D9 is the CAN CS, D10 a plain pin): normal
+// mode at clk/8, 2 counts per us, free running. ticks16() is enough for
+// intervals below 32.8 ms and needs no interrupt. now() is extended to
+// 32 bits (35.8 min) by the overflow interrupt (TIMER1_OVF_vect in
+// PumpControl.ino calls onOverflow()).
+// -----------------------------------------------------------------------------
+
+class Timer1Clock {
+public:
+    static const uint8_t COUNTS_PER_US = 2;
+
+    // Both boot paths, before anything is timed
+    static void begin() {
+        uint8_t sreg = SREG;
+        cli();
+        TCCR1A = 0;
+        TCCR1B = _BV(CS11);  // Normal mode, clk/8
+        TCNT1 = 0;
+        overflows() = 0;
+        TIFR1 = _BV(TOV1);
+        TIMSK1 = _BV(TOIE1);
+        SREG = sreg;
+    }
+
+    // TIMER1_OVF_vect
+    static void onOverflow() {
+        overflows() = overflows() + 1;
+    }
+
+    // Low 16 bits of the count; differences are valid up to 32.8 ms
+    static uint16_t ticks16() {
+        uint8_t sreg = SREG;
+        cli();
+        uint16_t t = TCNT1;
+        SREG = sreg;
+        return t;
+    }
+
+    // Counts since begin(). Safe with interrupts on or off: an overflow not
+    // yet serviced is counted when TCNT1 has already wrapped.
+    static uint32_t now() {
+        uint8_t sreg = SREG;
+        cli();
+        uint16_t low = TCNT1;
+        uint16_t high = overflows();
+        if ((TIFR1 & _BV(TOV1)) && low < 0x8000) high++;
+        SREG = sreg;
+        return ((uint32_t)high << 16) | low;
+    }
+
+    static uint32_t toUs(uint32_t counts) {
+        return counts / COUNTS_PER_US;
+    }
+
+private:
+    // Function-local so the header needs no .cpp (constant-initialised, no guard)
+    static volatile uint16_t& overflows() {
+        static volatile uint16_t count = 0;
+        return count;
+    }
+};
@@ -0,0 +1,313 @@
+#pragma once
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include "Config.h"
+
+// -----------------------------------------------------------------------------
+// UsageLog - Long-term operating histograms and energy counters (EEPROM)
+// -----------------------------------------------------------------------------
+// update() (once per control tick) adds the real time since the previous
+// tick, in 0.1 s, to (millis() converted with the exact Timer 0 ratio,
+// Config::coreTimeToReal - not the nominal 8x of MILLIS_COMPENSATED):
+//   - duty x MAP histogram (USAGE_DUTY_BINS x 4 MAP bins along the curve)
+//   - current histogram (both channels, USAGE_CURRENT_BIN_A wide)
+//   - heatsink temperature histogram (USAGE_TEMP_BIN_C wide)
+//   - powered, pump running, FAULT, EMERGENCY, derating and safety-off time
+// and integrates charge (mAh, both channels) and pump energy
+// (mWh = Vsupply x duty x I). Fractions of a unit are carried, nothing is
+// rounded away at 20 Hz.
+//
+// Checkpoint: the record goes to the next of USAGE_EEPROM_SLOTS slots (wear
+// leveling) with a new sequence number and a CRC-16:
+//   - USAGE_FIRST_CHECKPOINT_S after begin() (the boot count and a short
+//     drive are kept), then every USAGE_CHECKPOINT_INTERVAL_S
+//   - when the supply falls below USAGE_SUPPLY_DROP_V (ignition off,
+//     undervoltage) - the bytes that changed go out while the board's
+//     capacitors hold the MCU up; rearmed above USAGE_SUPPLY_REARM_V.
+//     Only readings the caller marks valid count (Tick::supplyValid): a
+//     sensor fault is not a power-off.
+// An early checkpoint waits until USAGE_CHECKPOINT_MIN_GAP_S after the
+// previous one, which bounds the wear of a flapping supply.
+// service() writes one byte per loop pass and only when the EEPROM is ready -
+// no 3.4 ms wait. Each 4-byte field is latched when its first byte is
+// written, so a counter that changes meanwhile is never torn; the CRC is
+// taken over the bytes as written. A slot cut by a power loss fails its CRC
+// and begin() loads the newest valid one.
+//
+// dump() sends the live record in binary: sync bytes 0xA5 0x5A, then UsageRecord
+// (little-endian, CRC valid). tools/log/usagedump decodes a Serial capture.
+// -----------------------------------------------------------------------------
+
+// MAP bins of the duty x MAP histogram
+enum UsageMapBin : uint8_t {
+    USAGE_MAP_VACUUM = 0,   // Below 0 bar gauge
+    USAGE_MAP_LOW,          // 0 .. MAP_BAR_LOW_SETPOINT
+    USAGE_MAP_CURVE,        // MAP_BAR_LOW_SETPOINT .. MAP_BAR_HIGH_SETPOINT
+    USAGE_MAP_HIGH,         // Above MAP_BAR_HIGH_SETPOINT
+    USAGE_MAP_BINS
+};
+
+// EEPROM slot and dump layout. Times in 0.1 s.
+struct UsageRecord {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t reserved;
+    uint32_t sequence;                                         // Checkpoint number, newest wins
+    uint32_t dutyMap[Config::USAGE_DUTY_BINS][USAGE_MAP_BINS];
+    uint32_t current[Config::USAGE_CURRENT_BINS];
+    uint32_t heatsink[Config::USAGE_TEMP_BINS];
+    uint32_t poweredDs;
+    uint32_t pumpOnDs;                                         // Duty > 0
+    uint32_t faultDs;
+    uint32_t emergencyDs;
+    uint32_t deratingDs;
+    uint32_t safetyOffDs;                                      // External safety
+    uint32_t chargeMah;                                        // Both channels
+    uint32_t energyMwh;
+    uint32_t boots;                                            // Cold boots and warm restarts
+    uint16_t crc;                                              // CRC-16 of everything above
+    uint16_t reserved2;
+};
+
+class UsageLog {
+public:
+    static const uint16_t MAGIC = 0x5355;  // "US"
+    static const uint8_t VERSION = 1;
+    static const uint8_t SYNC0 = 0xA5;     // Dump preamble
+    static const uint8_t SYNC1 = 0x5A;
+
+    static_assert(sizeof(UsageRecord) % 4 == 0, "UsageRecord: whole 4-byte fields (write latch)");
+    static_assert(Config::EEPROM_USAGE_ADDR + Config::USAGE_EEPROM_SLOTS * sizeof(UsageRecord) <= E2END + 1,
+                  "Usage slots do not fit the EEPROM");
+
+    // One control tick
+    struct Tick {
+        float duty;          // At the pins, 0..1
+        float pressureBar;   // MAP gauge
+        float current[2];    // A
+        float supplyV;
+        bool supplyValid;    // Supply sensor in range (drop detection)
+        float heatsinkC;
+        bool fault;
+        bool emergency;
+        bool derating;
+        bool forcedOff;      // External safety
+    };
+
+    UsageLog()
+        : _lastTickMs(0)
+        , _lastCheckpointMs(0)
+        , _msCarry(0)
+        , _chargeCarry(0)
+        , _energyCarry(0)
+        , _latch(0)
+        , _writePos(-1)
+        , _crc(0)
+        , _slot(0)
+        , _loaded(false)
+        , _supplyArmed(false)
+        , _dropPending(false)
+        , _checkpoints(0)
+        , _dueS(Config::USAGE_FIRST_CHECKPOINT_S)
+    {
+        memset(&_rec, 0, sizeof(_rec));
+    }
+
+    // Newest valid slot (or a fresh record), counts the boot - both boot paths.
+    // Each slot is checked in _rec itself: no second 192-byte record on the stack.
+    void begin() {
+        int8_t best = -1;
+        uint32_t bestSeq = 0;
+        for (uint8_t i = 0; i < Config::USAGE_EEPROM_SLOTS; i++) {
+            eeprom_read_block(&_rec, slotAddr(i), sizeof(_rec));
+            if (_rec.magic != MAGIC || _rec.version != VERSION || _rec.crc != crcOf(_rec)) continue;
+            if (best < 0 || (int32_t)(_rec.sequence - bestSeq) > 0) {
+                best = (int8_t)i;
+                bestSeq = _rec.sequence;
+            }
+        }
+        _loaded = (best >= 0);
+        if (_loaded) {
+            if (best != Config::USAGE_EEPROM_SLOTS - 1) {
+                eeprom_read_block(&_rec, slotAddr((uint8_t)best), sizeof(_rec));
+            }
+            _slot = (uint8_t)best;
+        } else {
+            memset(&_rec, 0, sizeof(_rec));
+            _rec.magic = MAGIC;
+            _rec.version = VERSION;
+            _slot = Config::USAGE_EEPROM_SLOTS - 1;  // First checkpoint in slot 0
+        }
+        _rec.boots++;
+        _writePos = -1;
+        _lastTickMs = millis();
+        _lastCheckpointMs = _lastTickMs;
+        _dueS = Config::USAGE_FIRST_CHECKPOINT_S;
+        _supplyArmed = false;
+        _dropPending = false;
+    }
+
+    // Once per control tick
+    void update(unsigned long now, const Tick& t) {
+        unsigned long elapsed = now - _lastTickMs;
+        _lastTickMs = now;
+        // Stalled loop (the watchdog resets at 500 ms)
+        if (elapsed > MILLIS_REAL(1000UL)) elapsed = MILLIS_REAL(1000UL);
+        uint32_t dtMs = Config::coreTimeToReal(elapsed);
+        _msCarry += dtMs;
+        uint32_t ds = _msCarry / 100;
+        _msCarry -= ds * 100;
+
+        _rec.poweredDs += ds;
+        if (t.forcedOff) _rec.safetyOffDs += ds;
+        if (t.fault) _rec.faultDs += ds;
+        if (t.emergency) _rec.emergencyDs += ds;
+        if (t.derating) _rec.deratingDs += ds;
+        if (t.duty > 0.0f) _rec.pumpOnDs += ds;
+
+        _rec.dutyMap[dutyBin(t.duty)][mapBin(t.pressureBar)] += ds;
+        _rec.heatsink[linearBin(t.heatsinkC - Config::USAGE_TEMP_FIRST_C, Config::USAGE_TEMP_BIN_C,
+                                Config::USAGE_TEMP_BINS, 1)] += ds;
+
+        // Charge in mA x ms (3.6e6 per mAh), energy in mW x ms (3.6e6 per mWh)
+        for (uint8_t ch = 0; ch < 2; ch++) {
+            float amps = (t.current[ch] > 0.0f) ? t.current[ch] : 0.0f;
+            _rec.current[linearBin(amps, Config::USAGE_CURRENT_BIN_A, Config::USAGE_CURRENT_BINS, 0)] += ds;
+            _chargeCarry += (uint32_t)(amps * 1000.0f) * dtMs;
+            _energyCarry += (uint32_t)(amps * t.supplyV * t.duty * 1000.0f) * dtMs;
+        }
+        _rec.chargeMah += _chargeCarry / MILLI_MS_PER_HOUR;
+        _chargeCarry %= MILLI_MS_PER_HOUR;
+        _rec.energyMwh += _energyCarry / MILLI_MS_PER_HOUR;
+        _energyCarry %= MILLI_MS_PER_HOUR;
+
+        // Supply drop: one checkpoint per fall (a checkpoint already being
+        // written is that one)
+        if (!t.supplyValid) {
+            _supplyArmed = false;
+        } else if (t.supplyV >= Config::USAGE_SUPPLY_REARM_V) {
+            _supplyArmed = true;
+        } else if (_supplyArmed && t.supplyV < Config::USAGE_SUPPLY_DROP_V) {
+            _supplyArmed = false;
+            if (_writePos < 0) _dropPending = true;
+        }
+    }
+
+    // Every loop pass: starts a checkpoint when due, then one byte per pass
+    void service(unsigned long now) {
+        if (_writePos < 0) {
+            unsigned long elapsed = now - _lastCheckpointMs;
+            bool due = elapsed >= MILLIS_REAL(_dueS * 1000UL) ||
+                       (_dropPending && elapsed >= MILLIS_REAL(Config::USAGE_CHECKPOINT_MIN_GAP_S * 1000UL));
+            if (!due) return;
+            _lastCheckpointMs = now;
+            _dueS = Config::USAGE_CHECKPOINT_INTERVAL_S;
+            _dropPending = false;
+            _rec.sequence++;
+            _slot = (uint8_t)((_slot + 1) % Config::USAGE_EEPROM_SLOTS);
+            _crc = 0xFFFF;
+            _writePos = 0;
+        }
+        if (!eeprom_is_ready()) return;
+
+        uint16_t pos = (uint16_t)_writePos;
+        if ((pos & 3) == 0) {
+            if (pos == offsetof(UsageRecord, crc)) {
+                _latch = _crc;  // crc + reserved2 (0)
+            } else {
+                memcpy(&_latch, (const uint8_t*)&_rec + pos, 4);
+            }
+        }
+        uint8_t b = (uint8_t)(_latch >> (8 * (pos & 3)));
+        if (pos < offsetof(UsageRecord, crc)) _crc = _crc16_update(_crc, b);
+        // eeprom_update_byte() starts a write only if the byte differs
+        eeprom_update_byte((uint8_t*)slotAddr(_slot) + pos, b);
+
+        if (++_writePos >= (int16_t)sizeof(UsageRecord)) {
+            _writePos = -1;
+            _checkpoints++;
+        }
+    }
+
+    // Binary dump of the live record (on request; blocks for the Serial TX:
+    // ~17 ms at 115200). Sent straight from _rec; the CRC and reserved2 are
+    // computed, not taken from _rec (its crc is the one loaded at boot).
+    void dump(Print& out) const {
+        uint16_t crc = crcOf(_rec);
+        out.write(SYNC0);
+        out.write(SYNC1);
+        out.write((const uint8_t*)&_rec, offsetof(UsageRecord, crc));
+        out.write((uint8_t)crc);
+        out.write((uint8_t)(crc >> 8));
+        out.write((uint8_t)0);
+        out.write((uint8_t)0);
+    }
+
+    const UsageRecord& getRecord() const { return _rec; }
+    // A valid slot was found at boot
+    bool wasLoaded() const { return _loaded; }
+    // Checkpoint being written / completed since boot / supply drop waiting
+    bool isWriting() const { return _writePos >= 0; }
+    uint16_t getCheckpointCount() const { return _checkpoints; }
+    bool isDropPending() const { return _dropPending; }
+    uint8_t getSlot() const { return _slot; }
+
+    float getPoweredHours() const { return _rec.poweredDs / 36000.0f; }
+    float getChargeAh() const { return _rec.chargeMah / 1000.0f; }
+    float getEnergyWh() const { return _rec.energyMwh / 1000.0f; }
+
+    static uint16_t crcOf(const UsageRecord& r) {
+        const uint8_t* p = (const uint8_t*)&r;
+        uint16_t crc = 0xFFFF;
+        for (uint16_t i = 0; i < offsetof(UsageRecord, crc); i++) {
+            crc = _crc16_update(crc, p[i]);
+        }
+        return crc;
+    }
+
+private:
+    static const uint32_t MILLI_MS_PER_HOUR = 3600000UL;
+
+    static void* slotAddr(uint8_t slot) {
+        return (void*)(uintptr_t)(Config::EEPROM_USAGE_ADDR + (uint16_t)slot * sizeof(UsageRecord));
+    }
+
+    static uint8_t dutyBin(float duty) {
+        int16_t bin = (int16_t)(duty * Config::USAGE_DUTY_BINS);
+        if (bin < 0) bin = 0;
+        if (bin >= Config::USAGE_DUTY_BINS) bin = Config::USAGE_DUTY_BINS - 1;  // 100% in the top bin
+        return (uint8_t)bin;
+    }
+
+    static uint8_t mapBin(float bar) {
+        if (bar < 0.0f) return USAGE_MAP_VACUUM;
+        if (bar < Config::MAP_BAR_LOW_SETPOINT) return USAGE_MAP_LOW;
+        if (bar < Config::MAP_BAR_HIGH_SETPOINT) return USAGE_MAP_CURVE;
+        return USAGE_MAP_HIGH;
+    }
+
+    // x / width, clamped to the bins; first = 1 makes bin 0 "below 0"
+    static uint8_t linearBin(float x, float width, uint8_t bins, uint8_t first) {
+        if (x < 0.0f) return 0;
+        int16_t bin = (int16_t)(x / width) + first;
+        if (bin >= bins) bin = bins - 1;
+        return (uint8_t)bin;
+    }
+
+    UsageRecord _rec;
+    unsigned long _lastTickMs;
+    unsigned long _lastCheckpointMs;
+    uint32_t _msCarry;        // ms below one 0.1 s unit
+    uint32_t _chargeCarry;    // mA x ms below one mAh
+    uint32_t _energyCarry;    // mW x ms below one mWh
+    uint32_t _latch;          // 4-byte field being written
+    int16_t _writePos;        // Next byte of the checkpoint, -1 = idle
+    uint16_t _crc;
+    uint8_t _slot;            // Slot of the last (or current) checkpoint
+    bool _loaded;
+    bool _supplyArmed;        // Supply seen above USAGE_SUPPLY_REARM_V
+    bool _dropPending;        // Supply drop checkpoint waiting for the min gap
+    uint16_t _checkpoints;
+    uint16_t _dueS;           // Next periodic checkpoint, s after the previous
+};
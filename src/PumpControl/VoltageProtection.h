@@ -117,7 +117,7 @@ private:
         // COMPENSATED: millis() runs 64x faster due to Timer 0 prescaler change
         // Divide by TIMER0_PRESCALER_FACTOR to get actual elapsed time
         unsigned long timeSinceLast = (unsigned long)(millis() - _lastLevelChangeMs) / Config::TIMER0_PRESCALER_FACTOR;
-        float voltage = _sensor.readVoltage();
+        float voltage = _sensor.getFilteredVoltage();
         
         // Log level change
         Serial.print(F("[VOLTAGE_PROTECTION] Sensor status: "));
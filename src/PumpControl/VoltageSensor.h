@@ -1,6 +1,8 @@
 #pragma once
 #include <Arduino.h>
 #include "Config.h"
+#include "Adc.h"
+#include "Filters.h"
 
 // -----------------------------------------------------------------------------
 // VoltageSensor - Measures supply voltage via resistive divider
@@ -18,6 +20,12 @@
 // At 12V supply: ADC sees 12V  0.0909 = 1.09V (safe)
 // At 14.5V max:  ADC sees 14.5V  0.0909 = 1.32V (safe)
 // At 8V min:     ADC sees 8V  0.0909 = 0.73V (safe)
+//
+// update() feeds a median of the last VOLTAGE_MEDIAN_SAMPLES ticks (spike
+// rejection for the protection). updateFast() feeds a short EMA at the 500 Hz
+// supply feed-forward, which must not lag: in regulated mode it is the only
+// supply estimate PowerOutputs sees (CV_SUPPLY_FILTER_CUTOFF_HZ). syncFast()
+// starts it at the median while the feed-forward is not running.
 // -----------------------------------------------------------------------------
 
 class VoltageSensor {
@@ -25,33 +33,38 @@ public:
     explicit VoltageSensor(uint8_t pin) 
         : _pin(pin)
         , _filteredVoltage(12.0f)  // Initialize to nominal 12V
-        , _initialized(false)
     {}
 
     void begin() {
         pinMode(_pin, INPUT);
         
         // Initialize filter with first reading to avoid startup transient
-        int adc = analogRead(_pin);
+        uint16_t adc = Adc::read(_pin);
+        _filter.reset(adc);
+        _fast.reset(adc);
         _filteredVoltage = adcToSupplyVoltage(adc);
-        _initialized = true;
     }
 
-    // Returns supply voltage in Volts (with EMA filtering)
-    float readVoltage() {
-        int adc = analogRead(_pin);
-        float voltage = adcToSupplyVoltage(adc);
-        
-        // Apply Exponential Moving Average filter for noise reduction
-        if (_initialized) {
-            _filteredVoltage = (Config::VOLTAGE_FILTER_ALPHA * voltage) + 
-                              ((1.0f - Config::VOLTAGE_FILTER_ALPHA) * _filteredVoltage);
-        } else {
-            _filteredVoltage = voltage;
-            _initialized = true;
-        }
-        
-        return _filteredVoltage;
+    // New reading into the median filter - once per control tick
+    void update() {
+        _filter.update(Adc::read(_pin));
+        _filteredVoltage = adcToSupplyVoltage(_filter.value());
+    }
+
+    // New reading into the fast filter - supply feed-forward (regulated mode)
+    float updateFast() {
+        _fast.update(Adc::read(_pin));
+        return getFastVoltage();
+    }
+
+    // Fast estimate without a new ADC read
+    float getFastVoltage() const {
+        return adcToSupplyVoltage(_fast.get());
+    }
+
+    // Fast filter to the median, so it is current when the feed-forward starts
+    void syncFast() {
+        _fast.reset(_filter.value());
     }
 
     // Get filtered voltage without triggering new ADC read
@@ -67,11 +80,13 @@ public:
 
 private:
     uint8_t _pin;
-    float _filteredVoltage;
-    bool _initialized;
+    Filters::Median<uint16_t, Config::VOLTAGE_MEDIAN_SAMPLES> _filter;
+    Filters::Ema<uint16_t, Filters::mHz(Config::CV_SUPPLY_FILTER_CUTOFF_HZ),
+                 Filters::mHz(Config::CV_FEEDFORWARD_HZ)> _fast;
+    float _filteredVoltage;  // Median converted once per update()
 
     // Convert ADC reading to supply voltage accounting for divider
-    float adcToSupplyVoltage(int adc) const {
+    float adcToSupplyVoltage(float adc) const {
         // ADC to voltage at divider output
         float adcVoltage = (adc / 1023.0f) * Config::ADC_REFERENCE_VOLTAGE;
         
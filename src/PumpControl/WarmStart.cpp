@@ -0,0 +1,20 @@
+#include "WarmStart.h"
+
+// Not cleared by the C runtime: survives resets, garbage after power-on
+// (rejected by the magic/CRC check)
+WarmSnapshot g_warmSnapshot __attribute__((section(".noinit")));
+uint8_t g_resetFlags __attribute__((section(".noinit")));
+
+#if defined(__AVR__)
+// Runs in .init3, before the C runtime and before the watchdog can fire
+// again: a watchdog reset leaves WDE set with the shortest timeout. Optiboot
+// clears MCUSR itself and passes the original value in r2.
+void captureResetFlags() __attribute__((naked, used, section(".init3")));
+void captureResetFlags() {
+    uint8_t bootloaderFlags;
+    __asm__ __volatile__("mov %0, r2" : "=r"(bootloaderFlags));
+    g_resetFlags = MCUSR ? MCUSR : bootloaderFlags;
+    MCUSR = 0;
+    wdt_disable();
+}
+#endif
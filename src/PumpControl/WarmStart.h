@@ -0,0 +1,161 @@
+#pragma once
+#include <Arduino.h>
+#include <avr/wdt.h>
+#include <util/crc16.h>
+#include "Config.h"
+
+// -----------------------------------------------------------------------------
+// WarmStart - Watchdog and warm restart after a watchdog or brown-out reset
+// -----------------------------------------------------------------------------
+// A reset with the engine under load must not stop the pump for the cold-boot
+// sequence (Serial wait, 100 ms output grace period, 2 s hold-off). Every
+// control tick saves a small snapshot of the output state to .noinit RAM,
+// which the C runtime does not clear. At the next boot begin() decides:
+//   - reset cause WDRF or BORF, and not PORF (MCUSR, captured in .init3 by
+//     WarmStart.cpp before anything else runs)
+//   - snapshot magic and CRC-16 intact
+//   - not EMERGENCY at the time of the reset, external safety not active now
+//   - fewer than WARM_RESTART_MAX_CONSECUTIVE warm restarts in a row (a fault
+//     that keeps resetting the board gets the cold boot and its hold-off)
+// If all hold, setup() puts the saved duty back on the pins first and skips
+// the cold-boot delays; otherwise the normal sequence runs.
+//
+// Watchdog: WDTO_500MS, fed at the end of loop() only while the loop-health
+// checks pass (control tick not stalled, Timer 0 prescaler intact).
+//
+// Bootloader: Optiboot starts the sketch at once after a WDRF/BORF reset and
+// passes MCUSR in r2. The old Nano bootloader waits ~1 s on every reset and
+// does not stop the watchdog, so the board resets in a loop - flash Optiboot
+// (board "Arduino Nano", processor "ATmega328P") before enabling the watchdog.
+// -----------------------------------------------------------------------------
+
+// Output state saved every control tick; survives any reset but power loss
+struct WarmSnapshot {
+    uint16_t magic;
+    float duty;              // Duty at the pins (after limit and ceiling)
+    float outputLimit;       // Protection + thermal limit
+    float headroom[2];       // PowerProtection I2t headroom per channel
+    uint8_t source;          // ControlSource
+    uint8_t protectionLevel; // PowerProtection::ProtectionLevel
+    uint8_t consecutive;     // Warm restarts without a stable period between
+    uint16_t warmRestarts;   // Warm restarts since power-on
+    uint16_t crc;            // CRC-16 of everything above
+};
+
+extern WarmSnapshot g_warmSnapshot;  // .noinit (WarmStart.cpp)
+extern uint8_t g_resetFlags;         // MCUSR at the last reset (WarmStart.cpp)
+
+class WarmStart {
+public:
+    static const uint16_t MAGIC = 0x5057;  // "PW"
+
+    WarmStart()
+        : _warm(false)
+        , _valid(false)
+        , _consecutive(0)
+        , _warmRestarts(0)
+        , _bootMs(0)
+        , _unhealthy(0)
+    {
+        memset(&_saved, 0, sizeof(_saved));
+    }
+
+    // Evaluate reset cause and snapshot - first thing in setup(), before the
+    // next save() overwrites the snapshot
+    void begin(bool safetyActive, uint8_t emergencyLevel) {
+        _saved = g_warmSnapshot;
+        _valid = (_saved.magic == MAGIC) && (_saved.crc == crcOf(_saved));
+
+        bool warmCause = (g_resetFlags & (_BV(WDRF) | _BV(BORF))) && !(g_resetFlags & _BV(PORF));
+        _warm = Config::ENABLE_WARM_RESTART && _valid && warmCause && !safetyActive &&
+                _saved.protectionLevel < emergencyLevel &&
+                _saved.consecutive < Config::WARM_RESTART_MAX_CONSECUTIVE;
+
+        _consecutive = _warm ? (uint8_t)(_saved.consecutive + 1) : 0;
+        _warmRestarts = _valid ? _saved.warmRestarts : 0;
+        if (_warm) _warmRestarts++;
+        _bootMs = millis();
+    }
+
+    // Start the watchdog (end of setup(), both paths)
+    void enableWatchdog() {
+        if (Config::ENABLE_WATCHDOG) {
+            wdt_enable(WDTO_500MS);
+        }
+    }
+
+    // Feed the watchdog if the loop is healthy - call once per loop() pass.
+    // An unhealthy loop is left to the watchdog.
+    void feed(bool healthy) {
+        if (!Config::ENABLE_WATCHDOG) return;
+        if (healthy) {
+            wdt_reset();
+        } else {
+            _unhealthy++;
+        }
+    }
+
+    // Save the output state - once per control tick
+    void save(float duty, float outputLimit, float headroom1, float headroom2,
+              uint8_t source, uint8_t protectionLevel, unsigned long nowMs) {
+        // Running long enough since the last reset: the next one starts a new series
+        if (_consecutive > 0 &&
+            (unsigned long)(nowMs - _bootMs) >= MILLIS_COMPENSATED(Config::WARM_RESTART_STABLE_MS)) {
+            _consecutive = 0;
+        }
+        WarmSnapshot s;
+        s.magic = MAGIC;
+        s.duty = duty;
+        s.outputLimit = outputLimit;
+        s.headroom[0] = headroom1;
+        s.headroom[1] = headroom2;
+        s.source = source;
+        s.protectionLevel = protectionLevel;
+        s.consecutive = _consecutive;
+        s.warmRestarts = _warmRestarts;
+        s.crc = crcOf(s);
+        g_warmSnapshot = s;
+    }
+
+    // This boot restored the output from the snapshot
+    bool isWarm() const { return _warm; }
+    // Snapshot found at boot had a valid magic and CRC
+    bool hadValidSnapshot() const { return _valid; }
+    // Snapshot as found at boot (valid if hadValidSnapshot())
+    const WarmSnapshot& getSnapshot() const { return _saved; }
+    // MCUSR at the last reset
+    uint8_t getResetFlags() const { return g_resetFlags; }
+    // Warm restarts since power-on / in the current series
+    uint16_t getWarmRestarts() const { return _warmRestarts; }
+    uint8_t getConsecutive() const { return _consecutive; }
+    // Loop passes that did not feed the watchdog (the last one is never seen)
+    uint16_t getUnhealthyPasses() const { return _unhealthy; }
+
+    // "WDT", "BOR", "EXT", "POR" (several flags can be set), "?" if none
+    void printResetCause() const {
+        uint8_t flags = g_resetFlags;
+        if (flags & _BV(WDRF)) Serial.print(F("WDT "));
+        if (flags & _BV(BORF)) Serial.print(F("BOR "));
+        if (flags & _BV(EXTRF)) Serial.print(F("EXT "));
+        if (flags & _BV(PORF)) Serial.print(F("POR "));
+        if (!(flags & (_BV(WDRF) | _BV(BORF) | _BV(EXTRF) | _BV(PORF)))) Serial.print(F("? "));
+    }
+
+private:
+    WarmSnapshot _saved;
+    bool _warm;
+    bool _valid;
+    uint8_t _consecutive;
+    uint16_t _warmRestarts;
+    unsigned long _bootMs;
+    uint16_t _unhealthy;
+
+    static uint16_t crcOf(const WarmSnapshot& s) {
+        const uint8_t* p = (const uint8_t*)&s;
+        uint16_t crc = 0xFFFF;
+        for (uint8_t i = 0; i < offsetof(WarmSnapshot, crc); i++) {
+            crc = _crc16_update(crc, p[i]);
+        }
+        return crc;
+    }
+};
@@ -0,0 +1,172 @@
+#pragma once
+#include <Arduino.h>
+#include "FastPin.h"
+
+// -----------------------------------------------------------------------------
+// Ws2812 - Fixed-buffer WS2812/WS2812B driver (GRB, 800 kHz, 16 MHz AVR)
+// -----------------------------------------------------------------------------
+// The pixel buffer is a member (COUNT * 3 bytes, no heap) and already holds the
+// bytes on the wire: GRB order, brightness applied in set(). set() only marks
+// the frame dirty when a byte actually changes, and show() does nothing for a
+// clean frame - the caller decides when a frame may go out.
+//
+// Interrupts are off for the whole frame (24 bits = 30us per pixel). Letting
+// an ISR run between pixels is not safe: Timer 0 overflow (~5us) or the INT1
+// engine edge can hold the line low past the 5-9us after which some WS2812
+// parts already latch, and the rest of the frame lands on the first pixels.
+// This is a deliberate trade-off: a frame adds COUNT x 30us to the
+// interrupt-off time. It is accepted because D2 has no hardware serialiser
+// (the USART is Serial, SPI MOSI is the CAN bus) and frames only go out when
+// a colour changes, at most every STATUS_LED_FRAME_INTERVAL_MS. COUNT is
+// capped at 4 (120us), well below the ~260us in which the USART RX
+// (2-byte FIFO + shift register, 115200 baud) overruns and below one Timer 0
+// overflow (255us, only delayed, never lost). An INT1 engine edge inside a
+// frame is timestamped up to 120us late; the per-tick period average keeps
+// that under 1% of a period at ENGINE_RPM_MAX.
+// Pin-change interrupts (MCP2515 INT and its long SPI burst) are checked at
+// each pixel boundary; if one is pending the frame is cut there, interrupts
+// come back so its ISR runs at once, and show() returns false with the frame
+// still dirty (sent again whole at the next window). A CAN interrupt is
+// therefore delayed by at most one pixel, whatever COUNT.
+//
+// Bit timing (20 cycles per bit at 16 MHz): HIGH for 5 cycles (0.31us) for
+// a 0, 13 cycles (0.81us) for a 1, data stored through the port pointer.
+//
+// Host build (tools/sim): no bit-banging, show() only clears the dirty flag
+// and counts frames.
+// -----------------------------------------------------------------------------
+
+template <uint8_t PIN, uint8_t COUNT, uint8_t BRIGHTNESS = 255>
+class Ws2812 {
+    // 30us per pixel with interrupts off: 4 pixels = 120us, half the USART RX overrun time
+    static_assert(COUNT > 0 && COUNT <= 4, "Ws2812: 1 to 4 pixels (interrupts off for the whole frame)");
+
+public:
+    static const uint8_t MASK = FastPin<PIN>::MASK;
+
+    Ws2812() : _dirty(true), _frames(0), _aborts(0) {
+        memset(_grb, 0, sizeof(_grb));
+    }
+
+    void begin() {
+        FastPin<PIN>::low();
+        FastPin<PIN>::output();
+        _dirty = true;
+    }
+
+    // Colour of pixel i (0-255 per channel, before brightness). Returns true
+    // if the frame changed.
+    bool set(uint8_t i, uint8_t r, uint8_t g, uint8_t b) {
+        if (i >= COUNT) return false;
+        uint8_t* p = &_grb[i * 3];
+        uint8_t gs = scale(g), rs = scale(r), bs = scale(b);
+        if (p[0] == gs && p[1] == rs && p[2] == bs) return false;
+        p[0] = gs;
+        p[1] = rs;
+        p[2] = bs;
+        _dirty = true;
+        return true;
+    }
+
+    bool setAll(uint8_t r, uint8_t g, uint8_t b) {
+        bool changed = false;
+        for (uint8_t i = 0; i < COUNT; i++) {
+            changed |= set(i, r, g, b);
+        }
+        return changed;
+    }
+
+    bool isDirty() const { return _dirty; }
+
+    // Sends the frame if dirty. false: cut short by a pin-change interrupt,
+    // still dirty.
+    bool show() {
+        if (!_dirty) return true;
+#if defined(__AVR__)
+        volatile uint8_t* port = (PIN < 8) ? &PORTD : (PIN < 14) ? &PORTB : &PORTC;
+        const uint8_t* ptr = _grb;
+
+        uint8_t sreg = SREG;
+        cli();
+        uint8_t pcicr = PCICR;
+        bool complete = true;
+        for (uint8_t i = 0; i < COUNT; i++) {
+            if (i > 0 && (PCIFR & pcicr)) {
+                complete = false;  // CAN interrupt pending: cut at the pixel boundary
+                break;
+            }
+            // PORT levels read with interrupts off: no ISR can change the
+            // other bits of the port while the frame is out
+            uint8_t hi = *port | MASK;
+            uint8_t lo = *port & (uint8_t)~MASK;
+            sendPixel(port, ptr, hi, lo);
+            ptr += 3;
+        }
+        SREG = sreg;
+
+        if (!complete) {
+            _aborts++;
+            return false;
+        }
+#endif
+        _dirty = false;
+        _frames++;
+        return true;
+    }
+
+    // Pixel i as stored (GRB, brightness applied)
+    const uint8_t* getPixel(uint8_t i) const { return &_grb[(i < COUNT ? i : 0) * 3]; }
+
+    // Statistics
+    uint16_t getFrameCount() const { return _frames; }
+    uint16_t getAbortCount() const { return _aborts; }
+
+private:
+    static uint8_t scale(uint8_t v) {
+        return (BRIGHTNESS == 255) ? v : (uint8_t)(((uint16_t)v * (BRIGHTNESS + 1)) >> 8);
+    }
+
+#if defined(__AVR__)
+    // 3 bytes from ptr, MSB first. Interrupts must be off. The last LD reads
+    // one byte past the pixel (never sent).
+    static void sendPixel(volatile uint8_t* port, const uint8_t* ptr, uint8_t hi, uint8_t lo) {
+        uint8_t byte = *ptr++;
+        uint8_t bit = 8;
+        uint8_t next = lo;
+        uint8_t count = 3;
+        asm volatile(
+            "1:"                        "\n\t"  //                    (T =  0)
+            "st   %a[port], %[hi]"      "\n\t"  // 2  PORT = hi       (T =  2)
+            "sbrc %[byte], 7"           "\n\t"  // 1-2 if (byte & 0x80)
+            "mov  %[next], %[hi]"       "\n\t"  // 0-1   next = hi    (T =  4)
+            "dec  %[bit]"               "\n\t"  // 1                  (T =  5)
+            "st   %a[port], %[next]"    "\n\t"  // 2  PORT = next     (T =  7)
+            "mov  %[next], %[lo]"       "\n\t"  // 1  next = lo       (T =  8)
+            "breq 2f"                   "\n\t"  // 1-2 byte done?
+            "rol  %[byte]"              "\n\t"  // 1                  (T = 10)
+            "rjmp .+0"                  "\n\t"  // 2                  (T = 12)
+            "nop"                       "\n\t"  // 1                  (T = 13)
+            "st   %a[port], %[lo]"      "\n\t"  // 2  PORT = lo       (T = 15)
+            "nop"                       "\n\t"  // 1                  (T = 16)
+            "rjmp .+0"                  "\n\t"  // 2                  (T = 18)
+            "rjmp 1b"                   "\n\t"  // 2  next bit        (T = 20)
+            "2:"                        "\n\t"  //                    (T = 10)
+            "ldi  %[bit], 8"            "\n\t"  // 1                  (T = 11)
+            "ld   %[byte], %a[ptr]+"    "\n\t"  // 2  next byte       (T = 13)
+            "st   %a[port], %[lo]"      "\n\t"  // 2  PORT = lo       (T = 15)
+            "nop"                       "\n\t"  // 1                  (T = 16)
+            "dec  %[count]"             "\n\t"  // 1                  (T = 17)
+            "nop"                       "\n\t"  // 1                  (T = 18)
+            "brne 1b"                   "\n"    // 2  next byte       (T = 20)
+            : [byte] "+r"(byte), [bit] "+d"(bit), [next] "+r"(next), [count] "+r"(count),
+              [ptr] "+e"(ptr)
+            : [port] "e"(port), [hi] "r"(hi), [lo] "r"(lo)
+            : "memory");
+    }
+#endif
+
+    uint8_t _grb[COUNT * 3];
+    bool _dirty;
+    uint16_t _frames;
+    uint16_t _aborts;
+};
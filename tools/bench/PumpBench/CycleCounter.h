@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+
+// -----------------------------------------------------------------------------
+// CycleCounter - CPU clock cycles from Timer 1 at clk/1
+// -----------------------------------------------------------------------------
+// Timer 1 runs free at F_CPU (CS10, no prescaler); the overflow interrupt
+// extends it to 32 bits (268 s at 16 MHz). Nothing is simulator-specific:
+// the bench gives the same counts on a Nano as under simavr.
+//
+// Timer 1 is free here: the power PWM is on Timer 0 (D5/D6) and the bench
+// does not start PowerOutputs. Timer 0 keeps the Arduino core's /64 setting,
+// so millis() and micros() are real time in the bench, not 8x.
+//
+// Interrupts that fire inside a measurement (Timer 0 overflow every 1024us,
+// Timer 1 overflow, ADC) are counted; the minimum of a run is the cost
+// without them, the maximum the worst case with them.
+// -----------------------------------------------------------------------------
+
+extern volatile uint16_t g_timer1Overflows;  // PumpBench.ino (TIMER1_OVF_vect)
+
+class CycleCounter {
+public:
+    static void begin() {
+        TCCR1A = 0;
+        TCCR1B = _BV(CS10);
+        TCNT1 = 0;
+        g_timer1Overflows = 0;
+        TIFR1 = _BV(TOV1);
+        TIMSK1 = _BV(TOIE1);
+    }
+
+    // Cycles since begin(). Safe with interrupts on or off: an overflow not
+    // yet serviced is counted when TCNT1 has already wrapped.
+    static uint32_t now() {
+        uint8_t sreg = SREG;
+        cli();
+        uint16_t low = TCNT1;
+        uint16_t high = g_timer1Overflows;
+        if ((TIFR1 & _BV(TOV1)) && low < 0x8000) high++;
+        SREG = sreg;
+        return ((uint32_t)high << 16) | low;
+    }
+};
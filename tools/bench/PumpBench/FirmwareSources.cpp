@@ -0,0 +1,9 @@
+// -----------------------------------------------------------------------------
+// FirmwareSources.cpp - The firmware .cpp files the benchmarked headers need
+// -----------------------------------------------------------------------------
+// arduino-cli only compiles the .cpp files of the sketch folder, so the ones
+// from src/PumpControl are pulled in here (found through the include path,
+// see PumpBench.ino). Adc.cpp holds ADC_vect: without it the first
+// Adc::read() with ENABLE_ADC_SLEEP jumps to __bad_interrupt and resets.
+// -----------------------------------------------------------------------------
+#include "Adc.cpp"
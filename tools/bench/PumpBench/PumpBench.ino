@@ -0,0 +1,176 @@
+/* ----------------------------------------------------------------------------
+   PumpBench.ino - Cycles per call of the firmware's hot functions
+
+   Build (the firmware headers come from src/PumpControl through -I):
+     arduino-cli compile -b arduino:avr:nano --output-dir build-bench \
+       --build-property "compiler.cpp.extra_flags=-I$PWD/src/PumpControl" \
+       tools/bench/PumpBench
+   Run under simavr with tools/bench/bench_runner (--bench), or flash it on a
+   Nano and read the same lines at 115200 baud.
+
+   Output, one line per benchmark (cycles at F_CPU, measurement overhead
+   already subtracted; lines starting with '#' are comments):
+     BENCH <name> <calls> <min> <avg> <max>
+   followed by BENCH_END. The sketch then stops with interrupts disabled and
+   the CPU asleep, which ends the simulation.
+
+   Inputs: the sensors read whatever is on A1..A5. bench_runner drives fixed
+   voltages (10 A per channel, 25 C heatsink, 1 bar MAP, 13.8 V supply) so
+   runs are comparable; the ADC path costs the same for any voltage.
+---------------------------------------------------------------------------- */
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "Config.h"
+#include "CurrentSensor.h"
+#include "VoltageSensor.h"
+#include "MapSensor.h"
+#include "TempSensor.h"
+#include "PressureCurve.h"
+#include "CycleCounter.h"
+
+volatile uint16_t g_timer1Overflows = 0;
+
+ISR(TIMER1_OVF_vect) {
+    g_timer1Overflows++;
+}
+
+// Formatting cost without the UART: Print's float path, bytes dropped
+class NullPrint : public Print {
+public:
+    size_t write(uint8_t) override { return 1; }
+};
+
+CurrentSensor g_curr1(Config::PIN_CURRENT_1);
+VoltageSensor g_voltage(Config::PIN_VCC_SENSE);
+MapSensor     g_map(Config::PIN_MAP_SENSOR);
+TempSensor    g_temp(Config::PIN_NTC_TEMP);
+NullPrint     g_null;
+
+volatile float g_sink;  // Keeps results alive
+uint32_t g_overhead = 0;
+
+struct BenchResult {
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;
+};
+
+// Runs fn(i) for i = 0..calls-1, each call timed on its own. The untimed
+// after(i) lets a benchmark drain the UART between calls.
+template <typename F, typename A>
+void bench(const __FlashStringHelper* name, uint16_t calls, F fn, A after) {
+    BenchResult r = {0xFFFFFFFFUL, 0, 0};
+    for (uint16_t i = 0; i < calls; i++) {
+        uint32_t start = CycleCounter::now();
+        fn(i);
+        uint32_t cycles = CycleCounter::now() - start;
+        after(i);
+        cycles = cycles > g_overhead ? cycles - g_overhead : 0;
+        if (cycles < r.min) r.min = cycles;
+        if (cycles > r.max) r.max = cycles;
+        r.sum += cycles;
+    }
+    Serial.print(F("BENCH "));
+    Serial.print(name);
+    Serial.print(' ');
+    Serial.print(calls);
+    Serial.print(' ');
+    Serial.print(r.min);
+    Serial.print(' ');
+    Serial.print((r.sum + calls / 2) / calls);
+    Serial.print(' ');
+    Serial.println(r.max);
+    Serial.flush();
+}
+
+template <typename F>
+void bench(const __FlashStringHelper* name, uint16_t calls, F fn) {
+    bench(name, calls, fn, [](uint16_t) {});
+}
+
+// Cost of the two CycleCounter::now() calls around an empty body
+void measureOverhead() {
+    uint32_t best = 0xFFFFFFFFUL;
+    for (uint8_t i = 0; i < 32; i++) {
+        uint32_t start = CycleCounter::now();
+        uint32_t cycles = CycleCounter::now() - start;
+        if (cycles < best) best = cycles;
+    }
+    g_overhead = best;
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println(F("# PumpBench: cycles per call at F_CPU"));
+    Serial.print(F("# F_CPU "));
+    Serial.println(F_CPU);
+    Serial.print(F("# ADC sleep "));
+    Serial.println(Config::ENABLE_ADC_SLEEP ? F("on") : F("off"));
+
+    g_curr1.begin();
+    g_voltage.begin();
+    g_map.begin();
+    g_temp.begin();
+
+    CycleCounter::begin();
+    measureOverhead();
+    Serial.print(F("# overhead "));
+    Serial.println(g_overhead);
+    Serial.println(F("# name calls min avg max"));
+    Serial.flush();
+
+    // Sensors, one tick's sample + filter: ADC sampling dominates (sleep or
+    // busy-wait, Config.h)
+    bench(F("CurrentSensor::update"), 16, [](uint16_t) {
+        g_curr1.update();
+    });
+    bench(F("CurrentSensor::readCurrentFastA"), 16, [](uint16_t) {
+        g_sink = g_curr1.readCurrentFastA();
+    });
+    bench(F("VoltageSensor::update"), 16, [](uint16_t) {
+        g_voltage.update();
+    });
+    bench(F("MapSensor::update"), 16, [](uint16_t) {
+        g_map.update();
+    });
+    bench(F("TempSensor::update"), 16, [](uint16_t) {
+        g_temp.update();
+    });
+    bench(F("Adc::read"), 64, [](uint16_t) {
+        g_sink = Adc::read(Config::PIN_NTC_TEMP);
+    });
+
+    // Pure math: input swept over the whole range (guards included)
+    bench(F("TempSensor::adcToCelsius"), 256, [](uint16_t i) {
+        g_sink = TempSensor::adcToCelsius((int)(i * 4));
+    });
+    bench(F("pressureToTargetPercent"), 256, [](uint16_t i) {
+        g_sink = pressureToTargetPercent(-0.2f + i * (1.2f / 256.0f));
+    });
+
+    // Status output: formatting alone, then through HardwareSerial with an
+    // empty TX buffer (the bytes leave by interrupt after the call)
+    bench(F("Print::print(float)"), 256, [](uint16_t i) {
+        g_null.print(i * 0.173f, 2);
+    });
+    Serial.print(F("# "));
+    bench(F("Serial.print(float)"), 64, [](uint16_t i) {
+        Serial.print(i * 0.173f, 2);
+    }, [](uint16_t i) {
+        Serial.flush();
+        Serial.write(i < 63 ? ' ' : '\n');
+        Serial.flush();
+    });
+
+    Serial.println(F("BENCH_END"));
+    Serial.flush();
+
+    // Stop: no interrupt can wake the CPU (simavr exits here)
+    cli();
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+    sleep_cpu();
+}
+
+void loop() {
+}
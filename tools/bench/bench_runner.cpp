@@ -0,0 +1,646 @@
+// -----------------------------------------------------------------------------
+// bench_runner - Cycle counts under simavr, footprint per subsystem from the ELF
+// -----------------------------------------------------------------------------
+// Build: cmake -S tools -B build-tools && cmake --build build-tools
+//        (--bench and --firmware need the simavr headers and libsimavr;
+//        without them only --footprint is built in)
+// Run:   ./build-tools/bench_runner [options]
+//   --bench ELF        PumpBench.ino.elf (tools/bench/PumpBench): cycles per
+//                      call of the hot functions
+//   --firmware ELF     PumpControl.ino.elf: loop() pass times, footprint
+//   --seconds S        simulated time of the --firmware run (default 5)
+//   --pwm-in HZ:DUTY   square wave on D8 for PwmInput (default: none, every
+//                      control tick waits out both pulseIn() timeouts)
+//   --adc CH=VOLTS     voltage on A<CH> (default: 25 C NTC, 10 A per ACS758,
+//                      1 bar MAP, 13.8 V supply)
+//   --footprint ELF    flash/SRAM per subsystem only, no simulation
+//   --top N            rows per footprint table (default 12, 0 = all)
+//   --json FILE        every result of the run, machine-readable
+//   --echo             UART output of the simulated sketch to stderr
+//
+// simavr executes the ELF as an ATmega328P at 16 MHz: instruction timing,
+// Timer 0/1, ADC conversion time and the UART at 115200 baud are those of
+// the chip, so cycle counts match a Nano (the MCP2515 is not simulated - SPI
+// reads return 0 and CanInterface takes its no-controller path).
+//
+// Loop passes (--firmware): every pass ends in CpuIdle::sleep(). A SLEEP
+// with ADSC set in ADCSRA is Adc::read() waiting on a conversion and stays
+// inside the pass. A pass runs from the wake-up after one idle sleep to the
+// next idle sleep; the worst is the control tick or the 1 Hz status report.
+// Needs ENABLE_IDLE_SLEEP (Config.h), otherwise no pass boundary is seen.
+//
+// Footprint: FUNC symbols of .text grouped by class, template arguments and
+// compiler clones folded (PowerOutputsT<6, 5>::setDuty -> PowerOutputsT);
+// SRAM per object of .data/.bss/.noinit - every subsystem is one g_ global.
+// The Arduino build uses LTO: inlined code counts for its caller, mostly
+// loop() and setup().
+//
+// Before/after: run with --json on both builds and diff the files.
+// -----------------------------------------------------------------------------
+#include <cxxabi.h>
+#include <elf.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#if BENCH_HAVE_SIMAVR
+#include <simavr/avr_adc.h>
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_uart.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_irq.h>
+#endif
+
+namespace {
+
+const uint32_t F_CPU_HZ = 16000000UL;
+const char* const MCU = "atmega328p";
+
+// ============================================================================
+// Results
+// ============================================================================
+
+struct BenchLine {
+    std::string name;
+    unsigned long calls, min, avg, max;
+};
+
+struct BenchRun {
+    bool ran = false;
+    bool complete = false;
+    unsigned long overhead = 0;
+    std::vector<BenchLine> lines;
+};
+
+struct LoopRun {
+    bool ran = false;
+    double seconds = 0.0;
+    uint64_t setupCycles = 0;
+    uint64_t idleCycles = 0;
+    uint64_t measuredCycles = 0;
+    uint64_t maxAtCycle = 0;
+    std::vector<uint32_t> passes;  // Cycles per pass
+};
+
+struct CodeGroup {
+    std::string name;
+    unsigned long bytes = 0;
+    unsigned functions = 0;
+};
+
+struct RamObject {
+    std::string name;
+    std::string section;
+    unsigned long bytes;
+};
+
+struct Footprint {
+    bool ran = false;
+    std::string elf;
+    unsigned long text = 0, data = 0, bss = 0, noinit = 0;
+    std::vector<CodeGroup> code;
+    std::vector<RamObject> objects;
+    unsigned long flash() const { return text + data; }  // .data initializers live in flash
+    unsigned long sram() const { return data + bss + noinit; }
+};
+
+// ============================================================================
+// ELF footprint
+// ============================================================================
+
+std::string demangle(const char* name) {
+    if (strncmp(name, "_Z", 2) != 0) {
+        std::string s(name);
+        return s.substr(0, s.find('.'));  // turnOffPWM.constprop.3, CSWTCH.159
+    }
+    int status = 0;
+    char* out = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status != 0 || !out) return name;
+    std::string s(out);
+    free(out);
+    return s;
+}
+
+std::string stripTemplateArgs(const std::string& s) {
+    std::string out;
+    int depth = 0;
+    for (char c : s) {
+        if (c == '<') depth++;
+        else if (c == '>' && depth > 0) depth--;
+        else if (depth == 0) out += c;
+    }
+    return out;
+}
+
+std::string codeGroup(const char* raw, const std::string& name) {
+    if (strncmp(raw, "__vector_", 9) == 0) return "(interrupt vectors)";
+    if (strncmp(raw, "_GLOBAL__", 9) == 0) return "(static constructors)";
+    if (name == "setup" || name == "loop" || name == "main") return "(sketch: setup/loop/main)";
+    std::string head = stripTemplateArgs(name.substr(0, name.find('(')));
+    size_t scope = head.rfind("::");
+    if (scope != std::string::npos) return head.substr(0, scope);
+    if (strncmp(raw, "__", 2) == 0) return "(libgcc)";
+    return "(C functions: core, avr-libc)";
+}
+
+bool readFootprint(const char* path, Footprint& out) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (file.size() < sizeof(Elf32_Ehdr) || memcmp(file.data(), ELFMAG, SELFMAG) != 0 ||
+        file[EI_CLASS] != ELFCLASS32 || file[EI_DATA] != ELFDATA2LSB) {
+        fprintf(stderr, "bench_runner: %s is not an AVR (ELF32 little-endian) file\n", path);
+        return false;
+    }
+    const Elf32_Ehdr* eh = (const Elf32_Ehdr*)file.data();
+    if (eh->e_shoff == 0 || eh->e_shentsize != sizeof(Elf32_Shdr) ||
+        eh->e_shoff + (unsigned long)eh->e_shnum * sizeof(Elf32_Shdr) > file.size() ||
+        eh->e_shstrndx >= eh->e_shnum) {
+        fprintf(stderr, "bench_runner: %s: bad section headers\n", path);
+        return false;
+    }
+    const Elf32_Shdr* sh = (const Elf32_Shdr*)(file.data() + eh->e_shoff);
+    const char* shstr = file.data() + sh[eh->e_shstrndx].sh_offset;
+
+    out.ran = true;
+    out.elf = path;
+    std::map<unsigned, std::string> ramSections;
+    unsigned textIndex = 0;
+    const Elf32_Shdr* symtab = nullptr;
+    for (unsigned i = 0; i < eh->e_shnum; i++) {
+        std::string name = shstr + sh[i].sh_name;
+        unsigned long size = sh[i].sh_size;
+        if (name == ".text") {
+            out.text = size;
+            textIndex = i;
+        } else if (name == ".data") {
+            out.data = size;
+            ramSections[i] = name;
+        } else if (name == ".bss") {
+            out.bss = size;
+            ramSections[i] = name;
+        } else if (name == ".noinit") {
+            out.noinit = size;
+            ramSections[i] = name;
+        }
+        if (sh[i].sh_type == SHT_SYMTAB) symtab = &sh[i];
+    }
+    if (!symtab || symtab->sh_link >= eh->e_shnum ||
+        symtab->sh_offset + symtab->sh_size > file.size()) {
+        fprintf(stderr, "bench_runner: %s: no symbol table (stripped ELF?)\n", path);
+        return false;
+    }
+    const char* strtab = file.data() + sh[symtab->sh_link].sh_offset;
+    const Elf32_Sym* syms = (const Elf32_Sym*)(file.data() + symtab->sh_offset);
+    size_t count = symtab->sh_size / sizeof(Elf32_Sym);
+
+    std::map<std::string, CodeGroup> groups;
+    unsigned long covered = 0;
+    for (size_t i = 0; i < count; i++) {
+        const Elf32_Sym& s = syms[i];
+        if (s.st_size == 0) continue;
+        const char* raw = strtab + s.st_name;
+        unsigned char type = ELF32_ST_TYPE(s.st_info);
+        if (s.st_shndx == textIndex && (type == STT_FUNC || type == STT_OBJECT)) {
+            std::string key = type == STT_FUNC ? codeGroup(raw, demangle(raw)) : "(PROGMEM data)";
+            CodeGroup& g = groups[key];
+            g.name = key;
+            g.bytes += s.st_size;
+            if (type == STT_FUNC) g.functions++;
+            covered += s.st_size;
+        } else if (type == STT_OBJECT && ramSections.count(s.st_shndx)) {
+            out.objects.push_back(RamObject{demangle(raw), ramSections[s.st_shndx], s.st_size});
+        }
+    }
+    if (out.text > covered) {
+        CodeGroup g;
+        g.name = "(unattributed: vector table, startup, padding)";
+        g.bytes = out.text - covered;
+        groups[g.name] = g;
+    }
+    for (const auto& g : groups) out.code.push_back(g.second);
+    std::stable_sort(out.code.begin(), out.code.end(),
+                     [](const CodeGroup& a, const CodeGroup& b) { return a.bytes > b.bytes; });
+    std::stable_sort(out.objects.begin(), out.objects.end(),
+                     [](const RamObject& a, const RamObject& b) { return a.bytes > b.bytes; });
+    return true;
+}
+
+// ============================================================================
+// Simulation (simavr)
+// ============================================================================
+
+#if BENCH_HAVE_SIMAVR
+
+const uint16_t ADCSRA_ADDR = 0x7A;  // Data space address (ATmega328P)
+const uint8_t ADSC_BIT = 0x40;
+
+struct Inputs {
+    float adcVolts[8] = {0.0f, 2.50f, 2.90f, 2.90f, 0.83f, 1.2545f, 0.0f, 0.0f};
+    float pwmHz = 0.0f;
+    float pwmDuty = 0.0f;
+};
+
+struct SquareWave {
+    avr_irq_t* irq;
+    avr_cycle_count_t high;
+    avr_cycle_count_t low;
+    uint32_t level;
+};
+
+struct Machine {
+    avr_t* avr = nullptr;
+    bool echo = false;
+    std::string line;
+    std::vector<std::string> lines;
+    SquareWave pwm;
+};
+
+void onUartByte(avr_irq_t*, uint32_t value, void* param) {
+    Machine* m = (Machine*)param;
+    char c = (char)value;
+    if (m->echo) fputc(c, stderr);
+    if (c == '\n') {
+        m->lines.push_back(m->line);
+        m->line.clear();
+    } else if (c != '\r') {
+        m->line += c;
+    }
+}
+
+avr_cycle_count_t onPwmEdge(avr_t*, avr_cycle_count_t when, void* param) {
+    SquareWave* w = (SquareWave*)param;
+    w->level = !w->level;
+    avr_raise_irq(w->irq, w->level);
+    return when + (w->level ? w->high : w->low);
+}
+
+bool boot(Machine& m, const char* path, const Inputs& in) {
+    elf_firmware_t fw;
+    memset(&fw, 0, sizeof(fw));
+    if (elf_read_firmware(path, &fw) != 0) {
+        fprintf(stderr, "bench_runner: cannot load %s\n", path);
+        return false;
+    }
+    m.avr = avr_make_mcu_by_name(MCU);
+    if (!m.avr) {
+        fprintf(stderr, "bench_runner: simavr has no %s core\n", MCU);
+        return false;
+    }
+    avr_init(m.avr);
+    fw.frequency = F_CPU_HZ;
+    fw.vcc = fw.avcc = fw.aref = 5000;  // mV
+    avr_load_firmware(m.avr, &fw);
+
+    // UART0 to the line buffer instead of simavr's stdout printer
+    uint32_t flags = 0;
+    avr_ioctl(m.avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+    flags &= ~AVR_UART_FLAG_STDIO;
+    avr_ioctl(m.avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+    avr_irq_register_notify(avr_io_getirq(m.avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT),
+                            onUartByte, &m);
+
+    for (int ch = 0; ch < 8; ch++) {
+        avr_raise_irq(avr_io_getirq(m.avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + ch),
+                      (uint32_t)(in.adcVolts[ch] * 1000.0f + 0.5f));
+    }
+    // Idle inputs: D7 safety inactive (active low), D4 MCP2515 INT released
+    avr_raise_irq(avr_io_getirq(m.avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 7), 1);
+    avr_raise_irq(avr_io_getirq(m.avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 4), 1);
+
+    // D8 = PB0: PwmInput
+    avr_irq_t* d8 = avr_io_getirq(m.avr, AVR_IOCTL_IOPORT_GETIRQ('B'), 0);
+    if (in.pwmHz > 0.0f && in.pwmDuty > 0.0f && in.pwmDuty < 1.0f) {
+        avr_cycle_count_t period = (avr_cycle_count_t)(F_CPU_HZ / in.pwmHz);
+        m.pwm.irq = d8;
+        m.pwm.high = (avr_cycle_count_t)(period * in.pwmDuty);
+        m.pwm.low = period - m.pwm.high;
+        m.pwm.level = 0;
+        avr_raise_irq(d8, 0);
+        avr_cycle_timer_register(m.avr, m.pwm.low, onPwmEdge, &m.pwm);
+    } else {
+        avr_raise_irq(d8, in.pwmDuty >= 1.0f ? 1 : 0);
+    }
+    return true;
+}
+
+bool runBench(const char* path, const Inputs& in, bool echo, BenchRun& out) {
+    Machine m;
+    m.echo = echo;
+    if (!boot(m, path, in)) return false;
+    out.ran = true;
+
+    const uint64_t limit = 120ULL * F_CPU_HZ;  // A stuck sketch, not a slow one
+    int state = cpu_Running;
+    while (m.avr->cycle < limit) {
+        state = avr_run(m.avr);
+        if (state == cpu_Done || state == cpu_Crashed) break;
+    }
+
+    for (const std::string& l : m.lines) {
+        char name[96];
+        BenchLine b;
+        if (l == "BENCH_END") {
+            out.complete = true;
+        } else if (sscanf(l.c_str(), "BENCH %95s %lu %lu %lu %lu",
+                          name, &b.calls, &b.min, &b.avg, &b.max) == 5) {
+            b.name = name;
+            out.lines.push_back(b);
+        } else {
+            sscanf(l.c_str(), "# overhead %lu", &out.overhead);
+        }
+    }
+    if (state == cpu_Crashed) {
+        fprintf(stderr, "bench_runner: %s crashed at cycle %llu\n", path,
+                (unsigned long long)m.avr->cycle);
+        return false;
+    }
+    if (!out.complete) {
+        fprintf(stderr, "bench_runner: %s: no BENCH_END (wrong sketch, or stuck)\n", path);
+        return false;
+    }
+    return true;
+}
+
+bool runFirmware(const char* path, const Inputs& in, double seconds, bool echo, LoopRun& out) {
+    Machine m;
+    m.echo = echo;
+    if (!boot(m, path, in)) return false;
+    out.ran = true;
+    out.seconds = seconds;
+
+    const uint64_t end = (uint64_t)(seconds * F_CPU_HZ);
+    bool wasSleeping = false;
+    bool idle = false;       // In CpuIdle::sleep()
+    bool started = false;    // First idle sleep seen (setup() done)
+    uint64_t passStart = 0;
+    uint64_t idleStart = 0;
+    uint32_t worst = 0;
+    int state = cpu_Running;
+    while (m.avr->cycle < end) {
+        state = avr_run(m.avr);
+        if (state == cpu_Done || state == cpu_Crashed) break;
+        bool sleeping = state == cpu_Sleeping;
+        if (sleeping && !wasSleeping && !(m.avr->data[ADCSRA_ADDR] & ADSC_BIT)) {
+            if (!started) {
+                out.setupCycles = m.avr->cycle;
+                started = true;
+            } else {
+                uint32_t cycles = (uint32_t)(m.avr->cycle - passStart);
+                out.passes.push_back(cycles);
+                if (cycles > worst) {
+                    worst = cycles;
+                    out.maxAtCycle = m.avr->cycle;
+                }
+            }
+            idle = true;
+            idleStart = m.avr->cycle;
+        } else if (!sleeping && wasSleeping && idle) {
+            idle = false;
+            out.idleCycles += m.avr->cycle - idleStart;
+            passStart = m.avr->cycle;
+        }
+        wasSleeping = sleeping;
+    }
+    if (started) out.measuredCycles = m.avr->cycle - out.setupCycles;
+
+    if (state == cpu_Crashed) {
+        fprintf(stderr, "bench_runner: %s crashed at cycle %llu\n", path,
+                (unsigned long long)m.avr->cycle);
+        return false;
+    }
+    if (!started) {
+        fprintf(stderr, "bench_runner: %s never reached CpuIdle::sleep() "
+                "(ENABLE_IDLE_SLEEP off, or setup() longer than %.1f s)\n", path, seconds);
+        return false;
+    }
+    return true;
+}
+
+#endif  // BENCH_HAVE_SIMAVR
+
+// ============================================================================
+// Report
+// ============================================================================
+
+double cyclesToUs(double cycles) { return cycles * 1e6 / F_CPU_HZ; }
+
+uint32_t percentile(std::vector<uint32_t> v, unsigned pct) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[(v.size() - 1) * pct / 100];
+}
+
+void printBench(const BenchRun& b) {
+    printf("bench (cycles per call, overhead %lu subtracted)\n", b.overhead);
+    printf("  %-34s %6s %9s %9s %9s %10s\n", "name", "calls", "min", "avg", "max", "avg us");
+    for (const BenchLine& l : b.lines) {
+        printf("  %-34s %6lu %9lu %9lu %9lu %10.1f\n", l.name.c_str(), l.calls, l.min, l.avg,
+               l.max, cyclesToUs(l.avg));
+    }
+}
+
+void printLoop(const LoopRun& r) {
+    uint32_t worst = r.passes.empty() ? 0 : *std::max_element(r.passes.begin(), r.passes.end());
+    uint32_t p99 = percentile(r.passes, 99);
+    uint32_t p50 = percentile(r.passes, 50);
+    printf("\nloop() passes (%.1f s simulated)\n", r.seconds);
+    printf("  setup    %10llu cycles  %9.1f us\n", (unsigned long long)r.setupCycles,
+           cyclesToUs((double)r.setupCycles));
+    printf("  passes   %10zu\n", r.passes.size());
+    printf("  max      %10u cycles  %9.1f us  at %.3f s\n", worst, cyclesToUs(worst),
+           (double)r.maxAtCycle / F_CPU_HZ);
+    printf("  p99      %10u cycles  %9.1f us\n", p99, cyclesToUs(p99));
+    printf("  p50      %10u cycles  %9.1f us\n", p50, cyclesToUs(p50));
+    printf("  idle     %10.1f %%\n",
+           r.measuredCycles ? 100.0 * r.idleCycles / r.measuredCycles : 0.0);
+}
+
+void printFootprint(const Footprint& f, size_t top) {
+    printf("\nfootprint %s\n", f.elf.c_str());
+    printf("  flash    %6lu B  (.text %lu + .data %lu)\n", f.flash(), f.text, f.data);
+    printf("  sram     %6lu B  (.data %lu + .bss %lu + .noinit %lu), stack and heap not included\n",
+           f.sram(), f.data, f.bss, f.noinit);
+    printf("\n  flash by class (largest first)\n");
+    size_t shown = 0;
+    for (const CodeGroup& g : f.code) {
+        if (top && shown++ == top) {
+            printf("  %6s  ... %zu more\n", "", f.code.size() - top);
+            break;
+        }
+        printf("  %6lu  %-48s %3u fn\n", g.bytes, g.name.c_str(), g.functions);
+    }
+    printf("\n  SRAM by object (largest first)\n");
+    shown = 0;
+    for (const RamObject& o : f.objects) {
+        if (top && shown++ == top) {
+            printf("  %6s  ... %zu more\n", "", f.objects.size() - top);
+            break;
+        }
+        printf("  %6lu  %-48s %s\n", o.bytes, o.name.c_str(), o.section.c_str());
+    }
+}
+
+std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+bool writeJson(const char* path, const BenchRun& b, const LoopRun& r, const Footprint& f) {
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return false;
+    }
+    fprintf(out, "{\n  \"mcu\": \"%s\",\n  \"f_cpu\": %lu", MCU, (unsigned long)F_CPU_HZ);
+    if (b.ran) {
+        fprintf(out, ",\n  \"bench_overhead\": %lu,\n  \"bench\": [", b.overhead);
+        for (size_t i = 0; i < b.lines.size(); i++) {
+            const BenchLine& l = b.lines[i];
+            fprintf(out, "%s\n    {\"name\": %s, \"calls\": %lu, \"min\": %lu, \"avg\": %lu, "
+                    "\"max\": %lu, \"avg_us\": %.2f}",
+                    i ? "," : "", jsonString(l.name).c_str(), l.calls, l.min, l.avg, l.max,
+                    cyclesToUs(l.avg));
+        }
+        fprintf(out, "\n  ]");
+    }
+    if (r.ran) {
+        uint32_t worst = r.passes.empty() ? 0 : *std::max_element(r.passes.begin(), r.passes.end());
+        fprintf(out, ",\n  \"loop\": {\"seconds\": %.3f, \"setup_cycles\": %llu, \"passes\": %zu, "
+                "\"max_cycles\": %u, \"max_at_s\": %.4f, \"p99_cycles\": %u, \"p50_cycles\": %u, "
+                "\"idle_percent\": %.2f}",
+                r.seconds, (unsigned long long)r.setupCycles, r.passes.size(), worst,
+                (double)r.maxAtCycle / F_CPU_HZ, percentile(r.passes, 99),
+                percentile(r.passes, 50),
+                r.measuredCycles ? 100.0 * r.idleCycles / r.measuredCycles : 0.0);
+    }
+    if (f.ran) {
+        fprintf(out, ",\n  \"footprint\": {\n    \"elf\": %s,\n    \"flash\": %lu, \"text\": %lu, "
+                "\"data\": %lu, \"bss\": %lu, \"noinit\": %lu, \"sram_static\": %lu,\n    \"code\": [",
+                jsonString(f.elf).c_str(), f.flash(), f.text, f.data, f.bss, f.noinit, f.sram());
+        for (size_t i = 0; i < f.code.size(); i++) {
+            fprintf(out, "%s\n      {\"name\": %s, \"bytes\": %lu, \"functions\": %u}", i ? "," : "",
+                    jsonString(f.code[i].name).c_str(), f.code[i].bytes, f.code[i].functions);
+        }
+        fprintf(out, "\n    ],\n    \"objects\": [");
+        for (size_t i = 0; i < f.objects.size(); i++) {
+            fprintf(out, "%s\n      {\"name\": %s, \"section\": \"%s\", \"bytes\": %lu}", i ? "," : "",
+                    jsonString(f.objects[i].name).c_str(), f.objects[i].section.c_str(),
+                    f.objects[i].bytes);
+        }
+        fprintf(out, "\n    ]\n  }");
+    }
+    fprintf(out, "\n}\n");
+    return fclose(out) == 0;
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: bench_runner [--bench ELF] [--firmware ELF] [--seconds S] [--pwm-in HZ:DUTY]\n"
+            "                    [--adc CH=VOLTS] [--footprint ELF] [--top N] [--json FILE] [--echo]\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* benchElf = nullptr;
+    const char* firmwareElf = nullptr;
+    const char* footprintElf = nullptr;
+    const char* jsonPath = nullptr;
+    double seconds = 5.0;
+    size_t top = 12;
+    bool echo = false;
+#if BENCH_HAVE_SIMAVR
+    Inputs inputs;
+#endif
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--bench" && hasValue) {
+            benchElf = argv[++i];
+        } else if (arg == "--firmware" && hasValue) {
+            firmwareElf = argv[++i];
+        } else if (arg == "--footprint" && hasValue) {
+            footprintElf = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (arg == "--seconds" && hasValue) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--top" && hasValue) {
+            top = strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--echo") {
+            echo = true;
+#if BENCH_HAVE_SIMAVR
+        } else if (arg == "--pwm-in" && hasValue) {
+            if (sscanf(argv[++i], "%f:%f", &inputs.pwmHz, &inputs.pwmDuty) != 2) {
+                usage();
+                return 2;
+            }
+        } else if (arg == "--adc" && hasValue) {
+            int ch = -1;
+            float v = 0.0f;
+            if (sscanf(argv[++i], "%d=%f", &ch, &v) != 2 || ch < 0 || ch > 7) {
+                usage();
+                return 2;
+            }
+            inputs.adcVolts[ch] = v;
+#endif
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!benchElf && !firmwareElf && !footprintElf) {
+        usage();
+        return 2;
+    }
+
+    BenchRun bench;
+    LoopRun loopRun;
+    Footprint footprint;
+    bool ok = true;
+
+#if BENCH_HAVE_SIMAVR
+    if (benchElf) ok = runBench(benchElf, inputs, echo, bench) && ok;
+    if (firmwareElf) ok = runFirmware(firmwareElf, inputs, seconds, echo, loopRun) && ok;
+#else
+    (void)seconds;
+    (void)echo;
+    if (benchElf || firmwareElf) {
+        fprintf(stderr, "bench_runner: built without simavr, only --footprint is available\n");
+        return 2;
+    }
+#endif
+    if (bench.ran) printBench(bench);
+    if (loopRun.ran) printLoop(loopRun);
+
+    const char* elf = footprintElf ? footprintElf : firmwareElf;
+    if (elf) {
+        ok = readFootprint(elf, footprint) && ok;
+        if (footprint.ran) printFootprint(footprint, top);
+    }
+
+    if (jsonPath && !writeJson(jsonPath, bench, loopRun, footprint)) return 2;
+    return ok ? 0 : 1;
+}
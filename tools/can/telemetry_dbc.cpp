@@ -0,0 +1,221 @@
+// -----------------------------------------------------------------------------
+// telemetry_dbc - Generates the CAN DBC from CanTelemetryLayout.h
+// -----------------------------------------------------------------------------
+// Usage:
+//   telemetry_dbc                  DBC on stdout
+//   telemetry_dbc <file>           write <file>
+//   telemetry_dbc --check <file>   exit 1 if <file> is not up to date
+//
+// Telemetry and PumpShare frames are sent by PumpControl (PumpShare once per
+// board id); PumpCommand is sent by the ECU.
+// The layout is also validated here: signals must fit their frame and must
+// not overlap. The `dbc` CMake target regenerates docs/PumpControl.dbc.
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+#include "Config.h"
+#include "CanTelemetryLayout.h"
+
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// index selects the signal set; the PumpShare frames share one set
+struct FrameDef {
+    int index;
+    const char* name;
+    unsigned id;
+    unsigned dlc;
+    const char* sender;
+    const char* comment;
+};
+
+// Signal sets of PumpCommand and PumpShare (telemetry frames use 0..FRAME_COUNT-1)
+const int kCommandFrame = 100;
+const int kShareFrame = 200;
+
+struct SignalDef {
+    int frame;
+    const char* name;
+    unsigned start;
+    unsigned length;
+    bool isSigned;
+    double factor;
+    double offset;
+    const char* unit;
+    const char* comment;
+};
+
+struct ValueDef {
+    const char* signal;
+    int raw;
+    const char* label;
+};
+
+const FrameDef kFrames[] = {
+#define DBC_FRAME(frame, name, idOffset, dlc, comment) \
+    {frame, #name, Config::CAN_TELEMETRY_BASE_ID + idOffset, dlc, "PumpControl", comment},
+    PUMP_TELEMETRY_FRAMES(DBC_FRAME)
+#undef DBC_FRAME
+    {kCommandFrame, "PumpCommand", Config::CAN_COMMAND_ID, 8, "ECU",
+     "Setpoint command to PumpControl (duty or pressure), checked by counter and CRC-8"},
+#define DBC_SHARE_FRAME(n) \
+    {kShareFrame, "PumpShare" #n, Config::CAN_LOAD_SHARE_BASE_ID + n, 8, "PumpControl", \
+     "Load sharing state of board " #n " (CAN_NODE_ID = " #n ")"},
+    DBC_SHARE_FRAME(0) DBC_SHARE_FRAME(1) DBC_SHARE_FRAME(2) DBC_SHARE_FRAME(3)
+#undef DBC_SHARE_FRAME
+};
+
+const SignalDef kSignals[] = {
+#define DBC_SIGNAL(frame, name, start, len, sgn, factor, offset, unit, comment) \
+    {frame, #name, start, len, sgn != 0, factor, offset, unit, comment},
+    PUMP_TELEMETRY_SIGNALS(DBC_SIGNAL)
+#undef DBC_SIGNAL
+#define DBC_COMMAND_SIGNAL(frame, name, start, len, sgn, factor, offset, unit, comment) \
+    {kCommandFrame + frame, #name, start, len, sgn != 0, factor, offset, unit, comment},
+    PUMP_COMMAND_SIGNALS(DBC_COMMAND_SIGNAL)
+#undef DBC_COMMAND_SIGNAL
+#define DBC_SHARE_SIGNAL(frame, name, start, len, sgn, factor, offset, unit, comment) \
+    {kShareFrame + frame, #name, start, len, sgn != 0, factor, offset, unit, comment},
+    PUMP_SHARE_SIGNALS(DBC_SHARE_SIGNAL)
+#undef DBC_SHARE_SIGNAL
+};
+
+const ValueDef kValues[] = {
+#define DBC_VALUE(signal, raw, label) {#signal, raw, label},
+    PUMP_TELEMETRY_VALUES(DBC_VALUE)
+#undef DBC_VALUE
+};
+
+// Layout constants are single precision in the firmware: print the shortest
+// fixed-point form that matches to float accuracy (0.001, not 0.0010000000475)
+std::string num(double v) {
+    char buf[32];
+    for (int decimals = 0; decimals <= 9; decimals++) {
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        if (fabs(strtod(buf, nullptr) - v) <= 1e-6 * fmax(1.0, fabs(v))) break;
+    }
+    return buf;
+}
+
+bool validate() {
+    bool ok = true;
+    for (const SignalDef& s : kSignals) {
+        bool found = false;
+        for (const FrameDef& f : kFrames) {
+            if (f.index == s.frame) found = true;
+        }
+        if (!found) {
+            fprintf(stderr, "%s refers to an unknown frame\n", s.name);
+            ok = false;
+        }
+    }
+    for (const FrameDef& f : kFrames) {
+        unsigned long long used = 0;
+        for (const SignalDef& s : kSignals) {
+            if (s.frame != f.index) continue;
+            if (s.start + s.length > f.dlc * 8) {
+                fprintf(stderr, "%s.%s exceeds frame length\n", f.name, s.name);
+                ok = false;
+                continue;
+            }
+            unsigned long long mask = ((s.length == 64) ? ~0ULL : ((1ULL << s.length) - 1)) << s.start;
+            if (used & mask) {
+                fprintf(stderr, "%s.%s overlaps another signal\n", f.name, s.name);
+                ok = false;
+            }
+            used |= mask;
+        }
+    }
+    for (const ValueDef& v : kValues) {
+        bool found = false;
+        for (const SignalDef& s : kSignals) {
+            if (std::string(s.name) == v.signal) found = true;
+        }
+        if (!found) {
+            fprintf(stderr, "value table for unknown signal %s\n", v.signal);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+std::string generate() {
+    std::ostringstream o;
+    o << "VERSION \"\"\n\n";
+    o << "NS_ :\n    CM_\n    BA_DEF_\n    BA_\n    VAL_\n    BA_DEF_DEF_\n    SIG_VALTYPE_\n\n";
+    o << "BS_:\n\n";
+    o << "BU_: PumpControl ECU\n\n";
+
+    for (const FrameDef& f : kFrames) {
+        const char* receiver = (f.index == kCommandFrame || f.index == kShareFrame) ? "PumpControl" : "Vector__XXX";
+        o << "BO_ " << f.id << " " << f.name << ": " << f.dlc << " " << f.sender << "\n";
+        for (const SignalDef& s : kSignals) {
+            if (s.frame != f.index) continue;
+            double rawMin = s.isSigned ? -(double)(1LL << (s.length - 1)) : 0.0;
+            double rawMax = s.isSigned ? (double)((1LL << (s.length - 1)) - 1) : (double)((1LL << s.length) - 1);
+            float factor = (float)s.factor;
+            float offset = (float)s.offset;
+            o << " SG_ " << s.name << " : " << s.start << "|" << s.length << "@1" << (s.isSigned ? "-" : "+")
+              << " (" << num(factor) << "," << num(offset) << ")"
+              << " [" << num(rawMin * factor + offset) << "|" << num(rawMax * factor + offset) << "]"
+              << " \"" << s.unit << "\" " << receiver << "\n";
+        }
+        o << "\n";
+    }
+
+    o << "CM_ \"PumpControl telemetry and command. Generated by tools/can/telemetry_dbc from "
+         "src/PumpControl/CanTelemetryLayout.h - do not edit.\";\n";
+    for (const FrameDef& f : kFrames) {
+        o << "CM_ BO_ " << f.id << " \"" << f.comment << "\";\n";
+    }
+    for (const FrameDef& f : kFrames) {
+        for (const SignalDef& s : kSignals) {
+            if (s.frame != f.index) continue;
+            o << "CM_ SG_ " << f.id << " " << s.name << " \"" << s.comment << "\";\n";
+        }
+    }
+    o << "\n";
+
+    for (const FrameDef& f : kFrames) {
+        for (const SignalDef& s : kSignals) {
+            if (s.frame != f.index) continue;
+            bool any = false;
+            for (const ValueDef& v : kValues) {
+                if (std::string(v.signal) != s.name) continue;
+                if (!any) o << "VAL_ " << f.id << " " << s.name;
+                o << " " << v.raw << " \"" << v.label << "\"";
+                any = true;
+            }
+            if (any) o << " ;\n";
+        }
+    }
+    return o.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (!validate()) return 2;
+    std::string dbc = generate();
+
+    if (argc == 3 && std::string(argv[1]) == "--check") {
+        std::ifstream in(argv[2], std::ios::binary);
+        std::stringstream cur;
+        cur << in.rdbuf();
+        if (cur.str() != dbc) {
+            fprintf(stderr, "%s is out of date - regenerate with the 'dbc' target\n", argv[2]);
+            return 1;
+        }
+        return 0;
+    }
+    if (argc == 2) {
+        std::ofstream out(argv[1], std::ios::binary);
+        out << dbc;
+        return out ? 0 : 1;
+    }
+    fputs(dbc.c_str(), stdout);
+    return 0;
+}
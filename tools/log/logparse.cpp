@@ -0,0 +1,912 @@
+// -----------------------------------------------------------------------------
+// logparse - Serial logs of the firmware to columns + summary statistics
+// -----------------------------------------------------------------------------
+// Usage:
+//   logparse [-o FILE.pcl] [-j N] [--quiet] <log> [<log> ...]
+//   logparse --info FILE.pcl
+//
+// Reads what the loggers capture from the Nano's Serial port:
+//   - tick lines (ENABLE_SERIAL_TICK_LOG, one per control tick):
+//       *** MAP MODE *** | P:0.25bar | T%:85% | Vo:11.7V | Vs:13.9V | I1:12.3A | I2:12.1A | Lim:100% | NORMAL
+//     and the EXTERNAL PWM / CAN variants (PWM In:60.0% @ 300.0Hz, P cmd:, T%:)
+//     The tick line is off by default while CAN telemetry is on: set
+//     Config::ENABLE_SERIAL_TICK_LOG = true for the tick table, mode/level
+//     times, I1/I2/Vs peaks and duty histogram. Without it only events and
+//     status reports are summarised
+//   - events: [PROTECTION], [VOLTAGE_PROTECTION], [PWM], [CAN], [CAL],
+//     [PUMP_SPEED] lines and the EMERGENCY banner
+//   - STATUS REPORT blocks (Uptime, supply, heatsink, duty, CPU idle ...)
+// An optional timestamp from the logger in front of each line is used when
+// present: "HH:MM:SS.mmm -> " (Arduino serial monitor) or "<seconds> ".
+// Without it, tick times come from the Uptime of the status reports (1 Hz),
+// interpolated over the ticks in between; a smaller Uptime starts a new boot.
+//
+// Speed: the log is mmap()ed and split into one chunk per thread at tick-line
+// boundaries. Each chunk is indexed 64 bytes at a time with SSE2 compares
+// (positions of '\n' and '|' as bitmasks, simdjson-style), then the lines are
+// parsed from that index with a fixed-point number scanner - no strtod, no
+// copies. Throughput is printed at the end.
+//
+// Output (-o): a columnar file, one little-endian array per field:
+//   "PCLOG001", uint32 column count, uint32 0, then per column a 48-byte
+//   descriptor {char name[24]; uint8 type; uint8 pad[7]; uint64 count;
+//   uint64 offset}, then the arrays (8-byte aligned). Types: 1 f32, 2 f64,
+//   3 u8, 4 u32, 5 u64. Tables: tick.*, event.*, status.*; missing values are
+//   NaN. numpy: np.frombuffer(data, dtype, count, offset) per descriptor.
+// Event rows point back at the log line (event.offset/event.length, offset
+// from the start of the concatenated inputs).
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+#include "Config.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const float NaN = NAN;
+
+// ============================================================================
+// Tables
+// ============================================================================
+
+enum Mode : uint8_t { MODE_MAP, MODE_EXTERNAL_PWM, MODE_CAN };
+enum Level : uint8_t { LEVEL_NORMAL, LEVEL_FAULT, LEVEL_EMERGENCY, LEVEL_UNKNOWN = 255 };
+const char* const LEVEL_NAMES[3] = {"NORMAL", "FAULT", "EMERGENCY"};
+
+enum Tag : uint8_t {
+    TAG_PROTECTION, TAG_VOLTAGE_PROTECTION, TAG_PWM, TAG_CAN, TAG_CAL, TAG_PUMP_SPEED,
+    TAG_EMERGENCY_BANNER, TAG_OTHER, TAG_COUNT
+};
+const char* const TAG_NAMES[TAG_COUNT] = {
+    "PROTECTION", "VOLTAGE_PROTECTION", "PWM", "CAN", "CAL", "PUMP_SPEED", "EMERGENCY banner", "other"};
+
+// event.kind for PROTECTION / VOLTAGE_PROTECTION
+enum Kind : uint8_t { KIND_INFO, KIND_LEVEL_CHANGE, KIND_FAULT_EVENT, KIND_RECOVERED };
+
+struct Ticks {
+    std::vector<double> t;       // Logger timestamp (NaN: none), then log time
+    std::vector<uint8_t> mode;
+    std::vector<uint8_t> level;
+    std::vector<float> pBar, dutyPct, vt, vo, vs, i1, i2, limPct, pwmHz, pCmd;
+
+    size_t size() const { return mode.size(); }
+    void append(const Ticks& o) {
+        t.insert(t.end(), o.t.begin(), o.t.end());
+        mode.insert(mode.end(), o.mode.begin(), o.mode.end());
+        level.insert(level.end(), o.level.begin(), o.level.end());
+        for (size_t f = 0; f < FLOATS; f++) {
+            std::vector<float>& v = this->*floats[f];
+            const std::vector<float>& w = o.*floats[f];
+            v.insert(v.end(), w.begin(), w.end());
+        }
+    }
+    void push(double time, uint8_t m) {
+        t.push_back(time);
+        mode.push_back(m);
+        level.push_back(LEVEL_UNKNOWN);
+        for (size_t f = 0; f < FLOATS; f++) (this->*floats[f]).push_back(NaN);
+    }
+
+    static const size_t FLOATS = 10;
+    static std::vector<float> Ticks::* const floats[FLOATS];
+};
+std::vector<float> Ticks::* const Ticks::floats[Ticks::FLOATS] = {
+    &Ticks::pBar, &Ticks::dutyPct, &Ticks::vt, &Ticks::vo, &Ticks::vs,
+    &Ticks::i1, &Ticks::i2, &Ticks::limPct, &Ticks::pwmHz, &Ticks::pCmd};
+
+struct Event {
+    double t;          // Logger timestamp (NaN: none), then log time
+    uint64_t tick;     // Ticks before it (chunk-local, then global)
+    uint64_t offset;   // Line in the input
+    uint32_t length;
+    uint8_t tag, kind, from, to;
+    float value;       // Current (level change), count (fault event)
+};
+
+// Status report fields, in column order
+enum StatusField {
+    ST_UPTIME, ST_SUPPLY, ST_HEATSINK, ST_DUTY, ST_MAX_CURRENT, ST_CPU_IDLE, ST_FAULTS,
+    ST_FREE_RAM, ST_FIELDS
+};
+const struct {
+    const char* key;     // Line start, up to and including ':'
+    uint8_t length;
+    const char* column;
+} STATUS_KEYS[ST_FIELDS] = {
+    {"Uptime:", 7, "status.uptime_s"},
+    {"Supply Voltage:", 15, "status.supply_v"},
+    {"Heatsink Temp:", 14, "status.heatsink_c"},
+    {"PWM Duty:", 9, "status.duty_pct"},
+    {"Max Current:", 12, "status.max_current_a"},
+    {"CPU Idle:", 9, "status.cpu_idle_pct"},
+    {"Fault Count:", 12, "status.fault_count"},
+    {"Memory:", 7, "status.free_ram_b"},
+};
+
+struct Status {
+    double t;
+    uint64_t tick;
+    float field[ST_FIELDS];
+};
+
+// Everything one thread found in its chunk, in file order
+struct Chunk {
+    const char* begin;
+    const char* end;
+    Ticks ticks;
+    std::vector<Event> events;
+    std::vector<Status> status;
+    uint64_t lines = 0;
+    uint64_t malformed = 0;
+};
+
+// ============================================================================
+// Scanning
+// ============================================================================
+
+// Positions of '\n' and '|' in [p, p + n), 64 bytes per step. The bitmask of
+// each class comes from four 16-byte compares; set bits are then walked with
+// ctz, so the cost does not depend on line length.
+void indexStructurals(const char* p, size_t n, std::vector<uint32_t>& out) {
+    out.clear();
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i pipe = _mm_set1_epi8('|');
+    for (; i + 64 <= n; i += 64) {
+        uint64_t mask = 0;
+        for (int k = 0; k < 4; k++) {
+            __m128i b = _mm_loadu_si128((const __m128i*)(p + i + 16 * k));
+            __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(b, nl), _mm_cmpeq_epi8(b, pipe));
+            mask |= (uint64_t)(uint32_t)_mm_movemask_epi8(hit) << (16 * k);
+        }
+        while (mask) {
+            out.push_back((uint32_t)(i + __builtin_ctzll(mask)));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (p[i] == '\n' || p[i] == '|') out.push_back((uint32_t)i);
+    }
+}
+
+// Fixed-point decimal as printed by Print::print(float, digits) / print(long);
+// "nan", "inf", "ovf" and anything else that is not a number give NaN
+float parseNumber(const char*& p, const char* end) {
+    while (p < end && *p == ' ') p++;
+    bool negative = p < end && *p == '-';
+    if (negative) p++;
+    if (p == end || (unsigned)(*p - '0') > 9) return NaN;
+    uint64_t mantissa = 0;
+    int scale = 0;
+    for (; p < end && (unsigned)(*p - '0') <= 9; p++) mantissa = mantissa * 10 + (*p - '0');
+    if (p < end && *p == '.') {
+        for (p++; p < end && (unsigned)(*p - '0') <= 9; p++) {
+            if (scale < 9) {
+                mantissa = mantissa * 10 + (*p - '0');
+                scale++;
+            }
+        }
+    }
+    static const double POW10[10] = {1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+    double v = (double)mantissa / POW10[scale];
+    return (float)(negative ? -v : v);
+}
+
+// Literal prefixes: length known at compile time, memcmp inlined
+template <size_t N>
+bool startsWith(const char* p, const char* end, const char (&prefix)[N]) {
+    return (size_t)(end - p) >= N - 1 && memcmp(p, prefix, N - 1) == 0;
+}
+
+uint8_t parseLevel(const char* p, const char* end) {
+    while (p < end && *p == ' ') p++;
+    if (p == end) return LEVEL_UNKNOWN;
+    switch (*p) {
+        case 'N': return startsWith(p, end, "NORMAL") ? LEVEL_NORMAL : LEVEL_UNKNOWN;
+        case 'F': return startsWith(p, end, "FAULT") ? LEVEL_FAULT : LEVEL_UNKNOWN;
+        case 'E': return startsWith(p, end, "EMERGENCY") ? LEVEL_EMERGENCY : LEVEL_UNKNOWN;
+        default: return LEVEL_UNKNOWN;
+    }
+}
+
+// Logger timestamp in front of the line; advances p past it
+double parsePrefix(const char*& p, const char* end) {
+    const char* q = p;
+    if (end - q >= 12 && q[2] == ':' && q[5] == ':' && q[8] == '.') {
+        // HH:MM:SS.mmm -> (Arduino serial monitor)
+        int h = (q[0] - '0') * 10 + (q[1] - '0');
+        int m = (q[3] - '0') * 10 + (q[4] - '0');
+        const char* s = q + 6;
+        double sec = parseNumber(s, end);
+        if (s + 3 <= end && memcmp(s, " ->", 3) == 0) s += 3;
+        if (s < end && *s == ' ') s++;
+        p = s;
+        return h * 3600.0 + m * 60.0 + sec;
+    }
+    double v = parseNumber(q, end);
+    if (q < end && (*q == ' ' || *q == '\t')) {
+        p = q + 1;
+        return v;
+    }
+    return NaN;
+}
+
+// Tick line; fields are the '|' positions in [sep, sepEnd)
+void parseTick(Chunk& c, double t, const char* line, const char* end, const uint32_t* sep,
+               const uint32_t* sepEnd, const char* base) {
+    uint8_t mode = line[4] == 'M' ? MODE_MAP : line[4] == 'E' ? MODE_EXTERNAL_PWM : MODE_CAN;
+    Ticks& k = c.ticks;
+    k.push(t, mode);
+    size_t row = k.size() - 1;
+    if (sep == sepEnd) {
+        c.malformed++;
+        return;
+    }
+    for (const uint32_t* s = sep; s < sepEnd; s++) {
+        const char* f = base + *s + 1;
+        const char* fEnd = s + 1 < sepEnd ? base + s[1] : end;
+        while (f < fEnd && *f == ' ') f++;
+        if (f >= fEnd) continue;
+        const char* colon = (const char*)memchr(f, ':', fEnd - f);
+        if (!colon) {
+            k.level[row] = parseLevel(f, fEnd);  // Last field
+            continue;
+        }
+        const char* v = colon + 1;
+        size_t keyLen = colon - f;
+        float x = parseNumber(v, fEnd);
+        switch (f[0]) {
+            case 'P':
+                if (keyLen == 1) k.pBar[row] = x;
+                else if (keyLen == 5 && f[2] == 'c') k.pCmd[row] = x;
+                else if (keyLen == 6 && f[1] == 'W') {  // "PWM In:60.0% @ 300.0Hz"
+                    k.dutyPct[row] = x;
+                    const char* at = (const char*)memchr(v, '@', fEnd - v);
+                    if (at) {
+                        const char* hz = at + 1;
+                        k.pwmHz[row] = parseNumber(hz, fEnd);
+                    }
+                }
+                break;
+            case 'T': k.dutyPct[row] = x; break;
+            case 'V':
+                if (f[1] == 't') k.vt[row] = x;
+                else if (f[1] == 'o') k.vo[row] = x;
+                else if (f[1] == 's') k.vs[row] = x;
+                break;
+            case 'I':
+                if (f[1] == '1') k.i1[row] = x;
+                else if (f[1] == '2') k.i2[row] = x;
+                break;
+            case 'L': k.limPct[row] = x; break;
+            default: break;
+        }
+    }
+}
+
+// "FROM -> TO | Current: 41.23A | ...": levels and the first value
+void parseTransition(Event& e, const char* p, const char* end) {
+    e.kind = KIND_LEVEL_CHANGE;
+    e.from = parseLevel(p, end);
+    const char* arrow = (const char*)memchr(p, '>', end - p);
+    if (arrow) e.to = parseLevel(arrow + 1, end);
+    const char* colon = (const char*)memchr(p, ':', end - p);
+    if (colon) {
+        const char* v = colon + 1;
+        e.value = parseNumber(v, end);
+    }
+}
+
+// "*** FAULT EVENT *** Count: 3"
+void parseCount(Event& e, const char* p, const char* end) {
+    e.kind = KIND_FAULT_EVENT;
+    const char* colon = (const char*)memchr(p, ':', end - p);
+    if (colon) {
+        const char* v = colon + 1;
+        e.value = parseNumber(v, end);
+    }
+}
+
+void parseEvent(Chunk& c, double t, const char* line, const char* end, uint64_t offset) {
+    Event e;
+    e.t = t;
+    e.tick = c.ticks.size();
+    e.offset = offset;
+    e.length = (uint32_t)(end - line);
+    e.kind = KIND_INFO;
+    e.from = e.to = LEVEL_UNKNOWN;
+    e.value = NaN;
+    if (line[0] == '!') {
+        e.tag = TAG_EMERGENCY_BANNER;
+    } else if (startsWith(line, end, "[PROTECTION] ")) {
+        e.tag = TAG_PROTECTION;
+        const char* p = line + 13;
+        if (startsWith(p, end, "Level change: ")) {
+            parseTransition(e, p + 14, end);  // NORMAL -> FAULT | Current: 41.23A | ...
+        } else if (startsWith(p, end, "*** FAULT EVENT ***")) {
+            parseCount(e, p, end);
+        } else if (startsWith(p, end, "Recovered")) {
+            e.kind = KIND_RECOVERED;
+        }
+    } else if (startsWith(line, end, "[VOLTAGE_PROTECTION] ")) {
+        e.tag = TAG_VOLTAGE_PROTECTION;
+        const char* p = line + 21;
+        if (startsWith(p, end, "Sensor status: ")) {
+            parseTransition(e, p + 15, end);  // NORMAL -> FAULT | Voltage: 7.12V | ...
+        } else if (startsWith(p, end, "*** SENSOR FAULT ***")) {
+            parseCount(e, p, end);
+        } else if (startsWith(p, end, "Sensor recovered")) {
+            e.kind = KIND_RECOVERED;
+        }
+    } else if (startsWith(line, end, "[PWM]")) {
+        e.tag = TAG_PWM;
+    } else if (startsWith(line, end, "[CAN]")) {
+        e.tag = TAG_CAN;
+    } else if (startsWith(line, end, "[CAL]")) {
+        e.tag = TAG_CAL;
+    } else if (startsWith(line, end, "[PUMP_SPEED]")) {
+        e.tag = TAG_PUMP_SPEED;
+    } else {
+        e.tag = TAG_OTHER;
+    }
+    c.events.push_back(e);
+}
+
+// One chunk: index a window, walk its lines, next window
+void parseChunk(Chunk& c, uint64_t chunkOffset) {
+    const size_t WINDOW = 1 << 20;
+    std::vector<uint32_t> index;
+    index.reserve(WINDOW / 8);
+    bool inStatus = false;
+    int statusFields = 0;  // Key lines seen; the dashes after them close the block
+    Status st = {};
+    const char* p = c.begin;
+    while (p < c.end) {
+        size_t n = std::min((size_t)(c.end - p), WINDOW);
+        if (p + n < c.end) {
+            // Window ends after its last complete line
+            const char* nl = (const char*)memrchr(p, '\n', n);
+            if (nl) n = nl + 1 - p;
+        }
+        indexStructurals(p, n, index);
+        const uint32_t* s = index.data();
+        const uint32_t* sEnd = s + index.size();
+        const char* line = p;
+        while (line < p + n) {
+            // Separators up to the end of this line
+            const uint32_t* sep = s;
+            while (s < sEnd && p[*s] != '\n') s++;
+            const char* end = s < sEnd ? p + *s : p + n;
+            const char* next = end + 1;
+            if (s < sEnd) s++;
+            c.lines++;
+            if (end > line && end[-1] == '\r') end--;
+
+            const char* text = line;
+            double t = NaN;
+            if (text < end && (unsigned)(*text - '0') <= 9) t = parsePrefix(text, end);
+            // '|' positions that belong to the text after the prefix
+            const uint32_t* sepText = sep;
+            while (sepText < s && p + *sepText < text) sepText++;
+            const uint32_t* sepEnd = s;
+            if (sepEnd > sepText && p[sepEnd[-1]] == '\n') sepEnd--;
+
+            if (text < end) {
+                if (inStatus) {
+                    if (*text == '-' && statusFields > 0) {
+                        c.status.push_back(st);
+                        inStatus = false;
+                    } else {
+                        for (int f = 0; f < ST_FIELDS; f++) {
+                            size_t len = STATUS_KEYS[f].length;
+                            if (*text == STATUS_KEYS[f].key[0] && (size_t)(end - text) >= len &&
+                                memcmp(text, STATUS_KEYS[f].key, len) == 0) {
+                                const char* v = text + len;
+                                if (f == ST_FREE_RAM) {  // "Memory:          free 1234 B | ..."
+                                    while (v < end && (*v == ' ' || (*v >= 'a' && *v <= 'z'))) v++;
+                                }
+                                st.field[f] = parseNumber(v, end);
+                                statusFields++;
+                                break;
+                            }
+                        }
+                    }
+                }
+                if (*text == '*' && end - text > 4 && text[1] == '*' && text[2] == '*') {
+                    parseTick(c, t, text, end, sepText, sepEnd, p);
+                } else if (*text == '[' || (*text == '!' && startsWith(text, end, "!!!   EMERGENCY"))) {
+                    parseEvent(c, t, text, end, chunkOffset + (uint64_t)(text - c.begin));
+                } else if (startsWith(text, end, "STATUS REPORT")) {
+                    inStatus = true;
+                    statusFields = 0;
+                    st.t = t;
+                    st.tick = c.ticks.size();
+                    for (int f = 0; f < ST_FIELDS; f++) st.field[f] = NaN;
+                }
+            }
+            line = next;
+        }
+        p += n;
+    }
+}
+
+// Chunk boundaries: about size/n apart, moved forward to the start of a tick
+// line so no STATUS REPORT block is split between two threads
+std::vector<Chunk> splitChunks(const char* data, size_t size, unsigned n) {
+    std::vector<Chunk> chunks;
+    const char* begin = data;
+    for (unsigned i = 1; i <= n && begin < data + size; i++) {
+        const char* end = data + size;
+        if (i < n) {
+            const char* target = data + size / n * i;
+            if (target > begin) {
+                const char* q = target;
+                while (q < data + size) {
+                    const char* nl = (const char*)memchr(q, '\n', data + size - q);
+                    if (!nl) {
+                        q = data + size;
+                        break;
+                    }
+                    q = nl + 1;
+                    if (data + size - q >= 3 && q[0] == '*' && q[1] == '*' && q[2] == '*') break;
+                }
+                end = q;
+            } else {
+                continue;
+            }
+        }
+        Chunk c;
+        c.begin = begin;
+        c.end = end;
+        chunks.push_back(std::move(c));
+        begin = end;
+    }
+    return chunks;
+}
+
+// ============================================================================
+// Time base
+// ============================================================================
+
+// Ticks and events without a logger timestamp get one from the status
+// reports' Uptime: linear between consecutive reports of the same boot,
+// MAIN_LOOP_INTERVAL_MS steps before the first / after the last one.
+// Each boot continues the time axis where the previous one ended.
+void assignTimes(Ticks& ticks, std::vector<Event>& events, std::vector<Status>& status,
+                 unsigned& boots) {
+    const double nominal = Config::MAIN_LOOP_INTERVAL_MS / 1000.0;
+    size_t n = ticks.size();
+    bool prefixed = n && !std::isnan(ticks.t[0]);
+    if (prefixed) {
+        // Logger clock: HH:MM:SS wraps at midnight
+        double offset = 0.0;
+        double last = ticks.t[0];
+        for (size_t i = 0; i < n; i++) {
+            if (std::isnan(ticks.t[i])) {
+                ticks.t[i] = last - offset + nominal;
+            } else if (ticks.t[i] + offset < last - 43200.0) {
+                offset += 86400.0;
+            }
+            ticks.t[i] += offset;
+            last = ticks.t[i];
+        }
+        boots = 1;
+    } else {
+        // Anchors: (tick index, uptime) per status report with an Uptime
+        struct Anchor { uint64_t tick; double uptime; };
+        std::vector<Anchor> anchors;
+        for (const Status& s : status) {
+            if (!std::isnan(s.field[ST_UPTIME])) anchors.push_back({s.tick, s.field[ST_UPTIME]});
+        }
+        boots = 1;
+        double base = 0.0;  // Log time of uptime 0 in the current boot
+        size_t a = 0;
+        for (size_t i = 0; i < n; i++) {
+            while (a < anchors.size() && anchors[a].tick <= i) {
+                if (a > 0 && anchors[a].uptime < anchors[a - 1].uptime) {
+                    base = (i ? ticks.t[i - 1] : 0.0) + nominal;
+                    boots++;
+                }
+                a++;
+            }
+            const Anchor* prev = a > 0 ? &anchors[a - 1] : nullptr;
+            const Anchor* next = a < anchors.size() ? &anchors[a] : nullptr;
+            bool sameBoot = prev && next && next->uptime >= prev->uptime && next->tick > prev->tick;
+            double t;
+            if (sameBoot) {
+                t = prev->uptime + (next->uptime - prev->uptime) * (double)(i - prev->tick) /
+                                       (double)(next->tick - prev->tick);
+            } else if (prev) {
+                t = prev->uptime + (double)(i - prev->tick) * nominal;
+            } else if (next) {
+                t = next->uptime - (double)(next->tick - i) * nominal;
+            } else {
+                t = (double)i * nominal;
+            }
+            ticks.t[i] = base + t;
+        }
+    }
+    if (n == 0) {
+        // No tick lines (tick log off): reports keep a logger timestamp or
+        // take their own Uptime, events only a logger timestamp
+        double base = 0.0, last = NaN;
+        for (Status& s : status) {
+            double up = s.field[ST_UPTIME];
+            if (!std::isnan(up)) {
+                if (!std::isnan(last) && up < last) {
+                    base += last + nominal;
+                    boots++;
+                }
+                last = up;
+            }
+            if (std::isnan(s.t)) s.t = base + (std::isnan(last) ? 0.0 : last);
+        }
+        for (Event& e : events) {
+            if (std::isnan(e.t)) e.t = 0.0;
+        }
+        return;
+    }
+    auto atTick = [&](uint64_t tick) {
+        return tick < n ? ticks.t[tick] : (n ? ticks.t[n - 1] + nominal : 0.0);
+    };
+    // Logger timestamps of events/reports get the same midnight offset as
+    // the tick they follow
+    auto place = [&](double& t, uint64_t tick) {
+        double ref = atTick(tick);
+        if (!prefixed || std::isnan(t)) t = ref;
+        else t += 86400.0 * floor((ref - t + 43200.0) / 86400.0);
+    };
+    for (Event& e : events) place(e.t, e.tick);
+    for (Status& s : status) place(s.t, s.tick);
+}
+
+// ============================================================================
+// Columnar output
+// ============================================================================
+
+enum ColumnType : uint8_t { COL_F32 = 1, COL_F64 = 2, COL_U8 = 3, COL_U32 = 4, COL_U64 = 5 };
+const size_t TYPE_SIZE[6] = {0, 4, 8, 1, 4, 8};
+const char MAGIC[8] = {'P', 'C', 'L', 'O', 'G', '0', '0', '1'};
+
+struct ColumnDesc {
+    char name[24];
+    uint8_t type;
+    uint8_t pad[7];
+    uint64_t count;
+    uint64_t offset;
+};
+static_assert(sizeof(ColumnDesc) == 48, "descriptor layout");
+
+struct Column {
+    std::string name;
+    uint8_t type;
+    const void* data;
+    uint64_t count;
+};
+
+template <typename T>
+Column column(const char* name, uint8_t type, const std::vector<T>& v) {
+    return Column{name, type, v.data(), v.size()};
+}
+
+bool writeColumns(const char* path, const std::vector<Column>& cols) {
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        perror(path);
+        return false;
+    }
+    uint32_t header[2] = {(uint32_t)cols.size(), 0};
+    fwrite(MAGIC, 1, sizeof(MAGIC), out);
+    fwrite(header, sizeof(header), 1, out);
+    uint64_t offset = sizeof(MAGIC) + sizeof(header) + cols.size() * sizeof(ColumnDesc);
+    for (const Column& c : cols) {
+        ColumnDesc d;
+        memset(&d, 0, sizeof(d));
+        strncpy(d.name, c.name.c_str(), sizeof(d.name) - 1);
+        d.type = c.type;
+        d.count = c.count;
+        offset = (offset + 7) & ~(uint64_t)7;
+        d.offset = offset;
+        offset += c.count * TYPE_SIZE[c.type];
+        fwrite(&d, sizeof(d), 1, out);
+    }
+    uint64_t pos = sizeof(MAGIC) + sizeof(header) + cols.size() * sizeof(ColumnDesc);
+    static const char zeros[8] = {};
+    for (const Column& c : cols) {
+        uint64_t aligned = (pos + 7) & ~(uint64_t)7;
+        fwrite(zeros, 1, aligned - pos, out);
+        fwrite(c.data, TYPE_SIZE[c.type], c.count, out);
+        pos = aligned + c.count * TYPE_SIZE[c.type];
+    }
+    return fclose(out) == 0;
+}
+
+int printInfo(const char* path) {
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return 2;
+    }
+    char magic[8];
+    uint32_t header[2];
+    if (fread(magic, 1, 8, in) != 8 || memcmp(magic, MAGIC, 8) != 0 ||
+        fread(header, sizeof(header), 1, in) != 1) {
+        fprintf(stderr, "logparse: %s is not a logparse column file\n", path);
+        fclose(in);
+        return 2;
+    }
+    static const char* const TYPE_NAMES[6] = {"?", "f32", "f64", "u8", "u32", "u64"};
+    printf("%s: %u columns\n", path, header[0]);
+    for (uint32_t i = 0; i < header[0]; i++) {
+        ColumnDesc d;
+        if (fread(&d, sizeof(d), 1, in) != 1) break;
+        d.name[sizeof(d.name) - 1] = 0;
+        printf("  %-24s %-4s %10llu rows  @ %llu\n", d.name, TYPE_NAMES[d.type < 6 ? d.type : 0],
+               (unsigned long long)d.count, (unsigned long long)d.offset);
+    }
+    fclose(in);
+    return 0;
+}
+
+// ============================================================================
+// Summary
+// ============================================================================
+
+struct Peak {
+    float value = NaN;
+    double t = 0.0;
+    void update(float v, double at) {
+        if (!std::isnan(v) && (std::isnan(value) || v > value)) {
+            value = v;
+            t = at;
+        }
+    }
+};
+
+void printSummary(const Ticks& k, const std::vector<Event>& events, const std::vector<Status>& status,
+                  unsigned boots) {
+    const double nominal = Config::MAIN_LOOP_INTERVAL_MS / 1000.0;
+    size_t n = k.size();
+    double levelTime[4] = {0, 0, 0, 0};
+    double modeTime[3] = {0, 0, 0};
+    uint64_t dutyHist[11] = {};
+    Peak i1, i2, vsMax;
+    float vsMin = NaN;
+    double total = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double dt = i + 1 < n ? k.t[i + 1] - k.t[i] : nominal;
+        if (dt < 0.0 || dt > 1.0) dt = nominal;  // Reboot or gap in the capture
+        total += dt;
+        levelTime[k.level[i] < 3 ? k.level[i] : 3] += dt;
+        modeTime[k.mode[i]] += dt;
+        i1.update(k.i1[i], k.t[i]);
+        i2.update(k.i2[i], k.t[i]);
+        vsMax.update(k.vs[i], k.t[i]);
+        if (!std::isnan(k.vs[i]) && (std::isnan(vsMin) || k.vs[i] < vsMin)) vsMin = k.vs[i];
+        float d = k.dutyPct[i];
+        if (!std::isnan(d)) dutyHist[d <= 0.0f ? 0 : d >= 100.0f ? 10 : (int)(d / 10.0f)]++;
+    }
+
+    uint64_t tagCount[TAG_COUNT] = {};
+    uint64_t faults = 0, emergencies = 0;
+    for (const Event& e : events) {
+        tagCount[e.tag]++;
+        if (e.tag == TAG_PROTECTION && e.kind == KIND_LEVEL_CHANGE) {
+            if (e.to == LEVEL_FAULT) faults++;
+            if (e.to == LEVEL_EMERGENCY) emergencies++;
+        }
+    }
+    Peak statusMax, heatsink;
+    for (const Status& s : status) {
+        statusMax.update(s.field[ST_MAX_CURRENT], s.t);
+        heatsink.update(s.field[ST_HEATSINK], s.t);
+    }
+
+    auto pct = [&](double v) { return total > 0.0 ? 100.0 * v / total : 0.0; };
+    if (n == 0) {
+        // Default firmware with CAN telemetry: the tick line is compiled out
+        printf("\nticks          0  (no tick lines - tick log disabled? Config::ENABLE_SERIAL_TICK_LOG)\n");
+    } else {
+        printf("\nticks          %zu  (%.1f s, %u boot%s)\n", n, total, boots, boots == 1 ? "" : "s");
+        printf("  MAP          %10.1f s  %5.1f %%\n", modeTime[MODE_MAP], pct(modeTime[MODE_MAP]));
+        printf("  external PWM %10.1f s  %5.1f %%\n", modeTime[MODE_EXTERNAL_PWM], pct(modeTime[MODE_EXTERNAL_PWM]));
+        printf("  CAN          %10.1f s  %5.1f %%\n", modeTime[MODE_CAN], pct(modeTime[MODE_CAN]));
+    }
+    printf("protection\n");
+    if (n > 0) {
+        for (int l = 0; l < 3; l++) {
+            printf("  %-12s %10.1f s  %5.1f %%\n", LEVEL_NAMES[l], levelTime[l], pct(levelTime[l]));
+        }
+        if (levelTime[3] > 0.0) printf("  %-12s %10.1f s\n", "(no level)", levelTime[3]);
+    }
+    printf("  -> FAULT %llu, -> EMERGENCY %llu\n", (unsigned long long)faults,
+           (unsigned long long)emergencies);
+    // Peaks without a single sample are left out (no NaN lines)
+    printf("peaks\n");
+    if (!std::isnan(i1.value)) printf("  I1           %8.1f A  at %.1f s\n", i1.value, i1.t);
+    if (!std::isnan(i2.value)) printf("  I2           %8.1f A  at %.1f s\n", i2.value, i2.t);
+    if (!std::isnan(statusMax.value)) {
+        printf("  Max Current  %8.1f A  at %.1f s  (status reports)\n", statusMax.value, statusMax.t);
+    }
+    if (!std::isnan(vsMin)) printf("  Vs           %8.1f .. %.1f V\n", vsMin, vsMax.value);
+    if (!std::isnan(heatsink.value)) printf("  heatsink     %8.1f C  at %.1f s\n", heatsink.value, heatsink.t);
+    if (n > 0) {
+        printf("commanded duty (ticks)\n");
+        uint64_t histMax = *std::max_element(dutyHist, dutyHist + 11);
+        for (int b = 0; b < 11; b++) {
+            int bar = histMax ? (int)(40 * dutyHist[b] / histMax) : 0;
+            if (b < 10) printf("  %3d-%3d %%  %10llu  ", b * 10, b * 10 + 10, (unsigned long long)dutyHist[b]);
+            else printf("      100 %%  %10llu  ", (unsigned long long)dutyHist[b]);
+            printf("%.*s\n", bar, "########################################");
+        }
+    }
+    printf("events         %zu\n", events.size());
+    for (int t = 0; t < TAG_COUNT; t++) {
+        if (tagCount[t]) printf("  %-18s %10llu\n", TAG_NAMES[t], (unsigned long long)tagCount[t]);
+    }
+    printf("status reports %zu\n", status.size());
+}
+
+double wallSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: logparse [-o FILE.pcl] [-j N] [--quiet] <log> [<log> ...]\n"
+            "       logparse --info FILE.pcl\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* outPath = nullptr;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool quiet = false;
+    std::vector<const char*> inputs;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--info" && i + 1 < argc) return printInfo(argv[i + 1]);
+        if (arg == "-o" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "-j" && i + 1 < argc) {
+            threads = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--quiet") {
+            quiet = true;
+        } else if (arg[0] != '-') {
+            inputs.push_back(argv[i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (inputs.empty()) {
+        usage();
+        return 2;
+    }
+
+    double wallStart = wallSeconds();
+    Chunk all;
+    uint64_t bytes = 0;
+    uint64_t lines = 0, malformed = 0;
+    for (const char* path : inputs) {
+        int fd = open(path, O_RDONLY);
+        struct stat sb;
+        if (fd < 0 || fstat(fd, &sb) != 0) {
+            perror(path);
+            return 2;
+        }
+        size_t size = (size_t)sb.st_size;
+        if (size == 0) {
+            close(fd);
+            continue;
+        }
+        const char* data = (const char*)mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            perror(path);
+            return 2;
+        }
+        madvise((void*)data, size, MADV_SEQUENTIAL | MADV_WILLNEED);
+
+        std::vector<Chunk> chunks = splitChunks(data, size, threads);
+        std::vector<std::thread> workers;
+        for (Chunk& c : chunks) {
+            uint64_t offset = bytes + (uint64_t)(c.begin - data);
+            workers.emplace_back([&c, offset] { parseChunk(c, offset); });
+        }
+        for (std::thread& w : workers) w.join();
+
+        // Chunk-local tick indices become global ones
+        for (Chunk& c : chunks) {
+            uint64_t base = all.ticks.size();
+            for (Event& e : c.events) e.tick += base;
+            for (Status& s : c.status) s.tick += base;
+            all.ticks.append(c.ticks);
+            all.events.insert(all.events.end(), c.events.begin(), c.events.end());
+            all.status.insert(all.status.end(), c.status.begin(), c.status.end());
+            lines += c.lines;
+            malformed += c.malformed;
+        }
+        munmap((void*)data, size);
+        bytes += size;
+    }
+    double parseS = wallSeconds() - wallStart;
+
+    unsigned boots = 0;
+    assignTimes(all.ticks, all.events, all.status, boots);
+
+    if (outPath) {
+        std::vector<double> evT, stT;
+        std::vector<uint64_t> evOffset;
+        std::vector<uint32_t> evLength;
+        std::vector<uint8_t> evTag, evKind, evFrom, evTo;
+        std::vector<float> evValue;
+        for (const Event& e : all.events) {
+            evT.push_back(e.t);
+            evOffset.push_back(e.offset);
+            evLength.push_back(e.length);
+            evTag.push_back(e.tag);
+            evKind.push_back(e.kind);
+            evFrom.push_back(e.from);
+            evTo.push_back(e.to);
+            evValue.push_back(e.value);
+        }
+        std::vector<std::vector<float>> stFields(ST_FIELDS);
+        for (const Status& s : all.status) {
+            stT.push_back(s.t);
+            for (int f = 0; f < ST_FIELDS; f++) stFields[f].push_back(s.field[f]);
+        }
+        const Ticks& k = all.ticks;
+        std::vector<Column> cols = {
+            column("tick.t_s", COL_F64, k.t),          column("tick.mode", COL_U8, k.mode),
+            column("tick.level", COL_U8, k.level),     column("tick.p_bar", COL_F32, k.pBar),
+            column("tick.duty_pct", COL_F32, k.dutyPct), column("tick.vt_v", COL_F32, k.vt),
+            column("tick.vo_v", COL_F32, k.vo),        column("tick.vs_v", COL_F32, k.vs),
+            column("tick.i1_a", COL_F32, k.i1),        column("tick.i2_a", COL_F32, k.i2),
+            column("tick.lim_pct", COL_F32, k.limPct), column("tick.pwm_hz", COL_F32, k.pwmHz),
+            column("tick.p_cmd_bar", COL_F32, k.pCmd),
+            column("event.t_s", COL_F64, evT),         column("event.tag", COL_U8, evTag),
+            column("event.kind", COL_U8, evKind),      column("event.from", COL_U8, evFrom),
+            column("event.to", COL_U8, evTo),          column("event.value", COL_F32, evValue),
+            column("event.offset", COL_U64, evOffset), column("event.length", COL_U32, evLength),
+            column("status.t_s", COL_F64, stT),
+        };
+        for (int f = 0; f < ST_FIELDS; f++) {
+            cols.push_back(column(STATUS_KEYS[f].column, COL_F32, stFields[f]));
+        }
+        if (!writeColumns(outPath, cols)) return 2;
+    }
+
+    double wallS = wallSeconds() - wallStart;
+    if (!quiet) printSummary(all.ticks, all.events, all.status, boots);
+    fflush(stdout);
+    fprintf(stderr, "\nlogparse: %.1f MB, %llu lines (%llu malformed tick lines) in %.3f s: "
+            "parse %.0f MB/s, total %.0f MB/s with %u thread%s\n",
+            bytes / 1e6, (unsigned long long)lines, (unsigned long long)malformed, wallS,
+            parseS > 0.0 ? bytes / 1e6 / parseS : 0.0, wallS > 0.0 ? bytes / 1e6 / wallS : 0.0,
+            threads, threads == 1 ? "" : "s");
+    return 0;
+}
@@ -0,0 +1,208 @@
+// -----------------------------------------------------------------------------
+// usagedump - Decodes the binary usage dump of the firmware (UsageLog.h)
+// -----------------------------------------------------------------------------
+// Usage:
+//   usagedump [--csv] [--all] <capture>
+//
+// The capture is whatever the Serial port delivered after the dump request
+// (USAGE_DUMP_COMMAND, 'U'), text lines around it included, e.g.
+//   stty -F /dev/ttyUSB0 115200 raw; cat /dev/ttyUSB0 > cap.bin & printf U > /dev/ttyUSB0
+// or plant_sim usage_dump_s=30 --log cap.bin. Each dump is the sync bytes
+// 0xA5 0x5A followed by UsageRecord; a candidate counts only with the magic,
+// version and CRC-16 intact. The last dump is printed (--all: every one).
+//
+// Text output: counters, then the histograms in hours and % of the powered
+// time. --csv: "table,row,column,hours" lines for the spreadsheet behind pump
+// sizing and service intervals. Bin edges come from Config.h: decode with the
+// tool built from the same tree as the firmware.
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+#include "Config.h"
+#include "UsageLog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+double hours(uint32_t ds) { return ds / 36000.0; }
+
+bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(f);
+    return true;
+}
+
+std::vector<UsageRecord> findDumps(const std::vector<uint8_t>& data) {
+    std::vector<UsageRecord> dumps;
+    for (size_t i = 0; i + 2 + sizeof(UsageRecord) <= data.size(); i++) {
+        if (data[i] != UsageLog::SYNC0 || data[i + 1] != UsageLog::SYNC1) continue;
+        UsageRecord r;
+        memcpy(&r, &data[i + 2], sizeof(r));
+        if (r.magic != UsageLog::MAGIC || r.version != UsageLog::VERSION || r.crc != UsageLog::crcOf(r)) continue;
+        dumps.push_back(r);
+        i += 1 + sizeof(r);
+    }
+    return dumps;
+}
+
+std::string dutyLabel(uint8_t i) {
+    char s[32];
+    snprintf(s, sizeof(s), "%.0f-%.0f %%", 100.0 * i / Config::USAGE_DUTY_BINS,
+             100.0 * (i + 1) / Config::USAGE_DUTY_BINS);
+    return s;
+}
+
+std::string mapLabel(uint8_t i) {
+    char s[32];
+    switch (i) {
+        case USAGE_MAP_VACUUM: return "vacuum";
+        case USAGE_MAP_LOW: snprintf(s, sizeof(s), "0-%.2f", Config::MAP_BAR_LOW_SETPOINT); return s;
+        case USAGE_MAP_CURVE:
+            snprintf(s, sizeof(s), "%.2f-%.2f", Config::MAP_BAR_LOW_SETPOINT, Config::MAP_BAR_HIGH_SETPOINT);
+            return s;
+        default: snprintf(s, sizeof(s), ">%.2f", Config::MAP_BAR_HIGH_SETPOINT); return s;
+    }
+}
+
+std::string currentLabel(uint8_t i) {
+    char s[32];
+    if (i == Config::USAGE_CURRENT_BINS - 1) {
+        snprintf(s, sizeof(s), ">=%.0f A", i * Config::USAGE_CURRENT_BIN_A);
+    } else {
+        snprintf(s, sizeof(s), "%.0f-%.0f A", i * Config::USAGE_CURRENT_BIN_A, (i + 1) * Config::USAGE_CURRENT_BIN_A);
+    }
+    return s;
+}
+
+std::string tempLabel(uint8_t i) {
+    char s[32];
+    float lo = Config::USAGE_TEMP_FIRST_C + (i - 1) * Config::USAGE_TEMP_BIN_C;
+    if (i == 0) {
+        snprintf(s, sizeof(s), "<%.0f C", Config::USAGE_TEMP_FIRST_C);
+    } else if (i == Config::USAGE_TEMP_BINS - 1) {
+        snprintf(s, sizeof(s), ">=%.0f C", lo);
+    } else {
+        snprintf(s, sizeof(s), "%.0f-%.0f C", lo, lo + Config::USAGE_TEMP_BIN_C);
+    }
+    return s;
+}
+
+void printText(const UsageRecord& r) {
+    double powered = hours(r.poweredDs);
+    auto pct = [powered](double h) { return powered > 0.0 ? 100.0 * h / powered : 0.0; };
+    auto line = [&](const char* name, uint32_t ds) {
+        printf("  %-14s %10.2f h %6.1f %%\n", name, hours(ds), pct(hours(ds)));
+    };
+
+    printf("Usage record: checkpoint %u, boots %u\n", (unsigned)r.sequence, (unsigned)r.boots);
+    line("powered", r.poweredDs);
+    line("pump running", r.pumpOnDs);
+    line("FAULT", r.faultDs);
+    line("EMERGENCY", r.emergencyDs);
+    line("derating", r.deratingDs);
+    line("safety off", r.safetyOffDs);
+    printf("  %-14s %10.3f Ah\n", "charge", r.chargeMah / 1000.0);
+    printf("  %-14s %10.1f Wh\n", "energy", r.energyMwh / 1000.0);
+
+    printf("\nDuty x MAP (h, bar gauge)\n  %-10s", "");
+    for (uint8_t m = 0; m < USAGE_MAP_BINS; m++) printf(" %11s", mapLabel(m).c_str());
+    printf(" %11s\n", "total");
+    for (uint8_t d = 0; d < Config::USAGE_DUTY_BINS; d++) {
+        printf("  %-10s", dutyLabel(d).c_str());
+        uint32_t row = 0;
+        for (uint8_t m = 0; m < USAGE_MAP_BINS; m++) {
+            printf(" %11.2f", hours(r.dutyMap[d][m]));
+            row += r.dutyMap[d][m];
+        }
+        printf(" %11.2f\n", hours(row));
+    }
+
+    printf("\nCurrent (h per channel, both channels added)\n");
+    for (uint8_t i = 0; i < Config::USAGE_CURRENT_BINS; i++) {
+        printf("  %-10s %10.2f h %6.1f %%\n", currentLabel(i).c_str(), hours(r.current[i]),
+               pct(hours(r.current[i]) / 2.0));
+    }
+
+    printf("\nHeatsink temperature (h)\n");
+    for (uint8_t i = 0; i < Config::USAGE_TEMP_BINS; i++) {
+        printf("  %-10s %10.2f h %6.1f %%\n", tempLabel(i).c_str(), hours(r.heatsink[i]), pct(hours(r.heatsink[i])));
+    }
+}
+
+void printCsv(const UsageRecord& r) {
+    printf("table,row,column,hours\n");
+    printf("counter,powered,,%.4f\n", hours(r.poweredDs));
+    printf("counter,pump_running,,%.4f\n", hours(r.pumpOnDs));
+    printf("counter,fault,,%.4f\n", hours(r.faultDs));
+    printf("counter,emergency,,%.4f\n", hours(r.emergencyDs));
+    printf("counter,derating,,%.4f\n", hours(r.deratingDs));
+    printf("counter,safety_off,,%.4f\n", hours(r.safetyOffDs));
+    printf("counter,charge_ah,,%.3f\n", r.chargeMah / 1000.0);
+    printf("counter,energy_wh,,%.3f\n", r.energyMwh / 1000.0);
+    printf("counter,boots,,%u\n", (unsigned)r.boots);
+    for (uint8_t d = 0; d < Config::USAGE_DUTY_BINS; d++) {
+        for (uint8_t m = 0; m < USAGE_MAP_BINS; m++) {
+            printf("duty_map,%s,%s,%.4f\n", dutyLabel(d).c_str(), mapLabel(m).c_str(), hours(r.dutyMap[d][m]));
+        }
+    }
+    for (uint8_t i = 0; i < Config::USAGE_CURRENT_BINS; i++) {
+        printf("current,%s,,%.4f\n", currentLabel(i).c_str(), hours(r.current[i]));
+    }
+    for (uint8_t i = 0; i < Config::USAGE_TEMP_BINS; i++) {
+        printf("heatsink,%s,,%.4f\n", tempLabel(i).c_str(), hours(r.heatsink[i]));
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool csv = false;
+    bool all = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--csv")) {
+            csv = true;
+        } else if (!strcmp(argv[i], "--all")) {
+            all = true;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: usagedump [--csv] [--all] <capture>\n");
+        return 2;
+    }
+
+    std::vector<uint8_t> data;
+    if (!readFile(path, data)) {
+        fprintf(stderr, "usagedump: cannot read %s\n", path);
+        return 1;
+    }
+    std::vector<UsageRecord> dumps = findDumps(data);
+    if (dumps.empty()) {
+        fprintf(stderr, "usagedump: no valid usage dump in %s\n", path);
+        return 1;
+    }
+
+    size_t first = all ? 0 : dumps.size() - 1;
+    for (size_t i = first; i < dumps.size(); i++) {
+        if (i > first) printf("\n");
+        if (csv) {
+            printCsv(dumps[i]);
+        } else {
+            printText(dumps[i]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+// -----------------------------------------------------------------------------
+// memreport - Static SRAM usage per object from the firmware ELF
+// -----------------------------------------------------------------------------
+// Usage:
+//   memreport [--ram BYTES] [--top N] [--max-static BYTES] <firmware.elf>
+//
+// Reads the symbol table directly (no avr-binutils needed) and lists every
+// object in .data, .bss and .noinit, largest first, with demangled names.
+// Bytes of a section not covered by a symbol (alignment, objects without a
+// symbol) are shown as "(unattributed)". What is left of --ram (default 2048,
+// ATmega328P) is shared by the heap and the stack at run time; the firmware's
+// MemoryMonitor reports how much of it the stack actually used.
+//
+// Exit code 1 when --max-static is given and static usage is above it (CI
+// budget check), 2 on a bad ELF.
+//
+// The ELF comes from the Arduino build, e.g.
+//   arduino-cli compile -b arduino:avr:nano --output-dir build-fw src/PumpControl
+//   ./build-tools/memreport build-fw/PumpControl.ino.elf
+// -----------------------------------------------------------------------------
+#include <cxxabi.h>
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const kRamSections[] = {".data", ".bss", ".noinit"};
+
+struct Object {
+    std::string name;
+    unsigned long size;
+};
+
+struct Section {
+    std::string name;
+    unsigned index;
+    unsigned long size;
+    std::vector<Object> objects;
+};
+
+std::string demangle(const char* name) {
+    if (strncmp(name, "_Z", 2) != 0) return name;  // C symbol
+    int status = 0;
+    char* out = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status != 0 || !out) return name;
+    std::string s(out);
+    free(out);
+    return s;
+}
+
+template <typename Ehdr, typename Shdr, typename Sym, unsigned char (*SymType)(unsigned char)>
+bool readSections(const std::vector<char>& file, std::vector<Section>& out) {
+    if (file.size() < sizeof(Ehdr)) return false;
+    const Ehdr* eh = (const Ehdr*)file.data();
+    if (eh->e_shoff == 0 || eh->e_shentsize != sizeof(Shdr) ||
+        eh->e_shoff + (unsigned long)eh->e_shnum * sizeof(Shdr) > file.size()) {
+        return false;
+    }
+    const Shdr* sh = (const Shdr*)(file.data() + eh->e_shoff);
+    if (eh->e_shstrndx >= eh->e_shnum) return false;
+    const char* shstr = file.data() + sh[eh->e_shstrndx].sh_offset;
+
+    const Shdr* symtab = nullptr;
+    for (unsigned i = 0; i < eh->e_shnum; i++) {
+        const char* name = shstr + sh[i].sh_name;
+        for (const char* ram : kRamSections) {
+            if (strcmp(name, ram) == 0) {
+                out.push_back(Section{name, i, (unsigned long)sh[i].sh_size, {}});
+            }
+        }
+        if (sh[i].sh_type == SHT_SYMTAB) symtab = &sh[i];
+    }
+    if (!symtab) {
+        fprintf(stderr, "memreport: no symbol table (stripped ELF?)\n");
+        return false;
+    }
+    if (symtab->sh_link >= eh->e_shnum ||
+        symtab->sh_offset + symtab->sh_size > file.size()) {
+        return false;
+    }
+    const char* strtab = file.data() + sh[symtab->sh_link].sh_offset;
+    const Sym* syms = (const Sym*)(file.data() + symtab->sh_offset);
+    size_t count = symtab->sh_size / sizeof(Sym);
+
+    for (size_t i = 0; i < count; i++) {
+        const Sym& s = syms[i];
+        if (s.st_size == 0 || SymType(s.st_info) != STT_OBJECT) continue;
+        for (Section& sec : out) {
+            if (s.st_shndx == sec.index) {
+                sec.objects.push_back(Object{demangle(strtab + s.st_name), (unsigned long)s.st_size});
+            }
+        }
+    }
+    return true;
+}
+
+unsigned char elf32SymType(unsigned char info) { return ELF32_ST_TYPE(info); }
+unsigned char elf64SymType(unsigned char info) { return ELF64_ST_TYPE(info); }
+
+void usage() {
+    fprintf(stderr, "usage: memreport [--ram BYTES] [--top N] [--max-static BYTES] <firmware.elf>\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    unsigned long ram = 2048;
+    unsigned long maxStatic = 0;
+    size_t top = 0;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "--ram" || arg == "--top" || arg == "--max-static") && i + 1 < argc) {
+            unsigned long v = strtoul(argv[++i], nullptr, 0);
+            if (arg == "--ram") ram = v;
+            else if (arg == "--top") top = v;
+            else maxStatic = v;
+        } else if (!path && arg[0] != '-') {
+            path = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!path) {
+        usage();
+        return 2;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (file.size() < EI_NIDENT || memcmp(file.data(), ELFMAG, SELFMAG) != 0 ||
+        file[EI_DATA] != ELFDATA2LSB) {
+        fprintf(stderr, "memreport: %s is not a little-endian ELF file\n", path);
+        return 2;
+    }
+
+    std::vector<Section> sections;
+    bool ok = (file[EI_CLASS] == ELFCLASS32)
+        ? readSections<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym, elf32SymType>(file, sections)
+        : readSections<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym, elf64SymType>(file, sections);
+    if (!ok) {
+        fprintf(stderr, "memreport: cannot read sections of %s\n", path);
+        return 2;
+    }
+
+    unsigned long total = 0;
+    for (const Section& sec : sections) total += sec.size;
+
+    printf("%s: RAM %lu B\n\n", path, ram);
+    for (const Section& sec : sections) {
+        printf("  %-10s %6lu B\n", sec.name.c_str(), sec.size);
+    }
+    printf("  %-10s %6lu B  (%.1f%%)\n", "static", total, ram ? 100.0 * total / ram : 0.0);
+    if (total <= ram) {
+        printf("  %-10s %6lu B\n", "heap+stack", ram - total);
+    } else {
+        printf("  %-10s %6lu B OVER\n", "heap+stack", total - ram);
+    }
+
+    for (Section& sec : sections) {
+        if (sec.size == 0) continue;
+        std::stable_sort(sec.objects.begin(), sec.objects.end(),
+                         [](const Object& a, const Object& b) { return a.size > b.size; });
+        unsigned long covered = 0;
+        for (const Object& o : sec.objects) covered += o.size;
+
+        printf("\n%s (largest first)\n", sec.name.c_str());
+        size_t shown = 0;
+        for (const Object& o : sec.objects) {
+            if (top && shown == top) {
+                printf("  %6s  ... %zu more\n", "", sec.objects.size() - shown);
+                break;
+            }
+            printf("  %6lu  %s\n", o.size, o.name.c_str());
+            shown++;
+        }
+        if (sec.size > covered) {
+            printf("  %6lu  (unattributed)\n", sec.size - covered);
+        }
+    }
+
+    if (maxStatic && total > maxStatic) {
+        fprintf(stderr, "\nmemreport: static SRAM %lu B is above the %lu B budget\n", total, maxStatic);
+        return 1;
+    }
+    return 0;
+}
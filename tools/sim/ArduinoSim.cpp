@@ -0,0 +1,849 @@
+// -----------------------------------------------------------------------------
+// ArduinoSim.cpp - Host implementation of the Arduino core shim
+// -----------------------------------------------------------------------------
+#include "ArduinoSim.h"
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <avr/sleep.h>
+
+#include <stdio.h>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Registers
+// ----------------------------------------------------------------------------
+#define SIM_REG8(name) volatile uint8_t name;
+SIM_REG8(TCCR0A) SIM_REG8(TCCR0B) SIM_REG8(TCNT0) SIM_REG8(OCR0A) SIM_REG8(OCR0B)
+SIM_REG8(TIMSK0) SIM_REG8(TIFR0)
+SIM_REG8(TCCR1A) SIM_REG8(TCCR1B) SIM_REG8(TCCR1C) SIM_REG8(TIMSK1)
+SIM_REG8(TCCR2A) SIM_REG8(TCCR2B) SIM_REG8(TCNT2) SIM_REG8(OCR2A) SIM_REG8(OCR2B)
+SIM_REG8(TIMSK2) SIM_REG8(TIFR2)
+SIM_REG8(ADCSRB) SIM_REG8(ADMUX) SIM_REG8(ADCL) SIM_REG8(ADCH) SIM_REG8(DIDR0)
+SIM_REG8(PORTB) SIM_REG8(PORTC) SIM_REG8(PORTD) SIM_REG8(PINB) SIM_REG8(PINC) SIM_REG8(PIND)
+SIM_REG8(DDRB) SIM_REG8(DDRC) SIM_REG8(DDRD)
+SIM_REG8(MCUSR) SIM_REG8(WDTCSR) SIM_REG8(SMCR) SIM_REG8(SREG) SIM_REG8(PRR)
+SIM_REG8(EICRA) SIM_REG8(EIMSK) SIM_REG8(EIFR)
+SIM_REG8(PCICR) SIM_REG8(PCIFR) SIM_REG8(PCMSK0) SIM_REG8(PCMSK1) SIM_REG8(PCMSK2)
+SIM_REG8(SPCR) SIM_REG8(SPSR) SIM_REG8(SPDR)
+SIM_REG8(EECR) SIM_REG8(EEDR) SIM_REG8(EEARL) SIM_REG8(EEARH)
+#undef SIM_REG8
+volatile uint16_t ADC;
+SimTcnt1 TCNT1;
+SimTifr1 TIFR1;
+volatile uint16_t ICR1;
+volatile uint16_t OCR1A;
+volatile uint16_t OCR1B;
+volatile uint16_t EEAR;
+SimAdcsra ADCSRA;
+
+// Vectors the sketch may define; unresolved weak symbols are null
+extern "C" void PCINT0_vect(void) __attribute__((weak));
+extern "C" void PCINT1_vect(void) __attribute__((weak));
+extern "C" void PCINT2_vect(void) __attribute__((weak));
+extern "C" void INT0_vect(void) __attribute__((weak));
+extern "C" void INT1_vect(void) __attribute__((weak));
+extern "C" void TIMER1_OVF_vect(void) __attribute__((weak));
+
+HardwareSerial Serial;
+SPIClass SPI;
+
+namespace {
+
+constexpr uint8_t NUM_PINS = 22;
+constexpr uint8_t SREG_I = 0x80;
+constexpr uint64_t MAX_STEP_NS = 1000000ULL;  // Peripherals see at least 1 kHz ticks
+constexpr uint8_t ADCSRA_STORED = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) |
+                                  _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+
+struct PulseInput {
+    uint64_t periodNs = 0;  // 0 = off
+    uint64_t highNs = 0;
+    uint8_t level = LOW;    // Level last seen by the pin-change logic
+};
+
+// One conversion in flight (ADSC) or waiting for its auto-trigger
+struct AdcState {
+    uint8_t control = 0;      // ADCSRA_STORED bits
+    bool flag = false;        // ADIF
+    bool pending = false;
+    uint64_t startNs = 0;
+    uint64_t doneNs = 0;
+};
+
+// Timer 0 as the core sees it: overflows = base + whole periods since originNs
+// at the mode/prescaler seen last (a change starts a new period at that point)
+struct Timer0State {
+    uint8_t setting = 0xFF;   // WGM01:0 | CS02:0 << 2; 0xFF = not seen yet
+    uint16_t counts = 256;    // Counts per overflow: 256, or 510 phase-correct
+    uint64_t periodNs = 0;    // 0 = timer stopped
+    uint64_t originNs = 0;
+    uint64_t base = 0;
+};
+
+// Timer 1 in normal mode: count = base + clocks since originNs at the clock
+// select seen last (a new TCCR1B clock select restarts from the count reached)
+struct Timer1State {
+    uint8_t clockSelect = 0;
+    uint64_t originNs = 0;
+    uint64_t base = 0;
+    uint64_t wraps = 0;       // Overflows already flagged
+    bool overflow = false;    // TOV1
+};
+
+struct State {
+    uint64_t nowNs = 0;
+    uint8_t mode[NUM_PINS] = {};
+    uint8_t output[NUM_PINS] = {};
+    uint8_t input[NUM_PINS] = {};
+    bool inputDriven[NUM_PINS] = {};
+    float analogVolts[NUM_PINS] = {};
+    sim::AnalogSource* analogSource[NUM_PINS] = {};
+    PulseInput pulse[NUM_PINS];
+    sim::DigitalSource* digitalSource[NUM_PINS] = {};
+    AdcState adc;
+    Timer0State timer0;
+    Timer1State timer1;
+    uint64_t lastFeedNs = 0;
+    uint64_t maxFeedGapNs = 0;
+    bool fed = false;
+    int analogOut[NUM_PINS] = {};
+    bool pwmActive[NUM_PINS] = {};  // analogWrite() since the last digitalWrite()
+    sim::SpiDevice* spiDevice[NUM_PINS] = {};
+    sim::SpiDevice* selected = nullptr;
+    std::vector<sim::Peripheral*> peripherals;
+    void (*extHandler[2])(void) = {nullptr, nullptr};
+    int extMode[2] = {0, 0};
+    bool inIsr = false;
+    bool advancing = false;
+    bool serialEcho = true;
+    std::string serialOut;
+    std::string serialIn;
+};
+
+State s;
+
+uint8_t pulseLevel(const PulseInput& p, uint64_t ns) {
+    return (ns % p.periodNs) < p.highNs ? HIGH : LOW;
+}
+
+uint8_t effectiveLevel(uint8_t pin) {
+    if (s.mode[pin] == OUTPUT) return s.output[pin];
+    if (s.pulse[pin].periodNs) return pulseLevel(s.pulse[pin], s.nowNs);
+    if (s.digitalSource[pin]) return s.digitalSource[pin]->level(s.nowNs / 1000ULL);
+    if (s.inputDriven[pin]) return s.input[pin];
+    return (s.mode[pin] == INPUT_PULLUP) ? HIGH : LOW;
+}
+
+uint8_t normalizePin(uint8_t pin) {
+    // analogRead() also accepts channel numbers 0..7
+    return pin < NUM_PINS ? pin : (uint8_t)(NUM_PINS - 1);
+}
+
+void onLevelChange(uint8_t pin, uint8_t oldLevel, uint8_t newLevel) {
+    uint8_t group = digitalPinToPCICRbit(pin);
+    volatile uint8_t* msk = digitalPinToPCMSK(pin);
+    if (msk && (*msk & _BV(digitalPinToPCMSKbit(pin)))) {
+        PCIFR |= (uint8_t)_BV(group);
+    }
+    if (pin == 2 || pin == 3) {
+        uint8_t n = pin - 2;
+        // attachInterrupt() mode, else the ISCn1:ISCn0 bits of EICRA for an
+        // ISR(INTn_vect) (00 low level - not modelled, 01 change, 10 falling,
+        // 11 rising: the same values as the Arduino constants)
+        int m = s.extHandler[n] ? s.extMode[n] : (EICRA >> (2 * n)) & 0x03;
+        bool fire = (m == CHANGE) || (m == RISING && newLevel && !oldLevel) ||
+                    (m == FALLING && !newLevel && oldLevel);
+        if (fire) EIFR |= (uint8_t)_BV(n);
+    }
+}
+
+bool pinChangeEnabled(uint8_t pin) {
+    volatile uint8_t* msk = digitalPinToPCMSK(pin);
+    return msk && (*msk & _BV(digitalPinToPCMSKbit(pin)));
+}
+
+// Square-wave inputs (setPulseInput) with their pin-change interrupt enabled:
+// the next edge after now (UINT64_MAX: none), so a time step can end on it
+uint64_t nextPulseEdgeNs() {
+    uint64_t next = UINT64_MAX;
+    for (uint8_t pin = 0; pin < NUM_PINS; pin++) {
+        const PulseInput& p = s.pulse[pin];
+        if (!p.periodNs || p.highNs == 0 || p.highNs >= p.periodNs) continue;
+        if (s.mode[pin] == OUTPUT || !pinChangeEnabled(pin)) continue;
+        uint64_t phase = s.nowNs % p.periodNs;
+        uint64_t edge = s.nowNs - phase + (phase < p.highNs ? p.highNs : p.periodNs);
+        if (edge < next) next = edge;
+    }
+    return next;
+}
+
+bool pulseEdges() {
+    bool raised = false;
+    for (uint8_t pin = 0; pin < NUM_PINS; pin++) {
+        PulseInput& p = s.pulse[pin];
+        if (!p.periodNs || s.mode[pin] == OUTPUT) continue;
+        uint8_t level = pulseLevel(p, s.nowNs);
+        if (level == p.level) continue;
+        if (pinChangeEnabled(pin)) {
+            onLevelChange(pin, p.level, level);
+            raised = true;
+        }
+        p.level = level;
+    }
+    return raised;
+}
+
+void runVector(void (*fn)(void)) {
+    if (!fn) return;
+    s.inIsr = true;
+    SREG &= (uint8_t)~SREG_I;
+    fn();
+    SREG |= SREG_I;
+    s.inIsr = false;
+}
+
+// Timer 0 overflows at now: 256 counts (fast PWM) or 510 (phase-correct, TOV0
+// at BOTTOM) of the prescaled 16 MHz clock each
+uint64_t timer0Update() {
+    static const uint16_t kDivider[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+    Timer0State& t = s.timer0;
+    uint64_t overflows = t.base + (t.periodNs ? (s.nowNs - t.originNs) / t.periodNs : 0);
+    uint8_t setting = (uint8_t)((TCCR0A & 0x03) | (TCCR0B & 0x07) << 2);
+    if (setting != t.setting) {
+        t.setting = setting;
+        t.counts = ((TCCR0A & 0x03) == 0x01) ? 510 : 256;
+        t.periodNs = (uint64_t)t.counts * kDivider[TCCR0B & 0x07] * 125 / 2;  // 62.5 ns per clock
+        t.originNs = s.nowNs;
+        t.base = overflows;
+    }
+    return overflows;
+}
+
+// TCNT0 at now: up-counting, or up then down in phase-correct mode
+uint8_t timer0Count() {
+    const Timer0State& t = s.timer0;
+    if (t.periodNs == 0) return 0;
+    uint64_t position = (s.nowNs - t.originNs) % t.periodNs * t.counts / t.periodNs;
+    return (uint8_t)(position <= 255 ? position : t.counts - position);
+}
+
+// Next Timer 0 overflow strictly after ns (ns >= now); 0 = timer stopped
+uint64_t timer0NextOverflowNs(uint64_t ns) {
+    timer0Update();
+    const Timer0State& t = s.timer0;
+    if (t.periodNs == 0) return 0;
+    return t.originNs + ((ns - t.originNs) / t.periodNs + 1) * t.periodNs;
+}
+
+// Timer 1 count (64-bit, wraps not folded) at now; raises TOV1 on new wraps
+uint64_t timer1Update() {
+    static const uint16_t kDivider[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+    Timer1State& t = s.timer1;
+    uint8_t cs = TCCR1B & 0x07;
+    uint64_t divider = kDivider[t.clockSelect];
+    // 16 clocks per us: count = elapsed ns * 16 / (1000 * divider)
+    uint64_t count = t.base + (divider ? (s.nowNs - t.originNs) * 16ULL / (1000ULL * divider) : 0);
+    if (cs != t.clockSelect) {
+        t.clockSelect = cs;
+        t.originNs = s.nowNs;
+        t.base = count;
+    }
+    if ((count >> 16) > t.wraps) {
+        t.wraps = count >> 16;
+        t.overflow = true;
+    }
+    return count;
+}
+
+uint64_t adcConversionNs() {
+    static const uint8_t kPrescaler[8] = {2, 2, 4, 8, 16, 32, 64, 128};
+    return 13ULL * kPrescaler[s.adc.control & 0x07] * 125 / 2;
+}
+
+bool adcTimer0Trigger() {
+    return (s.adc.control & _BV(ADATE)) && (ADCSRB & 0x07) == 0x04;
+}
+
+void adcStart(uint64_t startNs) {
+    s.adc.pending = true;
+    s.adc.startNs = startNs;
+    s.adc.doneNs = startNs + adcConversionNs();
+}
+
+// Next Timer 0 overflow strictly after ns
+void adcScheduleTimer0(uint64_t ns) {
+    uint64_t overflowNs = timer0NextOverflowNs(ns);
+    if (overflowNs == 0) return;
+    adcStart(overflowNs);
+}
+
+uint16_t adcCounts(uint8_t channel, uint64_t sampleNs) {
+    uint8_t pin = (uint8_t)(A0 + channel);
+    float v = s.analogSource[pin] ? s.analogSource[pin]->volts(sampleNs / 1000ULL)
+                                  : s.analogVolts[pin];
+    long counts = lround(v / 5.0f * 1023.0f);
+    if (counts < 0) counts = 0;
+    if (counts > 1023) counts = 1023;
+    return (uint16_t)counts;
+}
+
+// Complete every conversion that ended by now (auto-trigger may chain several)
+void adcUpdate() {
+    while (s.adc.pending && s.nowNs >= s.adc.doneNs) {
+        s.adc.pending = false;
+        // Sample-and-hold closes 1.5 ADC clocks after the start
+        uint64_t sampleNs = s.adc.startNs + (s.adc.doneNs - s.adc.startNs) * 3 / 26;
+        ADC = adcCounts(ADMUX & 0x07, sampleNs);
+        s.adc.flag = true;
+        if (s.adc.control & _BV(ADATE)) {
+            if ((ADCSRB & 0x07) == 0x00) {
+                adcStart(s.adc.doneNs);  // Free running
+            } else if (adcTimer0Trigger()) {
+                adcScheduleTimer0(s.adc.doneNs);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------------
+// sim:: control API
+// ----------------------------------------------------------------------------
+namespace sim {
+
+void reset() {
+    s = State();
+    TCCR0A = TCCR0B = TCNT0 = OCR0A = OCR0B = TIMSK0 = TIFR0 = 0;
+    TCCR1A = TCCR1B = TCCR1C = TIMSK1 = 0;
+    TCCR2A = TCCR2B = TCNT2 = OCR2A = OCR2B = TIMSK2 = TIFR2 = 0;
+    ADCSRB = ADMUX = ADCL = ADCH = DIDR0 = 0;
+    PORTB = PORTC = PORTD = PINB = PINC = PIND = DDRB = DDRC = DDRD = 0;
+    MCUSR = WDTCSR = SMCR = PRR = 0;
+    EICRA = EIMSK = EIFR = PCICR = PCIFR = PCMSK0 = PCMSK1 = PCMSK2 = 0;
+    SPCR = SPSR = SPDR = EECR = EEDR = EEARL = EEARH = 0;
+    ADC = ICR1 = OCR1A = OCR1B = EEAR = 0;
+    TCCR0B = 0x03;          // Arduino core default: Timer 0 prescaler 64
+    ADCSRA = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);  // init(): ADC on, /128
+    SREG = SREG_I;          // init() enables interrupts before setup()
+}
+
+uint64_t nowMicros() {
+    return s.nowNs / 1000ULL;
+}
+
+static void advanceNanos(uint64_t ns) {
+    // Nested waits (SPI byte inside a peripheral tick) only move the clock
+    if (s.advancing) {
+        s.nowNs += ns;
+        return;
+    }
+    s.advancing = true;
+    timer0Update();  // Time so far at the Timer 0 setting written before this call
+    while (ns > 0) {
+        uint64_t step = ns > MAX_STEP_NS ? MAX_STEP_NS : ns;
+        uint64_t edge = nextPulseEdgeNs();
+        if (edge - s.nowNs < step) step = edge - s.nowNs;
+        s.nowNs += step;
+        ns -= step;
+        for (Peripheral* p : s.peripherals) p->tick(s.nowNs / 1000ULL);
+        timer1Update();
+        if (pulseEdges() || s.timer1.overflow) serviceInterrupts();
+    }
+    s.advancing = false;
+    serviceInterrupts();
+}
+
+void advanceMicros(uint64_t us) {
+    advanceNanos(us * 1000ULL);
+}
+
+void setDigitalInput(uint8_t pin, uint8_t level) {
+    if (pin >= NUM_PINS) return;
+    uint8_t before = effectiveLevel(pin);
+    s.inputDriven[pin] = true;
+    s.input[pin] = level ? HIGH : LOW;
+    uint8_t after = effectiveLevel(pin);
+    if (before != after) onLevelChange(pin, before, after);
+    serviceInterrupts();
+}
+
+void setAnalogVoltage(uint8_t pin, float volts) {
+    s.analogVolts[normalizePin(pin)] = volts;
+}
+
+void setAnalogSource(uint8_t pin, AnalogSource* source) {
+    s.analogSource[normalizePin(pin)] = source;
+}
+
+void setPulseInput(uint8_t pin, float hz, float duty) {
+    if (pin >= NUM_PINS) return;
+    PulseInput& p = s.pulse[pin];
+    if (hz <= 0.0f) {
+        p = PulseInput();
+        return;
+    }
+    p.periodNs = (uint64_t)(1e9 / hz + 0.5);
+    if (duty < 0.0f) duty = 0.0f;
+    if (duty > 1.0f) duty = 1.0f;
+    p.highNs = (uint64_t)(p.periodNs * (double)duty + 0.5);
+    p.level = pulseLevel(p, s.nowNs);
+}
+
+void setDigitalSource(uint8_t pin, DigitalSource* source) {
+    if (pin < NUM_PINS) s.digitalSource[pin] = source;
+}
+
+uint8_t getDigitalOutput(uint8_t pin) {
+    return pin < NUM_PINS ? s.output[pin] : LOW;
+}
+
+uint8_t getPinMode(uint8_t pin) {
+    return pin < NUM_PINS ? s.mode[pin] : INPUT;
+}
+
+int getAnalogWrite(uint8_t pin) {
+    return pin < NUM_PINS ? s.analogOut[pin] : 0;
+}
+
+float getOutputDuty(uint8_t pin) {
+    if (pin >= NUM_PINS) return 0.0f;
+    if (s.mode[pin] == OUTPUT && s.pwmActive[pin]) return s.analogOut[pin] / 255.0f;
+    return effectiveLevel(pin) ? 1.0f : 0.0f;
+}
+
+void addPeripheral(Peripheral* p) {
+    s.peripherals.push_back(p);
+}
+
+void attachSpiDevice(uint8_t csPin, SpiDevice* dev) {
+    if (csPin < NUM_PINS) s.spiDevice[csPin] = dev;
+}
+
+uint64_t watchdogMaxGapMicros() {
+    return s.maxFeedGapNs / 1000ULL;
+}
+
+void serviceInterrupts() {
+    if (s.inIsr) return;
+    while (SREG & SREG_I) {
+        bool ran = false;
+        // Vector priority order: INT0, INT1, PCINT0, PCINT1, PCINT2
+        for (uint8_t n = 0; n < 2; n++) {
+            if (!(EIFR & _BV(n))) continue;
+            EIFR &= (uint8_t)~_BV(n);
+            if (s.extHandler[n]) {
+                runVector(s.extHandler[n]);
+                ran = true;
+            } else if (EIMSK & _BV(n)) {
+                runVector(n == 0 ? INT0_vect : INT1_vect);
+                ran = true;
+            }
+        }
+        void (*pcVectors[3])(void) = {PCINT0_vect, PCINT1_vect, PCINT2_vect};
+        for (uint8_t g = 0; g < 3; g++) {
+            if ((PCIFR & _BV(g)) && (PCICR & _BV(g))) {
+                PCIFR &= (uint8_t)~_BV(g);
+                runVector(pcVectors[g]);
+                ran = true;
+            }
+        }
+        timer1Update();
+        if (s.timer1.overflow && (TIMSK1 & _BV(TOIE1)) && TIMER1_OVF_vect) {
+            s.timer1.overflow = false;
+            runVector(TIMER1_OVF_vect);
+            ran = true;
+        }
+        if (!ran) break;
+    }
+}
+
+void setSerialEcho(bool echo) {
+    s.serialEcho = echo;
+}
+
+const std::string& serialOutput() {
+    return s.serialOut;
+}
+
+void clearSerialOutput() {
+    s.serialOut.clear();
+}
+
+void pushSerialInput(const std::string& bytes) {
+    s.serialIn += bytes;
+}
+
+}  // namespace sim
+
+// ----------------------------------------------------------------------------
+// Arduino core
+// ----------------------------------------------------------------------------
+// wiring.c: the overflow ISR adds 1024 us, i.e. 1 ms plus 3/125 ms, whatever
+// the real overflow period is (255 us with the PWM setup, so 4x fast)
+unsigned long millis() {
+    uint64_t overflows = timer0Update();
+    return (unsigned long)(overflows + overflows * 3 / 125);
+}
+
+// wiring.c: ((overflows << 8) + TCNT0) * 4. Steps backwards while a
+// phase-correct TCNT0 counts down.
+unsigned long micros() {
+    uint64_t overflows = timer0Update();
+    return (unsigned long)(((overflows << 8) + timer0Count()) * 4);
+}
+
+// wiring.c's loop on micros(), polled every microsecond. A backwards micros()
+// step ends it early, as on the board.
+void delay(unsigned long ms) {
+    uint32_t start = (uint32_t)micros();
+    while (ms > 0) {
+        sim::advanceMicros(1);
+        while (ms > 0 && (uint32_t)micros() - start >= 1000) {
+            ms--;
+            start += 1000;
+        }
+    }
+}
+
+// delayMicroseconds() is cycle-counted: real time
+void delayMicroseconds(unsigned int us) {
+    sim::advanceMicros(us);
+}
+
+// Same register sequence as the core: 104us per call at the default /128
+int analogRead(uint8_t pin) {
+    if (pin >= A0) pin -= A0;
+    ADMUX = (uint8_t)(_BV(REFS0) | (pin & 0x07));
+    ADCSRA |= _BV(ADSC);
+    while (ADCSRA & _BV(ADSC)) { }
+    return ADC;
+}
+
+void analogReference(uint8_t) {}
+
+void analogWrite(uint8_t pin, int value) {
+    if (pin >= NUM_PINS) return;
+    s.analogOut[pin] = value;
+    s.pwmActive[pin] = true;
+    s.output[pin] = value > 0 ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < NUM_PINS ? effectiveLevel(pin) : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin >= NUM_PINS) return;
+    uint8_t before = effectiveLevel(pin);
+    if (s.mode[pin] != OUTPUT) {
+        // Writing HIGH to an input enables the pull-up (classic AVR behaviour)
+        s.mode[pin] = value ? INPUT_PULLUP : INPUT;
+        return;
+    }
+    s.output[pin] = value ? HIGH : LOW;
+    s.pwmActive[pin] = false;
+    sim::SpiDevice* dev = s.spiDevice[pin];
+    if (dev) {
+        if (before == HIGH && !value) {
+            s.selected = dev;
+            dev->select();
+        } else if (before == LOW && value) {
+            dev->deselect();
+            if (s.selected == dev) s.selected = nullptr;
+        }
+    }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= NUM_PINS) return;
+    s.mode[pin] = mode;
+}
+
+// Like the core: wait for the current pulse to end, for the next one to start
+// and for it to end, all within the timeout. Without a pulse input attached
+// (or at 0/100% duty) the line is idle: timeout, 0.
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout) {
+    sim::DigitalSource* src = pin < NUM_PINS ? s.digitalSource[pin] : nullptr;
+    if (src && !s.pulse[pin].periodNs) {
+        // Wait out a pulse already in progress, then its start and its end
+        uint64_t nowUs = s.nowNs / 1000ULL;
+        uint64_t limitUs = nowUs + timeout;
+        uint64_t t = src->level(nowUs) == state ? src->nextEdge(nowUs, limitUs) : nowUs;
+        uint64_t start = t < limitUs ? src->nextEdge(t, limitUs) : limitUs;
+        uint64_t end = start < limitUs ? src->nextEdge(start, limitUs) : limitUs;
+        if (end >= limitUs) {
+            sim::advanceMicros(timeout);
+            return 0;
+        }
+        sim::advanceNanos(end * 1000ULL - s.nowNs);
+        return (unsigned long)(end - start);
+    }
+    const PulseInput* p = pin < NUM_PINS ? &s.pulse[pin] : nullptr;
+    if (!p || !p->periodNs || p->highNs == 0 || p->highNs >= p->periodNs) {
+        sim::advanceMicros(timeout);
+        return 0;
+    }
+    // Pulse of the requested level: [begin, begin + width) within each period
+    uint64_t begin = state ? 0 : p->highNs;
+    uint64_t width = state ? p->highNs : p->periodNs - p->highNs;
+    uint64_t phase = (s.nowNs + p->periodNs - begin) % p->periodNs;
+    uint64_t start = s.nowNs - phase + p->periodNs;  // Next full pulse
+    uint64_t end = start + width;
+    if (end - s.nowNs > (uint64_t)timeout * 1000ULL) {
+        sim::advanceMicros(timeout);
+        return 0;
+    }
+    sim::advanceNanos(end - s.nowNs);
+    return (unsigned long)(width / 1000ULL);
+}
+
+void attachInterrupt(uint8_t num, void (*fn)(void), int mode) {
+    if (num > 1) return;
+    s.extHandler[num] = fn;
+    s.extMode[num] = mode;
+}
+
+void detachInterrupt(uint8_t num) {
+    if (num > 1) return;
+    s.extHandler[num] = nullptr;
+    s.extMode[num] = 0;
+}
+
+void noInterrupts() {
+    SREG &= (uint8_t)~SREG_I;
+}
+
+void interrupts() {
+    SREG |= SREG_I;
+    sim::serviceInterrupts();
+}
+
+// Wakes at the next Timer 0 overflow or at the end of a conversion with ADIE
+// set. Other wake-up sources are not modelled.
+void sleep_cpu() {
+    if (!(SMCR & _BV(SE))) return;
+    uint64_t overflowNs = timer0NextOverflowNs(s.nowNs);
+    if (overflowNs == 0) return;  // Timer stopped: nothing would wake the CPU
+    uint64_t wakeNs = overflowNs - s.nowNs;
+    adcUpdate();
+    if (s.adc.pending && (s.adc.control & _BV(ADIE)) && s.adc.doneNs - s.nowNs < wakeNs) {
+        wakeNs = s.adc.doneNs - s.nowNs;
+    }
+    sim::advanceNanos(wakeNs);
+}
+
+void wdt_reset() {
+    if (!(WDTCSR & _BV(WDE))) return;
+    if (s.fed && s.nowNs - s.lastFeedNs > s.maxFeedGapNs) {
+        s.maxFeedGapNs = s.nowNs - s.lastFeedNs;
+    }
+    s.lastFeedNs = s.nowNs;
+    s.fed = true;
+}
+
+// ----------------------------------------------------------------------------
+// ADC control register
+// ----------------------------------------------------------------------------
+// The firmware only reads ADCSRA in poll loops (ADSC or ADIF), so a read that
+// finds a conversion pending and ADIF clear runs the clock to its end.
+SimAdcsra::operator uint8_t() const {
+    adcUpdate();
+    if (s.adc.pending && !s.adc.flag && !s.inIsr) {
+        sim::advanceNanos(s.adc.doneNs - s.nowNs);
+        adcUpdate();
+    }
+    uint8_t value = s.adc.control;
+    if (s.adc.pending && s.nowNs >= s.adc.startNs) value |= _BV(ADSC);
+    if (s.adc.flag) value |= _BV(ADIF);
+    return value;
+}
+
+SimAdcsra& SimAdcsra::operator=(uint8_t value) {
+    adcUpdate();
+    if (value & _BV(ADIF)) s.adc.flag = false;  // Write one to clear
+    s.adc.control = value & ADCSRA_STORED;
+    if (s.adc.pending && s.nowNs < s.adc.startNs && !adcTimer0Trigger()) {
+        s.adc.pending = false;  // Auto-trigger switched off before the trigger
+    }
+    if (!(value & _BV(ADEN))) {
+        s.adc.pending = false;
+    } else if (!s.adc.pending) {
+        if (value & _BV(ADSC)) {
+            adcStart(s.nowNs);
+        } else if (adcTimer0Trigger()) {
+            adcScheduleTimer0(s.nowNs);
+        }
+    }
+    return *this;
+}
+
+// ----------------------------------------------------------------------------
+// Timer 1 counter
+// ----------------------------------------------------------------------------
+SimTcnt1::operator uint16_t() const {
+    return (uint16_t)timer1Update();
+}
+
+SimTcnt1& SimTcnt1::operator=(uint16_t value) {
+    timer1Update();
+    s.timer1.originNs = s.nowNs;
+    s.timer1.base = value;
+    s.timer1.wraps = 0;
+    return *this;
+}
+
+SimTifr1::operator uint8_t() const {
+    timer1Update();
+    return s.timer1.overflow ? (uint8_t)_BV(TOV1) : 0;
+}
+
+SimTifr1& SimTifr1::operator=(uint8_t value) {
+    timer1Update();
+    if (value & _BV(TOV1)) s.timer1.overflow = false;  // Write one to clear
+    return *this;
+}
+
+// ----------------------------------------------------------------------------
+// Serial / Print
+// ----------------------------------------------------------------------------
+size_t HardwareSerial::write(uint8_t c) {
+    s.serialOut.push_back((char)c);
+    if (s.serialEcho) fputc(c, stdout);
+    return 1;
+}
+
+int HardwareSerial::available() {
+    return (int)s.serialIn.size();
+}
+
+int HardwareSerial::read() {
+    if (s.serialIn.empty()) return -1;
+    int c = (uint8_t)s.serialIn[0];
+    s.serialIn.erase(0, 1);
+    return c;
+}
+
+int HardwareSerial::peek() {
+    return s.serialIn.empty() ? -1 : (uint8_t)s.serialIn[0];
+}
+
+size_t Print::write(const uint8_t* buf, size_t n) {
+    for (size_t i = 0; i < n; i++) write(buf[i]);
+    return n;
+}
+
+size_t Print::print(const __FlashStringHelper* str) {
+    return print(reinterpret_cast<const char*>(str));
+}
+
+size_t Print::print(const char* str) {
+    return write(str);
+}
+
+size_t Print::print(char c) {
+    return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char n, int base) {
+    return print((unsigned long)n, base);
+}
+
+size_t Print::print(int n, int base) {
+    return print((long)n, base);
+}
+
+size_t Print::print(unsigned int n, int base) {
+    return print((unsigned long)n, base);
+}
+
+size_t Print::print(long n, int base) {
+    if (base == DEC && n < 0) {
+        size_t t = print('-');
+        return t + printNumber((unsigned long)(-n), DEC);
+    }
+    return printNumber((unsigned long)n, (uint8_t)base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+    return printNumber(n, (uint8_t)base);
+}
+
+// Same algorithm as the AVR core (rounding, then digit by digit)
+size_t Print::print(double number, int digits) {
+    if (isnan(number)) return print("nan");
+    if (isinf(number)) return print("inf");
+    if (number > 4294967040.0) return print("ovf");
+    if (number < -4294967040.0) return print("ovf");
+
+    size_t n = 0;
+    if (number < 0.0) {
+        n += print('-');
+        number = -number;
+    }
+    double rounding = 0.5;
+    for (int i = 0; i < digits; ++i) rounding /= 10.0;
+    number += rounding;
+
+    unsigned long intPart = (unsigned long)number;
+    double remainder = number - (double)intPart;
+    n += print(intPart);
+    if (digits > 0) n += print('.');
+    while (digits-- > 0) {
+        remainder *= 10.0;
+        unsigned int toPrint = (unsigned int)remainder;
+        n += print(toPrint);
+        remainder -= toPrint;
+    }
+    return n;
+}
+
+size_t Print::println() {
+    return write("\r\n");
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+    char buf[8 * sizeof(long) + 1];
+    char* str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+    if (base < 2) base = 10;
+    do {
+        char c = (char)(n % base);
+        n /= base;
+        *--str = c < 10 ? (char)(c + '0') : (char)(c + 'A' - 10);
+    } while (n);
+    return write(str);
+}
+
+// ----------------------------------------------------------------------------
+// SPI
+// ----------------------------------------------------------------------------
+void SPIClass::begin() {
+    SPCR = _BV(SPE) | _BV(MSTR);
+}
+
+void SPIClass::usingInterrupt(uint8_t num) {
+    if (num == 255) _maskInterrupts = true;
+}
+
+void SPIClass::beginTransaction(SPISettings settings) {
+    if (_maskInterrupts) {
+        _savedSreg = SREG;
+        SREG &= (uint8_t)~SREG_I;
+    }
+    _clock = settings.clock ? settings.clock : 4000000UL;
+}
+
+void SPIClass::endTransaction() {
+    if (_maskInterrupts) {
+        SREG = _savedSreg;
+        sim::serviceInterrupts();
+    }
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+    // 8 bit times on the bus + ~0.5us of load/poll loop around SPDR
+    sim::advanceNanos(8ULL * 1000000000ULL / _clock + 500ULL);
+    return s.selected ? s.selected->transfer(data) : 0xFF;
+}
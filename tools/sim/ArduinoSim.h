@@ -0,0 +1,93 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// ArduinoSim - Control side of the host Arduino shim (tools/sim/shim)
+// -----------------------------------------------------------------------------
+// Virtual time only moves when the firmware waits (delay, delayMicroseconds,
+// SPI bytes) or when the harness calls advanceMicros(). Peripherals attached
+// with addPeripheral() are ticked on every advance and may change input pins;
+// a change on a pin enabled in PCMSKn/PCICR raises the pin-change flag, and
+// the ISR (weak PCINTn_vect symbol) runs as soon as SREG.I is set. Edges on
+// D2/D3 raise INT0/INT1 (attachInterrupt() mode or EICRA, INTn_vect).
+//
+// The ADC converts in virtual time (13 ADC clocks at the ADCSRA prescaler);
+// a pin with an AnalogSource is evaluated at the moment of each conversion,
+// so ripple faster than the peripheral ticks is still sampled correctly.
+// -----------------------------------------------------------------------------
+#include <stdint.h>
+#include <string>
+
+namespace sim {
+
+// Anything clocked by virtual time (plant models, bus models, signal generators)
+class Peripheral {
+public:
+    virtual ~Peripheral() {}
+    virtual void tick(uint64_t nowUs) = 0;
+};
+
+// Pin voltage as a function of time (ripple, generators)
+class AnalogSource {
+public:
+    virtual ~AnalogSource() {}
+    virtual float volts(uint64_t nowUs) = 0;
+};
+
+// Input level as a function of time (recorded traces). nextEdge() is the
+// first time after nowUs at which the level changes, limitUs if none before.
+class DigitalSource {
+public:
+    virtual ~DigitalSource() {}
+    virtual uint8_t level(uint64_t nowUs) = 0;
+    virtual uint64_t nextEdge(uint64_t nowUs, uint64_t limitUs) = 0;
+};
+
+// SPI slave selected by its chip-select pin going LOW
+class SpiDevice {
+public:
+    virtual ~SpiDevice() {}
+    virtual void select() = 0;
+    virtual uint8_t transfer(uint8_t mosi) = 0;
+    virtual void deselect() = 0;
+};
+
+// Reset all pins, registers, time and attachments (start of a scenario)
+void reset();
+
+// Virtual time in real microseconds (independent of the Timer 0 prescaler)
+uint64_t nowMicros();
+void advanceMicros(uint64_t us);
+
+// Pins driven from outside the MCU
+void setDigitalInput(uint8_t pin, uint8_t level);
+void setAnalogVoltage(uint8_t pin, float volts);   // 0..5 V, Vref = 5 V
+void setAnalogSource(uint8_t pin, AnalogSource* source);  // nullptr: back to setAnalogVoltage()
+// Square wave on an input from t = 0 (hz = 0: off). digitalRead() and pulseIn()
+// follow it analytically; with its PCMSKn bit set, time steps end on its edges
+// and each edge raises the pin-change flag.
+void setPulseInput(uint8_t pin, float hz, float duty);
+// Input from a DigitalSource (nullptr: back to setDigitalInput()); digitalRead()
+// and pulseIn() follow it, no pin-change interrupts either.
+void setDigitalSource(uint8_t pin, DigitalSource* source);
+
+// Pins driven by the firmware
+uint8_t getDigitalOutput(uint8_t pin);
+uint8_t getPinMode(uint8_t pin);
+int getAnalogWrite(uint8_t pin);                    // Last analogWrite() value
+float getOutputDuty(uint8_t pin);                   // Fraction of time HIGH (PWM or level)
+
+void addPeripheral(Peripheral* p);
+void attachSpiDevice(uint8_t csPin, SpiDevice* dev);
+
+// Longest interval between wdt_reset() calls with the watchdog enabled
+uint64_t watchdogMaxGapMicros();
+
+// Deliver pending interrupts if SREG.I is set (also called on every advance)
+void serviceInterrupts();
+
+// Serial output: echo to stdout and/or capture
+void setSerialEcho(bool echo);
+const std::string& serialOutput();
+void clearSerialOutput();
+void pushSerialInput(const std::string& bytes);
+
+}  // namespace sim
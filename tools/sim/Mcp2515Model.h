@@ -0,0 +1,404 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// Mcp2515Model - Register-level model of the MCP2515 for the host simulator
+// -----------------------------------------------------------------------------
+// Implemented from the datasheet (DS20001801), independently of CanInterface:
+//   - SPI instructions: RESET, READ, WRITE, READ RX BUFFER, LOAD TX BUFFER,
+//     RTS, READ STATUS, BIT MODIFY
+//   - Configuration/normal modes via CANCTRL.REQOP -> CANSTAT.OPMOD
+//   - Acceptance masks/filters (RXB0: RXF0-1/RXM0, RXB1: RXF2-5/RXM1),
+//     RXB0 rollover (BUKT) and RXnOVR overflow flags in EFLG
+//   - CANINTE/CANINTF and the active-low INT pin
+//   - Transmission of TXB0..2 takes one frame time at the bit rate decoded
+//     from CNF1..3, so a wrong bit timing shows up as a wrong frame time
+// Frames are injected from the bus with injectFrame(); transmitted frames are
+// collected in transmitted() and forwarded to an optional bus callback.
+// -----------------------------------------------------------------------------
+#include "ArduinoSim.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <deque>
+#include <functional>
+
+class Mcp2515Model : public sim::SpiDevice, public sim::Peripheral {
+public:
+    struct Frame {
+        uint32_t id;
+        bool extended;
+        uint8_t dlc;
+        uint8_t data[8];
+    };
+
+    // Registers used by the model
+    enum : uint8_t {
+        CANSTAT = 0x0E, CANCTRL = 0x0F, TEC = 0x1C, REC = 0x1D,
+        CNF3 = 0x28, CNF2 = 0x29, CNF1 = 0x2A,
+        CANINTE = 0x2B, CANINTF = 0x2C, EFLG = 0x2D,
+        TXB0CTRL = 0x30, RXB0CTRL = 0x60, RXB1CTRL = 0x70
+    };
+
+    Mcp2515Model(uint8_t intPin, double oscillatorHz)
+        : _intPin(intPin), _oscHz(oscillatorHz) {
+        reset();
+    }
+
+    // Unplugged module: MISO floats high, nothing else responds
+    void setPresent(bool present) { _present = present; }
+
+    // Attach to the simulated MCU: CS pin + clocking
+    void attach(uint8_t csPin) {
+        sim::attachSpiDevice(csPin, this);
+        sim::addPeripheral(this);
+        updateInt();
+    }
+
+    // Called for every transmitted frame (virtual bus wiring)
+    void onTransmit(std::function<void(const Frame&)> fn) { _onTransmit = fn; }
+
+    // A frame arrives from the bus. Returns false if it was not accepted
+    // (wrong mode, no filter hit, or both buffers full).
+    bool injectFrame(const Frame& f) {
+        uint8_t mode = _reg[CANSTAT] & 0xE0;
+        if (mode != 0x00 && mode != 0x40 && mode != 0x60) return false;  // normal/loopback/listen
+
+        bool rx0 = acceptedBy(0, f);
+        bool rx1 = acceptedBy(1, f);
+        bool stored = false;
+        if (rx0) {
+            if (!(_reg[CANINTF] & 0x01)) {
+                store(0, f);
+                stored = true;
+            } else if (_reg[RXB0CTRL] & 0x04) {  // BUKT: roll over to RXB1
+                if (!(_reg[CANINTF] & 0x02)) {
+                    store(1, f);
+                    stored = true;
+                } else {
+                    _reg[EFLG] |= 0x80;  // RX1OVR
+                }
+            } else {
+                _reg[EFLG] |= 0x40;  // RX0OVR
+            }
+        } else if (rx1) {
+            if (!(_reg[CANINTF] & 0x02)) {
+                store(1, f);
+                stored = true;
+            } else {
+                _reg[EFLG] |= 0x80;
+            }
+        } else {
+            _filtered++;
+        }
+        if (_reg[EFLG] & 0xC0) _reg[CANINTF] |= 0x20;  // ERRIF
+        updateInt();
+        return stored;
+    }
+
+    const std::deque<Frame>& transmitted() const { return _txLog; }
+    void clearTransmitted() { _txLog.clear(); }
+
+    uint8_t reg(uint8_t addr) const { return _reg[addr & 0x7F]; }
+    bool intAsserted() const { return (_reg[CANINTE] & _reg[CANINTF]) != 0; }
+    uint32_t filteredCount() const { return _filtered; }
+    uint32_t spiTransactions() const { return _transactions; }
+
+    // Bit rate from CNF1..3 (0 if the timing is invalid)
+    double bitRate() const {
+        uint8_t brp = _reg[CNF1] & 0x3F;
+        uint8_t prseg = (_reg[CNF2] & 0x07) + 1;
+        uint8_t phseg1 = ((_reg[CNF2] >> 3) & 0x07) + 1;
+        uint8_t phseg2 = (_reg[CNF2] & 0x80) ? (uint8_t)((_reg[CNF3] & 0x07) + 1)
+                                             : (uint8_t)(phseg1 > 2 ? phseg1 : 2);
+        double tq = 2.0 * (brp + 1) / _oscHz;
+        double bit = (1 + prseg + phseg1 + phseg2) * tq;
+        return bit > 0 ? 1.0 / bit : 0.0;
+    }
+
+    // Sample point in percent of the bit time
+    double samplePoint() const {
+        uint8_t prseg = (_reg[CNF2] & 0x07) + 1;
+        uint8_t phseg1 = ((_reg[CNF2] >> 3) & 0x07) + 1;
+        uint8_t phseg2 = (_reg[CNF2] & 0x80) ? (uint8_t)((_reg[CNF3] & 0x07) + 1)
+                                             : (uint8_t)(phseg1 > 2 ? phseg1 : 2);
+        double total = 1 + prseg + phseg1 + phseg2;
+        return 100.0 * (1 + prseg + phseg1) / total;
+    }
+
+    // --- sim::SpiDevice ------------------------------------------------------
+    void select() override {
+        _selected = true;
+        _byteIndex = 0;
+        _instr = 0;
+        _transactions++;
+    }
+
+    uint8_t transfer(uint8_t mosi) override {
+        if (!_present) return 0xFF;
+        uint8_t miso = 0xFF;
+        uint8_t i = _byteIndex++;
+        if (i == 0) {
+            _instr = mosi;
+            beginInstruction(mosi);
+            return 0xFF;
+        }
+        switch (instructionClass(_instr)) {
+            case READ:
+                if (i == 1) { _addr = mosi & 0x7F; break; }
+                miso = _reg[_addr];
+                _addr = (_addr + 1) & 0x7F;
+                break;
+            case WRITE:
+                if (i == 1) { _addr = mosi & 0x7F; break; }
+                writeReg(_addr, mosi);
+                _addr = (_addr + 1) & 0x7F;
+                break;
+            case READ_RX:
+                miso = _reg[_addr];
+                _addr = (_addr + 1) & 0x7F;
+                break;
+            case LOAD_TX:
+                writeReg(_addr, mosi);
+                _addr = (_addr + 1) & 0x7F;
+                break;
+            case READ_STATUS:
+                miso = readStatus();
+                break;
+            case BIT_MODIFY:
+                if (i == 1) _addr = mosi & 0x7F;
+                else if (i == 2) _bmMask = mosi;
+                else if (i == 3) writeReg(_addr, (uint8_t)((_reg[_addr] & ~_bmMask) | (mosi & _bmMask)));
+                break;
+            default:
+                break;
+        }
+        return miso;
+    }
+
+    void deselect() override {
+        if (!_selected) return;
+        _selected = false;
+        if (!_present) return;
+        // READ RX BUFFER clears the matching RXnIF when CS goes high
+        if (instructionClass(_instr) == READ_RX && _byteIndex > 1) {
+            _reg[CANINTF] &= (uint8_t)~((_instr & 0x04) ? 0x02 : 0x01);
+        }
+        updateInt();
+    }
+
+    // --- sim::Peripheral -----------------------------------------------------
+    void tick(uint64_t nowUs) override {
+        if ((_reg[CANSTAT] & 0xE0) != 0x00 && (_reg[CANSTAT] & 0xE0) != 0x40) {
+            _txBuffer = -1;
+            return;
+        }
+        // Frames go out back to back: each starts when the bus is free and
+        // its RTS has been seen, independent of how coarse the ticks are
+        for (;;) {
+            if (_txBuffer < 0) {
+                uint64_t start = _rtsAtUs > _busFreeAtUs ? _rtsAtUs : _busFreeAtUs;
+                if (!startTx(start)) return;
+            }
+            if (nowUs < _txBusyUntil) return;
+            finishTx();
+        }
+    }
+
+private:
+    enum InstrClass { NONE, RESET_I, READ, WRITE, READ_RX, LOAD_TX, RTS, READ_STATUS, BIT_MODIFY };
+
+    uint8_t _intPin;
+    double _oscHz;
+    uint8_t _reg[128];
+    bool _present = true;
+    bool _selected = false;
+    uint8_t _byteIndex = 0;
+    uint8_t _instr = 0;
+    uint8_t _addr = 0;
+    uint8_t _bmMask = 0;
+    uint32_t _filtered = 0;
+    uint32_t _transactions = 0;
+    int _txBuffer = -1;          // Buffer being transmitted
+    uint64_t _txBusyUntil = 0;   // End of the frame on the bus
+    uint64_t _busFreeAtUs = 0;
+    uint64_t _rtsAtUs = 0;
+    std::deque<Frame> _txLog;
+    std::function<void(const Frame&)> _onTransmit;
+
+    static InstrClass instructionClass(uint8_t instr) {
+        if (instr == 0xC0) return RESET_I;
+        if (instr == 0x03) return READ;
+        if (instr == 0x02) return WRITE;
+        if ((instr & 0xF9) == 0x90) return READ_RX;
+        if ((instr & 0xF8) == 0x40) return LOAD_TX;
+        if ((instr & 0xF8) == 0x80) return RTS;
+        if (instr == 0xA0) return READ_STATUS;
+        if (instr == 0x05) return BIT_MODIFY;
+        return NONE;
+    }
+
+    void reset() {
+        memset(_reg, 0, sizeof(_reg));
+        _reg[CANSTAT] = 0x80;  // Configuration mode after reset
+        _reg[CANCTRL] = 0x87;
+        _txBuffer = -1;
+        _txBusyUntil = 0;
+        _busFreeAtUs = 0;
+    }
+
+    void beginInstruction(uint8_t instr) {
+        switch (instructionClass(instr)) {
+            case RESET_I:
+                reset();
+                break;
+            case READ_RX: {
+                // 0x90 | n<<2 | m<<1 : n = buffer, m = start at D0 instead of SIDH
+                uint8_t base = (instr & 0x04) ? 0x71 : 0x61;
+                _addr = (uint8_t)(base + ((instr & 0x02) ? 5 : 0));
+                break;
+            }
+            case LOAD_TX: {
+                // 0x40 | abc : TXB0SIDH, TXB0D0, TXB1SIDH, TXB1D0, TXB2SIDH, TXB2D0
+                uint8_t abc = instr & 0x07;
+                uint8_t base = (uint8_t)(0x31 + 0x10 * (abc >> 1));
+                _addr = (uint8_t)(base + ((abc & 0x01) ? 5 : 0));
+                break;
+            }
+            case RTS:
+                _rtsAtUs = sim::nowMicros();
+                for (uint8_t b = 0; b < 3; b++) {
+                    if (instr & (1 << b)) _reg[TXB0CTRL + 0x10 * b] |= 0x08;  // TXREQ
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void writeReg(uint8_t addr, uint8_t value) {
+        switch (addr) {
+            case CANSTAT:
+                return;  // Read-only
+            case CANCTRL:
+                _reg[CANCTRL] = value;
+                _reg[CANSTAT] = (uint8_t)((_reg[CANSTAT] & 0x1F) | (value & 0xE0));
+                return;
+            default:
+                break;
+        }
+        // Filters, masks and CNF are only writable in configuration mode
+        bool configOnly = (addr < 0x0E) || (addr >= 0x10 && addr < 0x1C) ||
+                          (addr >= 0x20 && addr <= 0x2A);
+        if (configOnly && (_reg[CANSTAT] & 0xE0) != 0x80) return;
+        _reg[addr] = value;
+    }
+
+    uint8_t readStatus() const {
+        uint8_t st = 0;
+        if (_reg[CANINTF] & 0x01) st |= 0x01;
+        if (_reg[CANINTF] & 0x02) st |= 0x02;
+        if (_reg[0x30] & 0x08) st |= 0x04;
+        if (_reg[CANINTF] & 0x04) st |= 0x08;
+        if (_reg[0x40] & 0x08) st |= 0x10;
+        if (_reg[CANINTF] & 0x08) st |= 0x20;
+        if (_reg[0x50] & 0x08) st |= 0x40;
+        if (_reg[CANINTF] & 0x10) st |= 0x80;
+        return st;
+    }
+
+    void updateInt() {
+        sim::setDigitalInput(_intPin, intAsserted() ? LOW : HIGH);
+    }
+
+    // --- Acceptance ----------------------------------------------------------
+    static uint32_t regId(const uint8_t* r, bool& ext) {
+        ext = (r[1] & 0x08) != 0;
+        uint32_t sid = ((uint32_t)r[0] << 3) | (r[1] >> 5);
+        if (!ext) return sid;
+        return (sid << 18) | ((uint32_t)(r[1] & 0x03) << 16) | ((uint32_t)r[2] << 8) | r[3];
+    }
+
+    bool filterMatch(uint8_t filterAddr, uint8_t maskAddr, const Frame& f) const {
+        bool fExt = false, mExt = false;
+        uint32_t filt = regId(&_reg[filterAddr], fExt);
+        if (fExt != f.extended) return false;
+        if (f.extended) {
+            // Mask register: EXIDE bit is unimplemented, decode all 29 bits
+            uint8_t m[4] = {_reg[maskAddr], (uint8_t)(_reg[maskAddr + 1] | 0x08),
+                            _reg[maskAddr + 2], _reg[maskAddr + 3]};
+            uint32_t mask = regId(m, mExt);
+            return ((f.id ^ filt) & mask) == 0;
+        }
+        uint32_t mask = regId(&_reg[maskAddr], mExt);
+        return ((f.id ^ filt) & mask & 0x7FF) == 0;
+    }
+
+    bool acceptedBy(uint8_t buffer, const Frame& f) const {
+        uint8_t ctrl = _reg[buffer ? RXB1CTRL : RXB0CTRL];
+        if ((ctrl & 0x60) == 0x60) return true;  // RXM = 11: filters off
+        if (buffer == 0) {
+            return filterMatch(0x00, 0x20, f) || filterMatch(0x04, 0x20, f);
+        }
+        static const uint8_t filters[4] = {0x08, 0x10, 0x14, 0x18};
+        for (uint8_t i = 0; i < 4; i++) {
+            if (filterMatch(filters[i], 0x24, f)) return true;
+        }
+        return false;
+    }
+
+    void store(uint8_t buffer, const Frame& f) {
+        uint8_t* r = &_reg[buffer ? 0x71 : 0x61];
+        if (f.extended) {
+            r[0] = (uint8_t)(f.id >> 21);
+            r[1] = (uint8_t)(((f.id >> 13) & 0xE0) | 0x08 | ((f.id >> 16) & 0x03));
+            r[2] = (uint8_t)(f.id >> 8);
+            r[3] = (uint8_t)f.id;
+        } else {
+            r[0] = (uint8_t)(f.id >> 3);
+            r[1] = (uint8_t)((f.id & 0x07) << 5);
+            r[2] = 0;
+            r[3] = 0;
+        }
+        r[4] = f.dlc & 0x0F;
+        for (uint8_t i = 0; i < 8; i++) r[5 + i] = (i < f.dlc) ? f.data[i] : 0;
+        _reg[CANINTF] |= buffer ? 0x02 : 0x01;
+    }
+
+    // --- Transmission --------------------------------------------------------
+    bool startTx(uint64_t startUs) {
+        // Highest buffer number wins at equal priority (TXP ignored)
+        for (int b = 2; b >= 0; b--) {
+            uint8_t ctrl = _reg[TXB0CTRL + 0x10 * b];
+            if (!(ctrl & 0x08)) continue;
+            double rate = bitRate();
+            if (rate <= 0) return false;
+            uint8_t dlc = _reg[TXB0CTRL + 0x10 * b + 5] & 0x0F;
+            if (dlc > 8) dlc = 8;
+            bool ext = (_reg[TXB0CTRL + 0x10 * b + 2] & 0x08) != 0;
+            // Frame bits without stuffing: SOF..EOF + IFS
+            unsigned bits = (ext ? 67u : 47u) + 8u * dlc;
+            uint64_t us = (uint64_t)(bits * 1e6 / rate + 0.5);
+            _txBuffer = b;
+            _txBusyUntil = startUs + (us ? us : 1);
+            return true;
+        }
+        return false;
+    }
+
+    void finishTx() {
+        uint8_t b = (uint8_t)_txBuffer;
+        const uint8_t* r = &_reg[TXB0CTRL + 0x10 * b + 1];
+        Frame f;
+        f.id = regId(r, f.extended);
+        f.dlc = r[4] & 0x0F;
+        if (f.dlc > 8) f.dlc = 8;
+        for (uint8_t i = 0; i < 8; i++) f.data[i] = r[5 + i];
+        _txLog.push_back(f);
+        if (_onTransmit) _onTransmit(f);
+
+        _reg[TXB0CTRL + 0x10 * b] &= (uint8_t)~0x08;
+        _reg[CANINTF] |= (uint8_t)(0x04 << b);  // TXnIF
+        _txBuffer = -1;
+        _busFreeAtUs = _txBusyUntil;
+        updateInt();
+    }
+};
@@ -0,0 +1,177 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// PumpPlant - The hardware around the Nano as seen from its pins
+// -----------------------------------------------------------------------------
+// Reads the two power outputs (D6/D5) and drives the analog inputs:
+//   - Pumps: brushed DC motors, I = (d*Vs - (1-d)*Vf - Ke*w) / R (freewheel
+//     diode, current never negative), J dw/dt = Ke*I - kq*load*w^2. A locked
+//     rotor stays at w = 0 and draws the stall current.
+//   - ACS758 on A2/A3: zero + 40 mV/A, plus the commutation ripple at
+//     w/2pi * PUMP_COMMUTATOR_SEGMENTS, evaluated at the instant of each
+//     conversion (AnalogSource) so PumpSpeedEstimator sees a real tone.
+//   - Supply on A5 through the 10k/1k divider, sagging with the pump
+//     current through the source resistance.
+//   - Heatsink NTC on A1: one RC node heated by MOSFET conduction
+//     (d*I^2*Rds) and diode freewheel ((1-d)*I*Vf) losses of both channels.
+//   - MPX5700AP on A4 from the absolute pressure set with setMapKpa().
+// Gaussian noise (adcNoiseV) on every analog input lets MAP oversampling gain
+// its bits. The model steps at most every STEP_US of virtual time.
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+#include "ArduinoSim.h"
+#include "Config.h"
+
+#include <math.h>
+#include <stdint.h>
+
+class PumpPlant : public sim::Peripheral {
+public:
+    struct Params {
+        float supplyV = 13.8f;        // Source open-circuit voltage
+        float supplyR = 0.010f;       // Battery + harness (Ohm)
+        float pumpR[2] = {0.15f, 0.15f};     // Winding + brushes (Ohm)
+        float pumpLoad[2] = {1.0f, 1.0f};    // Hydraulic load (1 = nominal, >1 worn/restricted)
+        float rippleFraction = 0.08f; // Commutation ripple amplitude / mean current
+        float acsZeroV = 2.49f;       // ACS758 output at 0 A
+        float ambientC = 25.0f;
+        float heatsinkRth = 1.2f;     // Heatsink to ambient (K/W)
+        float heatsinkCth = 250.0f;   // Heatsink thermal mass (J/K)
+        float adcNoiseV = 0.002f;     // RMS noise on every analog input
+        uint32_t seed = 1;
+    };
+
+    // Motor constants: ~5200 RPM and 18 A at 13.5 V with nominal load
+    static constexpr float KE = 0.0198f;        // V*s/rad (= Nm/A)
+    static constexpr float KQ = 1.2e-6f;        // Nm/(rad/s)^2, pump torque at load 1
+    static constexpr float INERTIA = 2e-4f;     // kg*m^2 (rotor + impeller)
+    static constexpr float ACS_V_PER_A = 0.04f;
+    static constexpr float DIVIDER = 1.0f / 11.0f;
+    static constexpr uint64_t STEP_US = 100;
+
+    explicit PumpPlant(const Params& p)
+        : _p(p), _heatsinkC(p.ambientC), _supplyV(p.supplyV), _rng(p.seed ? p.seed : 1) {
+        _current[0].plant = this;
+        _current[0].ch = 0;
+        _current[1].plant = this;
+        _current[1].ch = 1;
+    }
+
+    void attach() {
+        sim::addPeripheral(this);
+        sim::setAnalogSource(Config::PIN_CURRENT_1, &_current[0]);
+        sim::setAnalogSource(Config::PIN_CURRENT_2, &_current[1]);
+        _lastUs = sim::nowMicros();
+        updateInputs();
+    }
+
+    void setMapKpa(float kPa) { _mapKpa = kPa; }
+    void setStalled(uint8_t ch, bool stalled) {
+        _stalled[ch] = stalled;
+        if (stalled) _omega[ch] = 0.0f;
+    }
+
+    void tick(uint64_t nowUs) override {
+        if (nowUs - _lastUs < STEP_US) return;
+        float dt = (nowUs - _lastUs) * 1e-6f;
+        _lastUs = nowUs;
+
+        float supplyI = 0.0f;
+        float losses = 0.0f;
+        float rds = Config::MOSFET_RDS_ON_25C * (1.0f + Config::MOSFET_RDS_TEMPCO * (_heatsinkC - 25.0f));
+        for (uint8_t ch = 0; ch < 2; ch++) {
+            float d = pumpDuty(ch);
+            _duty[ch] = d;
+            float vMotor = d * _supplyV - (1.0f - d) * Config::DIODE_VF;
+            float i = (vMotor - KE * _omega[ch]) / _p.pumpR[ch];
+            if (i < 0.0f || d <= 0.0f) i = 0.0f;
+            _amps[ch] = i;
+            if (!_stalled[ch]) {
+                float torque = KE * i - KQ * _p.pumpLoad[ch] * _omega[ch] * _omega[ch];
+                _omega[ch] += torque / INERTIA * dt;
+                if (_omega[ch] < 0.0f) _omega[ch] = 0.0f;
+                _angle[ch] = fmodf(_angle[ch] + _omega[ch] * dt, 2.0f * (float)M_PI);
+            }
+            supplyI += d * i;
+            losses += d * i * i * rds + (1.0f - d) * i * Config::DIODE_VF;
+        }
+        _supplyV = _p.supplyV - _p.supplyR * supplyI;
+        _heatsinkC += (losses - (_heatsinkC - _p.ambientC) / _p.heatsinkRth) / _p.heatsinkCth * dt;
+        _energyJ += _supplyV * supplyI * dt;
+        _sampleUs = nowUs;
+        updateInputs();
+    }
+
+    // Plant state (for the harness)
+    float getCurrentA(uint8_t ch) const { return _amps[ch]; }
+    float getRpm(uint8_t ch) const { return _omega[ch] * 60.0f / (2.0f * (float)M_PI); }
+    float getDuty(uint8_t ch) const { return _duty[ch]; }
+    float getSupplyV() const { return _supplyV; }
+    float getHeatsinkC() const { return _heatsinkC; }
+    float getMapKpa() const { return _mapKpa; }
+    float getEnergyWh() const { return _energyJ / 3600.0f; }
+
+private:
+    struct CurrentSource : public sim::AnalogSource {
+        PumpPlant* plant = nullptr;
+        uint8_t ch = 0;
+        float volts(uint64_t nowUs) override { return plant->acsVolts(ch, nowUs); }
+    };
+
+    Params _p;
+    CurrentSource _current[2];
+    float _omega[2] = {0.0f, 0.0f};
+    float _angle[2] = {0.0f, 0.0f};
+    float _amps[2] = {0.0f, 0.0f};
+    float _duty[2] = {0.0f, 0.0f};
+    bool _stalled[2] = {false, false};
+    float _heatsinkC;
+    float _supplyV;
+    float _mapKpa = 101.3f;
+    float _energyJ = 0.0f;
+    uint64_t _lastUs = 0;
+    uint64_t _sampleUs = 0;
+    uint32_t _rng;
+
+    // Gate drive: the pump runs while its pin is LOW on the inverted board
+    float pumpDuty(uint8_t ch) const {
+        uint8_t pin = ch == 0 ? Config::PIN_PWM_OUT_1 : Config::PIN_PWM_OUT_2;
+        if (sim::getPinMode(pin) != OUTPUT) return 0.0f;  // Driver pulls the gate off
+        float high = sim::getOutputDuty(pin);
+        return Config::PWM_INVERTED_BY_HARDWARE ? 1.0f - high : high;
+    }
+
+    float acsVolts(uint8_t ch, uint64_t nowUs) {
+        float i = _amps[ch];
+        if (i > 0.0f && _omega[ch] > 0.0f) {
+            float angle = _angle[ch] + _omega[ch] * (float)(int64_t)(nowUs - _sampleUs) * 1e-6f;
+            i *= 1.0f + _p.rippleFraction * sinf(angle * Config::PUMP_COMMUTATOR_SEGMENTS);
+        }
+        return _p.acsZeroV + ACS_V_PER_A * i + noise();
+    }
+
+    void updateInputs() {
+        float mapV = 5.0f * (0.00125f * _mapKpa + 0.04f);
+        sim::setAnalogVoltage(Config::PIN_MAP_SENSOR, clampV(mapV + noise()));
+        sim::setAnalogVoltage(Config::PIN_VCC_SENSE, clampV(_supplyV * DIVIDER + noise()));
+        float kelvin = _heatsinkC + 273.15f;
+        float rNtc = Config::NTC_R25 * expf(Config::NTC_BETA * (1.0f / kelvin - 1.0f / Config::NTC_T25_KELVIN));
+        sim::setAnalogVoltage(Config::PIN_NTC_TEMP, clampV(5.0f * rNtc / (Config::NTC_R_PULLUP + rNtc) + noise()));
+    }
+
+    static float clampV(float v) { return v < 0.0f ? 0.0f : (v > 5.0f ? 5.0f : v); }
+
+    // Box-Muller on a xorshift32 stream: reproducible per seed
+    float noise() {
+        if (_p.adcNoiseV <= 0.0f) return 0.0f;
+        float u1 = (next() + 1.0f) / 4294967297.0f;
+        float u2 = next() / 4294967296.0f;
+        return _p.adcNoiseV * sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+    }
+
+    uint32_t next() {
+        _rng ^= _rng << 13;
+        _rng ^= _rng >> 17;
+        _rng ^= _rng << 5;
+        return _rng;
+    }
+};
@@ -0,0 +1,90 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// VirtualCanBus - In-process CAN bus between simulated boards
+// -----------------------------------------------------------------------------
+// Frame-level model for multi-node scenarios (no MCP2515 register model):
+//   - one frame on the wire at a time, for its unstuffed length at the bit rate
+//   - frames waiting when the bus frees up are arbitrated by id (lowest wins)
+//   - a frame is delivered to every node except its sender at end of frame
+// Ticked by virtual time as a sim::Peripheral. Nodes that go silent are
+// modelled by the harness simply not sending.
+// -----------------------------------------------------------------------------
+#include "ArduinoSim.h"
+#include "CanInterface.h"
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+class VirtualCanBus : public sim::Peripheral {
+public:
+    typedef std::function<void(const CanFrame&)> Receiver;
+
+    explicit VirtualCanBus(double bitRate) : _bitRate(bitRate) {
+        sim::addPeripheral(this);
+    }
+
+    // Returns the node handle used by send()
+    uint8_t attach(Receiver rx) {
+        _nodes.push_back(rx);
+        return (uint8_t)(_nodes.size() - 1);
+    }
+
+    void send(uint8_t from, const CanFrame& frame) {
+        Pending p;
+        p.frame = frame;
+        p.from = from;
+        p.readyUs = sim::nowMicros();
+        _pending.push_back(p);
+    }
+
+    // Frames delivered since the bus was created
+    uint32_t getDelivered() const { return _delivered; }
+
+    void tick(uint64_t nowUs) override {
+        for (;;) {
+            if (_onWire) {
+                if (nowUs < _wireEndUs) return;
+                deliver(_wire);
+                _onWire = false;
+                _busFreeAtUs = _wireEndUs;
+            }
+            // Arbitration among frames ready when the bus became free
+            int best = -1;
+            for (size_t i = 0; i < _pending.size(); i++) {
+                if (_pending[i].readyUs > nowUs) continue;
+                if (best < 0 || _pending[i].frame.id < _pending[best].frame.id) best = (int)i;
+            }
+            if (best < 0) return;
+            _wire = _pending[best];
+            _pending.erase(_pending.begin() + best);
+            uint64_t start = _wire.readyUs > _busFreeAtUs ? _wire.readyUs : _busFreeAtUs;
+            unsigned bits = (_wire.frame.extended ? 67u : 47u) + 8u * _wire.frame.dlc;
+            _wireEndUs = start + (uint64_t)(bits * 1e6 / _bitRate + 0.5);
+            _onWire = true;
+        }
+    }
+
+private:
+    struct Pending {
+        CanFrame frame;
+        uint8_t from;
+        uint64_t readyUs;
+    };
+
+    double _bitRate;
+    std::vector<Receiver> _nodes;
+    std::vector<Pending> _pending;
+    Pending _wire;
+    bool _onWire = false;
+    uint64_t _wireEndUs = 0;
+    uint64_t _busFreeAtUs = 0;
+    uint32_t _delivered = 0;
+
+    void deliver(const Pending& p) {
+        for (size_t n = 0; n < _nodes.size(); n++) {
+            if (n != p.from) _nodes[n](p.frame);
+        }
+        _delivered++;
+    }
+};
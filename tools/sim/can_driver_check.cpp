@@ -0,0 +1,350 @@
+// -----------------------------------------------------------------------------
+// can_driver_check - Runs CanInterface against the MCP2515 register model
+// -----------------------------------------------------------------------------
+// Build: cmake -S tools -B build-tools && cmake --build build-tools
+// Run:   ./build-tools/can_driver_check        (exit code 0 = all checks pass)
+//
+// Each scenario starts from a clean simulated Nano (sim::reset), attaches the
+// model on PIN_CAN_CS / PIN_CAN_INT and drives the driver exactly like the
+// sketch does: begin(), PCINT2 ISR -> onInterrupt(), poll() in the loop.
+// The command scenarios feed received frames to CanCommand like loop() does.
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+#include "ArduinoSim.h"
+#include "Mcp2515Model.h"
+#include "CanInterface.h"
+#include "CanCommand.h"
+#include "CanTelemetry.h"
+
+#include <stdio.h>
+#include <memory>
+
+namespace {
+
+std::unique_ptr<CanInterface> g_dut;
+int g_failures = 0;
+
+void check(bool ok, const char* name, const char* detail = "") {
+    printf("%s  %s%s%s\n", ok ? "PASS" : "FAIL", name, detail[0] ? ": " : "", detail);
+    if (!ok) g_failures++;
+}
+
+struct Bench {
+    Mcp2515Model model;
+    CanInterface& can;
+
+    explicit Bench(bool present = true)
+        : model((sim::reset(), Config::PIN_CAN_INT), Config::CAN_CRYSTAL_MHZ * 1e6)
+        , can(fresh()) {
+        sim::setSerialEcho(false);
+        TCCR0A = 0x01;  // Same Timer 0 setup as PowerOutputs::begin():
+        TCCR0B = 0x02;  // phase-correct, prescaler 8
+        Timer1Clock::begin();  // Transaction and ISR timing, as in the sketch
+        model.setPresent(present);
+        model.attach(Config::PIN_CAN_CS);
+    }
+
+    static CanInterface& fresh() {
+        g_dut.reset(new CanInterface());
+        return *g_dut;
+    }
+};
+
+Mcp2515Model::Frame frame(uint32_t id, uint8_t dlc, uint8_t seed, bool ext = false) {
+    Mcp2515Model::Frame f;
+    f.id = id;
+    f.extended = ext;
+    f.dlc = dlc;
+    for (uint8_t i = 0; i < 8; i++) f.data[i] = (uint8_t)(seed + i);
+    return f;
+}
+
+CanFrame txFrame(uint32_t id, uint8_t seed) {
+    CanFrame f;
+    f.id = id;
+    f.extended = false;
+    f.dlc = 8;
+    for (uint8_t i = 0; i < 8; i++) f.data[i] = (uint8_t)(seed + i);
+    return f;
+}
+
+// ---------------------------------------------------------------------------
+
+void checkBitTiming() {
+    static const uint8_t crystals[] = {8, 16};
+    static const uint16_t rates[] = {125, 250, 500, 1000};
+    for (uint8_t mhz : crystals) {
+        for (uint16_t kbps : rates) {
+            sim::reset();
+            Mcp2515Model m(Config::PIN_CAN_INT, mhz * 1e6);
+            uint8_t cnf[3];
+            char name[64];
+            snprintf(name, sizeof(name), "bit timing %u MHz / %u kbps", mhz, kbps);
+            // 1 Mbps at 8 MHz would need a 4 TQ bit (PS2 < IPT): must be refused
+            bool expected = !(mhz == 8 && kbps == 1000);
+            if (!CanInterface::bitTimingFor(mhz, kbps, cnf)) {
+                check(!expected, name, expected ? "refused" : "refused as expected");
+                continue;
+            }
+            m.select();
+            m.transfer(CanInterface::INSTR_WRITE);
+            m.transfer(CanInterface::REG_CNF3);
+            for (uint8_t i = 0; i < 3; i++) m.transfer(cnf[i]);
+            m.deselect();
+            double rate = m.bitRate();
+            double sp = m.samplePoint();
+            char detail[64];
+            snprintf(detail, sizeof(detail), "%.1f kbps, sample point %.0f%%", rate / 1000.0, sp);
+            check(expected && fabs(rate - kbps * 1000.0) < kbps * 0.5 && sp >= 70.0 && sp <= 90.0, name, detail);
+        }
+    }
+}
+
+void checkBegin() {
+    {
+        Bench b;
+        bool ok = b.can.begin();
+        check(ok && b.can.isReady(), "begin() with MCP2515 present");
+        check((b.model.reg(Mcp2515Model::CANSTAT) & 0xE0) == 0x00, "controller left in normal mode");
+        check(b.model.reg(Mcp2515Model::CANINTE) == 0x07, "CANINTE = RX0 | RX1 | TX0");
+        check(b.model.reg(Mcp2515Model::RXB0CTRL) & 0x04, "RXB0 rollover (BUKT) enabled");
+        check(PCICR & _BV(digitalPinToPCICRbit(Config::PIN_CAN_INT)), "pin-change interrupt enabled");
+        check(fabs(b.model.bitRate() - Config::CAN_BITRATE_KBPS * 1000.0) < 1.0, "configured bit rate");
+    }
+    {
+        Bench b(false);
+        check(!b.can.begin() && !b.can.isReady(), "begin() without MCP2515 fails cleanly");
+        check(!b.can.send(txFrame(0x6A0, 0)), "send() refused while not ready");
+    }
+}
+
+void checkReceive() {
+    Bench b;
+    b.can.begin();
+
+    bool acc = b.model.injectFrame(frame(Config::CAN_RX_ACCEPT_ID | 0x5, 8, 0x10));
+    CanFrame f;
+    bool got = b.can.receive(f);
+    check(acc && got && f.id == (uint32_t)(Config::CAN_RX_ACCEPT_ID | 0x5) && f.dlc == 8 &&
+          f.data[0] == 0x10 && f.data[7] == 0x17,
+          "accepted frame delivered through ISR");
+    check(!b.model.intAsserted() && digitalRead(Config::PIN_CAN_INT) == HIGH, "INT released after ISR");
+
+    bool rej = b.model.injectFrame(frame(0x123, 8, 0));
+    check(!rej && !b.can.receive(f), "frame outside acceptance block filtered in hardware");
+
+    bool ext = b.model.injectFrame(frame(Config::CAN_RX_ACCEPT_ID, 8, 0, true));
+    check(!ext, "extended frame filtered (standard-only filters)");
+
+    uint8_t sreg = SREG;
+    noInterrupts();
+    b.model.injectFrame(frame(Config::CAN_RX_ACCEPT_ID | 1, 2, 0x21));
+    b.model.injectFrame(frame(Config::CAN_RX_ACCEPT_ID | 2, 3, 0x31));
+    SREG = sreg;
+    sim::serviceInterrupts();
+    CanFrame a, c;
+    bool both = b.can.receive(a) && b.can.receive(c);
+    check(both && a.id == (uint32_t)(Config::CAN_RX_ACCEPT_ID | 1) && a.dlc == 2 &&
+          c.id == (uint32_t)(Config::CAN_RX_ACCEPT_ID | 2) && c.dlc == 3,
+          "back-to-back frames via RXB0 + rollover, in order");
+}
+
+void checkRxOverflow() {
+    Bench b;
+    b.can.begin();
+    const uint8_t n = 10;
+    for (uint8_t i = 0; i < n; i++) {
+        b.model.injectFrame(frame(Config::CAN_RX_ACCEPT_ID, 1, i));
+    }
+    uint8_t cap = SpscRing<CanFrame, Config::CAN_RX_RING_SIZE>::capacity();
+    uint8_t count = 0;
+    CanFrame f;
+    bool ordered = true;
+    while (b.can.receive(f)) {
+        if (f.data[0] != count) ordered = false;
+        count++;
+    }
+    char detail[64];
+    snprintf(detail, sizeof(detail), "kept %u, dropped %u", count, b.can.getRxDropped());
+    check(count == cap && b.can.getRxDropped() == n - cap && ordered,
+          "RX ring full: oldest kept, excess counted", detail);
+}
+
+void checkTransmit() {
+    Bench b;
+    b.can.begin();
+
+    uint8_t accepted = 0;
+    for (uint8_t i = 0; i < 6; i++) {
+        if (b.can.send(txFrame(0x6B0 + i, i * 8))) accepted++;
+    }
+    // One frame goes straight into TXB0, the ring holds capacity() more
+    uint8_t expected = 1 + SpscRing<CanFrame, Config::CAN_TX_RING_SIZE>::capacity();
+    check(accepted == expected, "TX ring back-pressure (send() returns false when full)");
+
+    sim::advanceMicros(5000);
+    const auto& log = b.model.transmitted();
+    bool ordered = log.size() == accepted;
+    for (size_t i = 0; ordered && i < log.size(); i++) {
+        ordered = log[i].id == 0x6B0 + i && log[i].dlc == 8 && log[i].data[0] == i * 8;
+    }
+    check(ordered && b.can.getTxFrames() == accepted, "queued frames transmitted in order from TX0 ISR");
+
+    CanFrame ext = txFrame(0x18FF50E5UL, 0xA0);
+    ext.extended = true;
+    b.can.send(ext);
+    sim::advanceMicros(1000);
+    check(!b.model.transmitted().empty() && b.model.transmitted().back().extended &&
+          b.model.transmitted().back().id == 0x18FF50E5UL,
+          "extended identifier encoding");
+}
+
+void checkMissedEdge() {
+    Bench b;
+    b.can.begin();
+    // Simulate a lost pin-change edge: mask PCINT2, frame arrives, unmask
+    PCICR &= (uint8_t)~_BV(digitalPinToPCICRbit(Config::PIN_CAN_INT));
+    b.model.injectFrame(frame(Config::CAN_RX_ACCEPT_ID | 7, 4, 0x70));
+    PCIFR = 0;
+    PCICR |= (uint8_t)_BV(digitalPinToPCICRbit(Config::PIN_CAN_INT));
+    CanFrame f;
+    bool before = b.can.receive(f);
+    b.can.poll();
+    bool after = b.can.receive(f);
+    check(!before && after && f.id == (uint32_t)(Config::CAN_RX_ACCEPT_ID | 7),
+          "poll() recovers an INT line left asserted");
+}
+
+void checkTiming() {
+    Bench b;
+    b.can.begin();
+    b.can.resetTiming();
+    for (uint16_t i = 0; i < 200; i++) {
+        b.model.injectFrame(frame(Config::CAN_RX_ACCEPT_ID | (i & 0xF), 8, (uint8_t)i));
+        if (i % 2 == 0) b.can.send(txFrame(0x6B0, (uint8_t)i));
+        CanFrame f;
+        while (b.can.receive(f)) {}
+        b.can.poll();
+        sim::advanceMicros(500);
+    }
+    char detail[96];
+    snprintf(detail, sizeof(detail), "SPI transaction max %u us, ISR max %u us",
+             b.can.getMaxTransactionUs(), b.can.getMaxIsrUs());
+    // Budget: a burst must fit well inside one Timer 0 PWM period (256 us)
+    check(b.can.getMaxTransactionUs() <= 30 && b.can.getMaxIsrUs() <= 120,
+          "transaction timing within budget", detail);
+}
+
+void checkIdCodec() {
+    static const uint32_t ids[] = {0x000, 0x6A0, 0x7FF, 0x00000000UL, 0x1FFFFFFFUL, 0x18DAF110UL};
+    bool ok = true;
+    for (uint8_t i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+        bool ext = i >= 3;
+        uint8_t raw[4];
+        CanInterface::encodeId(ids[i], ext, raw);
+        bool extOut = !ext;
+        uint32_t back = CanInterface::decodeId(raw, extOut);
+        ok = ok && back == ids[i] && extOut == ext;
+    }
+    check(ok, "id encode/decode round trip");
+}
+
+// PumpCommand as the ECU would build it (bad = corrupt the checksum)
+Mcp2515Model::Frame commandFrame(uint8_t mode, uint8_t counter, float duty, float bar, bool bad = false) {
+    Mcp2515Model::Frame f;
+    f.id = Config::CAN_COMMAND_ID;
+    f.extended = false;
+    f.dlc = 8;
+    memset(f.data, 0, sizeof(f.data));
+    CanTelemetry::packSignal(f.data, CanCommand::START_CommandMode, 4, mode);
+    CanTelemetry::packSignal(f.data, CanCommand::START_CommandCounter, 4, counter & 0x0F);
+    CanTelemetry::packSignal(f.data, CanCommand::START_DutyCommand, 16,
+                             CanTelemetry::encode(duty, 0.01f, 0.0f, 16, false));
+    CanTelemetry::packSignal(f.data, CanCommand::START_PressureCommand, 16,
+                             CanTelemetry::encode(bar, 0.001f, 0.0f, 16, true));
+    f.data[7] = CanCommand::checksum(Config::CAN_COMMAND_ID, f.data) ^ (bad ? 0x01 : 0x00);
+    return f;
+}
+
+// Inject through the controller and hand every received frame to the decoder
+uint8_t deliver(Bench& b, CanCommand& cmd, const Mcp2515Model::Frame& f) {
+    b.model.injectFrame(f);
+    CanFrame rx;
+    uint8_t accepted = 0;
+    while (b.can.receive(rx)) {
+        if (cmd.onFrame(rx, millis())) accepted++;
+    }
+    return accepted;
+}
+
+void checkCommand() {
+    // CRC-8 SAE J1850 reference check value: "123456789" -> 0x4B
+    uint8_t crc = 0xFF;
+    for (const char* p = "123456789"; *p; p++) crc = CanCommand::crc8Step(crc, (uint8_t)*p);
+    check((uint8_t)(crc ^ 0xFF) == 0x4B, "CRC-8 SAE J1850 check value");
+
+    Bench b;
+    b.can.begin();
+    CanCommand cmd;
+
+    check(deliver(b, cmd, commandFrame(CanCommand::MODE_DUTY, 5, 42.5f, 0.0f)) == 1 &&
+          cmd.update(millis()) && cmd.getMode() == CanCommand::MODE_DUTY &&
+          fabs(cmd.getDuty() - 0.425f) < 1e-4f,
+          "duty command accepted (first frame, any counter)");
+    check(cmd.takeNewCommand() && !cmd.takeNewCommand(), "new-command flag is one-shot");
+
+    check(deliver(b, cmd, commandFrame(CanCommand::MODE_DUTY, 5, 50.0f, 0.0f)) == 0 &&
+          fabs(cmd.getDuty() - 0.425f) < 1e-4f && cmd.getCounterErrors() == 1,
+          "repeated counter rejected");
+    check(deliver(b, cmd, commandFrame(CanCommand::MODE_DUTY, 6, 50.0f, 0.0f, true)) == 0 &&
+          cmd.getChecksumErrors() == 1,
+          "bad checksum rejected");
+    check(deliver(b, cmd, commandFrame(CanCommand::MODE_PRESSURE, 7, 0.0f, 0.35f)) == 1 &&
+          cmd.getMode() == CanCommand::MODE_PRESSURE && fabs(cmd.getPressureBar() - 0.35f) < 1e-3f,
+          "pressure command accepted (counter +2, one frame lost)");
+    check(deliver(b, cmd, commandFrame(CanCommand::MODE_PRESSURE, 12, 0.0f, 0.5f)) == 0 &&
+          deliver(b, cmd, commandFrame(CanCommand::MODE_PRESSURE, 13, 0.0f, 0.5f)) == 1 &&
+          cmd.getCounterErrors() == 2,
+          "counter jump rejected, next consecutive frame resynchronises");
+    check(deliver(b, cmd, commandFrame(CanCommand::MODE_DUTY, 14, 100.5f, 0.0f)) == 0 &&
+          deliver(b, cmd, commandFrame(9, 15, 0.0f, 0.0f)) == 0 && cmd.getRangeErrors() == 2,
+          "duty above 100 % and unknown mode rejected");
+
+    // The timeout is a MILLIS_COMPENSATED interval: ~2x nominal in real time
+    const uint64_t timeoutUs = Config::coreTimeToReal(MILLIS_COMPENSATED(Config::CAN_COMMAND_TIMEOUT_MS) * 1000UL);
+    sim::advanceMicros(timeoutUs / 2);
+    bool stillActive = cmd.update(millis());
+    sim::advanceMicros(timeoutUs);
+    bool stale = !cmd.update(millis());
+    check(stillActive && stale && cmd.getTimeouts() == 1, "command goes stale after CAN_COMMAND_TIMEOUT_MS");
+
+    check(deliver(b, cmd, commandFrame(CanCommand::MODE_DUTY, 3, 20.0f, 0.0f)) == 1 && cmd.update(millis()),
+          "fresh frame after timeout accepted with any counter");
+    check(deliver(b, cmd, commandFrame(CanCommand::MODE_RELEASE, 4, 0.0f, 0.0f)) == 1 &&
+          !cmd.update(millis()) && cmd.getTimeouts() == 1,
+          "RELEASE hands control back without a timeout");
+
+    CanFrame other = txFrame(Config::CAN_COMMAND_ID + 1, 0);
+    check(!cmd.onFrame(other, millis()) && cmd.getChecksumErrors() == 1, "other ids in the block ignored");
+}
+
+}  // namespace
+
+ISR(PCINT2_vect) {
+    if (g_dut) g_dut->onInterrupt();
+}
+
+int main() {
+    checkIdCodec();
+    checkBitTiming();
+    checkBegin();
+    checkReceive();
+    checkRxOverflow();
+    checkTransmit();
+    checkMissedEdge();
+    checkTiming();
+    checkCommand();
+
+    printf("\n%s (%d failure%s)\n", g_failures ? "FAILED" : "OK", g_failures, g_failures == 1 ? "" : "s");
+    return g_failures ? 1 : 0;
+}
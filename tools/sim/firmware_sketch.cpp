@@ -0,0 +1,17 @@
+// -----------------------------------------------------------------------------
+// firmware_sketch.cpp - The unmodified PumpControl.ino as a host translation unit
+// -----------------------------------------------------------------------------
+// What the Arduino builder does to a sketch: Arduino.h first, prototypes for
+// the functions used before their definition, then the .ino as C++. The other
+// .cpp files of the sketch folder are compiled next to this one (see the
+// pumpcontrol_firmware library in tools/CMakeLists.txt).
+//
+// The sketch's globals (g_power, g_protection, ...) exist once per process:
+// setup() runs once, like after a reset. Harnesses that need several runs use
+// one process per run (plant_sim forks).
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+
+void printDetailedStatus();
+
+#include "PumpControl.ino"
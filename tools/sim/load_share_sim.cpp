@@ -0,0 +1,292 @@
+// -----------------------------------------------------------------------------
+// load_share_sim - Several boards running LoadShare on a virtual CAN bus
+// -----------------------------------------------------------------------------
+// Build: cmake -S tools -B build-tools && cmake --build build-tools
+// Run:   ./build-tools/load_share_sim [-v]   (exit code 0 = all checks pass)
+//
+// Each simulated board owns a LoadShare instance, ticks every
+// MAIN_LOOP_INTERVAL_MS with its own phase (boards are not synchronised) and
+// broadcasts its PumpShare frame on VirtualCanBus, exactly like stage 5b of
+// the sketch. Scenarios change one board's inputs and check the split, that
+// every board computed bit-identical allocations, and how many ticks that took.
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+#include "ArduinoSim.h"
+#include "VirtualCanBus.h"
+#include "LoadShare.h"
+#include "PowerOutputs.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <memory>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+bool g_verbose = false;
+
+void check(bool ok, const char* name, const char* detail = "") {
+    printf("%s  %s%s%s\n", ok ? "PASS" : "FAIL", name, detail[0] ? ": " : "", detail);
+    if (!ok) g_failures++;
+}
+
+// MILLIS_COMPENSATED(MAIN_LOOP_INTERVAL_MS) in real time, as the sketch ticks
+const uint64_t kTickUs = Config::coreTimeToReal(MILLIS_COMPENSATED(Config::MAIN_LOOP_INTERVAL_MS) * 1000UL);
+
+struct Board {
+    LoadShare share;
+    LoadShare::NodeState state;
+    uint8_t handle;
+    uint64_t nextTickUs;
+    bool silent;
+    float applied;
+
+    Board(uint8_t id, uint8_t count, uint64_t phase)
+        : share(id, count), handle(0), nextTickUs(phase), silent(false), applied(0.0f) {
+        state.demand = 0.6f;
+        state.capacity = 1.0f;
+        state.currentA = 20.0f;
+        state.tempC = 40.0f;
+        state.available = true;
+    }
+};
+
+class Cluster {
+public:
+    explicit Cluster(uint8_t count) {
+        sim::reset();
+        sim::setSerialEcho(false);
+        TCCR0A = 0x01;  // Same Timer 0 setup as PowerOutputs::begin():
+        TCCR0B = 0x02;  // phase-correct, prescaler 8
+        _bus.reset(new VirtualCanBus(Config::CAN_BITRATE_KBPS * 1000.0));
+        for (uint8_t n = 0; n < count; n++) {
+            // Spread phases across the tick so every board sees stale peers
+            _boards.emplace_back(new Board(n, count, (kTickUs * n) / count + 3000));
+            Board* b = _boards.back().get();
+            b->handle = _bus->attach([b](const CanFrame& f) { b->share.onFrame(f, millis()); });
+        }
+    }
+
+    Board& operator[](uint8_t n) { return *_boards[n]; }
+    uint8_t size() const { return (uint8_t)_boards.size(); }
+
+    // Advance by whole control ticks (1 ms steps)
+    void runTicks(unsigned ticks) {
+        uint64_t end = sim::nowMicros() + ticks * kTickUs;
+        while (sim::nowMicros() < end) {
+            sim::advanceMicros(1000);
+            for (auto& bp : _boards) {
+                Board& b = *bp;
+                if (sim::nowMicros() < b.nextTickUs) continue;
+                b.nextTickUs += kTickUs;
+                if (b.silent) continue;
+                b.applied = b.share.update(millis(), b.state);
+                _bus->send(b.handle, b.share.getFrame());
+            }
+        }
+    }
+
+    // Every talking board holds the same allocation vector, bit for bit
+    bool identical() const {
+        const Board* ref = nullptr;
+        for (const auto& bp : _boards) {
+            if (bp->silent) continue;
+            if (!ref) {
+                ref = bp.get();
+                continue;
+            }
+            for (uint8_t n = 0; n < LoadShare::MAX_NODES; n++) {
+                float a = ref->share.getAllocation(n);
+                float b = bp->share.getAllocation(n);
+                if (memcmp(&a, &b, sizeof(a)) != 0) return false;
+            }
+        }
+        return true;
+    }
+
+    bool converged() const {
+        for (const auto& bp : _boards) {
+            if (!bp->silent && !bp->share.isConverged()) return false;
+        }
+        return identical();
+    }
+
+    // Ticks until converged (and still converged one tick later), max limit
+    unsigned settle(unsigned limit) {
+        for (unsigned t = 1; t <= limit; t++) {
+            runTicks(1);
+            if (converged()) {
+                runTicks(1);
+                if (converged()) return t;
+            }
+        }
+        return limit + 1;
+    }
+
+    float totalApplied() const {
+        float sum = 0.0f;
+        for (const auto& bp : _boards) {
+            if (!bp->silent && bp->state.available) sum += bp->applied;
+        }
+        return sum;
+    }
+
+    void print(const char* label) const {
+        if (!g_verbose) return;
+        printf("  %-28s", label);
+        for (const auto& bp : _boards) {
+            printf("  n%u %5.1f%%", bp->share.getNodeId(), bp->applied * 100.0f);
+        }
+        printf("  total %.1f%%\n", totalApplied() * 100.0f);
+    }
+
+private:
+    std::unique_ptr<VirtualCanBus> _bus;
+    std::vector<std::unique_ptr<Board>> _boards;
+};
+
+// Every scenario must settle within this many ticks of an input change
+const unsigned kMaxSettleTicks = 3;
+
+void checkSettled(Cluster& c, const char* name, unsigned limit = kMaxSettleTicks) {
+    unsigned ticks = c.settle(10);
+    char detail[64];
+    snprintf(detail, sizeof(detail), "converged in %u tick%s", ticks, ticks == 1 ? "" : "s");
+    check(ticks <= limit, name, detail);
+    c.print(name);
+}
+
+bool near(float a, float b, float tol = 0.003f) {
+    return fabs(a - b) <= tol;
+}
+
+// ---------------------------------------------------------------------------
+
+void checkBalanced() {
+    Cluster c(3);
+    checkSettled(c, "3 boards, cool, equal demand (from power-up)");
+    check(near(c[0].applied, 0.6f) && near(c[1].applied, 0.6f) && near(c[2].applied, 0.6f),
+          "equal split at the common demand");
+    check(c.identical(), "allocations bit-identical on every board");
+}
+
+void checkHotBoard() {
+    Cluster c(3);
+    c.settle(10);
+    c[1].state.tempC = 80.0f;
+    checkSettled(c, "board 1 heatsink 80 C");
+    char detail[64];
+    snprintf(detail, sizeof(detail), "%.3f / %.3f / %.3f", c[0].applied, c[1].applied, c[2].applied);
+    check(c[1].applied < c[0].applied - 0.05f && near(c[0].applied, c[2].applied) &&
+          near(c.totalApplied(), 1.8f, 0.01f),
+          "hot board unloaded, total flow kept", detail);
+}
+
+void checkFaultedBoard() {
+    Cluster c(3);
+    for (uint8_t n = 0; n < 3; n++) c[n].state.demand = 0.8f;
+    c.settle(10);
+    c[2].state.capacity = 0.5f;  // FAULT limit
+    checkSettled(c, "board 2 current FAULT (limit 50%)");
+    char detail[64];
+    snprintf(detail, sizeof(detail), "%.3f / %.3f / %.3f", c[0].applied, c[1].applied, c[2].applied);
+    check(near(c[2].applied, 0.5f) && near(c[0].applied, 0.95f) && near(c[1].applied, 0.95f),
+          "limited board at its cap, others absorb", detail);
+}
+
+// Stage 5b -> 6 of the sketch: the board's share through the real driver,
+// which scales the target by the same limit again
+float dutyFor(const Board& b) {
+    PowerOutputs out;
+    out.setVoltageLimit(b.state.capacity);
+    out.setOutputPercent(LoadShare::toTarget(b.applied, b.state.capacity));
+    return out.getCurrentDuty();
+}
+
+void checkDeratedBoardDuty() {
+    Cluster c(3);
+    c.settle(10);
+    c[2].state.capacity = 0.7f;  // Voltage / thermal derating
+    checkSettled(c, "board 2 derated to 70%, demand 60%");
+    char detail[64];
+    snprintf(detail, sizeof(detail), "share %.3f, duty %.3f", c[2].applied, dutyFor(c[2]));
+    check(near(c[2].applied, 0.6f) && near(dutyFor(c[2]), c[2].applied),
+          "share below the limit driven as is", detail);
+
+    for (uint8_t n = 0; n < 3; n++) c[n].state.demand = 0.8f;
+    checkSettled(c, "board 2 derated to 70%, demand 80%");
+    snprintf(detail, sizeof(detail), "share %.3f, duty %.3f", c[2].applied, dutyFor(c[2]));
+    check(near(c[2].applied, 0.7f) && near(dutyFor(c[2]), 0.7f) && near(dutyFor(c[0]), 0.85f),
+          "derated board at its limit once, not limit squared", detail);
+}
+
+void checkEmergencyBoard() {
+    Cluster c(3);
+    c.settle(10);
+    c[2].state.available = false;  // EMERGENCY / external safety
+    checkSettled(c, "board 2 unavailable (EMERGENCY)");
+    check(c[2].applied == 0.0f && near(c[0].applied, 0.9f) && near(c[1].applied, 0.9f),
+          "unavailable board's flow moved to the others");
+    c[2].state.available = true;
+    checkSettled(c, "board 2 back");
+    check(near(c[0].applied, 0.6f) && near(c[2].applied, 0.6f), "equal split restored");
+}
+
+void checkSilentBoard() {
+    Cluster c(3);
+    c.settle(10);
+    c[1].silent = true;  // CAN cable off / board reset
+    // Peers only notice after LOAD_SHARE_PEER_TIMEOUT_MS without a frame
+    unsigned timeoutTicks = (unsigned)((Config::LOAD_SHARE_PEER_TIMEOUT_MS + Config::MAIN_LOOP_INTERVAL_MS - 1) /
+                                       Config::MAIN_LOOP_INTERVAL_MS);
+    c.runTicks(timeoutTicks);
+    checkSettled(c, "board 1 silent, after peer timeout");
+    check(near(c[0].applied, 0.9f) && near(c[2].applied, 0.9f), "silent board's flow redistributed");
+}
+
+void checkSaturation() {
+    Cluster c(3);
+    for (uint8_t n = 0; n < 3; n++) c[n].state.demand = 1.0f;
+    c[0].state.capacity = 0.5f;
+    checkSettled(c, "demand above total capacity");
+    check(near(c[0].applied, 0.5f) && near(c[1].applied, 1.0f) && near(c[2].applied, 1.0f),
+          "every board at its capacity");
+}
+
+void checkMixedDemand() {
+    Cluster c(3);
+    c[0].state.demand = 0.5f;
+    c[1].state.demand = 0.7f;
+    c[2].state.demand = 0.6f;
+    checkSettled(c, "different local demands");
+    check(near(c[0].applied, 0.7f) && near(c[1].applied, 0.7f) && near(c[2].applied, 0.7f),
+          "highest demand wins (no under-supply)");
+}
+
+void checkTwoBoards() {
+    Cluster c(2);
+    c[0].state.tempC = 90.0f;
+    checkSettled(c, "2 boards, board 0 at full bias");
+    // Weights 0.5 : 1.0 -> 0.4 / 0.8 of a 1.2 total
+    check(near(c[0].applied, 0.4f) && near(c[1].applied, 0.8f), "split follows the weights (1:2)");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    g_verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+
+    checkBalanced();
+    checkHotBoard();
+    checkFaultedBoard();
+    checkDeratedBoardDuty();
+    checkEmergencyBoard();
+    checkSilentBoard();
+    checkSaturation();
+    checkMixedDemand();
+    checkTwoBoards();
+
+    printf("\n%s (%d failure%s)\n", g_failures ? "FAILED" : "OK", g_failures, g_failures == 1 ? "" : "s");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,680 @@
+// -----------------------------------------------------------------------------
+// plant_sim - The unmodified sketch in closed loop with a simulated plant
+// -----------------------------------------------------------------------------
+// Build: cmake -S tools -B build-tools && cmake --build build-tools
+// Run:   ./build-tools/plant_sim [options] [name=value ...]
+//   name=value        scenario/plant parameter (--list shows all of them)
+//   --map FILE        MAP trace, CSV "seconds,kPa absolute" (default: built-in
+//                     drive cycle, engine off for 4 s then idle/cruise/boost)
+//   --log FILE        Serial output of the firmware (single run)
+//   --trace FILE      Plant and firmware state every 10 ms, CSV (single run)
+//   --echo            Serial output to stdout (single run)
+//   --sweep name=LIST parameter sweep, LIST = a,b,c or start:stop:step;
+//                     several --sweep options form the cartesian product
+//   -j N              parallel runs for a sweep (default: online CPUs)
+//   --csv FILE        sweep results (default: stdout)
+//
+// setup() and loop() of PumpControl.ino run on the Arduino shim; loop() is
+// called back to back and virtual time moves with the firmware's own waits
+// (ADC conversions, delays, SPI, pulseIn, sleep until the next Timer 0
+// overflow). PumpPlant closes the loop: pump currents from the duty on
+// D6/D5, supply sag, heatsink temperature, MAP. An MCP2515 model on the SPI
+// bus takes the CAN traffic; the external PWM generator drives D8 and the
+// engine pulse generator (engine_rpm > 0) drives D3 edge by edge (INT1).
+// usage_dump_s sends the usage dump request; --log keeps the binary dump
+// (tools/log/usagedump decodes it). The lat_* metrics are the p90 input-to-
+// output latencies of LatencyProbe.h (0 unless ENABLE_LATENCY_PROBE); with
+// pwm_step_s the D8 duty steps to pwm_step_duty.
+//
+// The sketch's globals exist once per process, so every run of a sweep is a
+// forked worker. Config.h values are compile-time constants: firmware
+// setpoints are compared by rebuilding (PUMPCONTROL_CONFIG in
+// tools/CMakeLists.txt), the sweep covers the plant and the scenario.
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+#include "ArduinoSim.h"
+#include "Mcp2515Model.h"
+#include "PumpPlant.h"
+#include "CpuIdle.h"
+#include "EngineInput.h"
+#include "LatencyProbe.h"
+#include "PowerProtection.h"
+#include "PumpSpeedEstimator.h"
+#include "SoftStart.h"
+#include "ThermalModel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// PumpControl.ino (firmware_sketch.cpp)
+void setup();
+void loop();
+extern PowerProtection g_protection;
+extern ThermalModel g_thermal;
+extern PumpSpeedEstimator g_pumpSpeed;
+extern SoftStart g_softStart;
+extern CpuIdle g_cpuIdle;
+extern EngineInput g_engine;
+extern LatencyProbe g_latency;
+extern bool g_outputForcedOff;
+
+namespace {
+
+// ----------------------------------------------------------------------------
+// Parameters
+// ----------------------------------------------------------------------------
+struct Scenario {
+    double duration_s = 60.0;
+    double supply_v = 13.8;
+    double supply_r = 0.010;
+    double pump_r1 = 0.15;
+    double pump_r2 = 0.15;
+    double load1 = 1.0;
+    double load2 = 1.0;
+    double ripple = 0.08;
+    double acs_zero_v = 2.49;
+    double ambient_c = 25.0;
+    double hs_rth = 1.2;
+    double hs_cth = 250.0;
+    double noise_v = 0.002;
+    double seed = 1;
+    double baro_kpa = 101.3;
+    double boost_scale = 1.0;
+    double pwm_hz = 0.0;
+    double pwm_duty = 0.5;
+    double pwm_start_s = 10.0;
+    double pwm_step_s = -1.0;
+    double pwm_step_duty = 0.8;
+    double safety_off_s = -1.0;
+    double safety_on_s = -1.0;
+    double stall_s = -1.0;
+    double engine_rpm = 0.0;
+    double engine_ppr = 2.0;
+    double engine_duty = 0.3;
+    double engine_start_s = 4.5;
+    double usage_dump_s = -1.0;
+};
+
+struct Param {
+    const char* name;
+    double Scenario::*field;
+    const char* help;
+};
+
+const Param kParams[] = {
+    {"duration_s", &Scenario::duration_s, "simulated time (s)"},
+    {"supply_v", &Scenario::supply_v, "source open-circuit voltage (V)"},
+    {"supply_r", &Scenario::supply_r, "source + harness resistance (Ohm)"},
+    {"pump_r1", &Scenario::pump_r1, "pump 1 winding resistance (Ohm)"},
+    {"pump_r2", &Scenario::pump_r2, "pump 2 winding resistance (Ohm)"},
+    {"load1", &Scenario::load1, "pump 1 hydraulic load (1 = nominal, >1 worn)"},
+    {"load2", &Scenario::load2, "pump 2 hydraulic load"},
+    {"ripple", &Scenario::ripple, "commutation ripple / mean current"},
+    {"acs_zero_v", &Scenario::acs_zero_v, "ACS758 output at 0 A (V)"},
+    {"ambient_c", &Scenario::ambient_c, "ambient temperature (C)"},
+    {"hs_rth", &Scenario::hs_rth, "heatsink to ambient (K/W)"},
+    {"hs_cth", &Scenario::hs_cth, "heatsink thermal mass (J/K)"},
+    {"noise_v", &Scenario::noise_v, "RMS noise on the analog inputs (V)"},
+    {"seed", &Scenario::seed, "noise seed"},
+    {"baro_kpa", &Scenario::baro_kpa, "barometric pressure (kPa)"},
+    {"boost_scale", &Scenario::boost_scale, "scales the trace around 101.3 kPa"},
+    {"pwm_hz", &Scenario::pwm_hz, "external PWM on D8 (Hz, 0 = none)"},
+    {"pwm_duty", &Scenario::pwm_duty, "external PWM duty (0..1)"},
+    {"pwm_start_s", &Scenario::pwm_start_s, "external PWM starts at (s)"},
+    {"pwm_step_s", &Scenario::pwm_step_s, "external PWM duty steps at (s, -1 = never)"},
+    {"pwm_step_duty", &Scenario::pwm_step_duty, "external PWM duty after the step (0..1)"},
+    {"safety_off_s", &Scenario::safety_off_s, "D7 pulled LOW at (s, -1 = never)"},
+    {"safety_on_s", &Scenario::safety_on_s, "D7 released at (s, -1 = never)"},
+    {"stall_s", &Scenario::stall_s, "pump 1 rotor locks at (s, -1 = never)"},
+    {"engine_rpm", &Scenario::engine_rpm, "engine pulses on D3 at this RPM (0 = none)"},
+    {"engine_ppr", &Scenario::engine_ppr, "engine pulses per revolution"},
+    {"engine_duty", &Scenario::engine_duty, "engine pulse (LOW) fraction of the period"},
+    {"engine_start_s", &Scenario::engine_start_s, "engine pulses start at (s)"},
+    {"usage_dump_s", &Scenario::usage_dump_s, "usage dump requested on Serial at (s, -1 = never)"},
+};
+
+const Param* findParam(const std::string& name) {
+    for (const Param& p : kParams) {
+        if (name == p.name) return &p;
+    }
+    return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+// Results
+// ----------------------------------------------------------------------------
+struct Result {
+    double sim_s;
+    double wall_s;
+    double speedup;
+    double imax1_a;
+    double imax2_a;
+    double energy_wh;
+    double hs_max_c;
+    double tj_est_max_c;
+    double fault_s;
+    double emergency_s;
+    double derate_s;
+    double track_rms;
+    double track_max;
+    double boost_lag_ms;
+    double rpm1;
+    double rpm1_est;
+    double eng_rpm_est;
+    double wdt_gap_ms;
+    double idle_pct;
+    double can_tx;
+    double lat_safety_ms;
+    double lat_pwm_ms;
+    double lat_map_ms;
+};
+
+struct Metric {
+    const char* name;
+    double Result::*field;
+    const char* format;
+};
+
+const Metric kMetrics[] = {
+    {"sim_s", &Result::sim_s, "%.1f"},
+    {"wall_s", &Result::wall_s, "%.2f"},
+    {"speedup", &Result::speedup, "%.0f"},
+    {"imax1_a", &Result::imax1_a, "%.1f"},
+    {"imax2_a", &Result::imax2_a, "%.1f"},
+    {"energy_wh", &Result::energy_wh, "%.2f"},
+    {"hs_max_c", &Result::hs_max_c, "%.1f"},
+    {"tj_est_max_c", &Result::tj_est_max_c, "%.1f"},
+    {"fault_s", &Result::fault_s, "%.2f"},
+    {"emergency_s", &Result::emergency_s, "%.2f"},
+    {"derate_s", &Result::derate_s, "%.2f"},
+    {"track_rms", &Result::track_rms, "%.4f"},
+    {"track_max", &Result::track_max, "%.3f"},
+    {"boost_lag_ms", &Result::boost_lag_ms, "%.0f"},
+    {"rpm1", &Result::rpm1, "%.0f"},
+    {"rpm1_est", &Result::rpm1_est, "%.0f"},
+    {"eng_rpm_est", &Result::eng_rpm_est, "%.0f"},
+    {"wdt_gap_ms", &Result::wdt_gap_ms, "%.1f"},
+    {"idle_pct", &Result::idle_pct, "%.1f"},
+    {"can_tx", &Result::can_tx, "%.0f"},
+    {"lat_safety_ms", &Result::lat_safety_ms, "%.1f"},
+    {"lat_pwm_ms", &Result::lat_pwm_ms, "%.1f"},
+    {"lat_map_ms", &Result::lat_map_ms, "%.1f"},
+};
+
+// ----------------------------------------------------------------------------
+// MAP trace
+// ----------------------------------------------------------------------------
+struct MapPoint {
+    double t;
+    double kPa;
+};
+
+std::vector<MapPoint> g_trace;
+double g_tracePeriod = 0.0;  // Built-in cycle repeats after the engine-off part
+
+// Engine off, then idle -> cruise -> boost -> lift-off, repeated every 20 s
+void builtInTrace() {
+    g_trace = {{0, 101.3}, {4, 101.3}, {4.5, 35}, {8, 35}, {10, 90}, {14, 90},
+               {16, 200}, {20, 200}, {20.5, 30}, {24, 30}};
+    g_tracePeriod = 20.0;
+}
+
+bool loadTrace(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    g_trace.clear();
+    g_tracePeriod = 0.0;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        double t, kPa;
+        if (line[0] == '#' || sscanf(line, "%lf,%lf", &t, &kPa) != 2) continue;
+        g_trace.push_back({t, kPa});
+    }
+    fclose(f);
+    return !g_trace.empty();
+}
+
+double traceKpa(double t) {
+    if (g_tracePeriod > 0.0 && t > g_trace.back().t) {
+        double first = g_trace.back().t - g_tracePeriod;
+        t = first + fmod(t - first, g_tracePeriod);
+    }
+    if (t <= g_trace.front().t) return g_trace.front().kPa;
+    for (size_t i = 1; i < g_trace.size(); i++) {
+        if (t <= g_trace[i].t) {
+            const MapPoint& a = g_trace[i - 1];
+            const MapPoint& b = g_trace[i];
+            return a.kPa + (b.kPa - a.kPa) * (t - a.t) / (b.t - a.t);
+        }
+    }
+    return g_trace.back().kPa;
+}
+
+// Duty the MAP curve asks for at the true pressure (pressureToTargetPercent)
+double idealDuty(double gaugeBar, double supplyV) {
+    double pct;
+    if (gaugeBar <= Config::MAP_BAR_LOW_SETPOINT) {
+        pct = Config::OUTPUT_PERCENT_MIN;
+    } else if (gaugeBar >= Config::MAP_BAR_HIGH_SETPOINT) {
+        pct = Config::OUTPUT_PERCENT_MAX;
+    } else {
+        pct = Config::OUTPUT_PERCENT_MIN + (gaugeBar - Config::MAP_BAR_LOW_SETPOINT) /
+              (Config::MAP_BAR_HIGH_SETPOINT - Config::MAP_BAR_LOW_SETPOINT) *
+              (Config::OUTPUT_PERCENT_MAX - Config::OUTPUT_PERCENT_MIN);
+    }
+    if (Config::ENABLE_CONSTANT_VOLTAGE_MODE) pct = pct * Config::CV_REFERENCE_VOLTAGE / supplyV;
+    return pct > 1.0 ? 1.0 : pct;
+}
+
+// ----------------------------------------------------------------------------
+// Bench: scenario events and measurements, ticked with the plant
+// ----------------------------------------------------------------------------
+class Bench : public sim::Peripheral {
+public:
+    Bench(const Scenario& sc, PumpPlant& plant, FILE* trace)
+        : _sc(sc), _plant(plant), _trace(trace) {
+        memset(&_r, 0, sizeof(_r));
+        if (_trace) fprintf(_trace, "t_s,map_kpa,duty1,duty2,i1_a,i2_a,supply_v,heatsink_c,rpm1,level\n");
+    }
+
+    // Tracking error counts from the first loop() pass on
+    void startTracking(uint64_t nowUs) { _trackFromUs = nowUs; }
+
+    void tick(uint64_t nowUs) override {
+        double t = nowUs * 1e-6;
+        double dt = (nowUs - _lastUs) * 1e-6;
+        _lastUs = nowUs;
+
+        _plant.setMapKpa((float)(_sc.baro_kpa + _sc.boost_scale * (traceKpa(t) - 101.3)));
+        event(t, _sc.pwm_start_s, _pwmOn, [this] {
+            sim::setPulseInput(Config::PIN_PWM_INPUT, (float)_sc.pwm_hz, (float)_sc.pwm_duty);
+        }, _sc.pwm_hz > 0.0);
+        event(t, _sc.pwm_step_s, _pwmStepped, [this] {
+            sim::setPulseInput(Config::PIN_PWM_INPUT, (float)_sc.pwm_hz, (float)_sc.pwm_step_duty);
+        }, _sc.pwm_hz > 0.0 && _pwmOn);
+        event(t, _sc.safety_off_s, _safetyOff, [] { sim::setDigitalInput(Config::PIN_DIG_IN_1, LOW); });
+        event(t, _sc.safety_on_s, _safetyOn, [] { sim::setDigitalInput(Config::PIN_DIG_IN_1, HIGH); });
+        event(t, _sc.stall_s, _stalled, [this] { _plant.setStalled(0, true); });
+        event(t, _sc.usage_dump_s, _usageDumped, [] {
+            sim::pushSerialInput(std::string(1, Config::USAGE_DUMP_COMMAND));
+        });
+        engineEdges(nowUs);
+
+        _r.imax1_a = fmax(_r.imax1_a, _plant.getCurrentA(0));
+        _r.imax2_a = fmax(_r.imax2_a, _plant.getCurrentA(1));
+        _r.hs_max_c = fmax(_r.hs_max_c, _plant.getHeatsinkC());
+        _r.tj_est_max_c = fmax(_r.tj_est_max_c, fmax(g_thermal.getMosfetTempC(0), g_thermal.getMosfetTempC(1)));
+
+        PowerProtection::ProtectionLevel level = g_protection.getLevel();
+        if (level == PowerProtection::ProtectionLevel::FAULT) _r.fault_s += dt;
+        if (level == PowerProtection::ProtectionLevel::EMERGENCY) _r.emergency_s += dt;
+        if (g_thermal.isDerating()) _r.derate_s += dt;
+
+        // Control lag against the MAP curve while nothing else limits the output
+        bool mapControl = _trackFromUs && nowUs >= _trackFromUs && !_pwmOn && !g_outputForcedOff &&
+                          !g_softStart.isActive() && level == PowerProtection::ProtectionLevel::NORMAL &&
+                          !g_thermal.isDerating();
+        if (mapControl) {
+            double gauge = (_plant.getMapKpa() - _sc.baro_kpa) / 100.0;
+            double err = fabs(_plant.getDuty(0) - idealDuty(gauge, _plant.getSupplyV()));
+            _errSq += err * err * dt;
+            _errTime += dt;
+            _r.track_max = fmax(_r.track_max, err);
+
+            // Boost response: true MAP reaches the top of the curve -> duty
+            // within 5% of full output (longest of the run)
+            double full = idealDuty(Config::MAP_BAR_HIGH_SETPOINT, _plant.getSupplyV());
+            bool atTop = gauge >= Config::MAP_BAR_HIGH_SETPOINT;
+            if (atTop && !_wasAtTop) _boostFromUs = nowUs;
+            if (_boostFromUs && _plant.getDuty(0) >= 0.95 * full) {
+                _r.boost_lag_ms = fmax(_r.boost_lag_ms, (nowUs - _boostFromUs) / 1000.0);
+                _boostFromUs = 0;
+            }
+            _wasAtTop = atTop;
+        } else {
+            _boostFromUs = 0;
+            _wasAtTop = (_plant.getMapKpa() - _sc.baro_kpa) / 100.0 >= Config::MAP_BAR_HIGH_SETPOINT;
+        }
+
+        if (_trace && nowUs >= _nextTraceUs) {
+            _nextTraceUs = nowUs + 10000;
+            fprintf(_trace, "%.3f,%.1f,%.3f,%.3f,%.2f,%.2f,%.2f,%.1f,%.0f,%u\n", t, _plant.getMapKpa(),
+                    _plant.getDuty(0), _plant.getDuty(1), _plant.getCurrentA(0), _plant.getCurrentA(1),
+                    _plant.getSupplyV(), _plant.getHeatsinkC(), _plant.getRpm(0), (unsigned)level);
+        }
+    }
+
+    Result finish() {
+        _r.track_rms = _errTime > 0.0 ? sqrt(_errSq / _errTime) : 0.0;
+        _r.energy_wh = _plant.getEnergyWh();
+        _r.rpm1 = _plant.getRpm(0);
+        _r.rpm1_est = g_pumpSpeed.getRpm(0);
+        _r.eng_rpm_est = g_engine.getRpm();
+        _r.lat_safety_ms = g_latency.getPercentileUs(LatencyProbe::PATH_SAFETY, 0.9f) / 1000.0;
+        _r.lat_pwm_ms = g_latency.getPercentileUs(LatencyProbe::PATH_PWM, 0.9f) / 1000.0;
+        _r.lat_map_ms = g_latency.getPercentileUs(LatencyProbe::PATH_MAP, 0.9f) / 1000.0;
+        return _r;
+    }
+
+private:
+    const Scenario& _sc;
+    PumpPlant& _plant;
+    FILE* _trace;
+    Result _r;
+    uint64_t _lastUs = 0;
+    uint64_t _trackFromUs = 0;
+    uint64_t _nextTraceUs = 0;
+    double _errSq = 0.0;
+    double _errTime = 0.0;
+    uint64_t _boostFromUs = 0;  // True MAP reached MAP_BAR_HIGH_SETPOINT
+    bool _wasAtTop = false;
+    bool _pwmOn = false;
+    bool _pwmStepped = false;
+    bool _safetyOff = false;
+    bool _safetyOn = false;
+    bool _stalled = false;
+    bool _usageDumped = false;
+    uint64_t _engineEdgeUs = 0;  // Next edge on D3
+    bool _engineLow = false;
+
+    // Active-LOW pulses on D3 (tach/injector), edges at the tick resolution
+    void engineEdges(uint64_t nowUs) {
+        if (_sc.engine_rpm <= 0.0 || nowUs < (uint64_t)(_sc.engine_start_s * 1e6)) return;
+        if (_engineEdgeUs == 0) _engineEdgeUs = nowUs;
+        double periodUs = 60e6 / (_sc.engine_rpm * _sc.engine_ppr);
+        while (nowUs >= _engineEdgeUs) {
+            _engineLow = !_engineLow;
+            sim::setDigitalInput(Config::PIN_ENGINE_INPUT, _engineLow ? LOW : HIGH);
+            _engineEdgeUs += (uint64_t)(periodUs * (_engineLow ? _sc.engine_duty : 1.0 - _sc.engine_duty));
+        }
+    }
+
+    template <typename Fn>
+    static void event(double t, double at, bool& done, Fn fn, bool enabled = true) {
+        if (done || !enabled || at < 0.0 || t < at) return;
+        done = true;
+        fn();
+    }
+};
+
+double wallSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// One run from power-on; only once per process (see firmware_sketch.cpp)
+Result runScenario(const Scenario& sc, FILE* log, FILE* trace, bool echo) {
+    double wallStart = wallSeconds();
+    sim::reset();
+    sim::setSerialEcho(echo);
+
+    PumpPlant::Params pp;
+    pp.supplyV = (float)sc.supply_v;
+    pp.supplyR = (float)sc.supply_r;
+    pp.pumpR[0] = (float)sc.pump_r1;
+    pp.pumpR[1] = (float)sc.pump_r2;
+    pp.pumpLoad[0] = (float)sc.load1;
+    pp.pumpLoad[1] = (float)sc.load2;
+    pp.rippleFraction = (float)sc.ripple;
+    pp.acsZeroV = (float)sc.acs_zero_v;
+    pp.ambientC = (float)sc.ambient_c;
+    pp.heatsinkRth = (float)sc.hs_rth;
+    pp.heatsinkCth = (float)sc.hs_cth;
+    pp.adcNoiseV = (float)sc.noise_v;
+    pp.seed = (uint32_t)sc.seed;
+
+    Mcp2515Model can(Config::PIN_CAN_INT, Config::CAN_CRYSTAL_MHZ * 1e6);
+    can.attach(Config::PIN_CAN_CS);
+    PumpPlant plant(pp);
+    plant.setMapKpa((float)(sc.baro_kpa + sc.boost_scale * (traceKpa(0.0) - 101.3)));
+    plant.attach();
+    Bench bench(sc, plant, trace);
+    sim::addPeripheral(&bench);
+
+    uint64_t endUs = (uint64_t)(sc.duration_s * 1e6);
+    double canTx = 0.0;
+    auto drain = [&] {
+        const std::string& out = sim::serialOutput();
+        if (log && !out.empty()) fwrite(out.data(), 1, out.size(), log);
+        sim::clearSerialOutput();
+        canTx += can.transmitted().size();
+        can.clearTransmitted();
+    };
+
+    setup();
+    drain();
+    bench.startTracking(sim::nowMicros());
+    while (sim::nowMicros() < endUs) {
+        loop();
+        drain();
+    }
+
+    Result r = bench.finish();
+    r.sim_s = sim::nowMicros() * 1e-6;
+    r.wall_s = wallSeconds() - wallStart;
+    r.speedup = r.wall_s > 0.0 ? r.sim_s / r.wall_s : 0.0;
+    r.wdt_gap_ms = sim::watchdogMaxGapMicros() / 1000.0;
+    r.idle_pct = g_cpuIdle.getIdlePercent();
+    r.can_tx = canTx;
+    return r;
+}
+
+// ----------------------------------------------------------------------------
+// Sweeps
+// ----------------------------------------------------------------------------
+struct Sweep {
+    const Param* param;
+    std::vector<double> values;
+};
+
+bool parseList(const std::string& list, std::vector<double>& out) {
+    double a, b, step;
+    if (sscanf(list.c_str(), "%lf:%lf:%lf", &a, &b, &step) == 3) {
+        if (step <= 0.0 || b < a) return false;
+        for (double v = a; v <= b + step * 1e-9; v += step) out.push_back(v);
+        return true;
+    }
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t comma = list.find(',', pos);
+        std::string item = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        char* end = nullptr;
+        double v = strtod(item.c_str(), &end);
+        if (item.empty() || *end) return false;
+        out.push_back(v);
+        if (comma == std::string::npos) break;
+        pos = comma + 1;
+    }
+    return !out.empty();
+}
+
+int runSweep(const Scenario& base, const std::vector<Sweep>& sweeps, int jobs, FILE* csv) {
+    size_t total = 1;
+    for (const Sweep& s : sweeps) total *= s.values.size();
+
+    std::vector<Scenario> points(total, base);
+    for (size_t i = 0; i < total; i++) {
+        size_t rest = i;
+        for (size_t k = sweeps.size(); k-- > 0;) {
+            const Sweep& s = sweeps[k];
+            points[i].*(s.param->field) = s.values[rest % s.values.size()];
+            rest /= s.values.size();
+        }
+    }
+
+    std::vector<Result> results(total);
+    std::vector<bool> ok(total, false);
+    std::map<pid_t, std::pair<size_t, int>> running;  // pid -> point, pipe
+    size_t next = 0, done = 0;
+    fflush(nullptr);
+    while (done < total) {
+        while (next < total && (int)running.size() < jobs) {
+            int fd[2];
+            if (pipe(fd) != 0) {
+                perror("plant_sim: pipe");
+                return 1;
+            }
+            pid_t pid = fork();
+            if (pid == 0) {
+                close(fd[0]);
+                Result r = runScenario(points[next], nullptr, nullptr, false);
+                ssize_t n = write(fd[1], &r, sizeof(r));
+                _exit(n == (ssize_t)sizeof(r) ? 0 : 1);
+            }
+            close(fd[1]);
+            if (pid < 0) {
+                perror("plant_sim: fork");
+                return 1;
+            }
+            running[pid] = std::make_pair(next++, fd[0]);
+        }
+        int status = 0;
+        pid_t pid = wait(&status);
+        if (pid < 0) break;
+        auto it = running.find(pid);
+        if (it == running.end()) continue;
+        size_t index = it->second.first;
+        int fd = it->second.second;
+        ok[index] = WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+                    read(fd, &results[index], sizeof(Result)) == (ssize_t)sizeof(Result);
+        close(fd);
+        running.erase(it);
+        done++;
+        fprintf(stderr, "\r[%zu/%zu]", done, total);
+    }
+    fprintf(stderr, "\n");
+
+    for (const Sweep& s : sweeps) fprintf(csv, "%s,", s.param->name);
+    for (size_t m = 0; m < sizeof(kMetrics) / sizeof(kMetrics[0]); m++) {
+        fprintf(csv, m ? ",%s" : "%s", kMetrics[m].name);
+    }
+    fprintf(csv, "\n");
+    int failures = 0;
+    for (size_t i = 0; i < total; i++) {
+        for (const Sweep& s : sweeps) fprintf(csv, "%g,", points[i].*(s.param->field));
+        if (!ok[i]) {
+            fprintf(csv, "failed\n");
+            failures++;
+            continue;
+        }
+        for (size_t m = 0; m < sizeof(kMetrics) / sizeof(kMetrics[0]); m++) {
+            if (m) fputc(',', csv);
+            fprintf(csv, kMetrics[m].format, results[i].*(kMetrics[m].field));
+        }
+        fprintf(csv, "\n");
+    }
+    return failures ? 1 : 0;
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: plant_sim [--map FILE] [--log FILE] [--trace FILE] [--echo]\n"
+            "                 [--sweep name=a,b,c|start:stop:step ...] [-j N] [--csv FILE]\n"
+            "                 [--list] [name=value ...]\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Scenario sc;
+    std::vector<Sweep> sweeps;
+    const char* mapPath = nullptr;
+    const char* logPath = nullptr;
+    const char* tracePath = nullptr;
+    const char* csvPath = nullptr;
+    bool echo = false;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int jobs = cpus > 0 ? (int)cpus : 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--list") {
+            Scenario defaults;
+            for (const Param& p : kParams) printf("  %-13s %-8g %s\n", p.name, defaults.*(p.field), p.help);
+            return 0;
+        } else if (arg == "--echo") {
+            echo = true;
+        } else if (arg == "--map" && hasValue) {
+            mapPath = argv[++i];
+        } else if (arg == "--log" && hasValue) {
+            logPath = argv[++i];
+        } else if (arg == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            csvPath = argv[++i];
+        } else if (arg == "-j" && hasValue) {
+            jobs = atoi(argv[++i]);
+            if (jobs < 1) jobs = 1;
+        } else if (arg == "--sweep" && hasValue) {
+            std::string spec = argv[++i];
+            size_t eq = spec.find('=');
+            Sweep s;
+            s.param = eq == std::string::npos ? nullptr : findParam(spec.substr(0, eq));
+            if (!s.param || !parseList(spec.substr(eq + 1), s.values)) {
+                fprintf(stderr, "plant_sim: bad sweep '%s'\n", spec.c_str());
+                return 2;
+            }
+            sweeps.push_back(s);
+        } else if (arg.find('=') != std::string::npos && arg[0] != '-') {
+            size_t eq = arg.find('=');
+            const Param* p = findParam(arg.substr(0, eq));
+            char* end = nullptr;
+            double v = strtod(arg.c_str() + eq + 1, &end);
+            if (!p || end == arg.c_str() + eq + 1 || *end) {
+                fprintf(stderr, "plant_sim: bad parameter '%s' (--list)\n", arg.c_str());
+                return 2;
+            }
+            sc.*(p->field) = v;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (mapPath) {
+        if (!loadTrace(mapPath)) {
+            fprintf(stderr, "plant_sim: cannot read MAP trace %s\n", mapPath);
+            return 2;
+        }
+    } else {
+        builtInTrace();
+    }
+
+    if (!sweeps.empty()) {
+        FILE* csv = csvPath ? fopen(csvPath, "w") : stdout;
+        if (!csv) {
+            fprintf(stderr, "plant_sim: cannot write %s\n", csvPath);
+            return 2;
+        }
+        int rc = runSweep(sc, sweeps, jobs, csv);
+        if (csv != stdout) fclose(csv);
+        return rc;
+    }
+
+    FILE* log = logPath ? fopen(logPath, "w") : nullptr;
+    FILE* trace = tracePath ? fopen(tracePath, "w") : nullptr;
+    if ((logPath && !log) || (tracePath && !trace)) {
+        fprintf(stderr, "plant_sim: cannot write %s\n", log ? tracePath : logPath);
+        return 2;
+    }
+    Result r = runScenario(sc, log, trace, echo);
+    if (log) fclose(log);
+    if (trace) fclose(trace);
+
+    for (const Metric& m : kMetrics) {
+        printf("  %-13s ", m.name);
+        printf(m.format, r.*(m.field));
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// Arduino.h - Host (Linux) shim of the Arduino AVR core for the PumpControl sketch
+// -----------------------------------------------------------------------------
+// Only what the firmware uses. Behaviour that the firmware depends on is kept:
+//   - millis()/micros()/delay() are wiring.c's, on the modelled Timer 0
+//     overflows and TCNT0 (mode and prescaler from TCCR0A/TCCR0B): 1024 us per
+//     overflow, so 4x fast with the phase-correct /8 PWM setup, and micros()
+//     steps backwards while TCNT0 counts down, exactly like on the Nano
+//   - SREG bit 7 is the global interrupt flag; pin-change ISRs are dispatched
+//     only while it is set
+//   - analogRead() returns 10-bit counts of the simulated pin voltage
+// Time, pins and peripherals are driven from tools/sim/ArduinoSim.h.
+// -----------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+// Nano analog pins
+enum { A0 = 14, A1, A2, A3, A4, A5, A6, A7 };
+
+// pins_arduino.h (standard variant)
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p)  ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+#define digitalPinToPCICR(p)      (((p) >= 0 && (p) <= 21) ? (&PCICR) : ((uint8_t*)0))
+#define digitalPinToPCICRbit(p)   (((p) <= 7) ? 2 : (((p) <= 13) ? 0 : 1))
+#define digitalPinToPCMSK(p)      (((p) <= 7) ? (&PCMSK2) : (((p) <= 13) ? (&PCMSK0) : (((p) <= 21) ? (&PCMSK1) : ((uint8_t*)0))))
+#define digitalPinToPCMSKbit(p)   (((p) <= 7) ? (p) : (((p) <= 13) ? ((p) - 8) : ((p) - 14)))
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    size_t write(const uint8_t* buf, size_t n);
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+    size_t print(const __FlashStringHelper* s);
+    size_t print(const char* s);
+    size_t print(char c);
+    size_t print(unsigned char n, int base = DEC);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println();
+    template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+    template <typename T> size_t println(T v, int f) { size_t n = print(v, f); return n + println(); }
+
+private:
+    size_t printNumber(unsigned long n, uint8_t base);
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long) {}
+    void end() {}
+    operator bool() { return true; }
+    int available();
+    int read();
+    int peek();
+    void flush() {}
+    int availableForWrite() { return 63; }
+    size_t write(uint8_t c) override;
+    using Print::write;
+};
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+int  analogRead(uint8_t pin);
+void analogReference(uint8_t mode);
+void analogWrite(uint8_t pin, int value);
+int  digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+void pinMode(uint8_t pin, uint8_t mode);
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout = 1000000UL);
+
+void attachInterrupt(uint8_t num, void (*fn)(void), int mode);
+void detachInterrupt(uint8_t num);
+
+void noInterrupts();
+void interrupts();
+
+// Functions rather than the core's macros so host STL headers still compile
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define _BV(b) (1 << (b))
+#define bitRead(v, b) (((v) >> (b)) & 0x01)
+#define bitSet(v, b) ((v) |= (1UL << (b)))
+#define bitClear(v, b) ((v) &= ~(1UL << (b)))
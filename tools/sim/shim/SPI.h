@@ -0,0 +1,40 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// SPI.h - Host shim of the Arduino SPI library
+// -----------------------------------------------------------------------------
+// transfer() is routed to the sim::SpiDevice attached to whichever chip-select
+// pin is currently driven LOW. Each byte advances virtual time by the bus
+// time at the transaction clock plus a fixed per-byte software overhead, so
+// the driver's transaction timing statistics stay meaningful on the host.
+// usingInterrupt(255) masks interrupts for the transaction, as on AVR.
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+class SPISettings {
+public:
+    SPISettings() : clock(4000000UL) {}
+    SPISettings(uint32_t clk, uint8_t, uint8_t) : clock(clk) {}
+    uint32_t clock;
+};
+
+class SPIClass {
+public:
+    void begin();
+    void end() {}
+    void usingInterrupt(uint8_t num);
+    void beginTransaction(SPISettings settings);
+    void endTransaction();
+    uint8_t transfer(uint8_t data);
+
+private:
+    bool _maskInterrupts = false;
+    uint8_t _savedSreg = 0;
+    uint32_t _clock = 4000000UL;
+};
+
+extern SPIClass SPI;
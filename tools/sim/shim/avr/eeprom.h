@@ -0,0 +1,32 @@
+#pragma once
+// avr/eeprom.h - 1 KB EEPROM (ATmega328P) as a host array, erased (0xFF) at start
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define E2END 0x3FF
+
+inline uint8_t* sim_eeprom() {
+    static uint8_t mem[E2END + 1];
+    static bool erased = false;
+    if (!erased) {
+        memset(mem, 0xFF, sizeof(mem));
+        erased = true;
+    }
+    return mem;
+}
+
+// Writes complete at once: the EEPROM is always ready
+inline bool eeprom_is_ready() { return true; }
+
+inline uint8_t eeprom_read_byte(const uint8_t* addr) { return sim_eeprom()[(uintptr_t)addr & E2END]; }
+inline void eeprom_write_byte(uint8_t* addr, uint8_t value) { sim_eeprom()[(uintptr_t)addr & E2END] = value; }
+inline void eeprom_update_byte(uint8_t* addr, uint8_t value) { eeprom_write_byte(addr, value); }
+
+inline void eeprom_read_block(void* dst, const void* src, size_t n) {
+    for (size_t i = 0; i < n; i++) ((uint8_t*)dst)[i] = eeprom_read_byte((const uint8_t*)src + i);
+}
+inline void eeprom_update_block(const void* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) eeprom_update_byte((uint8_t*)dst + i, ((const uint8_t*)src)[i]);
+}
+inline void eeprom_write_block(const void* src, void* dst, size_t n) { eeprom_update_block(src, dst, n); }
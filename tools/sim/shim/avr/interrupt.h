@@ -0,0 +1,9 @@
+#pragma once
+// avr/interrupt.h - vectors are plain extern "C" functions; ArduinoSim.cpp
+// declares them weak and dispatches them when the simulated flag is raised
+#include <avr/io.h>
+
+#define ISR(vector) extern "C" void vector(void)
+
+#define sei() (SREG |= 0x80)
+#define cli() (SREG &= (uint8_t)~0x80)
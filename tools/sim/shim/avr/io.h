@@ -0,0 +1,189 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// avr/io.h - ATmega328P registers as plain host variables (see ArduinoSim.cpp)
+// -----------------------------------------------------------------------------
+#include <stdint.h>
+
+#define SIM_REG8(name) extern volatile uint8_t name;
+SIM_REG8(TCCR0A) SIM_REG8(TCCR0B) SIM_REG8(TCNT0) SIM_REG8(OCR0A) SIM_REG8(OCR0B)
+SIM_REG8(TIMSK0) SIM_REG8(TIFR0)
+SIM_REG8(TCCR1A) SIM_REG8(TCCR1B) SIM_REG8(TCCR1C) SIM_REG8(TIMSK1)
+SIM_REG8(TCCR2A) SIM_REG8(TCCR2B) SIM_REG8(TCNT2) SIM_REG8(OCR2A) SIM_REG8(OCR2B)
+SIM_REG8(TIMSK2) SIM_REG8(TIFR2)
+SIM_REG8(ADCSRB) SIM_REG8(ADMUX) SIM_REG8(ADCL) SIM_REG8(ADCH) SIM_REG8(DIDR0)
+SIM_REG8(PORTB) SIM_REG8(PORTC) SIM_REG8(PORTD) SIM_REG8(PINB) SIM_REG8(PINC) SIM_REG8(PIND)
+SIM_REG8(DDRB) SIM_REG8(DDRC) SIM_REG8(DDRD)
+SIM_REG8(MCUSR) SIM_REG8(WDTCSR) SIM_REG8(SMCR) SIM_REG8(SREG) SIM_REG8(PRR)
+SIM_REG8(EICRA) SIM_REG8(EIMSK) SIM_REG8(EIFR)
+SIM_REG8(PCICR) SIM_REG8(PCIFR) SIM_REG8(PCMSK0) SIM_REG8(PCMSK1) SIM_REG8(PCMSK2)
+SIM_REG8(SPCR) SIM_REG8(SPSR) SIM_REG8(SPDR)
+SIM_REG8(EECR) SIM_REG8(EEDR) SIM_REG8(EEARL) SIM_REG8(EEARH)
+#undef SIM_REG8
+extern volatile uint16_t ADC;
+
+// ADCSRA goes through the ADC model in ArduinoSim.cpp: ADSC and ADIF follow
+// the conversion in virtual time, ADIF is cleared by writing a one, ADATE
+// re-triggers free running or on Timer 0 overflow (ADCSRB ADTS = 0 / 100)
+class SimAdcsra {
+public:
+    operator uint8_t() const;
+    SimAdcsra& operator=(uint8_t value);
+    SimAdcsra& operator|=(uint8_t bits) { return *this = (uint8_t)(*this | bits); }
+    SimAdcsra& operator&=(uint8_t bits) { return *this = (uint8_t)(*this & bits); }
+};
+extern SimAdcsra ADCSRA;
+
+// TCNT1 follows virtual time at the TCCR1B clock select (normal mode only:
+// counts up, wraps at 0xFFFF and raises TOV1 in TIFR1); a write sets the count.
+// TIFR1: TOV1 only, cleared by writing a one (or by running TIMER1_OVF_vect)
+class SimTcnt1 {
+public:
+    operator uint16_t() const;
+    SimTcnt1& operator=(uint16_t value);
+};
+extern SimTcnt1 TCNT1;
+class SimTifr1 {
+public:
+    operator uint8_t() const;
+    SimTifr1& operator=(uint8_t value);
+};
+extern SimTifr1 TIFR1;
+extern volatile uint16_t ICR1;
+extern volatile uint16_t OCR1A;
+extern volatile uint16_t OCR1B;
+extern volatile uint16_t EEAR;
+
+// TCCR0A/B, TCCR1B, TIMSK, TIFR
+#define WGM00 0
+#define WGM01 1
+#define COM0B0 4
+#define COM0B1 5
+#define COM0A0 6
+#define COM0A1 7
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define TOIE0 0
+#define TOV0 0
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define WGM13 4
+#define ICES1 6
+#define ICNC1 7
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define ICIE1 5
+#define TOV1 0
+#define OCF1A 1
+#define OCF1B 2
+#define ICF1 5
+#define COM2B1 5
+#define COM2B0 4
+#define OCIE2B 2
+#define TOIE2 0
+
+// ADC
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define REFS1 7
+#define REFS0 6
+#define ADLAR 5
+#define MUX3 3
+#define MUX2 2
+#define MUX1 1
+#define MUX0 0
+#define ADTS2 2
+#define ADTS1 1
+#define ADTS0 0
+
+// MCUSR / WDTCSR
+#define WDRF 3
+#define BORF 2
+#define EXTRF 1
+#define PORF 0
+#define WDIF 7
+#define WDIE 6
+#define WDP3 5
+#define WDCE 4
+#define WDE 3
+#define WDP2 2
+#define WDP1 1
+#define WDP0 0
+
+// SMCR
+#define SM2 3
+#define SM1 2
+#define SM0 1
+#define SE 0
+
+// External / pin-change interrupts
+#define ISC00 0
+#define ISC01 1
+#define ISC10 2
+#define ISC11 3
+#define INT0 0
+#define INT1 1
+#define INTF0 0
+#define INTF1 1
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCIF0 0
+#define PCIF1 1
+#define PCIF2 2
+#define PCINT20 4
+#define PCINT23 7
+
+// SPI
+#define SPIE 7
+#define SPE 6
+#define DORD 5
+#define MSTR 4
+#define CPOL 3
+#define CPHA 2
+#define SPR1 1
+#define SPR0 0
+#define SPIF 7
+#define WCOL 6
+#define SPI2X 0
+
+// EEPROM
+#define EERE 0
+#define EEPE 1
+#define EEMPE 2
+#define EERIE 3
+
+// Port bits
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+#define RAMSTART 0x100
+#define RAMEND 0x8FF
+#define E2END 0x3FF
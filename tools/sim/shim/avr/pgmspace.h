@@ -0,0 +1,14 @@
+#pragma once
+// avr/pgmspace.h - flash and RAM are the same address space on the host
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p)  (*(const uint8_t*)(p))
+#define pgm_read_word(p)  (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define pgm_read_float(p) (*(const float*)(p))
+#define pgm_read_ptr(p)   (*(void* const*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
@@ -0,0 +1,25 @@
+#pragma once
+// avr/sleep.h - SMCR bits as on the AVR; sleep_cpu() advances virtual time to
+// the next Timer 0 overflow, the interrupt that ends SLEEP_MODE_IDLE at the
+// latest on the Nano (ArduinoSim.cpp)
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE         0
+#define SLEEP_MODE_ADC          (1 << SM0)
+#define SLEEP_MODE_PWR_DOWN     (1 << SM1)
+#define SLEEP_MODE_PWR_SAVE     ((1 << SM0) | (1 << SM1))
+#define SLEEP_MODE_STANDBY      ((1 << SM1) | (1 << SM2))
+#define SLEEP_MODE_EXT_STANDBY  ((1 << SM0) | (1 << SM1) | (1 << SM2))
+
+#define set_sleep_mode(mode) (SMCR = (uint8_t)((SMCR & ~((1 << SM0) | (1 << SM1) | (1 << SM2))) | (mode)))
+#define sleep_enable()  (SMCR |= (uint8_t)(1 << SE))
+#define sleep_disable() (SMCR &= (uint8_t)~(1 << SE))
+
+void sleep_cpu();
+
+#define sleep_mode()     \
+    do {                 \
+        sleep_enable();  \
+        sleep_cpu();     \
+        sleep_disable(); \
+    } while (0)
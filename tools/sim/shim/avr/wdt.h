@@ -0,0 +1,22 @@
+#pragma once
+// avr/wdt.h - watchdog control only updates WDTCSR; the simulator never
+// fires a watchdog reset. wdt_reset() records the longest gap between feeds
+// while WDE is set (sim::watchdogMaxGapMicros()).
+#include <avr/io.h>
+
+#define WDTO_15MS   0
+#define WDTO_30MS   1
+#define WDTO_60MS   2
+#define WDTO_120MS  3
+#define WDTO_250MS  4
+#define WDTO_500MS  5
+#define WDTO_1S     6
+#define WDTO_2S     7
+#define WDTO_4S     8
+#define WDTO_8S     9
+
+inline void wdt_enable(uint8_t timeout) {
+    WDTCSR = (uint8_t)((1 << WDE) | ((timeout & 0x08) ? (1 << WDP3) : 0) | (timeout & 0x07));
+}
+inline void wdt_disable() { WDTCSR = 0; }
+void wdt_reset();
@@ -0,0 +1,19 @@
+#pragma once
+// util/crc16.h - same algorithms as avr-libc (C equivalents from its docs)
+#include <stdint.h>
+
+// CRC-16/ARC: poly 0xA001 (reflected 0x8005)
+inline uint16_t _crc16_update(uint16_t crc, uint8_t a) {
+    crc ^= a;
+    for (uint8_t i = 0; i < 8; ++i) {
+        crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+    }
+    return crc;
+}
+
+// CRC-CCITT (reflected): poly 0x8408
+inline uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data) {
+    data ^= (uint8_t)(crc & 0xFF);
+    data ^= (uint8_t)(data << 4);
+    return (uint16_t)((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
@@ -0,0 +1,582 @@
+// -----------------------------------------------------------------------------
+// trace_replay - Recorded sensor traces through the unmodified sketch
+// -----------------------------------------------------------------------------
+// Build: cmake -S tools -B build-tools && cmake --build build-tools
+// Run:   ./build-tools/trace_replay [options] <trace.csv | trace.bin>
+//   --out FILE        timeline (default: stdout unless --golden is given)
+//   --golden FILE     compare the timeline with FILE, exit 1 on a difference
+//   --log FILE        Serial output of the firmware
+//   --to-binary FILE  convert the trace to the binary format and exit
+//
+// Trace, CSV: a header line naming the columns, then one row per sample.
+// Values hold until the next row, so rows are only needed where something
+// changes (an edge on D8, a new ADC reading). Columns, any order:
+//   t_us or t_s       time from the first row (non-decreasing)
+//   a1 .. a5          raw ADC counts 0..1023: NTC, current 1, current 2,
+//                     MAP, supply divider (Config.h pins)
+//   d7, d8            external safety (active low), external PWM input
+// Missing columns keep a nominal value (25 C, 0 A, 1 bar, 13.8 V, D7 high,
+// D8 low); unknown columns and lines starting with '#' are ignored.
+//
+// Trace, binary (--to-binary, ~5x faster to read): "PCTRACE1", then 16-byte
+// little-endian records: uint32 dt_us (from the previous record), uint16
+// a1..a5, uint8 pins (bit 0 D7, bit 1 D8), uint8 reserved.
+//
+// setup() and loop() of PumpControl.ino run on the Arduino shim as in
+// plant_sim, so the samples go through the same code as on the Nano:
+// CurrentSensor/VoltageSensor/MapSensor filters, PowerProtection,
+// VoltageProtection, PwmInput (pulseIn() on the D8 edges of the trace),
+// pressureToTargetPercent(), soft-start and StatusLed. Every ADC conversion
+// reads the row valid at its sample instant. The trace is read as virtual
+// time advances, with at most the pulseIn() timeout of lookahead: memory
+// does not grow with the trace length.
+//
+// Timeline: one CSV line whenever an output changes, checked after each
+// loop() pass:
+//   t_ms, pump duty 1 and 2 (% at the gate, after the hardware inversion),
+//   PowerProtection level, VoltageProtection level, output forced off
+//   (safety or EMERGENCY), LED colour (RRGGBB)
+// Record a golden file with --out from a known-good build; replays after a
+// change run with --golden and print the first differences.
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+#include "ArduinoSim.h"
+#include "Mcp2515Model.h"
+#include "PowerProtection.h"
+#include "StatusLed.h"
+#include "VoltageProtection.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+// PumpControl.ino (firmware_sketch.cpp)
+void setup();
+void loop();
+extern PowerProtection g_protection;
+extern VoltageProtection g_voltageProtection;
+extern StatusLed g_statusLed;
+extern bool g_outputForcedOff;
+
+namespace {
+
+const char BINARY_MAGIC[8] = {'P', 'C', 'T', 'R', 'A', 'C', 'E', '1'};
+const size_t RECORD_BYTES = 16;
+const uint8_t PIN_BIT_D7 = 0x01;
+const uint8_t PIN_BIT_D8 = 0x02;
+const uint8_t ADC_PINS[5] = {Config::PIN_NTC_TEMP, Config::PIN_CURRENT_1, Config::PIN_CURRENT_2,
+                             Config::PIN_MAP_SENSOR, Config::PIN_VCC_SENSE};
+const char* const ADC_NAMES[5] = {"a1", "a2", "a3", "a4", "a5"};
+
+struct Row {
+    uint64_t tUs;
+    uint16_t adc[5];  // A1..A5 raw counts
+    uint8_t pins;     // PIN_BIT_D7 | PIN_BIT_D8
+};
+
+uint16_t countsFor(float volts) {
+    long counts = lround(volts / 5.0f * 1023.0f);
+    return (uint16_t)(counts < 0 ? 0 : (counts > 1023 ? 1023 : counts));
+}
+
+// Idle board: 25 C heatsink, no current, 1 bar absolute, 13.8 V, safety off
+Row nominalRow() {
+    Row r;
+    r.tUs = 0;
+    r.adc[0] = countsFor(5.0f * Config::NTC_R25 / (Config::NTC_R_PULLUP + Config::NTC_R25));
+    r.adc[1] = r.adc[2] = countsFor(Config::ACS758_ZERO_CURRENT_V);
+    r.adc[3] = countsFor(5.0f * (0.00125f * 101.3f + 0.04f));
+    r.adc[4] = countsFor(13.8f / 11.0f);
+    r.pins = PIN_BIT_D7;
+    return r;
+}
+
+// ----------------------------------------------------------------------------
+// Trace input (CSV or binary), one row at a time
+// ----------------------------------------------------------------------------
+class TraceReader {
+public:
+    ~TraceReader() {
+        if (_file) fclose(_file);
+    }
+
+    bool open(const char* path) {
+        _path = path;
+        _file = fopen(path, "rb");
+        if (!_file) {
+            perror(path);
+            return false;
+        }
+        setvbuf(_file, nullptr, _IOFBF, 1 << 20);
+        char magic[sizeof(BINARY_MAGIC)];
+        _binary = fread(magic, 1, sizeof(magic), _file) == sizeof(magic) &&
+                  memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0;
+        if (!_binary) {
+            rewind(_file);
+            return readHeader();
+        }
+        return true;
+    }
+
+    // Next row, times relative to the first one; false at the end or on error
+    bool read(Row& row) {
+        if (_failed) return false;
+        bool ok = _binary ? readBinary(row) : readCsv(row);
+        if (!ok) return false;
+        if (_rows == 0) _t0 = row.tUs;
+        if (row.tUs < _t0 || row.tUs - _t0 < _lastUs) {
+            return fail("time goes backwards");
+        }
+        row.tUs -= _t0;
+        _lastUs = row.tUs;
+        _rows++;
+        return true;
+    }
+
+    bool failed() const { return _failed; }
+    uint64_t rows() const { return _rows; }
+
+private:
+    FILE* _file = nullptr;
+    std::string _path;
+    bool _binary = false;
+    bool _failed = false;
+    uint64_t _rows = 0;
+    uint64_t _line = 0;
+    uint64_t _t0 = 0;
+    uint64_t _lastUs = 0;
+    uint64_t _binaryUs = 0;
+    Row _last = nominalRow();
+    // CSV column -> field: -1 ignored, 0 t_us, 1 t_s, 2..6 a1..a5, 7 d7, 8 d8
+    std::vector<int> _columns;
+    char _buf[4096];
+
+    bool fail(const char* what) {
+        fprintf(stderr, "trace_replay: %s:%llu: %s\n", _path.c_str(),
+                (unsigned long long)(_binary ? _rows + 1 : _line), what);
+        _failed = true;
+        return false;
+    }
+
+    bool nextLine() {
+        while (fgets(_buf, sizeof(_buf), _file)) {
+            _line++;
+            if (_buf[0] != '#' && _buf[0] != '\n' && _buf[0] != '\r') return true;
+        }
+        return false;
+    }
+
+    bool readHeader() {
+        if (!nextLine()) return fail("empty trace");
+        bool hasTime = false;
+        for (char* tok = strtok(_buf, ",\r\n"); tok; tok = strtok(nullptr, ",\r\n")) {
+            while (*tok == ' ') tok++;
+            int field = -1;
+            if (strcmp(tok, "t_us") == 0) field = 0;
+            else if (strcmp(tok, "t_s") == 0) field = 1;
+            else if (strcmp(tok, "d7") == 0) field = 7;
+            else if (strcmp(tok, "d8") == 0) field = 8;
+            for (int i = 0; i < 5; i++) {
+                if (strcmp(tok, ADC_NAMES[i]) == 0) field = 2 + i;
+            }
+            if (field == 0 || field == 1) hasTime = true;
+            _columns.push_back(field);
+        }
+        return hasTime ? true : fail("header needs a t_us or t_s column");
+    }
+
+    bool readCsv(Row& row) {
+        if (!nextLine()) return false;
+        row = _last;
+        char* p = _buf;
+        for (size_t c = 0; c < _columns.size(); c++) {
+            char* end = p;
+            int field = _columns[c];
+            if (field == 1) {
+                row.tUs = (uint64_t)llround(strtod(p, &end) * 1e6);
+            } else if (field >= 0) {
+                unsigned long long v = strtoull(p, &end, 10);
+                if (field == 0) row.tUs = v;
+                else if (field <= 6) row.adc[field - 2] = (uint16_t)(v > 1023 ? 1023 : v);
+                else {
+                    uint8_t bit = field == 7 ? PIN_BIT_D7 : PIN_BIT_D8;
+                    row.pins = v ? (uint8_t)(row.pins | bit) : (uint8_t)(row.pins & ~bit);
+                }
+            } else {
+                end = p + strcspn(p, ",\r\n");
+            }
+            if (end == p && field >= 0) return fail("bad number");
+            p = end;
+            if (*p == ',') p++;
+            else if (c + 1 < _columns.size()) return fail("missing columns");
+        }
+        _last = row;
+        return true;
+    }
+
+    bool readBinary(Row& row) {
+        uint8_t rec[RECORD_BYTES];
+        size_t n = fread(rec, 1, sizeof(rec), _file);
+        if (n == 0) return false;
+        if (n != sizeof(rec)) return fail("truncated record");
+        _binaryUs += (uint32_t)rec[0] | (uint32_t)rec[1] << 8 | (uint32_t)rec[2] << 16 |
+                     (uint32_t)rec[3] << 24;
+        row.tUs = _binaryUs;
+        for (int i = 0; i < 5; i++) {
+            row.adc[i] = (uint16_t)(rec[4 + 2 * i] | rec[5 + 2 * i] << 8);
+        }
+        row.pins = rec[14];
+        return true;
+    }
+};
+
+bool writeBinary(TraceReader& in, const char* path) {
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        perror(path);
+        return false;
+    }
+    fwrite(BINARY_MAGIC, 1, sizeof(BINARY_MAGIC), out);
+    Row row;
+    uint64_t lastUs = 0;
+    while (in.read(row)) {
+        uint64_t dt = row.tUs - lastUs;
+        if (dt > 0xFFFFFFFFULL) {
+            fprintf(stderr, "trace_replay: gap over 71 minutes at %.3f s\n", row.tUs * 1e-6);
+            fclose(out);
+            return false;
+        }
+        lastUs = row.tUs;
+        uint8_t rec[RECORD_BYTES] = {(uint8_t)dt, (uint8_t)(dt >> 8), (uint8_t)(dt >> 16),
+                                     (uint8_t)(dt >> 24)};
+        for (int i = 0; i < 5; i++) {
+            rec[4 + 2 * i] = (uint8_t)row.adc[i];
+            rec[5 + 2 * i] = (uint8_t)(row.adc[i] >> 8);
+        }
+        rec[14] = row.pins;
+        fwrite(rec, 1, sizeof(rec), out);
+    }
+    return fclose(out) == 0 && !in.failed();
+}
+
+// ----------------------------------------------------------------------------
+// The rows around virtual time: pin sources for the shim
+// ----------------------------------------------------------------------------
+class TraceWindow {
+public:
+    // Rows older than this behind the latest query are dropped (an ADC
+    // sample instant lies up to one conversion before the current time)
+    static const uint64_t HISTORY_US = 2000;
+
+    explicit TraceWindow(TraceReader& reader) : _reader(reader) {
+        Row first;
+        if (!_reader.read(first)) first = nominalRow();
+        _rows.push_back(first);
+    }
+
+    // Row valid at t (the last one at or before t)
+    const Row& at(uint64_t t) {
+        while (_rows.size() >= 2 && _rows[1].tUs + HISTORY_US <= t) {
+            _rows.pop_front();
+            if (_cursor) _cursor--;
+        }
+        while (!_eof && _rows.back().tUs <= t) load();
+        _cursor = indexAt(t, _cursor);
+        return _rows[_cursor];
+    }
+
+    // First row after fromUs where the pin bit differs, limitUs if none before
+    uint64_t nextChange(uint8_t bit, uint64_t fromUs, uint64_t limitUs) {
+        size_t i = indexAt(fromUs, _cursor);
+        uint8_t level = _rows[i].pins & bit;
+        for (i++;; i++) {
+            if (i == _rows.size() && !load()) return limitUs;
+            const Row& r = _rows[i];
+            if (r.tUs >= limitUs) return limitUs;
+            if ((r.pins & bit) != level) return r.tUs;
+        }
+    }
+
+    // Virtual time has passed the last row
+    bool finished(uint64_t t) {
+        while (!_eof && _rows.back().tUs <= t) load();
+        return _eof && t >= _rows.back().tUs;
+    }
+
+private:
+    TraceReader& _reader;
+    std::deque<Row> _rows;
+    size_t _cursor = 0;
+    bool _eof = false;
+
+    bool load() {
+        Row r;
+        if (_eof || !_reader.read(r)) {
+            _eof = true;
+            return false;
+        }
+        _rows.push_back(r);
+        return true;
+    }
+
+    size_t indexAt(uint64_t t, size_t i) const {
+        while (i > 0 && _rows[i].tUs > t) i--;
+        while (i + 1 < _rows.size() && _rows[i + 1].tUs <= t) i++;
+        return i;
+    }
+};
+
+class TraceAnalog : public sim::AnalogSource {
+public:
+    TraceAnalog(TraceWindow& w, uint8_t index) : _w(w), _index(index) {}
+    float volts(uint64_t nowUs) override { return _w.at(nowUs).adc[_index] * (5.0f / 1023.0f); }
+
+private:
+    TraceWindow& _w;
+    uint8_t _index;
+};
+
+class TraceDigital : public sim::DigitalSource {
+public:
+    TraceDigital(TraceWindow& w, uint8_t bit) : _w(w), _bit(bit) {}
+    uint8_t level(uint64_t nowUs) override { return (_w.at(nowUs).pins & _bit) ? HIGH : LOW; }
+    uint64_t nextEdge(uint64_t nowUs, uint64_t limitUs) override {
+        return _w.nextChange(_bit, nowUs, limitUs);
+    }
+
+private:
+    TraceWindow& _w;
+    uint8_t _bit;
+};
+
+// ----------------------------------------------------------------------------
+// Timeline
+// ----------------------------------------------------------------------------
+const char* const TIMELINE_HEADER = "# t_ms,duty1,duty2,protection,voltage,forced_off,led";
+
+struct Outputs {
+    int duty[2];  // 0.1 % at the gate
+    PowerProtection::ProtectionLevel level;
+    VoltageProtection::ProtectionLevel voltage;
+    bool forcedOff;
+    uint32_t led;
+
+    bool operator!=(const Outputs& o) const {
+        return duty[0] != o.duty[0] || duty[1] != o.duty[1] || level != o.level ||
+               voltage != o.voltage || forcedOff != o.forcedOff || led != o.led;
+    }
+};
+
+// Gate drive as the pump sees it: LOW runs the pump on the inverted board
+int gateDutyPermille(uint8_t pin) {
+    if (sim::getPinMode(pin) != OUTPUT) return 0;  // Driver pulls the gate off
+    float high = sim::getOutputDuty(pin);
+    float d = Config::PWM_INVERTED_BY_HARDWARE ? 1.0f - high : high;
+    return (int)lroundf(d * 1000.0f);
+}
+
+Outputs sampleOutputs() {
+    Outputs o;
+    o.duty[0] = gateDutyPermille(Config::PIN_PWM_OUT_1);
+    o.duty[1] = gateDutyPermille(Config::PIN_PWM_OUT_2);
+    o.level = g_protection.getLevel();
+    o.voltage = g_voltageProtection.getLevel();
+    o.forcedOff = g_outputForcedOff;
+    o.led = g_statusLed.getColor() & 0xFFFFFF;
+    return o;
+}
+
+std::string formatLine(uint64_t tUs, const Outputs& o) {
+    char buf[160];
+    snprintf(buf, sizeof(buf), "%llu.%03u,%d.%d,%d.%d,%s,%s,%d,%06X",
+             (unsigned long long)(tUs / 1000), (unsigned)(tUs % 1000), o.duty[0] / 10,
+             o.duty[0] % 10, o.duty[1] / 10, o.duty[1] % 10,
+             PowerProtection::getLevelString(o.level), VoltageProtection::getLevelString(o.voltage),
+             o.forcedOff ? 1 : 0, (unsigned)o.led);
+    return buf;
+}
+
+// Streams the timeline to a file and/or against a golden file
+class TimelineSink {
+public:
+    static const unsigned MAX_REPORTED = 10;
+
+    TimelineSink(FILE* out, FILE* golden) : _out(out), _golden(golden) {}
+
+    void emit(const std::string& line) {
+        _lines++;
+        if (_out) {
+            fputs(line.c_str(), _out);
+            fputc('\n', _out);
+        }
+        if (!_golden) return;
+        std::string expected;
+        bool have = nextGolden(expected);
+        if (have && expected == line) return;
+        if (_diffs++ < MAX_REPORTED) {
+            printf("line %llu:\n  golden: %s\n  replay: %s\n", (unsigned long long)_lines,
+                   have ? expected.c_str() : "(end of file)", line.c_str());
+        }
+    }
+
+    // Golden lines left over count as differences
+    void finish() {
+        if (!_golden) return;
+        std::string expected;
+        while (nextGolden(expected)) {
+            if (_diffs++ < MAX_REPORTED) {
+                printf("golden line not produced:\n  golden: %s\n", expected.c_str());
+            }
+        }
+    }
+
+    uint64_t lines() const { return _lines; }
+    uint64_t differences() const { return _diffs; }
+
+private:
+    FILE* _out;
+    FILE* _golden;
+    uint64_t _lines = 0;
+    uint64_t _diffs = 0;
+    char _buf[256];
+
+    bool nextGolden(std::string& line) {
+        if (!fgets(_buf, sizeof(_buf), _golden)) return false;
+        line = _buf;
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+        return true;
+    }
+};
+
+double wallSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: trace_replay [--out FILE] [--golden FILE] [--log FILE] [--to-binary FILE]\n"
+            "                    <trace.csv | trace.bin>\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* tracePath = nullptr;
+    const char* outPath = nullptr;
+    const char* goldenPath = nullptr;
+    const char* logPath = nullptr;
+    const char* binaryPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--out" && hasValue) {
+            outPath = argv[++i];
+        } else if (arg == "--golden" && hasValue) {
+            goldenPath = argv[++i];
+        } else if (arg == "--log" && hasValue) {
+            logPath = argv[++i];
+        } else if (arg == "--to-binary" && hasValue) {
+            binaryPath = argv[++i];
+        } else if (!tracePath && arg[0] != '-') {
+            tracePath = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!tracePath) {
+        usage();
+        return 2;
+    }
+
+    TraceReader reader;
+    if (!reader.open(tracePath)) return 2;
+    if (binaryPath) {
+        if (!writeBinary(reader, binaryPath)) return 2;
+        fprintf(stderr, "trace_replay: %llu rows -> %s\n", (unsigned long long)reader.rows(),
+                binaryPath);
+        return 0;
+    }
+
+    FILE* out = nullptr;
+    if (outPath) {
+        out = strcmp(outPath, "-") == 0 ? stdout : fopen(outPath, "w");
+    } else if (!goldenPath) {
+        out = stdout;
+    }
+    FILE* golden = goldenPath ? fopen(goldenPath, "r") : nullptr;
+    FILE* log = logPath ? fopen(logPath, "w") : nullptr;
+    if ((outPath && !out) || (goldenPath && !golden) || (logPath && !log)) {
+        perror("trace_replay");
+        return 2;
+    }
+
+    double wallStart = wallSeconds();
+    sim::reset();
+    sim::setSerialEcho(false);
+
+    TraceWindow window(reader);
+    std::vector<TraceAnalog> analog;
+    for (uint8_t i = 0; i < 5; i++) analog.push_back(TraceAnalog(window, i));
+    for (uint8_t i = 0; i < 5; i++) sim::setAnalogSource(ADC_PINS[i], &analog[i]);
+    TraceDigital safety(window, PIN_BIT_D7);
+    TraceDigital pwmIn(window, PIN_BIT_D8);
+    sim::setDigitalSource(Config::PIN_DIG_IN_1, &safety);
+    sim::setDigitalSource(Config::PIN_PWM_INPUT, &pwmIn);
+
+    // Same bus as plant_sim: telemetry goes out, nothing comes in
+    Mcp2515Model can(Config::PIN_CAN_INT, Config::CAN_CRYSTAL_MHZ * 1e6);
+    can.attach(Config::PIN_CAN_CS);
+
+    TimelineSink sink(out, golden);
+    sink.emit(TIMELINE_HEADER);
+    auto drain = [&] {
+        const std::string& serial = sim::serialOutput();
+        if (log && !serial.empty()) fwrite(serial.data(), 1, serial.size(), log);
+        sim::clearSerialOutput();
+        can.clearTransmitted();
+    };
+
+    setup();
+    drain();
+    Outputs last = sampleOutputs();
+    sink.emit(formatLine(sim::nowMicros(), last));
+    while (!window.finished(sim::nowMicros())) {
+        loop();
+        drain();
+        Outputs now = sampleOutputs();
+        if (now != last) {
+            sink.emit(formatLine(sim::nowMicros(), now));
+            last = now;
+        }
+    }
+    sink.finish();
+
+    double simS = sim::nowMicros() * 1e-6;
+    double wallS = wallSeconds() - wallStart;
+    fprintf(stderr, "trace_replay: %llu rows, %.1f s replayed in %.2f s (%.0fx), %llu timeline lines\n",
+            (unsigned long long)reader.rows(), simS, wallS, wallS > 0.0 ? simS / wallS : 0.0,
+            (unsigned long long)sink.lines());
+
+    if (out && out != stdout) fclose(out);
+    if (log) fclose(log);
+    if (reader.failed()) return 2;
+    if (golden) {
+        fclose(golden);
+        if (sink.differences()) {
+            printf("FAIL %llu timeline line(s) differ from %s\n",
+                   (unsigned long long)sink.differences(), goldenPath);
+            return 1;
+        }
+        printf("OK timeline matches %s (%llu lines)\n", goldenPath, (unsigned long long)sink.lines());
+    }
+    return 0;
+}